@@ -0,0 +1,358 @@
+// ArmModelTest.cpp
+// ArmChainModel's gravity pass on a small DH chain, checked against the
+// chain's potential energy worked out independently in doubles, a
+// GravityLookupTable of it against the chain itself between the grid points,
+// ArmKinematicsCache's partial rebuilds against the chain's full forward
+// kinematics, and ArmDynamics on a planar two link arm against its textbook
+// equations of motion.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/ArmChainModel.h"
+#include "RoveMotionControl/Experimental/ArmDynamics.h"
+#include "RoveMotionControl/Experimental/ArmKinematicsCache.h"
+#include "RoveMotionControl/Experimental/GravityInertiaSystemStatus.h"
+#include "RoveMotionControl/Experimental/GravityLookupTable.h"
+#include "HostTest.h"
+
+static const int Joints = 4;
+
+// a four joint arm with every DH parameter in use, centers of gravity off of
+// the links' axises and gravity not along any of the base's axises, so no
+// term of the gravity pass can cancel out by accident
+static const ArmLink Links[Joints] = {
+  {0.2, 0.25, 0.05, M_PI / 2, 3.0, {0.01, -0.12, 0.02}, {0.02, 0.03, 0.01, 0.001, 0, 0.002}},
+  {-0.4, 0.02, 0.35, 0.1, 2.2, {-0.17, 0.01, 0.03}, {0.004, 0.03, 0.03, 0, 0.001, 0}},
+  {M_PI / 2, 0, 0.05, M_PI / 2, 1.1, {0.02, 0.03, -0.09}, {0.01, 0.01, 0.002, 0, 0, 0.0005}},
+  {0.3, 0.22, 0, -M_PI / 2, 0.6, {0, 0.04, 0.06}, {0.002, 0.002, 0.001, 0, 0, 0}},
+};
+static const double Gravity[3] = {0.8, -1.3, -9.6};
+
+static const float Poses[][Joints] = {
+  {0, 0, 0, 0},
+  {0.7, -1.1, 0.4, 2.0},
+  {-2.5, 0.3, -1.9, -0.6},
+  {1.6, 2.4, 2.9, 1.1},
+};
+
+static void buildArm(ArmChainModel& arm) {
+  for (int i = 0; i < Joints; i++) {
+    arm.addLink(Links[i], 0);
+  }
+  arm.setGravity(Gravity[0], Gravity[1], Gravity[2]);
+}
+
+// potential energy of the chain at the given angles, in joules: the sum of
+// -m * g . c over the links' centers of gravity
+static double potentialEnergy(const double angles[]) {
+  Mat4<double> toLink;
+  double energy = 0;
+
+  for (int i = 0; i < Joints; i++) {
+    const ArmLink& link = Links[i];
+    toLink = toLink * Mat4<double>::fromDH(angles[i] + link.thetaOffset, link.d, link.a, link.alpha);
+
+    Vec3<double> cog = toLink.transformPoint(Vec3<double>(link.cog[0], link.cog[1], link.cog[2]));
+    energy -= link.mass * (Gravity[0] * cog.x + Gravity[1] * cog.y + Gravity[2] * cog.z);
+  }
+  return energy;
+}
+
+// the torque a joint needs to hold the arm up is the slope of the potential
+// energy along it. Central differences in doubles are good to h^2, far below
+// the float pass's own rounding
+static void testGravityMatchesPotential() {
+  ArmChainModel arm;
+  const double h = 1e-5;
+  float torques[Joints];
+  double worst = 0;
+
+  buildArm(arm);
+  for (unsigned p = 0; p < sizeof(Poses) / sizeof(Poses[0]); p++) {
+    double angles[Joints];
+    for (int i = 0; i < Joints; i++) {
+      angles[i] = Poses[p][i];
+    }
+
+    arm.gravityTorques(Poses[p], torques);
+    for (int i = 0; i < Joints; i++) {
+      double saved = angles[i];
+      angles[i] = saved + h;
+      double above = potentialEnergy(angles);
+      angles[i] = saved - h;
+      double below = potentialEnergy(angles);
+      angles[i] = saved;
+
+      // joules per radian to milli newton-meters
+      double expected = (above - below) / (2 * h) * 1000;
+      worst = fmax(worst, fabs(torques[i] - expected));
+      HOST_CHECK(fabs(torques[i] - expected) < 0.1 + fabs(expected) * 1e-5);
+    }
+  }
+  printf("gravity torques within %.3f milli newton-meters of the potential energy's slope\n", worst);
+}
+
+// the last three joints over a whole turn each, 10 degrees apart, with the
+// first held where it is
+static const int TablePoints = 37;
+static float tableStorage[TablePoints * TablePoints * TablePoints * Joints];
+
+static void testLookupTableMatchesModel() {
+  ArmChainModel arm;
+  GravityLookupTable table(tableStorage, sizeof(tableStorage) / sizeof(tableStorage[0]));
+  const float step = 2 * M_PI / (TablePoints - 1);
+  float held[GravityLookupTable::MaxJoints] = {0.7};
+  float angles[GravityLookupTable::MaxJoints] = {0.7};
+  float expected[GravityLookupTable::MaxJoints], looked[GravityLookupTable::MaxJoints];
+  float amplitude[Joints] = {0};
+  double worst = 0;
+  int i, k;
+
+  buildArm(arm);
+  GravityInertiaSystemStatus status(&arm);
+  for (i = 1; i < Joints; i++) {
+    HOST_CHECK(table.addDimension(i, -M_PI, M_PI, TablePoints));
+  }
+  HOST_CHECK(table.getTableLength(Joints) == sizeof(tableStorage) / sizeof(tableStorage[0]));
+  HOST_CHECK(table.generate(GravityInertiaSystemStatus::gravityModel, &status, Joints, held));
+  HOST_CHECK(table.isReady());
+
+  // the largest torque each joint sees anywhere on the grid
+  for (i = 0; i < TablePoints * TablePoints * TablePoints; i++) {
+    for (k = 0; k < Joints; k++) {
+      amplitude[k] = fmax(amplitude[k], fabs(tableStorage[i * Joints + k]));
+    }
+  }
+
+  // anywhere between the grid points, each of the three dimensions is off by
+  // at most the torque's amplitude * step^2 / 8
+  srand(45);
+  for (i = 0; i < 2000; i++) {
+    for (k = 1; k < Joints; k++) {
+      angles[k] = 2 * M_PI * rand() / RAND_MAX - M_PI;
+    }
+    arm.gravityTorques(angles, expected);
+    table.lookup(angles, looked);
+
+    for (k = 0; k < Joints; k++) {
+      worst = fmax(worst, fabs(looked[k] - expected[k]) / amplitude[k]);
+      HOST_CHECK(fabs(looked[k] - expected[k]) <= 3 * amplitude[k] * step * step / 8);
+    }
+  }
+  printf("gravity table within %.4f of each torque's amplitude off the grid, against a bound of %.4f; %.1f milli newton-meters at the cell centers\n",
+         worst, 3 * step * step / 8, table.getMeasuredError());
+
+  // and on the grid, it's the model
+  angles[1] = -M_PI + 4 * step;
+  angles[2] = -M_PI + 30 * step;
+  angles[3] = -M_PI + 17 * step;
+  arm.gravityTorques(angles, expected);
+  table.lookup(angles, looked);
+  for (k = 0; k < Joints; k++) {
+    HOST_CHECK(fabs(looked[k] - expected[k]) < 0.01 + fabs(expected[k]) * 1e-5);
+  }
+}
+
+// the largest difference between any element of two frames
+static float frameDifference(const Mat4<float>& a, const Mat4<float>& b) {
+  float worst = fmax(fmax(fabs(a.p.x - b.p.x), fabs(a.p.y - b.p.y)), fabs(a.p.z - b.p.z));
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      worst = fmax(worst, fabs(a.r[i][j] - b.r[i][j]));
+    }
+  }
+  return worst;
+}
+
+static void testKinematicsCacheRebuildsFromMovedJoint() {
+  ArmChainModel arm;
+  ArmKinematicsCache cache(&arm);
+  Mat4<float> before[Joints], expected[Joints];
+  const Mat4<float>* frames;
+  float angles[Joints], cachedTorques[Joints], fullTorques[Joints];
+  float worst = 0;
+  int i, k;
+
+  buildArm(arm);
+  for (i = 0; i < Joints; i++) {
+    angles[i] = Poses[1][i];
+  }
+
+  // the first update builds everything
+  frames = cache.update(angles);
+  HOST_CHECK(cache.getFirstRebuiltLink() == 0);
+
+  // moving joint k leaves the frames before it as they were, and rebuilds the
+  // rest to what working the whole chain out again gives
+  for (k = Joints - 1; k >= 0; k--) {
+    memcpy(before, frames, sizeof(before));
+    angles[k] += 0.3;
+
+    frames = cache.update(angles);
+    arm.forwardKinematics(angles, expected);
+    HOST_CHECK(cache.getFirstRebuiltLink() == k);
+    for (i = 0; i < k; i++) {
+      HOST_CHECK(memcmp(&frames[i], &before[i], sizeof(frames[i])) == 0);
+    }
+    for (i = 0; i < Joints; i++) {
+      worst = fmax(worst, frameDifference(frames[i], expected[i]));
+      HOST_CHECK(frameDifference(frames[i], expected[i]) < 1e-5);
+    }
+
+    cache.gravityTorques(angles, cachedTorques);
+    arm.gravityTorques(angles, fullTorques);
+    for (i = 0; i < Joints; i++) {
+      HOST_CHECK(fabs(cachedTorques[i] - fullTorques[i]) < 0.01);
+    }
+  }
+
+  // two joints at once rebuild from the nearer the base
+  angles[1] -= 0.2;
+  angles[3] += 0.1;
+  frames = cache.update(angles);
+  HOST_CHECK(cache.getFirstRebuiltLink() == 1);
+
+  // moves within the threshold rebuild nothing, so the frames stay where they were
+  memcpy(before, frames, sizeof(before));
+  angles[2] += 0.0005;
+  frames = cache.update(angles);
+  HOST_CHECK(cache.getFirstRebuiltLink() == Joints);
+  HOST_CHECK(memcmp(frames, before, sizeof(before)) == 0);
+
+  // and invalidating starts over from the base
+  cache.invalidate();
+  frames = cache.update(angles);
+  HOST_CHECK(cache.getFirstRebuiltLink() == 0);
+  arm.forwardKinematics(angles, expected);
+  for (i = 0; i < Joints; i++) {
+    HOST_CHECK(frameDifference(frames[i], expected[i]) < 1e-5);
+  }
+  printf("cached frames within %g of the full forward kinematics\n", worst);
+}
+
+// a planar two link arm turning about z with gravity along -y: link lengths,
+// masses, the distances from each joint out to its link's center of gravity,
+// and the links' inertias about z through their centers of gravity
+static const double L1 = 0.4, L2 = 0.3;
+static const double M1 = 2.5, M2 = 1.2;
+static const double C1 = 0.22, C2 = 0.13;
+static const double I1 = 0.04, I2 = 0.015;
+static const double G = 9.81;
+
+static void buildPlanarArm(ArmChainModel& arm) {
+  // each frame sits at the far end of its link, so the centers of gravity are
+  // back along the link's x. Ixx and Iyy never come into a planar motion
+  ArmLink first = {0, 0, L1, 0, M1, {C1 - L1, 0, 0}, {0.3, 0.2, I1, 0, 0, 0}};
+  ArmLink second = {0, 0, L2, 0, M2, {C2 - L2, 0, 0}, {0.1, 0.05, I2, 0, 0, 0}};
+
+  arm.addLink(first, 0);
+  arm.addLink(second, 0);
+  arm.setGravity(0, -G, 0);
+}
+
+// tau = M(q) qdd + C(q, qd) qd + g(q), from the arm's Lagrangian, in N*m
+static void planarArmTorques(const double q[2], const double qd[2], const double qdd[2], double tau[2], double mass[2][2],
+                             double velocity[2], double gravity[2]) {
+  double h = -M2 * L1 * C2 * sin(q[1]);
+
+  mass[0][0] = M1 * C1 * C1 + M2 * (L1 * L1 + C2 * C2 + 2 * L1 * C2 * cos(q[1])) + I1 + I2;
+  mass[0][1] = mass[1][0] = M2 * (C2 * C2 + L1 * C2 * cos(q[1])) + I2;
+  mass[1][1] = M2 * C2 * C2 + I2;
+
+  velocity[0] = h * (2 * qd[0] * qd[1] + qd[1] * qd[1]);
+  velocity[1] = -h * qd[0] * qd[0];
+
+  gravity[0] = (M1 * C1 + M2 * L1) * G * cos(q[0]) + M2 * C2 * G * cos(q[0] + q[1]);
+  gravity[1] = M2 * C2 * G * cos(q[0] + q[1]);
+
+  for (int i = 0; i < 2; i++) {
+    tau[i] = mass[i][0] * qdd[0] + mass[i][1] * qdd[1] + velocity[i] + gravity[i];
+  }
+}
+
+static bool closeTo(float torque, double expected) {
+  return fabs(torque - expected) < 0.05 + fabs(expected) * 1e-5;
+}
+
+static void testDynamicsMatchesLagrangian() {
+  ArmChainModel arm;
+  ArmDynamics dynamics(&arm);
+  const float motions[][6] = {
+    // q1, q2, qd1, qd2, qdd1, qdd2
+    {0, 0, 0, 0, 0, 0},
+    {0.5, -1.2, 1.5, -2.0, 3.0, -4.0},
+    {-2.1, 2.6, -3.0, 0.7, -1.0, 6.0},
+    {1.3, 0.4, 4.0, 4.0, 0, 0},
+  };
+  double worst = 0;
+
+  buildPlanarArm(arm);
+  for (unsigned m = 0; m < sizeof(motions) / sizeof(motions[0]); m++) {
+    const float* angles = motions[m];
+    const float* speeds = motions[m] + 2;
+    const float* accelerations = motions[m] + 4;
+    double q[2] = {angles[0], angles[1]}, qd[2] = {speeds[0], speeds[1]}, qdd[2] = {accelerations[0], accelerations[1]};
+    double tau[2], mass[2][2], velocity[2], gravity[2];
+    float full[2], gravityOnly[2], velocityOnly[2], inertias[2];
+
+    planarArmTorques(q, qd, qdd, tau, mass, velocity, gravity);
+    dynamics.inverseDynamics(angles, speeds, accelerations, full);
+    dynamics.gravityTorques(angles, gravityOnly);
+    dynamics.velocityTorques(angles, speeds, velocityOnly);
+    dynamics.jointInertias(angles, inertias);
+
+    // N*m to milli newton-meters
+    for (int i = 0; i < 2; i++) {
+      worst = fmax(worst, fabs(full[i] - tau[i] * 1000));
+      HOST_CHECK(closeTo(full[i], tau[i] * 1000));
+      HOST_CHECK(closeTo(gravityOnly[i], gravity[i] * 1000));
+      HOST_CHECK(closeTo(velocityOnly[i], velocity[i] * 1000));
+      HOST_CHECK(fabs(inertias[i] - mass[i][i]) < 1e-5);
+    }
+  }
+  printf("inverse dynamics within %.3f milli newton-meters of the lagrangian's\n", worst);
+}
+
+// what GravityInertiaSystemStatus publishes for a chain arm told how it's
+// moving is gravity plus the torque for the motion
+static void testStatusPublishesMotionTorque() {
+  ArmChainModel arm;
+  ArmDynamics dynamics(&arm);
+  const float angles[2] = {0, 0};
+  const float speeds[2] = {radians(60), radians(-90)};
+  const float accelerations[2] = {radians(200), radians(30)};
+  float expected[2];
+
+  // the links have no sensors, so the status reads them at 0
+  buildPlanarArm(arm);
+  GravityInertiaSystemStatus status(&arm);
+
+  status.update();
+  HOST_CHECK(status.getTorque(1) == status.getGravity(1) && status.getTorque(2) == status.getGravity(2));
+
+  status.setJointMotion(1, 60, 200);
+  status.setJointMotion(2, -90, 30);
+  status.update();
+  dynamics.inverseDynamics(angles, speeds, accelerations, expected);
+  HOST_CHECK(closeTo(status.getTorque(1), expected[0]) && closeTo(status.getTorque(2), expected[1]));
+  HOST_CHECK(fabs(status.getTorque(1) - status.getGravity(1)) > 100);
+
+  // stopping takes the motion back out
+  status.setJointMotion(1, 0, 0);
+  status.setJointMotion(2, 0, 0);
+  status.update();
+  HOST_CHECK(status.getTorque(1) == status.getGravity(1) && status.getTorque(2) == status.getGravity(2));
+}
+
+int main() {
+  testGravityMatchesPotential();
+  testLookupTableMatchesModel();
+  testKinematicsCacheRebuildsFromMovedJoint();
+  testDynamicsMatchesLagrangian();
+  testStatusPublishesMotionTorque();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("ArmModelTest");
+}
@@ -0,0 +1,57 @@
+// AxisGroupTest.cpp
+// AxisGroup's rate-monotonic tick on the virtual clock.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/MotionAxises/AxisGroup.h"
+#include "HostTest.h"
+
+static AxisGroup group;
+static uint32_t fastRuns = 0;
+static uint32_t slowRuns = 0;
+
+static void fastTask(void* context) {
+  fastRuns++;
+  delayMicroseconds(100);
+}
+
+// a tick interrupt that lands while this task runs must be turned away, not run the group again
+static void slowTask(void* context) {
+  slowRuns++;
+  group.tick();
+  delayMicroseconds(300);
+}
+
+int main() {
+  AxisGroupTaskStats stats;
+  uint32_t start;
+  int fast, slow;
+
+  fast = group.addTask(fastTask, NULL, 1000);
+  slow = group.addTask(slowTask, NULL, 10000);
+  HOST_CHECK(fast == 0 && slow == 1);
+  HOST_CHECK(group.addTask(fastTask, NULL, 0) == -1);
+
+  // 100ms of ticks every 100us
+  group.start();
+  start = micros();
+  while (micros() - start < 100000) {
+    group.tick();
+    delayMicroseconds(100);
+  }
+
+  HOST_CHECK(fastRuns == 100 || fastRuns == 101);
+  HOST_CHECK(slowRuns == 10 || slowRuns == 11);
+  HOST_CHECK(group.getOverlappedTicks() == slowRuns);
+
+  stats = group.getStats(fast);
+  HOST_CHECK(stats.runs == fastRuns && stats.period_us == 1000 && stats.deadlineMisses == 0);
+
+  // indexes outside the group
+  HOST_CHECK(group.getAxisStatus(-1) == InvalidInput);
+  HOST_CHECK(group.getAxisStatus(2) == InvalidInput);
+  HOST_CHECK(group.getAxisStatus(AxisGroup::MaxTasks) == InvalidInput);
+  stats = group.getStats(5);
+  HOST_CHECK(stats.runs == 0 && stats.period_us == 0);
+
+  return HostTestResult("AxisGroupTest");
+}
@@ -0,0 +1,174 @@
+// CartesianVelocityTest.cpp
+// CartesianVelocityController on a planar two link arm, whose jacobian is
+// known in closed form: following a twist away from singularities, staying
+// bounded at and around the stretched out one, and holding joints at their
+// limits.
+
+#include <math.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/CartesianVelocityController.h"
+#include "HostTest.h"
+
+static const float L1 = 0.4, L2 = 0.3;
+static const float Damping = 0.01;
+
+struct PlanarArm
+{
+  ArmChainModel chain;
+  FixedEncoder encoders[2];
+
+  PlanarArm() {
+    ArmLink first = {0, 0, L1, 0, 1, {0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+    ArmLink second = {0, 0, L2, 0, 1, {0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+
+    chain.addLink(first, &encoders[0]);
+    chain.addLink(second, &encoders[1]);
+  }
+
+  void moveTo(float q1, float q2) {
+    encoders[0].position = degreesToPos(q1 * 180 / M_PI);
+    encoders[1].position = degreesToPos(q2 * 180 / M_PI);
+  }
+};
+
+// the tool's velocity in the plane from the joint speeds, J * qd
+static void toolVelocity(float q1, float q2, float qd1, float qd2, float* vx, float* vy) {
+  *vx = -(L1 * sinf(q1) + L2 * sinf(q1 + q2)) * qd1 - L2 * sinf(q1 + q2) * qd2;
+  *vy = (L1 * cosf(q1) + L2 * cosf(q1 + q2)) * qd1 + L2 * cosf(q1 + q2) * qd2;
+}
+
+// sets the controller up for an arm that can only move its tool in the plane,
+// with the joints' max speeds out of the way so what's seen is the solve's own
+static void setUp(CartesianVelocityController& controller) {
+  controller.setDamping(Damping);
+  controller.setTaskWeights(1, 0);
+  controller.setCommandTimeout(0);
+  controller.setMaxJointSpeed(0, 1000);
+  controller.setMaxJointSpeed(1, 1000);
+}
+
+static void testFollowsTwist() {
+  PlanarArm arm;
+  CartesianVelocityController controller(&arm.chain);
+  float vx, vy;
+
+  setUp(controller);
+  arm.moveTo(0.4, 1.3);
+  controller.setTwist(0.05, -0.08, 0, 0, 0, 0);
+  HOST_CHECK(controller.update());
+
+  // well away from a singularity, the damping hardly shows
+  toolVelocity(0.4, 1.3, controller.getJointSpeed(0), controller.getJointSpeed(1), &vx, &vy);
+  HOST_CHECK(fabsf(vx - 0.05) < 0.001 && fabsf(vy + 0.08) < 0.001);
+  HOST_CHECK(controller.getLimitedJoints() == 0);
+}
+
+static void testBoundedAtSingularity() {
+  PlanarArm arm;
+  CartesianVelocityController controller(&arm.chain);
+  const float elbows[] = {0, 0.001, 0.01, 0.05};
+  const float speed = 0.1;
+  float worst = 0;
+  float vx, vy;
+
+  setUp(controller);
+
+  // stretched straight out along x, the tool can't move along x at all. Damped
+  // least squares never asks more than |v| / (2 * damping) of the joints, and
+  // gives none at all for a twist straight into the singular direction
+  for (unsigned e = 0; e < sizeof(elbows) / sizeof(elbows[0]); e++) {
+    arm.moveTo(0, elbows[e]);
+    controller.setTwist(speed, 0, 0, 0, 0, 0);
+    HOST_CHECK(controller.update());
+
+    float qd1 = controller.getJointSpeed(0), qd2 = controller.getJointSpeed(1);
+    float magnitude = sqrtf(qd1 * qd1 + qd2 * qd2);
+    worst = fmax(worst, magnitude);
+    HOST_CHECK(!isnan(magnitude));
+    HOST_CHECK(magnitude <= speed / (2 * Damping) * 1.001);
+    if (elbows[e] == 0) {
+      HOST_CHECK(magnitude < 1e-3);
+    }
+  }
+  printf("joint speeds for %g m/s into the singularity at most %.3f rad/s, against a bound of %.3f\n", speed, worst,
+         speed / (2 * Damping));
+
+  // with a tenth of the damping, the same twist just off the singularity gets
+  // far more than that
+  controller.setDamping(Damping / 10);
+  arm.moveTo(0, 0.01);
+  HOST_CHECK(controller.update());
+  HOST_CHECK(fabsf(controller.getJointSpeed(1)) > speed / (2 * Damping));
+
+  // while the direction it can move in is still followed as is
+  controller.setDamping(Damping);
+  arm.moveTo(0, 0);
+  controller.setTwist(0, speed, 0, 0, 0, 0);
+  HOST_CHECK(controller.update());
+  toolVelocity(0, 0, controller.getJointSpeed(0), controller.getJointSpeed(1), &vx, &vy);
+  HOST_CHECK(fabsf(vx) < 1e-4 && fabsf(vy - speed) < 0.001);
+}
+
+static void testJointLimits() {
+  PlanarArm arm;
+  CartesianVelocityController controller(&arm.chain);
+  float free1, free2, vx, vy;
+
+  setUp(controller);
+
+  // pulling the tool in towards the base bends the elbow further
+  arm.moveTo(0.2, 1.0);
+  controller.setTwist(-0.05 * cosf(0.7), -0.05 * sinf(0.7), 0, 0, 0, 0);
+  HOST_CHECK(controller.update());
+  free1 = controller.getJointSpeed(0);
+  free2 = controller.getJointSpeed(1);
+  HOST_CHECK(free2 > 0);
+
+  // with the elbow's limit just past it, within the margin, the elbow's held
+  // and the shoulder does what it can alone
+  controller.setJointLimits(1, -0.5, 1.02);
+  HOST_CHECK(controller.update());
+  HOST_CHECK(controller.getLimitedJoints() == 2);
+  HOST_CHECK(controller.getJointSpeed(1) == 0);
+  HOST_CHECK(controller.getJointSpeed(0) != 0);
+
+  // the shoulder alone moves the tool along its circle; what it gives is the
+  // least squares fit of the twist to that
+  toolVelocity(0.2, 1.0, controller.getJointSpeed(0), 0, &vx, &vy);
+  float tangentX = -(L1 * sinf(0.2) + L2 * sinf(1.2)), tangentY = L1 * cosf(0.2) + L2 * cosf(1.2);
+  float fit = (-0.05 * cosf(0.7) * tangentX - 0.05 * sinf(0.7) * tangentY) / (tangentX * tangentX + tangentY * tangentY);
+  HOST_CHECK(fabsf(controller.getJointSpeed(0) - fit) < 0.01 * fabsf(fit) + 1e-4);
+
+  // pushing the tool back out moves away from the limit, so nothing's held
+  controller.setTwist(0.05 * cosf(0.7), 0.05 * sinf(0.7), 0, 0, 0, 0);
+  HOST_CHECK(controller.update());
+  HOST_CHECK(controller.getLimitedJoints() == 0);
+  HOST_CHECK(controller.getJointSpeed(1) < 0);
+
+  // and a limit that wraps through 0 holds the same way
+  controller.setJointLimits(1, 5.5, 1.02);
+  controller.setTwist(-0.05 * cosf(0.7), -0.05 * sinf(0.7), 0, 0, 0, 0);
+  HOST_CHECK(controller.update());
+  HOST_CHECK(controller.getLimitedJoints() == 2);
+
+  // with no limit, a joint's max speed slows every joint by the same ratio, so
+  // the tool keeps going the same way
+  PlanarArm free;
+  CartesianVelocityController slowed(&free.chain);
+  setUp(slowed);
+  free.moveTo(0.2, 1.0);
+  slowed.setMaxJointSpeed(1, fabsf(free2) / 2);
+  slowed.setTwist(-0.05 * cosf(0.7), -0.05 * sinf(0.7), 0, 0, 0, 0);
+  HOST_CHECK(slowed.update());
+  HOST_CHECK(fabsf(slowed.getJointSpeed(1) - free2 / 2) < 1e-4);
+  HOST_CHECK(fabsf(slowed.getJointSpeed(0) - free1 / 2) < 1e-4);
+}
+
+int main() {
+  testFollowsTwist();
+  testBoundedAtSingularity();
+  testJointLimits();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("CartesianVelocityTest");
+}
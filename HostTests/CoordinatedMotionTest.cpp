@@ -0,0 +1,95 @@
+// CoordinatedMotionTest.cpp
+// CoordinatedMotionPlanner moves on the virtual clock, including a new move
+// given while one is still going.
+
+#include <math.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/CoordinatedMotionPlanner.h"
+#include "HostTest.h"
+
+static const long POS_RANGE = POS_MAX - POS_MIN;
+static const int Axises = 3;
+static const uint32_t Period_us = 1000;
+static const float MaxSpeed[Axises] = {30, 60, 90};
+static const float MaxAcceleration[Axises] = {60, 120, 200};
+static const float MaxJerk[Axises] = {400, 0, 2000};
+
+// signed change between two positions the short way round, in degrees
+static float stepDegrees(long from, long to) {
+  long step = to - from;
+  if (step > POS_RANGE / 2) step -= POS_RANGE;
+  if (step < -POS_RANGE / 2) step += POS_RANGE;
+  return step * 360.0 / POS_RANGE;
+}
+
+static CoordinatedMotionPlanner planner;
+static float speeds[Axises];
+static long lastSetpoints[Axises];
+static float worstSpeedStep[Axises];
+
+// one update a period for the given time or until the move's done, tracking
+// each setpoint's speed and the biggest change in it from one update to the next
+static bool runFor(uint32_t time_us) {
+  uint32_t start = micros();
+  bool going = true;
+  int i;
+
+  while (going && micros() - start < time_us) {
+    roveBoardHost_Advance(Period_us);
+    going = planner.update();
+    for (i = 0; i < Axises; i++) {
+      float speed = stepDegrees(lastSetpoints[i], planner.getSetpoint(i)) * 1000000.0 / Period_us;
+      worstSpeedStep[i] = fmaxf(worstSpeedStep[i], fabsf(speed - speeds[i]));
+      speeds[i] = speed;
+      lastSetpoints[i] = planner.getSetpoint(i);
+    }
+  }
+
+  return going;
+}
+
+int main() {
+  FixedEncoder encoders[Axises];
+  long first[Axises] = {degreesToPos(40), degreesToPos(-90), degreesToPos(150)};
+  long second[Axises] = {degreesToPos(70), degreesToPos(-20), degreesToPos(100)};
+  TrajectoryProfile solo;
+  float slowest = 0;
+  uint32_t start;
+  int i;
+
+  for (i = 0; i < Axises; i++) {
+    HOST_CHECK(planner.addAxis(&encoders[i], NULL, -1, MaxSpeed[i], MaxAcceleration[i], MaxJerk[i]) == i);
+    lastSetpoints[i] = 0;
+  }
+
+  // the first move takes as long as its slowest axis alone
+  for (i = 0; i < Axises; i++) {
+    solo.plan(stepDegrees(0, first[i]), MaxSpeed[i], MaxAcceleration[i], MaxJerk[i]);
+    slowest = fmaxf(slowest, solo.getDuration());
+  }
+  HOST_CHECK(planner.moveTo(first));
+  HOST_CHECK(fabsf(planner.getMoveDuration() - slowest) < 1e-4f);
+  for (i = 0; i < Axises; i++) {
+    lastSetpoints[i] = planner.getSetpoint(i);
+  }
+
+  // halfway through, every axis is moving when the second move comes in
+  HOST_CHECK(runFor(planner.getMoveDuration() * 500000));
+  for (i = 0; i < Axises; i++) {
+    HOST_CHECK(fabsf(speeds[i]) > MaxSpeed[i] / 4);
+  }
+
+  // the setpoints carry on from where they were rather than stopping dead
+  HOST_CHECK(planner.moveTo(second));
+  start = micros();
+  HOST_CHECK(!runFor(20000000));
+  HOST_CHECK(fabsf((micros() - start) / 1000000.0 - planner.getMoveDuration()) < 0.002f);
+  for (i = 0; i < Axises; i++) {
+    float stepBound = MaxAcceleration[i] * Period_us / 1000000.0 + 2 * 360000.0 / POS_RANGE * 1000000.0 / Period_us / 1000;
+    HOST_CHECK(worstSpeedStep[i] <= stepBound);
+    HOST_CHECK(planner.getSetpoint(i) == second[i]);
+  }
+  HOST_CHECK(planner.isMoveDone());
+
+  return HostTestResult("CoordinatedMotionTest");
+}
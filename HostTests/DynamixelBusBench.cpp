@@ -0,0 +1,91 @@
+// DynamixelBusBench.cpp
+// Latency and throughput of the common RoveDynamixel transactions on the
+// virtual bus, at the factory MX baud and at 1M. Bus time is the sim's
+// virtual time, i.e. what the transaction costs on the wire; host time is
+// what simulating it costs the PC. At 1M every transaction is over inside
+// DYNAMIXEL_ECHO_DELAY, so that wait is all the bus time there is.
+
+#include "RoveBoardHost.h"
+#include "RoveDynamixel.h"
+#include "RoveDynamixelSim.h"
+#include "HostBench.h"
+
+static const uint8_t BusUart = 3;
+static const int Servos = 4;
+static const uint32_t Transactions = 2000;
+
+static DynamixelSimBus sim;
+static Dynamixel dynas[Servos];
+static DynamixelShadow shadows[Servos];
+static uint8_t data[Servos * 4];
+static uint8_t errors[Servos];
+
+static void ping() {
+  DynamixelPing(dynas[0]);
+}
+
+static void readFeedback() {
+  DynamixelReadRegisters(dynas[0], DYNAMIXEL_PRESENT_POSITION_L, 4, data);
+}
+
+static void syncWriteGoals() {
+  DynamixelSendSyncWriteCommand(dynas, Servos, DYNAMIXEL_GOAL_POSITION_L, 2, data);
+}
+
+static void bulkReadFeedback() {
+  DynamixelBulkRead(dynas, Servos, DYNAMIXEL_PRESENT_POSITION_L, 4, data, errors);
+}
+
+typedef struct {
+  const char* name;
+  void (*run)();
+} BusTransaction;
+
+static const BusTransaction transactions[] = {
+  {"ping", ping},
+  {"read feedback", readFeedback},
+  {"sync-write goals to 4 servos", syncWriteGoals},
+  {"bulk read feedback of 4 servos", bulkReadFeedback},
+};
+
+static void benchBaud(uint32_t baud, uint8_t baudByte) {
+  char name[96];
+  uint32_t busStart;
+  uint64_t hostStart;
+  double bus_us;
+  uint32_t t, i;
+
+  DynamixelSimInit(&sim, baud, micros);
+  roveBoardHost_AttachUart(BusUart, &sim);
+
+  // replies as soon as the servo can, so the figures are the wire and nothing else
+  for (i = 0; i < Servos; i++) {
+    DynamixelSimAddServo(&sim, MX, i + 1, baudByte);
+    DynamixelInit(&dynas[i], MX, i + 1, BusUart, baud, 0, 0);
+    DynamixelAttachShadow(&dynas[i], &shadows[i]);
+    DynamixelSetReturnDelayTime(dynas[i], 0);
+  }
+  memset(data, 0, sizeof(data));
+
+  for (t = 0; t < sizeof(transactions) / sizeof(transactions[0]); t++) {
+    busStart = micros();
+    hostStart = HostBenchNow_ns();
+    for (i = 0; i < Transactions; i++) {
+      transactions[t].run();
+    }
+
+    snprintf(name, sizeof(name), "%s at %lu", transactions[t].name, (unsigned long)baud);
+    bus_us = (double)(micros() - busStart) / Transactions;
+    printf("%-48s %8.1f us bus, %6.0f per s\n", name, bus_us, 1000000.0 / bus_us);
+    HostBenchReport("  host", HostBenchNow_ns() - hostStart, Transactions);
+  }
+
+  roveBoardHost_AttachUart(BusUart, NULL);
+}
+
+int main() {
+  benchBaud(57600, 34);
+  benchBaud(1000000, 1);
+
+  return roveBoardHost_FaultCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// DynamixelDiscoveryTest.cpp
+// Bus discovery, baud migration and reply configuration against the virtual bus.
+
+#include "RoveBoardHost.h"
+#include "RoveDynamixel.h"
+#include "RoveDynamixelSim.h"
+#include "RoveDynamixelDiscovery.h"
+#include "HostTest.h"
+
+static const uint8_t BusUart = 2;
+
+static DynamixelSimBus sim;
+static DynamixelBus bus;
+
+static void testDiscoverAndConfigure() {
+  const uint32_t bauds[] = {1000000, 57600};
+
+  // AX servos read 250 as 7968 baud where MX servos read it as 2.25M, so it's no good for a mixed bus
+  const uint8_t migrateTo[] = {250, 1};
+  uint32_t packets, start;
+  uint8_t error;
+  int i;
+
+  DynamixelSimInit(&sim, 1000000, micros);
+  roveBoardHost_AttachUart(BusUart, &sim);
+  DynamixelSimAddServo(&sim, AX, 1, 1);
+  DynamixelSimAddServo(&sim, MX, 3, 34);
+
+  // an alarm shows up in every status packet, but the servo is still there
+  DynamixelSimGetServo(&sim, 3) -> alarms = DYNAMIXEL_ERROR_OVERHEATING;
+
+  DynamixelBusInit(&bus, BusUart, 0, 0);
+  HOST_CHECK(DynamixelBusDiscover(&bus, bauds, 2, 2) == 2);
+  HOST_CHECK(bus.servos[0].id == 1 && bus.models[0] == 12 && bus.servos[0].type == AX);
+  HOST_CHECK(bus.servos[1].id == 3 && bus.models[1] == 29 && bus.servos[1].type == MX);
+  HOST_CHECK(bus.servoBauds[1] == 57600);
+
+  // the alarmed servo's settings still made it into its shadow
+  packets = sim.stats.packetsReceived;
+  HOST_CHECK(DynamixelGetReturnDelayTime(bus.servos[1], &error) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(sim.stats.packetsReceived == packets);
+
+  HOST_CHECK(DynamixelBusMigrate(&bus, migrateTo, 2) == 1000000);
+  HOST_CHECK(DynamixelSimGetServo(&sim, 1) -> table[DYNAMIXEL_BAUD_RATE] == 1);
+  HOST_CHECK(DynamixelSimGetServo(&sim, 3) -> table[DYNAMIXEL_BAUD_RATE] == 1);
+
+  // the new levels are read back from the servos themselves, not their shadows
+  packets = sim.stats.packetsReceived;
+  error = DynamixelBusConfigureReplies(&bus, 0, DYNAMIXEL_RETURN_READ);
+  HOST_CHECK(!(error & DYNAMIXEL_ERROR_UNKNOWN));
+  HOST_CHECK(error & DYNAMIXEL_ERROR_OVERHEATING);
+  HOST_CHECK(sim.stats.packetsReceived - packets == 3 * bus.servoCount);
+
+  // writes to the now quiet servos neither wait for nor miss a reply
+  for (i = 0; i < bus.servoCount; i++) {
+    start = micros();
+    HOST_CHECK(DynamixelRotateJoint(bus.servos[i], 400) == DYNAMIXEL_ERROR_SUCCESS);
+    HOST_CHECK(micros() - start < TXDELAY);
+    HOST_CHECK(DynamixelSimGetServo(&sim, bus.servos[i].id) -> table[DYNAMIXEL_BAUD_RATE] == 1);
+    HOST_CHECK(DynamixelSimGetServo(&sim, bus.servos[i].id) -> table[DYNAMIXEL_GOAL_POSITION_L] == (400 & 0xFF));
+  }
+}
+
+// a servo that won't take the new baud is put back and stays reachable at the old one
+static void testMigrateRollsBack() {
+  const uint32_t bauds[] = {1000000};
+  const uint8_t stuck[] = {3};
+  const uint8_t fallback[] = {3, 1};
+  int i;
+
+  DynamixelSimInit(&sim, 1000000, micros);
+  roveBoardHost_AttachUart(BusUart, &sim);
+  DynamixelSimAddServo(&sim, AX, 4, 1);
+  DynamixelSimAddServo(&sim, MX, 5, 1);
+  DynamixelSimGetServo(&sim, 5) -> table[DYNAMIXEL_LOCK] = 1;
+
+  DynamixelBusInit(&bus, BusUart, 0, 0);
+  HOST_CHECK(DynamixelBusDiscover(&bus, bauds, 1, 2) == 2);
+
+  HOST_CHECK(DynamixelBusMigrate(&bus, stuck, 1) == 0);
+  HOST_CHECK(bus.servoBauds[0] == 500000 && bus.servoBauds[1] == 1000000);
+  for (i = 0; i < bus.servoCount; i++) {
+    roveBoard_UART_open(BusUart, bus.servoBauds[i], 0, 0);
+    HOST_CHECK(DynamixelPing(bus.servos[i]) == DYNAMIXEL_ERROR_SUCCESS);
+  }
+
+  // the servo that did move comes back to a rate they can share
+  HOST_CHECK(DynamixelBusMigrate(&bus, fallback, 2) == 1000000);
+  HOST_CHECK(bus.servoBauds[0] == 1000000 && bus.servoBauds[1] == 1000000);
+  HOST_CHECK(DynamixelSimGetServo(&sim, 4) -> table[DYNAMIXEL_BAUD_RATE] == 1);
+}
+
+int main() {
+  testDiscoverAndConfigure();
+  testMigrateRollsBack();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("DynamixelDiscoveryTest");
+}
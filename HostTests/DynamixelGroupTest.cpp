@@ -0,0 +1,189 @@
+// DynamixelGroupTest.cpp
+// Sync-write, bulk read, DynamixelGroup and DynamixelFeedback against the virtual bus.
+
+#include "RoveBoardHost.h"
+#include "RoveDynamixel.h"
+#include "RoveDynamixelSim.h"
+#include "RoveMotionControl/OutputDevices/DynamixelController.h"
+#include "RoveMotionControl/FeedbackDevices/DynamixelFeedback.h"
+#include "HostTest.h"
+
+static const uint8_t BusUart = 4;
+static const uint32_t BusBaud = 1000000;
+
+static DynamixelSimBus sim;
+
+// move() is only for the axis that owns the controller; the test stands in for it
+class TestDynamixelController : public DynamixelController
+{
+  public:
+    TestDynamixelController(DynamixelGroup* group, DynamixelType type, uint8_t id)
+      : DynamixelController(group, type, id, Joint, false) {}
+
+    void moveTo(long position) { move(position); }
+};
+
+static void setupSim() {
+  DynamixelSimInit(&sim, BusBaud, micros);
+  roveBoardHost_AttachUart(BusUart, &sim);
+}
+
+static void placeServo(uint8_t id, float rawPosition) {
+  DynamixelSimServo* servo = DynamixelSimGetServo(&sim, id);
+
+  servo -> position = rawPosition;
+  servo -> table[DYNAMIXEL_GOAL_POSITION_L] = (uint16_t)rawPosition & 0xFF;
+  servo -> table[DYNAMIXEL_GOAL_POSITION_H] = (uint16_t)rawPosition >> 8;
+}
+
+static void testSyncWrite() {
+  Dynamixel dynas[3];
+  uint8_t goals[6] = {100 & 0xFF, 100 >> 8, 2000 & 0xFF, 2000 >> 8, 3000 & 0xFF, 3000 >> 8};
+  uint32_t packets, statusPackets;
+  int i;
+
+  setupSim();
+  DynamixelSimAddServo(&sim, AX, 1, 1);
+  DynamixelSimAddServo(&sim, MX, 2, 1);
+  DynamixelSimAddServo(&sim, MX, 3, 1);
+  for (i = 0; i < 3; i++) {
+    DynamixelInit(&dynas[i], i == 0 ? AX : MX, i + 1, BusUart, BusBaud, 0, 0);
+  }
+
+  packets = sim.stats.packetsReceived;
+  statusPackets = sim.stats.statusPackets;
+  HOST_CHECK(DynamixelSendSyncWriteCommand(dynas, 3, DYNAMIXEL_GOAL_POSITION_L, 2, goals) == DYNAMIXEL_ERROR_SUCCESS);
+
+  // one packet, no replies, and every servo took its own two bytes
+  HOST_CHECK(sim.stats.packetsReceived == packets + 1);
+  HOST_CHECK(sim.stats.statusPackets == statusPackets);
+  for (i = 0; i < 3; i++) {
+    HOST_CHECK(DynamixelSimGetServo(&sim, i + 1) -> table[DYNAMIXEL_GOAL_POSITION_L] == goals[i * 2]);
+    HOST_CHECK(DynamixelSimGetServo(&sim, i + 1) -> table[DYNAMIXEL_GOAL_POSITION_H] == goals[i * 2 + 1]);
+  }
+}
+
+static void testBulkRead() {
+  Dynamixel dynas[4];
+  uint8_t data[4 * 2];
+  uint8_t errors[4];
+  uint8_t error;
+  int i;
+
+  setupSim();
+  for (i = 0; i < 3; i++) {
+    DynamixelSimAddServo(&sim, MX, i + 2, 1);
+    DynamixelInit(&dynas[i], MX, i + 2, BusUart, BusBaud, 0, 0);
+    placeServo(i + 2, 1000 * (i + 1));
+  }
+
+  // an overloaded servo still answers with its real position
+  DynamixelSimGetServo(&sim, 3) -> alarms = DYNAMIXEL_ERROR_OVERLOAD;
+
+  error = DynamixelBulkRead(dynas, 3, DYNAMIXEL_PRESENT_POSITION_L, 2, data, errors);
+  HOST_CHECK(error == DYNAMIXEL_ERROR_OVERLOAD);
+  HOST_CHECK(errors[0] == DYNAMIXEL_ERROR_SUCCESS && errors[1] == DYNAMIXEL_ERROR_OVERLOAD && errors[2] == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelDataValid(errors[1]));
+  for (i = 0; i < 3; i++) {
+    HOST_CHECK((data[i * 2] | data[i * 2 + 1] << 8) == 1000 * (i + 1));
+  }
+
+  // everyone listed after a servo that isn't there is left waiting on it
+  dynas[3] = dynas[2];
+  dynas[2] = dynas[1];
+  dynas[1].id = 9;
+  error = DynamixelBulkRead(dynas, 4, DYNAMIXEL_PRESENT_POSITION_L, 2, data, errors);
+  HOST_CHECK(errors[0] == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(errors[1] & DYNAMIXEL_ERROR_UNKNOWN && errors[2] & DYNAMIXEL_ERROR_UNKNOWN && errors[3] & DYNAMIXEL_ERROR_UNKNOWN);
+  HOST_CHECK(error & DYNAMIXEL_ERROR_UNKNOWN);
+  HOST_CHECK(!DynamixelDataValid(errors[3]));
+
+  DynamixelSimRead(&sim, NULL, DYNAMIXEL_SIM_RX_QUEUE_SIZE);
+}
+
+static void testGroupAndFeedback() {
+  DynamixelGroup* group;
+  TestDynamixelController* controllers[3];
+  DynamixelFeedback* feedbacks[3];
+  const DynamixelType types[3] = {AX, MX, MX};
+  const long goals[3] = {150000, 90000, 270000};
+  uint32_t packets;
+  long lastGood;
+  int i;
+
+  setupSim();
+  for (i = 0; i < 3; i++) {
+    DynamixelSimAddServo(&sim, types[i], i + 1, 1);
+  }
+
+  group = new DynamixelGroup(BusUart, BusBaud, 0, 0);
+  for (i = 0; i < 3; i++) {
+    controllers[i] = new TestDynamixelController(group, types[i], i + 1);
+    feedbacks[i] = new DynamixelFeedback(group, i + 1, InputPosition);
+  }
+  HOST_CHECK(group->indexOf(2) == 1 && group->indexOf(7) == -1);
+
+  // nothing has been read yet
+  feedbacks[0]->getFeedback();
+  HOST_CHECK(feedbacks[0]->getFeedbackStatus() == FeedbackStatus_Fail);
+
+  for (i = 0; i < 3; i++) {
+    controllers[i]->moveTo(goals[i]);
+  }
+
+  // every queued goal goes out in the one sync-write
+  packets = sim.stats.packetsReceived;
+  group->flush();
+  HOST_CHECK(sim.stats.packetsReceived == packets + 1);
+  for (i = 0; i < 3; i++) {
+    HOST_CHECK(DynamixelSimGetServo(&sim, i + 1) -> table[DYNAMIXEL_TORQUE_ENABLE] == 1);
+  }
+
+  // with nothing queued, a flush sends nothing
+  packets = sim.stats.packetsReceived;
+  group->flush();
+  HOST_CHECK(sim.stats.packetsReceived == packets);
+
+  delay(3000);
+
+  // one read for the AX servo and one bulk read for both MX servos
+  packets = sim.stats.packetsReceived;
+  group->refreshFeedback();
+  HOST_CHECK(sim.stats.packetsReceived == packets + 2);
+
+  for (i = 0; i < 3; i++) {
+    HOST_CHECK(labs(feedbacks[i]->getFeedback() - goals[i]) < 400);
+    HOST_CHECK(feedbacks[i]->getFeedbackStatus() == FeedbackStatus_Success);
+    HOST_CHECK(feedbacks[i]->getAlarms() == 0);
+  }
+
+  // an overheating servo keeps giving feedback, alarm and all
+  DynamixelSimGetServo(&sim, 2) -> alarms = DYNAMIXEL_ERROR_OVERHEATING;
+  DynamixelSimGetServo(&sim, 1) -> alarms = DYNAMIXEL_ERROR_OVERLOAD;
+  group->update();
+  for (i = 0; i < 3; i++) {
+    HOST_CHECK(labs(feedbacks[i]->getFeedback() - goals[i]) < 400);
+    HOST_CHECK(feedbacks[i]->getFeedbackStatus() == FeedbackStatus_Success);
+  }
+  HOST_CHECK(feedbacks[0]->getAlarms() == DYNAMIXEL_ERROR_OVERLOAD);
+  HOST_CHECK(feedbacks[1]->getAlarms() == DYNAMIXEL_ERROR_OVERHEATING);
+  HOST_CHECK(feedbacks[2]->getAlarms() == 0);
+
+  // a servo that stops answering fails its feedback and holds the last good reading
+  lastGood = feedbacks[2]->getFeedback();
+  DynamixelSimGetServo(&sim, 3) -> table[DYNAMIXEL_ID] = 30;
+  DynamixelSimGetServo(&sim, 3) -> id = 30;
+  group->update();
+  HOST_CHECK(feedbacks[2]->getFeedback() == lastGood);
+  HOST_CHECK(feedbacks[2]->getFeedbackStatus() == FeedbackStatus_Fail);
+  HOST_CHECK(feedbacks[0]->getFeedbackStatus() == FeedbackStatus_Success);
+}
+
+int main() {
+  testSyncWrite();
+  testBulkRead();
+  testGroupAndFeedback();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("DynamixelGroupTest");
+}
@@ -0,0 +1,207 @@
+// DynamixelSimTest.cpp
+// RoveDynamixel and the bus scheduler driven against the virtual bus.
+
+#include "RoveBoardHost.h"
+#include "RoveDynamixel.h"
+#include "RoveDynamixelSim.h"
+#include "RoveDynamixelScheduler.h"
+#include "HostTest.h"
+
+static const uint8_t BusUart = 1;
+static const uint32_t BusBaud = 1000000;
+
+static DynamixelSimBus bus;
+
+static void setupBus(Dynamixel* ax, Dynamixel* mx) {
+  DynamixelSimInit(&bus, BusBaud, micros);
+  roveBoardHost_AttachUart(BusUart, &bus);
+
+  DynamixelSimAddServo(&bus, AX, 1, 1);
+  DynamixelSimAddServo(&bus, MX, 2, 1);
+
+  DynamixelInit(ax, AX, 1, BusUart, BusBaud, 0, 0);
+  DynamixelInit(mx, MX, 2, BusUart, BusBaud, 0, 0);
+}
+
+static void testPingAndMove() {
+  Dynamixel ax, mx, missing;
+  uint16_t position;
+
+  setupBus(&ax, &mx);
+  missing = ax;
+  missing.id = 9;
+
+  HOST_CHECK(DynamixelPing(ax) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelPing(mx) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelPing(missing) & DYNAMIXEL_ERROR_UNKNOWN);
+
+  HOST_CHECK(DynamixelSetMode(ax, Joint) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelRotateJoint(ax, 100) == DYNAMIXEL_ERROR_SUCCESS);
+  delay(2000);
+  HOST_CHECK(DynamixelGetPresentPosition(ax, &position) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(position == 100);
+}
+
+static void testShadowElidesWrites() {
+  Dynamixel ax, mx;
+  DynamixelShadow shadow;
+  DynamixelMode mode = Wheel;
+  uint32_t packets;
+
+  setupBus(&ax, &mx);
+  DynamixelAttachShadow(&ax, &shadow);
+
+  HOST_CHECK(DynamixelSetMode(ax, Joint) == DYNAMIXEL_ERROR_SUCCESS);
+
+  packets = bus.stats.packetsReceived;
+  HOST_CHECK(DynamixelSetMode(ax, Joint) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelGetMode(ax, &mode) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(mode == Joint);
+  HOST_CHECK(bus.stats.packetsReceived == packets);
+}
+
+static void testCoordinatedMove() {
+  Dynamixel dynas[2];
+  uint16_t goals[2] = {700, 3000};
+  uint16_t speeds[2] = {0, 0};
+  uint16_t position;
+
+  setupBus(&dynas[0], &dynas[1]);
+
+  HOST_CHECK(DynamixelCoordinatedMove(dynas, 2, goals, speeds) == DYNAMIXEL_ERROR_SUCCESS);
+  delay(3000);
+  HOST_CHECK(DynamixelGetPresentPosition(dynas[0], &position) == DYNAMIXEL_ERROR_SUCCESS && position == 700);
+  HOST_CHECK(DynamixelGetPresentPosition(dynas[1], &position) == DYNAMIXEL_ERROR_SUCCESS && position == 3000);
+}
+
+// a servo that only answers reads gives nothing back for REG_WRITE, so staging mustn't wait on it
+static void testStagingQuietServo() {
+  Dynamixel ax, mx;
+  DynamixelShadow shadow;
+  uint32_t start;
+
+  setupBus(&ax, &mx);
+  DynamixelAttachShadow(&ax, &shadow);
+  HOST_CHECK(DynamixelSetStatusReturnLevel(ax, DYNAMIXEL_RETURN_READ) == DYNAMIXEL_ERROR_SUCCESS);
+
+  start = micros();
+  HOST_CHECK(DynamixelStagePosition(ax, 300) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(micros() - start < TXDELAY);
+
+  // a servo that does answer is still waited on and its reply parsed
+  HOST_CHECK(DynamixelStagePosition(mx, 300) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(bus.rxCount == 0);
+}
+
+static void testSchedulerRates() {
+  Dynamixel ax, mx;
+  DynamixelScheduler sched;
+  uint8_t telemetry[DYNAMIXEL_SCHEDULER_MAX_TELEMETRY];
+  int axSlot, mxSlot, i;
+
+  setupBus(&ax, &mx);
+  DynamixelSchedulerInit(&sched, ax.uart, BusBaud, 100, DYNAMIXEL_GOAL_POSITION_L, 2);
+
+  HOST_CHECK(DynamixelSchedulerAddServo(&sched, ax, 30, 0, 0, 0) == -1);
+  HOST_CHECK(DynamixelSchedulerAddServo(&sched, ax, 100, 30, DYNAMIXEL_PRESENT_POSITION_L, 2) == -1);
+  HOST_CHECK(DynamixelSchedulerAddServo(&sched, ax, 200, 0, 0, 0) == -1);
+
+  axSlot = DynamixelSchedulerAddServo(&sched, ax, 100, 50, DYNAMIXEL_PRESENT_POSITION_L, 2);
+  mxSlot = DynamixelSchedulerAddServo(&sched, mx, 50, 1, DYNAMIXEL_PRESENT_TEMPERATURE, 1);
+  HOST_CHECK(axSlot == 0 && mxSlot == 1);
+
+  DynamixelSchedulerSetGoalPosition(&sched, axSlot, 200);
+  DynamixelSchedulerSetGoalPosition(&sched, mxSlot, 100);
+
+  for (i = 0; i < 200; i++) {
+    uint32_t frameStart = micros();
+
+    DynamixelSchedulerRunFrame(&sched);
+    if (micros() - frameStart < 10000) {
+      delayMicroseconds(10000 - (micros() - frameStart));
+    }
+  }
+
+  HOST_CHECK(sched.frames == 200);
+  HOST_CHECK(sched.overruns == 0);
+  HOST_CHECK(DynamixelSchedulerGetTelemetry(&sched, axSlot, telemetry, NULL) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK((telemetry[0] | telemetry[1] << 8) == 200);
+}
+
+// the longest length byte used to run the sim's parser off the end of its packet buffer
+static void testOversizedPacket() {
+  Dynamixel ax, mx;
+  uint8_t junk[300];
+  uint32_t checksumErrors;
+
+  setupBus(&ax, &mx);
+  checksumErrors = bus.stats.checksumErrors;
+
+  memset(junk, 0x55, sizeof(junk));
+  junk[0] = 0xFF;
+  junk[1] = 0xFF;
+  junk[2] = 1;
+  junk[3] = 0xFF;
+  roveBoard_UART_write(ax.uart, junk, sizeof(junk));
+  roveBoard_UART_read(ax.uart, NULL, sizeof(junk));
+
+  HOST_CHECK(bus.stats.checksumErrors == checksumErrors + 1);
+  HOST_CHECK(bus.packetLength < DYNAMIXEL_SIM_MAX_PACKET);
+  HOST_CHECK(DynamixelPing(ax) == DYNAMIXEL_ERROR_SUCCESS);
+}
+
+// at the slowest baud a reply byte takes longer to cross the wire than the old fixed 1ms byte timeout
+static void testSlowestBaud() {
+  Dynamixel ax;
+  uint16_t position;
+
+  DynamixelSimInit(&bus, DYNAMIXEL_MIN_BAUD, micros);
+  roveBoardHost_AttachUart(BusUart, &bus);
+  DynamixelSimAddServo(&bus, AX, 1, 254);
+  DynamixelInit(&ax, AX, 1, BusUart, DYNAMIXEL_MIN_BAUD, 0, 0);
+
+  HOST_CHECK(DynamixelPing(ax) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(DynamixelGetPresentPosition(ax, &position) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(bus.rxCount == 0);
+}
+
+// an empty group or one too big for the length byte is refused rather than sent
+static void testGroupPacketBounds() {
+  Dynamixel dynas[85];
+  uint8_t data[85 * 3];
+  uint8_t errors[85];
+  uint32_t packets;
+  int i;
+
+  setupBus(&dynas[0], &dynas[1]);
+  for (i = 2; i < 85; i++) {
+    dynas[i] = dynas[1];
+  }
+  memset(data, 0, sizeof(data));
+  packets = bus.stats.packetsReceived;
+
+  HOST_CHECK(DynamixelSendSyncWriteCommand(dynas, 0, DYNAMIXEL_GOAL_POSITION_L, 2, data) == DYNAMIXEL_ERROR_RANGE);
+  HOST_CHECK(DynamixelSendSyncWriteCommand(dynas, 84, DYNAMIXEL_GOAL_POSITION_L, 2, data) == DYNAMIXEL_ERROR_RANGE);
+  HOST_CHECK(DynamixelSendBulkReadCommand(dynas, 0, DYNAMIXEL_PRESENT_POSITION_L, 2) == DYNAMIXEL_ERROR_RANGE);
+  HOST_CHECK(DynamixelBulkRead(dynas, 85, DYNAMIXEL_PRESENT_POSITION_L, 2, data, errors) & DYNAMIXEL_ERROR_RANGE);
+  HOST_CHECK(errors[0] & DYNAMIXEL_ERROR_UNKNOWN && errors[84] & DYNAMIXEL_ERROR_UNKNOWN);
+  HOST_CHECK(bus.stats.packetsReceived == packets);
+
+  // the largest group that fits still goes out as one packet
+  HOST_CHECK(DynamixelSendSyncWriteCommand(dynas, 83, DYNAMIXEL_GOAL_POSITION_L, 2, data) == DYNAMIXEL_ERROR_SUCCESS);
+  HOST_CHECK(bus.stats.packetsReceived == packets + 1);
+}
+
+int main() {
+  testPingAndMove();
+  testShadowElidesWrites();
+  testCoordinatedMove();
+  testStagingQuietServo();
+  testSchedulerRates();
+  testOversizedPacket();
+  testSlowestBaud();
+  testGroupPacketBounds();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("DynamixelSimTest");
+}
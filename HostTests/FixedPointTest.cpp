@@ -0,0 +1,151 @@
+// FixedPointTest.cpp
+// PIAlgorithm, PIVConverter and VelocityDeriver on the fixed point MotionReal
+// against the float one. The Makefile builds this twice: the float build runs
+// the converters over a scripted set of readings and writes what they gave to
+// FIXED_POINT_TRACE, and the ROVEMOTION_FIXED_POINT build runs them over the
+// same readings and checks its outputs against the trace, to the tolerances
+// RoveFixedPoint.h and the readme give.
+
+#include <math.h>
+#include <stdlib.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/IOConverters/PIAlgorithm.h"
+#include "RoveMotionControl/Experimental/PIVConverter.h"
+#include "RoveMotionControl/Experimental/VelocityDeriver.h"
+#include "HostTest.h"
+
+static const int Runs = 3000;
+static const float DT = 0.01;
+
+// PIAlgorithm's output is within this many power percent units of the float version's. PIVConverter's is a running
+// total of its velocity loop's rounded outputs, so it can wander further; this far over these readings
+static const long PowerTolerance = 1;
+static const long PIVPowerTolerance = 5;
+
+// VelocityDeriver's speed from each reading is within this many milli-degrees/s, divided by the milliseconds
+// between readings, plus 1 for truncating it. Its low pass filter carries those errors on and can round each output
+// a unit differently, so the filtered output is within the largest of them plus 1 / (1 - k)
+static const long SpeedTolerance = 16;
+static const float FilterConstant = 0.8;
+
+// a speed sensor that reads whatever the test last put in it
+class FixedSpeed : public FeedbackDevice
+{
+  public:
+    long speed;
+
+    FixedSpeed() : FeedbackDevice(InputSpeed), speed(0) {}
+
+    long getFeedback() { return speed; }
+    FeedbackDevice_Status getFeedbackStatus() { return FeedbackStatus_Success; }
+};
+
+typedef struct {
+  long piOutput;
+  long pivOutput;
+  long speed;
+  long filteredSpeed;
+  long dt_ms;
+} FixedPointStep;
+
+static FixedPointStep steps[Runs];
+
+// the same readings for both builds: an axis swinging around its destination
+// with some noise on the encoder, while a second one turns through 0 at
+// changing speeds for the deriver
+static void runConverters() {
+  float derivedDegrees = 300;
+  FixedEncoder loopEncoder, derivedEncoder;
+  FixedSpeed speedSensor;
+  PIAlgorithm pi(40, 10, DT, &loopEncoder);
+  PIVConverter piv(4, 1, 1, 2, DT, &loopEncoder, &speedSensor);
+  IOConverter* piLoop = &pi;
+  IOConverter* pivLoop = &piv;
+  IOConverter_Status status;
+  int i;
+
+  derivedEncoder.position = degreesToPos(derivedDegrees);
+  VelocityDeriver deriver(&derivedEncoder, 0), filteredDeriver(&derivedEncoder, FilterConstant);
+
+  srand(33);
+  for (i = 0; i < Runs; i++) {
+    loopEncoder.position = degreesToPos(60 + 25 * sinf(i * 0.013) + (rand() % 2001 - 1000) / 1000.0);
+    speedSensor.speed = (long)(400 * cosf(i * 0.021)) + rand() % 41 - 20;
+    steps[i].piOutput = piLoop->runAlgorithm(degreesToPos(62), &status);
+    steps[i].pivOutput = pivLoop->runAlgorithm(degreesToPos(62), &status);
+
+    steps[i].dt_ms = 1 + i % 7;
+    derivedDegrees += (40 + 30 * sinf(i * 0.005)) * steps[i].dt_ms / 1000.0 + (rand() % 201 - 100) / 1000.0;
+    derivedEncoder.position = degreesToPos(derivedDegrees);
+    roveBoardHost_Advance(steps[i].dt_ms * 1000);
+    steps[i].speed = deriver.getFeedback();
+    steps[i].filteredSpeed = filteredDeriver.getFeedback();
+  }
+}
+
+#ifndef ROVEMOTION_FIXED_POINT
+
+int main() {
+  FILE* trace;
+  int i;
+
+  runConverters();
+
+  trace = fopen(FIXED_POINT_TRACE, "w");
+  HOST_CHECK(trace != NULL);
+  if (trace != NULL) {
+    for (i = 0; i < Runs; i++) {
+      fprintf(trace, "%ld %ld %ld %ld %ld\n", steps[i].piOutput, steps[i].pivOutput, steps[i].speed, steps[i].filteredSpeed, steps[i].dt_ms);
+    }
+    fclose(trace);
+  }
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("FixedPointTest (float, writing the trace)");
+}
+
+#else
+
+int main() {
+  FixedPointStep floatStep;
+  long worstPower = 0, worstPIVPower = 0, worstSpeed = 0, worstFiltered = 0;
+  int matched = 0;
+  FILE* trace;
+  int i;
+
+  runConverters();
+
+  trace = fopen(FIXED_POINT_TRACE, "r");
+  HOST_CHECK(trace != NULL);
+  if (trace != NULL) {
+    for (i = 0; i < Runs; i++) {
+      if (fscanf(trace, "%ld %ld %ld %ld %ld", &floatStep.piOutput, &floatStep.pivOutput, &floatStep.speed,
+                 &floatStep.filteredSpeed, &floatStep.dt_ms) != 5) {
+        break;
+      }
+      matched++;
+
+      worstPower = fmax(worstPower, labs(steps[i].piOutput - floatStep.piOutput));
+      worstPIVPower = fmax(worstPIVPower, labs(steps[i].pivOutput - floatStep.pivOutput));
+      HOST_CHECK(labs(steps[i].piOutput - floatStep.piOutput) <= PowerTolerance);
+      HOST_CHECK(labs(steps[i].pivOutput - floatStep.pivOutput) <= PIVPowerTolerance);
+
+      // the speed tolerance is per reading, so scale it back up to compare
+      worstSpeed = fmax(worstSpeed, (labs(steps[i].speed - floatStep.speed) - 1) * steps[i].dt_ms);
+      HOST_CHECK((labs(steps[i].speed - floatStep.speed) - 1) * steps[i].dt_ms <= SpeedTolerance);
+
+      // the readings come a millisecond apart at the closest
+      worstFiltered = fmax(worstFiltered, labs(steps[i].filteredSpeed - floatStep.filteredSpeed));
+      HOST_CHECK(labs(steps[i].filteredSpeed - floatStep.filteredSpeed) <= SpeedTolerance + 1 + 1 / (1 - FilterConstant));
+    }
+    fclose(trace);
+  }
+  HOST_CHECK(matched == Runs);
+
+  printf("fixed point against float over %d runs: PI power within %ld, PIV power within %ld, speed within %ld/dt_ms + 1, "
+         "filtered speed within %ld\n", matched, worstPower, worstPIVPower, worstSpeed, worstFiltered);
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("FixedPointTest (fixed point, against the trace)");
+}
+
+#endif
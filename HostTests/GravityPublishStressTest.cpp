@@ -0,0 +1,194 @@
+// GravityPublishStressTest.cpp
+// GravityInertiaSystemStatus::update on one thread publishing as fast as it
+// can, with readers on others checking that every sample they copy out is
+// whole: its gravity and inertia are exactly what its own joint angles give.
+// Meanwhile the main thread generates gravity tables from the same status,
+// which have to come out as the chain's torques however update() is moving.
+
+#include <atomic>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "RoveBoardHost.h"
+#include <math.h>
+#include "RoveMotionControl/Experimental/GravityInertiaSystemStatus.h"
+#include "RoveMotionControl/Experimental/GravityLookupTable.h"
+#include "HostTest.h"
+
+static const int Joints = 6;
+static const int Readers = 3;
+static const long RunTime_ms = 1000;
+static const int TablePoints = 13;
+
+// moves on every time it's read, so every update has a new pose
+class SweepingEncoder : public FeedbackDevice
+{
+  public:
+    long position;
+    long step;
+
+    SweepingEncoder() : FeedbackDevice(InputPosition), position(0), step(0) {}
+
+    long getFeedback() {
+      position = (position + step) % POS_MAX;
+      return position;
+    }
+    FeedbackDevice_Status getFeedbackStatus() { return FeedbackStatus_Success; }
+};
+
+struct ReaderResult
+{
+  unsigned long samples;
+  unsigned long torn;
+  unsigned long backwards;
+};
+
+static ArmChainModel chain;
+static GravityInertiaSystemStatus* status;
+static std::atomic<bool> stopping(false);
+
+static void* writerThread(void* updates) {
+  while (!stopping) {
+    status->update();
+    (*(unsigned long*)updates)++;
+  }
+  return NULL;
+}
+
+static void* readerThread(void* result) {
+  ReaderResult* counts = (ReaderResult*)result;
+  ArmDynamics dynamics(&chain);
+  GravityInertiaSample sample;
+  float torques[GravityInertiaSample::MaxJoints];
+  float inertias[GravityInertiaSample::MaxJoints];
+  uint32_t lastSequence = 0;
+  int i;
+
+  while (!stopping) {
+    if (!status->getSample(sample)) {
+      continue;
+    }
+    counts->samples++;
+
+    if (sample.sequence < lastSequence) {
+      counts->backwards++;
+    }
+    lastSequence = sample.sequence;
+
+    chain.gravityTorques(sample.jointAngles, torques);
+    dynamics.jointInertias(sample.jointAngles, inertias);
+    for (i = 0; i < Joints; i++) {
+      if (sample.gravity[i] != (double)torques[i] || sample.inertia[i] != (double)inertias[i]) {
+        counts->torn++;
+        break;
+      }
+    }
+  }
+  return NULL;
+}
+
+// generates tables over joints 2 and 3 over and over until the run time is up,
+// checking every grid point against the chain. Returns how many were wrong
+static unsigned long generateTables(unsigned long* tables) {
+  static float storage[TablePoints * TablePoints * Joints];
+  GravityLookupTable table(storage, sizeof(storage) / sizeof(storage[0]));
+  const float step = 2 * M_PI / (TablePoints - 1);
+  float angles[GravityLookupTable::MaxJoints] = {0};
+  float looked[GravityLookupTable::MaxJoints], expected[GravityLookupTable::MaxJoints];
+  struct timespec start, now;
+  unsigned long wrong = 0;
+  int a, b, k;
+
+  table.addDimension(1, -M_PI, M_PI, TablePoints);
+  table.addDimension(2, -M_PI, M_PI, TablePoints);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  do {
+    table.generate(GravityInertiaSystemStatus::gravityModel, status, Joints, 0);
+    (*tables)++;
+
+    for (a = 0; a < TablePoints; a++) {
+      for (b = 0; b < TablePoints; b++) {
+        angles[1] = -M_PI + a * step;
+        angles[2] = -M_PI + b * step;
+        chain.gravityTorques(angles, expected);
+        table.lookup(angles, looked);
+        for (k = 0; k < Joints; k++) {
+          if (fabs(looked[k] - expected[k]) > 0.01 + fabs(expected[k]) * 1e-4) {
+            wrong++;
+            break;
+          }
+        }
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+  } while ((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000 < RunTime_ms);
+
+  return wrong;
+}
+
+int main() {
+  SweepingEncoder encoders[Joints];
+  float blob[2 + Joints * ArmChainModel::ConfigFloatsPerLink];
+  GravityInertiaSample sample;
+  ReaderResult results[Readers];
+  pthread_t writer, readers[Readers];
+  unsigned long updates = 0;
+  unsigned long tables = 0, wrongPoints;
+  int i, k;
+
+  // a made up six link arm with some weight on every link
+  srand(5);
+  blob[0] = ArmChainConfigVersion;
+  blob[1] = Joints;
+  for (i = 0; i < Joints; i++) {
+    float* link = &blob[2 + i * ArmChainModel::ConfigFloatsPerLink];
+    for (k = 0; k < ArmChainModel::ConfigFloatsPerLink; k++) {
+      link[k] = (rand() % 1000) / 1000.0f - 0.5f;
+    }
+    link[4] = 0.5f + i * 0.3f;
+    link[8] = link[9] = link[10] = 0.05f;
+  }
+  HOST_CHECK(chain.loadConfig(blob, sizeof(blob) / sizeof(blob[0])));
+  for (i = 0; i < Joints; i++) {
+    encoders[i].step = 997 + i * 131;
+    chain.setJointSensor(i, &encoders[i]);
+  }
+
+  status = new GravityInertiaSystemStatus(&chain);
+  HOST_CHECK(!status->getSample(sample));
+  HOST_CHECK(sample.sequence == 0);
+
+  // redo the kinematics on every update, so the results are exactly what the published angles give
+  status->getKinematics()->setThreshold(0);
+
+  for (i = 0; i < Readers; i++) {
+    results[i].samples = results[i].torn = results[i].backwards = 0;
+    pthread_create(&readers[i], NULL, readerThread, &results[i]);
+  }
+  pthread_create(&writer, NULL, writerThread, &updates);
+
+  wrongPoints = generateTables(&tables);
+  stopping = true;
+  pthread_join(writer, NULL);
+  for (i = 0; i < Readers; i++) {
+    pthread_join(readers[i], NULL);
+  }
+
+  printf("%lu updates published\n", updates);
+  HOST_CHECK(updates > 1000);
+  printf("%lu gravity tables generated alongside, %lu grid points wrong\n", tables, wrongPoints);
+  HOST_CHECK(tables > 10);
+  HOST_CHECK(wrongPoints == 0);
+  for (i = 0; i < Readers; i++) {
+    printf("reader %d: %lu samples, %lu torn, %lu out of order\n", i, results[i].samples, results[i].torn, results[i].backwards);
+    HOST_CHECK(results[i].samples > 1000);
+    HOST_CHECK(results[i].torn == 0);
+    HOST_CHECK(results[i].backwards == 0);
+  }
+
+  HOST_CHECK(status->getSample(sample));
+  HOST_CHECK(sample.sequence == updates);
+
+  delete status;
+  return HostTestResult("GravityPublishStressTest");
+}
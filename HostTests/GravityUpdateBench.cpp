@@ -0,0 +1,58 @@
+// GravityUpdateBench.cpp
+// GravityInertiaSystemStatus::update for the Atlas arm against the update it
+// replaced, built on double[4][4] arrays and the MatrixMath library.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/GravityInertiaSystemStatus.h"
+#include "LegacyAtlasGravity.h"
+#include "HostBench.h"
+
+static const uint32_t Updates = 2000000;
+
+class BenchEncoder : public FeedbackDevice
+{
+  public:
+    long position;
+
+    BenchEncoder() : FeedbackDevice(InputPosition), position(0) {}
+
+    long getFeedback() { return position; }
+    FeedbackDevice_Status getFeedbackStatus() { return FeedbackStatus_Success; }
+};
+
+static BenchEncoder joints[6];
+
+// a new pose each update, so nothing gets to cache it
+static void movePose(uint32_t i) {
+  joints[0].position = (i * 37) % POS_MAX;
+  joints[1].position = (i * 91) % POS_MAX;
+  joints[2].position = (i * 13) % POS_MAX;
+}
+
+int main() {
+  AtlasArmConstants constants(1.5, 0.3, 2.0, 1.2, 0.2, 3.0, 0, 4, 0, 1.5707963, 0, 0, 12, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                              0, 0, 0, &joints[0], &joints[1], &joints[2], &joints[3], &joints[4], &joints[5]);
+  LegacyAtlasGravity legacy(&constants);
+  GravityInertiaSystemStatus status(AtlasArm, &constants);
+  volatile double sink = 0;
+  uint64_t start;
+  uint32_t i;
+
+  start = HostBenchNow_ns();
+  for (i = 0; i < Updates; i++) {
+    movePose(i);
+    legacy.update();
+    sink += legacy.j2Gravity;
+  }
+  HostBenchReport("legacy Atlas update, MatrixMath", HostBenchNow_ns() - start, Updates);
+
+  start = HostBenchNow_ns();
+  for (i = 0; i < Updates; i++) {
+    movePose(i);
+    status.update();
+    sink += status.getGravity(2);
+  }
+  HostBenchReport("GravityInertiaSystemStatus::update, Atlas", HostBenchNow_ns() - start, Updates);
+
+  return 0;
+}
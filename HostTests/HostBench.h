@@ -0,0 +1,23 @@
+// HostBench.h
+// Wall clock timing for the host benchmarks. micros() is virtual time on the
+// host port, so benchmarks time themselves with the monotonic clock instead.
+
+#ifndef HOSTBENCH_H
+#define HOSTBENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static inline uint64_t HostBenchNow_ns() {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static inline void HostBenchReport(const char* name, uint64_t elapsed_ns, uint32_t iterations) {
+  printf("%-48s %8.1f ns\n", name, (double)elapsed_ns / iterations);
+}
+
+#endif
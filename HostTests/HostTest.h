@@ -0,0 +1,47 @@
+// HostTest.h
+// Bare-bones checks for the host tests: a failed check prints where it was and
+// the run carries on, and the test's main returns HostTestResult() to the Makefile.
+// Also the fixtures more than one test drives the motion control library with.
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <stdio.h>
+#include "RoveMotionControl/AbstractFramework.h"
+
+static int hostTestChecks = 0;
+static int hostTestFailures = 0;
+
+#define HOST_CHECK(condition) do { \
+    hostTestChecks++; \
+    if (!(condition)) { \
+      hostTestFailures++; \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while (0)
+
+static inline int HostTestResult(const char* name) {
+  printf("%s: %d checks, %d failed\n", name, hostTestChecks, hostTestFailures);
+  return hostTestFailures == 0 ? 0 : 1;
+}
+
+// a position sensor that reads wherever the test last put it
+class FixedEncoder : public FeedbackDevice
+{
+  public:
+    long position;
+
+    FixedEncoder() : FeedbackDevice(InputPosition), position(0) {}
+
+    long getFeedback() { return position; }
+    FeedbackDevice_Status getFeedbackStatus() { return FeedbackStatus_Success; }
+};
+
+// degrees to position units, wrapped into the position range
+static inline long degreesToPos(float degrees) {
+  const long range = POS_MAX - POS_MIN;
+  long position = (long)(degrees * range / 360.0) % range;
+  return position < 0 ? position + range : position;
+}
+
+#endif
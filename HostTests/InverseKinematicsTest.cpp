@@ -0,0 +1,240 @@
+// InverseKinematicsTest.cpp
+// ArmInverseKinematics on a three joint arm (a turning base, a shoulder and an
+// elbow), checking every solution by putting it back through the chain's
+// forward kinematics: single solves, batches along a path, a seed table over a
+// box that's partly out of reach, and the seed table's packed angles.
+
+#include <math.h>
+#include <stdlib.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/ArmInverseKinematics.h"
+#include "HostTest.h"
+
+static const int Joints = 3;
+static const float Base = 0.3, Upper = 0.4, Fore = 0.3;
+static const float Tolerance = 0.0005;
+
+struct ThreeJointArm
+{
+  ArmChainModel chain;
+  FixedEncoder encoders[Joints];
+
+  ThreeJointArm() {
+    ArmLink base = {0, Base, 0, M_PI / 2, 1, {0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+    ArmLink upper = {0, 0, Upper, 0, 1, {0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+    ArmLink fore = {0, 0, Fore, 0, 1, {0, 0, 0}, {0, 0, 0, 0, 0, 0}};
+
+    // the solver only moves joints that have sensors
+    chain.addLink(base, &encoders[0]);
+    chain.addLink(upper, &encoders[1]);
+    chain.addLink(fore, &encoders[2]);
+  }
+
+  // how far the tool ends up from the target at the given angles
+  float miss(const float angles[], const Vec3<float>& target) {
+    Mat4<float> frames[Joints];
+    chain.forwardKinematics(angles, frames);
+    Vec3<float> error = frames[Joints - 1].origin() - target;
+    return sqrtf(dot(error, error));
+  }
+
+  Vec3<float> toolAt(const float angles[]) {
+    Mat4<float> frames[Joints];
+    chain.forwardKinematics(angles, frames);
+    return frames[Joints - 1].origin();
+  }
+};
+
+static void testSolve() {
+  ThreeJointArm arm;
+  ArmInverseKinematics ik(&arm.chain);
+  const float known[Joints] = {0.6, 0.9, -1.4};
+  const float seed[Joints] = {0.4, 1.1, -1.1};
+  const float rest[Joints] = {0, 0.5, -0.5};
+  float angles[Joints];
+  int iterations;
+
+  // a target the arm can reach, from a nearby seed and from further off
+  Vec3<float> target = arm.toolAt(known);
+  iterations = ik.solve(target, seed, angles);
+  HOST_CHECK(iterations >= 1 && iterations <= 4);
+  HOST_CHECK(arm.miss(angles, target) <= Tolerance);
+  HOST_CHECK(ik.solve(target, rest, angles) >= 0);
+  HOST_CHECK(arm.miss(angles, target) <= Tolerance);
+
+  // the solutions come back in [0, 2pi), the same as the sensors read
+  for (int i = 0; i < Joints; i++) {
+    HOST_CHECK(angles[i] >= 0 && angles[i] < 2 * M_PI);
+  }
+
+  // already there takes no iterations
+  HOST_CHECK(ik.solve(target, known, angles) == 0);
+
+  // out of reach, it gives up, with the arm reaching towards it as far as it goes
+  Vec3<float> far(1.5, 0.2, 0.4);
+  HOST_CHECK(ik.solve(far, seed, angles) == -1);
+  HOST_CHECK(!isnan(angles[0]) && !isnan(angles[1]) && !isnan(angles[2]));
+  HOST_CHECK(fabsf(arm.miss(angles, far) - (sqrtf(1.5 * 1.5 + 0.2 * 0.2 + 0.1 * 0.1) - Upper - Fore)) < 0.01);
+
+  // a shoulder limit short of the solution clamps it, and the target's missed
+  ik.setJointLimits(1, 0, 0.7);
+  HOST_CHECK(ik.solve(target, seed, angles) == -1);
+  HOST_CHECK(angles[1] >= 0 && angles[1] <= 0.7 + 1e-6);
+}
+
+static void testSolveBatch() {
+  ThreeJointArm arm;
+  ArmInverseKinematics ik(&arm.chain);
+  const int Count = 200;
+  static Vec3<float> targets[Count];
+  static float angles[Count * Joints];
+  int8_t iterations[Count];
+  const float seed[Joints] = {0.2, 0.8, -1.2};
+  float solved[Joints];
+  int batchIterations = 0, coldIterations = 0;
+  int i;
+
+  // a straight line through the workspace, 2mm between targets
+  for (i = 0; i < Count; i++) {
+    targets[i] = Vec3<float>(0.45 - i * 0.001, -0.2 + i * 0.0015, 0.5 - i * 0.0005);
+  }
+
+  HOST_CHECK(ik.solveBatch(targets, Count, seed, angles, iterations) == Count);
+  for (i = 0; i < Count; i++) {
+    HOST_CHECK(iterations[i] >= 0);
+    HOST_CHECK(arm.miss(&angles[i * Joints], targets[i]) <= Tolerance);
+    batchIterations += iterations[i];
+
+    coldIterations += ik.solve(targets[i], seed, solved);
+  }
+
+  // each target starts from the one before, so after the first they're already close
+  printf("batch along a path: %.2f iterations per target, against %.2f each solved from the same seed\n",
+         batchIterations / (float)Count, coldIterations / (float)Count);
+  HOST_CHECK(batchIterations <= Count * 1.5);
+  HOST_CHECK(batchIterations * 2 < coldIterations);
+
+  // an unreachable target in the middle doesn't stop the rest, and isn't started from
+  targets[Count / 2] = Vec3<float>(2, 0, 0.3);
+  HOST_CHECK(ik.solveBatch(targets, Count, seed, angles, iterations) == Count - 1);
+  HOST_CHECK(iterations[Count / 2] == -1);
+  HOST_CHECK(iterations[Count / 2 + 1] >= 0 && iterations[Count / 2 + 1] <= 2);
+}
+
+static void testSeedTable() {
+  ThreeJointArm arm;
+  ArmInverseKinematics ik(&arm.chain);
+  const float start[Joints] = {0, 0.8, -1.2};
+  static uint16_t storage[11 * 11 * 6 * Joints];
+  float seed[Joints], angles[Joints];
+  uint32_t reachable = 0, reached;
+  int tableIterations = 0, coldIterations = 0, worstTable = 0;
+  int x, y, z, i;
+
+  // a box reaching out past the arm's 0.7m; its far corners are out of reach
+  HOST_CHECK(ik.setSeedGrid(Vec3<float>(0.1, -0.5, 0.05), Vec3<float>(0.8, 0.5, 0.55), 11, 11, 6));
+  HOST_CHECK(ik.getSeedTableLength() == sizeof(storage) / sizeof(storage[0]));
+  HOST_CHECK(!ik.getSeed(Vec3<float>(0.4, 0, 0.3), seed));
+  HOST_CHECK(ik.buildSeedTable(storage, ik.getSeedTableLength() - 1, start) == 0);
+
+  reached = ik.buildSeedTable(storage, sizeof(storage) / sizeof(storage[0]), start);
+
+  // every grid point within reach has a seed that puts the tool on it, to
+  // within the packing's half a unit per joint; every one past it has none
+  for (z = 0; z < 6; z++) {
+    for (y = 0; y < 11; y++) {
+      for (x = 0; x < 11; x++) {
+        Vec3<float> point(0.1 + x * 0.07, -0.5 + y * 0.1, 0.05 + z * 0.1);
+        Vec3<float> fromShoulder = point - Vec3<float>(0, 0, Base);
+        float distance = sqrtf(dot(fromShoulder, fromShoulder));
+
+        if (distance < Upper + Fore - 0.001) {
+          reachable++;
+          HOST_CHECK(ik.getSeed(point, seed));
+          HOST_CHECK(arm.miss(seed, point) <= Tolerance + (Upper + Fore) * M_PI / 65535 * Joints);
+        } else if (distance > Upper + Fore + 0.001) {
+          HOST_CHECK(!ik.getSeed(point, seed));
+        }
+      }
+    }
+  }
+  HOST_CHECK(reached >= reachable && reached < 11 * 11 * 6);
+  printf("seed table: %u of %u grid points reachable, %u bytes\n", reached, 11 * 11 * 6, (unsigned)sizeof(storage));
+
+  // between the grid points, a seed from the table converges in a couple of iterations
+  srand(48);
+  for (i = 0; i < 2000; i++) {
+    Vec3<float> target(0.1 + 0.7 * rand() / RAND_MAX, -0.5 + 1.0 * rand() / RAND_MAX, 0.05 + 0.5 * rand() / RAND_MAX);
+    Vec3<float> fromShoulder = target - Vec3<float>(0, 0, Base);
+    if (sqrtf(dot(fromShoulder, fromShoulder)) > Upper + Fore - 0.02) {
+      continue;
+    }
+
+    int fromTable = ik.solveFromTable(target, start, angles);
+    HOST_CHECK(fromTable >= 0);
+    HOST_CHECK(arm.miss(angles, target) <= Tolerance);
+    tableIterations += fromTable;
+    worstTable = fromTable > worstTable ? fromTable : worstTable;
+    coldIterations += ik.solve(target, start, angles);
+  }
+  printf("seeded from the table: %d iterations in total, at most %d for one target, against %d from one seed\n",
+         tableIterations, worstTable, coldIterations);
+  HOST_CHECK(tableIterations * 2 < coldIterations);
+
+  // a table built elsewhere works the same once handed over
+  ArmInverseKinematics copy(&arm.chain);
+  HOST_CHECK(copy.setSeedGrid(Vec3<float>(0.1, -0.5, 0.05), Vec3<float>(0.8, 0.5, 0.55), 11, 11, 6));
+  HOST_CHECK(!copy.useSeedTable(storage, sizeof(storage) / sizeof(storage[0]) - 1));
+  HOST_CHECK(copy.useSeedTable(storage, sizeof(storage) / sizeof(storage[0])));
+  HOST_CHECK(copy.getSeed(Vec3<float>(0.38, 0.1, 0.35), seed));
+
+  // off the grid there's no seed, and the fallback's used
+  HOST_CHECK(!copy.getSeed(Vec3<float>(0.0, 0, 0.3), seed));
+  HOST_CHECK(copy.solveFromTable(Vec3<float>(0.05, 0.1, 0.5), start, angles) >= 0);
+}
+
+static void testSeedPacking() {
+  const float unit = 2 * M_PI / 65535;
+  float worst = 0;
+  int i;
+
+  // a sweep over more than a turn either way, plus the edges of the turn
+  for (i = -70000; i <= 140000; i++) {
+    float angle = i * (float)(2 * M_PI / 70000) + 0.3 * unit;
+    uint16_t packed = ArmInverseKinematics::packSeedAngle(angle);
+    float error = fmodf(fabsf(ArmInverseKinematics::unpackSeedAngle(packed) - fmodf(angle + 4 * M_PI, 2 * M_PI)), 2 * M_PI);
+    error = fminf(error, 2 * M_PI - error);
+
+    HOST_CHECK(packed != ArmInverseKinematics::UnreachableSeed);
+    worst = fmax(worst, error);
+  }
+
+  const float edges[] = {0, unit * 0.49f, 2 * M_PI - unit * 0.49f, 2 * M_PI - unit * 0.51f, 2 * M_PI - 1e-6f, -1e-6f};
+  for (i = 0; i < (int)(sizeof(edges) / sizeof(edges[0])); i++) {
+    uint16_t packed = ArmInverseKinematics::packSeedAngle(edges[i]);
+    float error = fmodf(fabsf(ArmInverseKinematics::unpackSeedAngle(packed) - fmodf(edges[i] + 4 * M_PI, 2 * M_PI)), 2 * M_PI);
+    error = fminf(error, 2 * M_PI - error);
+
+    HOST_CHECK(packed != ArmInverseKinematics::UnreachableSeed);
+    worst = fmax(worst, error);
+  }
+
+  // just under a whole turn packs as 0, not as the last unit
+  HOST_CHECK(ArmInverseKinematics::packSeedAngle(2 * M_PI - unit * 0.49f) == 0);
+  HOST_CHECK(ArmInverseKinematics::packSeedAngle(2 * M_PI - unit) == 65534);
+  HOST_CHECK(ArmInverseKinematics::unpackSeedAngle(65534) < 2 * M_PI);
+
+  // half a unit, with a little for the float math around it
+  printf("packed seed angles within %.3g rad, half a unit being %.3g\n", worst, unit / 2);
+  HOST_CHECK(worst <= unit / 2 * 1.05);
+}
+
+int main() {
+  testSolve();
+  testSolveBatch();
+  testSeedTable();
+  testSeedPacking();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("InverseKinematicsTest");
+}
@@ -0,0 +1,159 @@
+// PIDConverterTest.cpp
+// PIDConverter's back-calculation anti-windup, derivative filter, feedforward
+// and setpoint weighting, seen through its output.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/IOConverters/PIDConverter.h"
+#include "RoveMotionControl/RoveMotionProfiler.h"
+#include "HostTest.h"
+
+static long runTimes(IOConverter* loop, long destination, int times) {
+  IOConverter_Status status;
+  long output = 0;
+
+  while (times-- > 0) {
+    output = loop->runAlgorithm(destination, &status);
+  }
+  return output;
+}
+
+static void testAntiWindup() {
+  FixedEncoder encoder;
+  PIDConverter pid(20, 20, 0, 0.01, &encoder);
+  IOConverter* loop = &pid;
+  long output;
+
+  // the tracking takes out the whole excess each run, so the bleed is as strong as it gets
+  pid.setAntiWindupTime(0);
+
+  // a stalled axis 10 degrees short winds the integral up to about KP * 10 on its own
+  output = runTimes(loop, degreesToPos(10), 100);
+  HOST_CHECK(output > 350 && output < 450);
+
+  // then a destination far the other way saturates the output negative. The
+  // clamp cuts off a negative output, so the bleed is positive; it mustn't
+  // push the still positive integral further up
+  output = runTimes(loop, degreesToPos(-90), 100);
+  HOST_CHECK(output == POWERPERCENT_MIN);
+
+  // back to the first destination, the integral has wound down rather than up
+  output = runTimes(loop, degreesToPos(10), 1);
+  HOST_CHECK(output > 150 && output < 250);
+}
+
+static void testDerivative() {
+  FixedEncoder encoder;
+  PIDConverter pid(1, 0, 0.5, 0.01, &encoder, 0);
+  IOConverter* loop = &pid;
+  long output, low = POWERPERCENT_MAX, high = POWERPERCENT_MIN;
+  int i;
+
+  // the derivative is on the measurement, so changing the destination doesn't kick it
+  HOST_CHECK(runTimes(loop, degreesToPos(90), 1) == 90);
+  HOST_CHECK(runTimes(loop, degreesToPos(100), 1) == 100);
+
+  // the axis moving at 100 degrees/s with the destination kept 90 degrees ahead.
+  // The filter (KD / KP / 10 = 0.05s) lets the derivative in gradually, from
+  // about a sixth of KD * speed on the first run to all of it
+  encoder.position = degreesToPos(1);
+  output = runTimes(loop, degreesToPos(91), 1);
+  HOST_CHECK(output >= 80 && output <= 83);
+  for (i = 2; i <= 100; i++) {
+    encoder.position = degreesToPos(i);
+    output = runTimes(loop, degreesToPos(i + 90), 1);
+  }
+  HOST_CHECK(output >= 39 && output <= 41);
+
+  // standing still with a degree of encoder noise, unfiltered that would swing
+  // the output by KD * 100 degrees/s = 50 either way
+  pid.reset();
+  for (i = 0; i < 100; i++) {
+    encoder.position = degreesToPos(i % 2);
+    output = runTimes(loop, degreesToPos(90), 1);
+    if (i >= 50) {
+      low = output < low ? output : low;
+      high = output > high ? output : high;
+    }
+  }
+  HOST_CHECK(low >= 84 && high <= 96);
+}
+
+static void testFeedforward() {
+  FixedEncoder encoder;
+  PIDConverter pid(1, 0, 0, 0.01, &encoder, 0);
+  IOConverter* loop = &pid;
+  IOConverter_Status status;
+
+  pid.setFeedforwardGains(2, 0.1);
+  pid.setFeedforward(30, 100);
+  HOST_CHECK(runTimes(loop, degreesToPos(10), 1) == 10 + 60 + 10);
+
+  // a moving destination keeps it going even at the destination
+  pid.setFeedforward(30, 0);
+  HOST_CHECK(loop->runAlgorithm(0, &status) == 60);
+  HOST_CHECK(status.flags == IOConverter_RunAgain);
+
+  // and once the destination stops, so does the axis
+  pid.setFeedforward(0, 0);
+  HOST_CHECK(loop->runAlgorithm(0, &status) == 0);
+  HOST_CHECK(status.flags == IOConverter_Complete);
+}
+
+static void testSetpointWeight() {
+  FixedEncoder stepped, streamed;
+  PIDConverter stepLoop(2, 0, 0, 0.01, &stepped, 0), streamLoop(2, 0, 0, 0.01, &streamed, 0);
+  IOConverter* step = &stepLoop;
+  IOConverter* stream = &streamLoop;
+  long output;
+  int i;
+
+  stepLoop.setSetpointWeight(0.75);
+  streamLoop.setSetpointWeight(0.75);
+
+  // a step of 40 degrees, the proportional term seeing only 3/4 of it
+  stepped.position = degreesToPos(340);
+  HOST_CHECK(runTimes(step, degreesToPos(20), 1) == 60);
+
+  // the same 40 degrees streamed in a degree at a time, across 0, with the
+  // axis following along. Wherever it's come from, the proportional term works
+  // on weight * destination - position: 2 * (0.75 * 40 - 20) either way
+  streamed.position = degreesToPos(340);
+  for (i = 1; i <= 40; i++) {
+    streamed.position = degreesToPos(340 + i / 2);
+    output = runTimes(stream, degreesToPos(340 + i), 1);
+  }
+  HOST_CHECK(output == 20);
+
+  stepped.position = degreesToPos(360);
+  HOST_CHECK(runTimes(step, degreesToPos(20), 1) == 20);
+}
+
+#ifdef ROVEMOTION_PROFILING
+// with the profiler built in, every feedback read is recorded against its encoder
+static void testProfiled() {
+  FixedEncoder encoder;
+  PIDConverter pid(1, 0, 0, 0.01, &encoder, 0);
+  const MotionProfileStats* stats;
+
+  MotionProfiler::start();
+  MotionProfiler::reset();
+  runTimes(&pid, degreesToPos(90), 10);
+
+  HOST_CHECK(MotionProfiler::getEntryCount() == 1);
+  stats = MotionProfiler::getEntry(0);
+  HOST_CHECK(stats != NULL && stats->module == &encoder && stats->site == ProfileSite_Feedback);
+  HOST_CHECK(stats != NULL && stats->count == 10 && stats->minTicks <= stats->maxTicks);
+}
+#endif
+
+int main() {
+  testAntiWindup();
+  testDerivative();
+  testFeedforward();
+  testSetpointWeight();
+#ifdef ROVEMOTION_PROFILING
+  testProfiled();
+#endif
+
+  return HostTestResult("PIDConverterTest");
+}
@@ -0,0 +1,173 @@
+// PathTimeParameterizerTest.cpp
+// PathTimeParameterizer on a six link arm, with the torques along the timed
+// move checked against the path's exact derivatives rather than the finite
+// differences the parameterizer works from. The limits only hold exactly at
+// the waypoints; PathTimeParameterizer.h gives 0.5% as the most they're gone
+// over by between them, from a hundred waypoints or from a few thousand, and
+// that's what's checked.
+
+#include <math.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/Experimental/PathTimeParameterizer.h"
+#include "HostTest.h"
+
+static const int Joints = 6;
+static const int Points = 101;
+static const int DensePoints = 3201;
+static const double Tolerance = 0.005;
+
+static const double Start[Joints] = {0.1, 0.6, 0.9, 0.2, 0.8, 0.3};
+static const double End[Joints] = {1.6, 1.5, -0.4, 1.2, -0.3, 2.0};
+
+static ArmChainModel arm;
+static float limits[Joints];
+
+// a straight line in joint space with a half sine bowed into it, s from 0 to 1
+static void pathAt(double s, double q[], double dq[], double ddq[]) {
+  for (int i = 0; i < Joints; i++) {
+    double bow = (i % 2) ? 0.3 : -0.3;
+    q[i] = Start[i] + (End[i] - Start[i]) * s + bow * sin(M_PI * s);
+    dq[i] = (End[i] - Start[i]) + bow * M_PI * cos(M_PI * s);
+    ddq[i] = -bow * M_PI * M_PI * sin(M_PI * s);
+  }
+}
+
+// the worst any joint's torque gets over its limit along the timed move, and
+// the fastest joint 1 goes. The path parameter is rebuilt from the waypoint
+// times and speeds the same way evaluate() does it
+static void checkMove(PathTimeParameterizer& timing, int points, double* worstRatio, double* fastestJoint1) {
+  ArmDynamics dynamics(&arm);
+  const int Samples = 20000;
+  double duration = timing.getDuration();
+  int k = 0;
+
+  *worstRatio = 0;
+  *fastestJoint1 = 0;
+  for (int n = 0; n <= Samples; n++) {
+    double t = duration * n / Samples;
+    while (k < points - 2 && t >= timing.getWaypointTime(k + 1)) {
+      k++;
+    }
+
+    double dt = t - timing.getWaypointTime(k);
+    double v0 = timing.getWaypointSpeed(k), v1 = timing.getWaypointSpeed(k + 1);
+    double acceleration = (v1 * v1 - v0 * v0) / 2;
+    double fraction = fmin(1, v0 * dt + acceleration * dt * dt / 2);
+    double s = (k + fraction) / (points - 1);
+    double sd = (v0 + acceleration * dt) / (points - 1);
+    double sdd = acceleration / (points - 1);
+
+    double q[Joints], dq[Joints], ddq[Joints];
+    float angles[Joints], speeds[Joints], accelerations[Joints], torques[Joints];
+    pathAt(s, q, dq, ddq);
+    for (int i = 0; i < Joints; i++) {
+      angles[i] = q[i];
+      speeds[i] = dq[i] * sd;
+      accelerations[i] = dq[i] * sdd + ddq[i] * sd * sd;
+    }
+
+    dynamics.inverseDynamics(angles, speeds, accelerations, torques);
+    for (int i = 0; i < Joints; i++) {
+      *worstRatio = fmax(*worstRatio, fabs(torques[i]) / limits[i]);
+    }
+    *fastestJoint1 = fmax(*fastestJoint1, fabs(speeds[0]));
+  }
+}
+
+// the path as the given amount of evenly spaced waypoints
+static void sample(int points, float waypoints[]) {
+  for (int k = 0; k < points; k++) {
+    double q[Joints], dq[Joints], ddq[Joints];
+    pathAt(k / (double)(points - 1), q, dq, ddq);
+    for (int i = 0; i < Joints; i++) {
+      waypoints[k * Joints + i] = q[i];
+    }
+  }
+}
+
+int main() {
+  // the parameterizer never reads the joints, but the chain wants a sensor for each
+  static FixedEncoder sensors[Joints];
+  static float waypoints[Points * Joints];
+  static float work[Points * (3 * Joints + 4)];
+  static float denseWaypoints[DensePoints * Joints];
+  static float denseWork[DensePoints * (3 * Joints + 4)];
+  const float halfPi = M_PI / 2;
+  const float dh[Joints][4] = {{0, 0.3, 0, halfPi}, {0, 0, 0.4, 0}, {halfPi, 0, 0, halfPi}, {0, 0.4, 0, -halfPi}, {0, 0, 0, halfPi}, {0, 0.1, 0, 0}};
+  const float kt[Joints] = {0.05, 0.05, 0.05, 0.03, 0.03, 0.02};
+  const float gear[Joints] = {40, 40, 30, 20, 20, 10};
+  double worstRatio, fastestJoint1;
+
+  for (int i = 0; i < Joints; i++) {
+    ArmLink link = {dh[i][0], dh[i][1], dh[i][2], dh[i][3], 1, {0, 0, 0}, {0.01, 0.01, 0.01, 0, 0, 0}};
+    arm.addLink(link, &sensors[i]);
+  }
+
+  sample(Points, waypoints);
+
+  PathTimeParameterizer timing(&arm, work, sizeof(work) / sizeof(work[0]));
+  HOST_CHECK(timing.getStorageLength(Points) == sizeof(work) / sizeof(work[0]));
+  HOST_CHECK(!timing.parameterize(waypoints, 2));
+
+  // 12V motors through 0.4 ohms
+  for (int i = 0; i < Joints; i++) {
+    timing.setMotorLimit(i, kt[i], 400, 12000, gear[i]);
+    limits[i] = kt[i] * 12 / 0.4 * gear[i] * 1000;
+  }
+
+  // the limits hold at the waypoints; between them the dynamics drift a
+  // little from what the waypoints sampled, within the tolerance
+  HOST_CHECK(timing.parameterize(waypoints, Points));
+  HOST_CHECK(timing.getDuration() > 0.2 && timing.getDuration() < 0.4);
+  HOST_CHECK(timing.getWaypointSpeed(0) == 0 && timing.getWaypointSpeed(Points - 1) == 0);
+  checkMove(timing, Points, &worstRatio, &fastestJoint1);
+  printf("torque limits: worst joint at %.4f of its limit over a %.3f s move\n", worstRatio, timing.getDuration());
+  HOST_CHECK(worstRatio > 0.99 && worstRatio <= 1 + Tolerance);
+
+  // the same path from far more waypoints, so close together the floats'
+  // rounding is a fair part of their second differences
+  PathTimeParameterizer dense(&arm, denseWork, sizeof(denseWork) / sizeof(denseWork[0]));
+  sample(DensePoints, denseWaypoints);
+  for (int i = 0; i < Joints; i++) {
+    dense.setMotorLimit(i, kt[i], 400, 12000, gear[i]);
+  }
+  HOST_CHECK(dense.parameterize(denseWaypoints, DensePoints));
+  checkMove(dense, DensePoints, &worstRatio, &fastestJoint1);
+  printf("torque limits from %d waypoints: worst joint at %.4f of its limit over a %.3f s move\n", DensePoints, worstRatio,
+         dense.getDuration());
+  HOST_CHECK(worstRatio > 0.99 && worstRatio <= 1 + Tolerance);
+  HOST_CHECK(fabs(dense.getDuration() - timing.getDuration()) < 0.01);
+
+  // a path whose waypoints are only a few floats' steps apart can't have its
+  // curvature told at all, and is refused
+  for (int k = 0; k < 5; k++) {
+    for (int i = 0; i < Joints; i++) {
+      denseWaypoints[k * Joints + i] = 1 + k * 3e-7f;
+    }
+  }
+  HOST_CHECK(!dense.parameterize(denseWaypoints, 5));
+
+  // where the same few waypoints spread out are fine
+  for (int k = 0; k < 5; k++) {
+    for (int i = 0; i < Joints; i++) {
+      denseWaypoints[k * Joints + i] = 1 + k * 0.05f;
+    }
+  }
+  HOST_CHECK(dense.parameterize(denseWaypoints, 5));
+
+  // a joint speed limit, the same
+  timing.setMaxJointSpeed(0, 0.5);
+  HOST_CHECK(timing.parameterize(waypoints, Points));
+  checkMove(timing, Points, &worstRatio, &fastestJoint1);
+  printf("joint 1 speed limit: fastest %.4f of its limit over a %.3f s move\n", fastestJoint1 / 0.5, timing.getDuration());
+  HOST_CHECK(worstRatio <= 1 + Tolerance);
+  HOST_CHECK(fastestJoint1 > 0.45 && fastestJoint1 <= 0.5 * (1 + Tolerance));
+
+  // a joint that can't hold the arm up anywhere along the path
+  timing.setMaxJointSpeed(0, 0);
+  timing.setTorqueLimit(1, 5000);
+  HOST_CHECK(!timing.parameterize(waypoints, Points));
+  HOST_CHECK(timing.getDuration() == 0);
+
+  return HostTestResult("PathTimeParameterizerTest");
+}
@@ -0,0 +1,49 @@
+// RoutePlannerBench.cpp
+// Route queries through PositionRoutePlanner against the float route finding it replaced.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/IOConverters/PositionRoutePlanner.h"
+#include "LegacyRoutePlanner.h"
+#include "HostBench.h"
+
+static const int Queries = 4096;
+static const int Rounds = 2000;
+
+static long presents[Queries];
+static long destinations[Queries];
+
+int main() {
+  LegacyRoutePlanner legacy;
+  PositionRoutePlanner planner;
+  volatile long sink = 0;
+  uint64_t start;
+  int round, i;
+
+  srand(3);
+  for (i = 0; i < Queries; i++) {
+    presents[i] = rand() % POS_MAX;
+    destinations[i] = rand() % POS_MAX;
+  }
+
+  legacy.hardStopPos1 = 30;
+  legacy.hardStopPos2 = 300;
+  planner.setHardStops(30000, 300000);
+
+  start = HostBenchNow_ns();
+  for (round = 0; round < Rounds; round++) {
+    for (i = 0; i < Queries; i++) {
+      sink += (long)legacy.calcRouteToDest(legacyDegrees(presents[i]), legacyDegrees(destinations[i]));
+    }
+  }
+  HostBenchReport("legacy calcRouteToDest, two hard stops", HostBenchNow_ns() - start, Rounds * Queries);
+
+  start = HostBenchNow_ns();
+  for (round = 0; round < Rounds; round++) {
+    for (i = 0; i < Queries; i++) {
+      sink += planner.routeTo(presents[i], destinations[i]);
+    }
+  }
+  HostBenchReport("PositionRoutePlanner::routeTo, two hard stops", HostBenchNow_ns() - start, Rounds * Queries);
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+// RoutePlannerTest.cpp
+// PositionRoutePlanner against the float route finding it replaced, over a
+// grid of positions and hard stops plus random cases.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/IOConverters/PositionRoutePlanner.h"
+#include "LegacyRoutePlanner.h"
+#include "HostTest.h"
+
+// 2 degrees for positions, 10 for the stops
+static const long PositionStep = 2000;
+static const long StopStep = 10000;
+static const long RandomCases = 2000000;
+
+static long checks = 0;
+static long mismatches = 0;
+
+static void compare(LegacyRoutePlanner& legacy, PositionRoutePlanner& planner, long present, long destination) {
+  float legacyRoute = legacy.calcRouteToDest(legacyDegrees(present), legacyDegrees(destination));
+  long expected = legacyRoute == IMPOSSIBLE_MOVEMENT ? PositionRoutePlanner::ImpossibleRoute : lroundf(legacyRoute * 1000);
+  long route = planner.routeTo(present, destination);
+
+  checks++;
+  if (route != expected) {
+    if (mismatches++ < 10) {
+      printf("present %ld destination %ld stops %.0f %.0f: legacy %ld, planner %ld\n", present, destination, legacy.hardStopPos1, legacy.hardStopPos2, expected, route);
+    }
+  }
+}
+
+static void setStops(LegacyRoutePlanner& legacy, PositionRoutePlanner& planner, long stop1, long stop2) {
+  legacy.hardStopPos1 = stop1 / 1000.0;
+  legacy.hardStopPos2 = stop2 / 1000.0;
+  planner.setHardStops(stop1, stop2);
+}
+
+int main() {
+  LegacyRoutePlanner legacy;
+  PositionRoutePlanner planner;
+  long present, destination, stop1, stop2, i;
+
+  for (present = POS_MIN; present < (long)POS_MAX; present += PositionStep) {
+    for (destination = POS_MIN; destination <= (long)POS_MAX; destination += PositionStep) {
+      compare(legacy, planner, present, destination);
+    }
+  }
+
+  for (stop1 = POS_MIN; stop1 < (long)POS_MAX; stop1 += StopStep) {
+    for (stop2 = POS_MIN; stop2 < (long)POS_MAX; stop2 += StopStep) {
+      setStops(legacy, planner, stop1, stop2);
+
+      for (present = POS_MIN; present < (long)POS_MAX; present += PositionStep) {
+        for (destination = POS_MIN; destination < (long)POS_MAX; destination += PositionStep) {
+          compare(legacy, planner, present, destination);
+        }
+      }
+    }
+  }
+
+  // stops on whole degrees so the legacy float compares against them exactly
+  srand(3);
+  for (i = 0; i < RandomCases; i++) {
+    setStops(legacy, planner, (rand() % 360) * 1000, (rand() % 360) * 1000);
+    compare(legacy, planner, rand() % POS_MAX, rand() % POS_MAX);
+  }
+
+  printf("%ld routes compared, %ld mismatched\n", checks, mismatches);
+  HOST_CHECK(mismatches == 0);
+  return HostTestResult("RoutePlannerTest");
+}
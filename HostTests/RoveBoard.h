@@ -0,0 +1,51 @@
+// RoveBoard.h
+// Host port of the RoveBoard API, for building RoveWare off-target.
+//
+// Covers the parts RoveDynamixel and the motion control math use: uarts,
+// timing, debugFault and the trig helpers. Time is virtual: it only moves
+// when delay/delayMicroseconds is called or a uart has to wait for data, so
+// runs are deterministic and a 2 second servo move takes no wall time.
+// Uarts are routed to a DynamixelSimBus with roveBoardHost_AttachUart.
+
+#ifndef ROVEBOARD_H
+#define ROVEBOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct {
+  uint8_t index;
+  bool initialized;
+} RoveUart_Handle;
+
+RoveUart_Handle roveBoard_UART_open(unsigned int uartIndex, unsigned int baud, unsigned int txPin, unsigned int rxPin);
+void roveBoard_UART_write(RoveUart_Handle uart, void* data, size_t length);
+
+// blocks until length bytes have arrived; data can be NULL to throw them away
+void roveBoard_UART_read(RoveUart_Handle uart, void* data, size_t length);
+bool roveBoard_UART_available(RoveUart_Handle uart);
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void debugFault(const char* message);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+#ifndef radians
+#define radians(deg) ((deg) * 0.017453292519943295)
+#endif
+#ifndef degrees
+#define degrees(rad) ((rad) * 57.29577951308232)
+#endif
+
+// the board library's lookup table versions; plain libm on the host
+float cosLW(float x);
+float sinLW(float x);
+
+#endif
@@ -0,0 +1,128 @@
+// RoveBoardHost.cpp
+
+#include "RoveBoardHost.h"
+
+// a blocking read that has seen nothing for this long is waiting on a bus that will never answer
+#define ROVEBOARD_HOST_READ_TIMEOUT_US 1000000
+
+static volatile uint32_t now_us = 0;
+static DynamixelSimBus* uartBuses[ROVEBOARD_HOST_UARTS];
+
+static const char* lastFault = NULL;
+static uint32_t faultCount = 0;
+
+static DynamixelSimBus* roveBoardHost_Bus(RoveUart_Handle uart) {
+  if (!uart.initialized || uart.index >= ROVEBOARD_HOST_UARTS) {
+    return NULL;
+  }
+  return uartBuses[uart.index];
+}
+
+void roveBoardHost_AttachUart(uint8_t uartIndex, DynamixelSimBus* bus) {
+  if (uartIndex < ROVEBOARD_HOST_UARTS) {
+    uartBuses[uartIndex] = bus;
+  }
+}
+
+void roveBoardHost_Advance(uint32_t us) {
+  now_us += us;
+}
+
+const char* roveBoardHost_LastFault() {
+  return lastFault;
+}
+
+uint32_t roveBoardHost_FaultCount() {
+  return faultCount;
+}
+
+void roveBoardHost_ClearFaults() {
+  lastFault = NULL;
+  faultCount = 0;
+}
+
+RoveUart_Handle roveBoard_UART_open(unsigned int uartIndex, unsigned int baud, unsigned int txPin, unsigned int rxPin) {
+  RoveUart_Handle uart;
+
+  uart.index = uartIndex;
+  uart.initialized = uartIndex < ROVEBOARD_HOST_UARTS;
+
+  if (roveBoardHost_Bus(uart) != NULL) {
+    DynamixelSimSetBaud(roveBoardHost_Bus(uart), baud);
+  }
+  return uart;
+}
+
+void roveBoard_UART_write(RoveUart_Handle uart, void* data, size_t length) {
+  DynamixelSimBus* bus = roveBoardHost_Bus(uart);
+
+  if (bus != NULL) {
+    DynamixelSimWrite(bus, (const uint8_t*)data, length);
+  }
+}
+
+void roveBoard_UART_read(RoveUart_Handle uart, void* data, size_t length) {
+  DynamixelSimBus* bus = roveBoardHost_Bus(uart);
+  uint8_t* bytes = (uint8_t*)data;
+  uint32_t idle = 0;
+  size_t count = 0;
+
+  while (count < length) {
+    size_t got = bus != NULL ? DynamixelSimRead(bus, bytes != NULL ? &bytes[count] : NULL, length - count) : 0;
+
+    if (got > 0) {
+      count += got;
+      idle = 0;
+    } else if (++idle > ROVEBOARD_HOST_READ_TIMEOUT_US) {
+      debugFault("roveBoard_UART_read: nothing arrived");
+      return;
+    } else {
+      now_us++;
+    }
+  }
+}
+
+// a polling loop on the board burns time between polls; here each empty poll costs a microsecond
+bool roveBoard_UART_available(RoveUart_Handle uart) {
+  DynamixelSimBus* bus = roveBoardHost_Bus(uart);
+
+  if (bus != NULL && DynamixelSimAvailable(bus)) {
+    return true;
+  }
+
+  now_us++;
+  return false;
+}
+
+uint32_t millis() {
+  return now_us / 1000;
+}
+
+uint32_t micros() {
+  return now_us;
+}
+
+void delay(uint32_t ms) {
+  now_us += ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+  now_us += us;
+}
+
+void debugFault(const char* message) {
+  lastFault = message;
+  faultCount++;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+float cosLW(float x) {
+  return cosf(x);
+}
+
+float sinLW(float x) {
+  return sinf(x);
+}
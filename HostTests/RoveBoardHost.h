@@ -0,0 +1,23 @@
+// RoveBoardHost.h
+// Controls for the host RoveBoard port that the real board has no use for.
+
+#ifndef ROVEBOARDHOST_H
+#define ROVEBOARDHOST_H
+
+#include "RoveBoard.h"
+#include "RoveDynamixelSim.h"
+
+#define ROVEBOARD_HOST_UARTS 8
+
+// routes a uart index to a virtual bus; opening the uart sets the bus baud. NULL detaches it
+void roveBoardHost_AttachUart(uint8_t uartIndex, DynamixelSimBus* bus);
+
+// moves virtual time on without going through a delay
+void roveBoardHost_Advance(uint32_t us);
+
+// the last message passed to debugFault, or NULL, and how many there have been
+const char* roveBoardHost_LastFault();
+uint32_t roveBoardHost_FaultCount();
+void roveBoardHost_ClearFaults();
+
+#endif
@@ -0,0 +1,458 @@
+// RoveDynamixelSim.cpp
+
+#include "RoveDynamixelSim.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#define DYNAMIXEL_SIM_BITS_PER_BYTE        10
+#define DYNAMIXEL_SIM_BAUD_TOLERANCE       3
+
+static uint32_t DynamixelSimDefaultClock() {
+#if defined(__linux__)
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)(now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+#else
+  return 0;
+#endif
+}
+
+static uint32_t DynamixelSimByteTime(DynamixelSimBus* bus) {
+  return (DYNAMIXEL_SIM_BITS_PER_BYTE * 1000000UL + bus -> baud - 1) / bus -> baud;
+}
+
+// servos tolerate about 3% baud error, which is what lets register value 34
+// (57142 baud) talk to a uart opened at 57600
+static bool DynamixelSimHears(DynamixelSimBus* bus, DynamixelSimServo* servo) {
+  uint32_t servoBaud = DynamixelBaudFromByte(servo -> type, servo -> table[DYNAMIXEL_BAUD_RATE]);
+  uint32_t difference = servoBaud > bus -> baud ? servoBaud - bus -> baud : bus -> baud - servoBaud;
+
+  return difference * 100 <= servoBaud * DYNAMIXEL_SIM_BAUD_TOLERANCE;
+}
+
+// signed compare so the 32 bit microsecond clock can roll over
+static bool DynamixelSimReached(uint32_t now, uint32_t time) {
+  return (int32_t)(now - time) >= 0;
+}
+
+static void DynamixelSimFactoryDefaults(DynamixelSimServo* servo) {
+  uint8_t* table = servo -> table;
+  uint16_t maxPosition = servo -> type == MX ? 0x0FFF : 0x03FF;
+
+  memset(table, 0, DYNAMIXEL_CONTROL_TABLE_SIZE);
+
+  table[DYNAMIXEL_MODEL_NUMBER_L] = servo -> type == MX ? 29 : 12;
+  table[DYNAMIXEL_ID] = servo -> id;
+  table[DYNAMIXEL_BAUD_RATE] = servo -> type == MX ? 34 : 1;
+  table[DYNAMIXEL_RETURN_DELAY_TIME] = 250;
+  table[DYNAMIXEL_CCW_ANGLE_LIMIT_L] = maxPosition & 0xFF;
+  table[DYNAMIXEL_CCW_ANGLE_LIMIT_H] = maxPosition >> 8;
+  table[DYNAMIXEL_LIMIT_TEMPERATURE] = 70;
+  table[DYNAMIXEL_DOWN_LIMIT_VOLTAGE] = 60;
+  table[DYNAMIXEL_UP_LIMIT_VOLTAGE] = 140;
+  table[DYNAMIXEL_MAX_TORQUE_L] = 0xFF;
+  table[DYNAMIXEL_MAX_TORQUE_H] = 0x03;
+  table[DYNAMIXEL_RETURN_LEVEL] = 2;
+  table[DYNAMIXEL_ALARM_LED] = 36;
+  table[DYNAMIXEL_ALARM_SHUTDOWN] = 36;
+
+  if (servo -> type == MX) {
+    table[MX_RESOLUTION_DIVIDER] = 1;
+    table[MX_P_GAIN] = 32;
+  } else {
+    table[AX_CW_COMPLIANCE_MARGIN] = 1;
+    table[AX_CCW_COMPLIANCE_MARGIN] = 1;
+    table[AX_CW_COMPLIANCE_SLOPE] = 32;
+    table[AX_CCW_COMPLIANCE_SLOPE] = 32;
+  }
+
+  table[DYNAMIXEL_TORQUE_LIMIT_L] = 0xFF;
+  table[DYNAMIXEL_TORQUE_LIMIT_H] = 0x03;
+  table[DYNAMIXEL_PRESENT_VOLTAGE] = 120;
+  table[DYNAMIXEL_PRESENT_TEMPERATURE] = 30;
+  table[DYNAMIXEL_PUNCH_L] = 32;
+
+  servo -> position = maxPosition / 2;
+  table[DYNAMIXEL_GOAL_POSITION_L] = (uint16_t)servo -> position & 0xFF;
+  table[DYNAMIXEL_GOAL_POSITION_H] = (uint16_t)servo -> position >> 8;
+  servo -> registeredLength = 0;
+}
+
+static uint16_t DynamixelSimWord(DynamixelSimServo* servo, uint8_t lowRegister) {
+  return servo -> table[lowRegister] | (servo -> table[lowRegister + 1] << 8);
+}
+
+// slews present position toward the goal at the commanded moving speed, joint mode only
+static void DynamixelSimUpdateMotion(DynamixelSimServo* servo, uint32_t now) {
+  float elapsed_s = (uint32_t)(now - servo -> lastMotionUpdate_us) / 1000000.0;
+  float rpmPerUnit = servo -> type == MX ? 0.114 : 0.111;
+  float unitsPerDegree = servo -> type == MX ? 4095.0 / 360.0 : 1023.0 / 300.0;
+  uint16_t speedUnits = DynamixelSimWord(servo, DYNAMIXEL_MOVING_SPEED_L) & 0x03FF;
+  float goal = DynamixelSimWord(servo, DYNAMIXEL_GOAL_POSITION_L);
+  bool jointMode = DynamixelSimWord(servo, DYNAMIXEL_CW_ANGLE_LIMIT_L) != 0 || DynamixelSimWord(servo, DYNAMIXEL_CCW_ANGLE_LIMIT_L) != 0;
+  float step;
+  uint16_t present;
+
+  servo -> lastMotionUpdate_us = now;
+
+  if (jointMode && servo -> table[DYNAMIXEL_TORQUE_ENABLE]) {
+    // a moving speed of 0 means as fast as the servo can go
+    step = (speedUnits == 0 ? 1023 : speedUnits) * rpmPerUnit * 6.0 * unitsPerDegree * elapsed_s;
+
+    if (goal > servo -> position + step) {
+      servo -> position += step;
+    } else if (goal < servo -> position - step) {
+      servo -> position -= step;
+    } else {
+      servo -> position = goal;
+    }
+  }
+
+  present = (uint16_t)(servo -> position + 0.5);
+  servo -> table[DYNAMIXEL_PRESENT_POSITION_L] = present & 0xFF;
+  servo -> table[DYNAMIXEL_PRESENT_POSITION_H] = present >> 8;
+  servo -> table[DYNAMIXEL_MOVING] = (present != (uint16_t)goal && servo -> table[DYNAMIXEL_TORQUE_ENABLE]) ? 1 : 0;
+  servo -> table[DYNAMIXEL_PRESENT_SPEED_L] = servo -> table[DYNAMIXEL_MOVING] ? (speedUnits & 0xFF) : 0;
+  servo -> table[DYNAMIXEL_PRESENT_SPEED_H] = servo -> table[DYNAMIXEL_MOVING] ? (speedUnits >> 8) : 0;
+}
+
+static uint8_t DynamixelSimWriteTable(DynamixelSimServo* servo, uint8_t address, uint8_t length, const uint8_t* data, uint32_t now) {
+  int i;
+
+  if (address + length > DYNAMIXEL_CONTROL_TABLE_SIZE) {
+    return DYNAMIXEL_ERROR_RANGE;
+  }
+
+  // a set lock refuses any write that reaches into the EEPROM
+  if (servo -> table[DYNAMIXEL_LOCK] && address < DYNAMIXEL_TORQUE_ENABLE) {
+    return DYNAMIXEL_ERROR_RANGE;
+  }
+
+  DynamixelSimUpdateMotion(servo, now);
+
+  for (i = 0; i < length; i++) {
+    servo -> table[address + i] = data[i];
+
+    // like the real thing, a new goal position switches torque on
+    if (address + i == DYNAMIXEL_GOAL_POSITION_L || address + i == DYNAMIXEL_GOAL_POSITION_H) {
+      servo -> table[DYNAMIXEL_TORQUE_ENABLE] = 1;
+    }
+  }
+
+  servo -> id = servo -> table[DYNAMIXEL_ID];
+  return DYNAMIXEL_ERROR_SUCCESS;
+}
+
+static void DynamixelSimQueueByte(DynamixelSimBus* bus, uint8_t byte, uint32_t readyAt) {
+  uint16_t tail;
+
+  if (bus -> rxCount >= DYNAMIXEL_SIM_RX_QUEUE_SIZE) {
+    return;
+  }
+
+  tail = (bus -> rxHead + bus -> rxCount) % DYNAMIXEL_SIM_RX_QUEUE_SIZE;
+  bus -> rxData[tail] = byte;
+  bus -> rxReadyAt[tail] = readyAt;
+  bus -> rxCount++;
+}
+
+static void DynamixelSimSendStatus(DynamixelSimBus* bus, DynamixelSimServo* servo, uint8_t error, const uint8_t* params, uint8_t paramLength, uint32_t packetEnd) {
+  uint8_t reply[DYNAMIXEL_CONTROL_TABLE_SIZE + 6];
+  uint8_t checksum;
+  uint32_t byteTime = DynamixelSimByteTime(bus);
+  uint32_t start = packetEnd + servo -> table[DYNAMIXEL_RETURN_DELAY_TIME] * DYNAMIXEL_RETURN_DELAY_UNIT;
+  int i;
+
+  if (!DynamixelSimReached(start, bus -> busFreeAt_us)) {
+    start = bus -> busFreeAt_us;
+  }
+
+  reply[0] = 0xFF;
+  reply[1] = 0xFF;
+  reply[2] = servo -> id;
+  reply[3] = paramLength + 2;
+  reply[4] = error | servo -> alarms;
+  memcpy(&(reply[5]), params, paramLength);
+
+  checksum = 0;
+  for (i = 2; i < paramLength + 5; i++) {
+    checksum += reply[i];
+  }
+  reply[paramLength + 5] = ~checksum;
+
+  for (i = 0; i < paramLength + 6; i++) {
+    DynamixelSimQueueByte(bus, reply[i], start + (i + 1) * byteTime);
+  }
+
+  bus -> busFreeAt_us = start + (paramLength + 6) * byteTime;
+  bus -> stats.statusPackets++;
+  bus -> stats.bytesToHost += paramLength + 6;
+  bus -> stats.lastReplyLatency_us = bus -> busFreeAt_us - packetEnd;
+}
+
+static bool DynamixelSimShouldReply(DynamixelSimServo* servo, uint8_t instruction) {
+  uint8_t level = servo -> table[DYNAMIXEL_RETURN_LEVEL];
+
+  if (instruction == DYNAMIXEL_PING) {
+    return true;
+  }
+
+  if (level == DYNAMIXEL_RETURN_PING) {
+    return false;
+  }
+
+  if (level == DYNAMIXEL_RETURN_READ) {
+    return instruction == DYNAMIXEL_READ_DATA;
+  }
+
+  return true;
+}
+
+static void DynamixelSimHandleSyncWrite(DynamixelSimBus* bus, const uint8_t* params, uint8_t paramLength, uint32_t packetEnd) {
+  uint8_t address, length;
+  int offset, i;
+
+  if (paramLength < 2) {
+    return;
+  }
+
+  address = params[0];
+  length = params[1];
+
+  for (offset = 2; offset + length + 1 <= paramLength; offset += length + 1) {
+    for (i = 0; i < bus -> servoCount; i++) {
+      DynamixelSimServo* servo = &(bus -> servos[i]);
+
+      if (servo -> id == params[offset] && DynamixelSimHears(bus, servo)) {
+        DynamixelSimWriteTable(servo, address, length, &(params[offset + 1]), packetEnd);
+      }
+    }
+  }
+}
+
+// MX only; each listed servo answers in turn, which SendStatus serializes on the wire
+static void DynamixelSimHandleBulkRead(DynamixelSimBus* bus, const uint8_t* params, uint8_t paramLength, uint32_t packetEnd) {
+  int offset, i;
+
+  for (offset = 1; offset + 3 <= paramLength; offset += 3) {
+    uint8_t length = params[offset];
+    uint8_t id = params[offset + 1];
+    uint8_t address = params[offset + 2];
+
+    for (i = 0; i < bus -> servoCount; i++) {
+      DynamixelSimServo* servo = &(bus -> servos[i]);
+
+      if (servo -> id == id && servo -> type == MX && DynamixelSimHears(bus, servo)) {
+        if (address + length > DYNAMIXEL_CONTROL_TABLE_SIZE) {
+          DynamixelSimSendStatus(bus, servo, DYNAMIXEL_ERROR_RANGE, servo -> table, 0, packetEnd);
+        } else {
+          DynamixelSimUpdateMotion(servo, packetEnd);
+          DynamixelSimSendStatus(bus, servo, DYNAMIXEL_ERROR_SUCCESS, &(servo -> table[address]), length, packetEnd);
+        }
+      }
+    }
+  }
+}
+
+static void DynamixelSimHandleInstruction(DynamixelSimBus* bus, DynamixelSimServo* servo, bool broadcast, uint8_t instruction, const uint8_t* params, uint8_t paramLength, uint32_t packetEnd) {
+  uint8_t error = DYNAMIXEL_ERROR_SUCCESS;
+  uint8_t readData[DYNAMIXEL_CONTROL_TABLE_SIZE];
+  uint8_t readLength = 0;
+
+  switch (instruction) {
+    case DYNAMIXEL_PING:
+      break;
+    case DYNAMIXEL_READ_DATA:
+      if (paramLength != 2 || params[0] + params[1] > DYNAMIXEL_CONTROL_TABLE_SIZE) {
+        error = DYNAMIXEL_ERROR_RANGE;
+        break;
+      }
+      DynamixelSimUpdateMotion(servo, packetEnd);
+      readLength = params[1];
+      memcpy(readData, &(servo -> table[params[0]]), readLength);
+      break;
+    case DYNAMIXEL_WRITE_DATA:
+      if (paramLength < 2) {
+        error = DYNAMIXEL_ERROR_RANGE;
+        break;
+      }
+      error = DynamixelSimWriteTable(servo, params[0], paramLength - 1, &(params[1]), packetEnd);
+      break;
+    case DYNAMIXEL_REG_WRITE:
+      if (paramLength < 2 || params[0] + paramLength - 1 > DYNAMIXEL_CONTROL_TABLE_SIZE) {
+        error = DYNAMIXEL_ERROR_RANGE;
+        break;
+      }
+      servo -> registeredAddress = params[0];
+      servo -> registeredLength = paramLength - 1;
+      memcpy(servo -> registeredData, &(params[1]), paramLength - 1);
+      servo -> table[DYNAMIXEL_REGISTERED_INSTRUCTION] = 1;
+      break;
+    case DYNAMIXEL_ACTION:
+      if (servo -> registeredLength > 0) {
+        DynamixelSimWriteTable(servo, servo -> registeredAddress, servo -> registeredLength, servo -> registeredData, packetEnd);
+        servo -> registeredLength = 0;
+        servo -> table[DYNAMIXEL_REGISTERED_INSTRUCTION] = 0;
+      }
+      break;
+    case DYNAMIXEL_RESET:
+      servo -> id = 1;
+      DynamixelSimFactoryDefaults(servo);
+      break;
+    default:
+      error = DYNAMIXEL_ERROR_UNKNOWN;
+  }
+
+  if (!broadcast && DynamixelSimShouldReply(servo, instruction)) {
+    DynamixelSimSendStatus(bus, servo, error, readData, readLength, packetEnd);
+  }
+}
+
+static void DynamixelSimHandlePacket(DynamixelSimBus* bus, uint32_t packetEnd) {
+  uint8_t id = bus -> packet[2];
+  uint8_t length = bus -> packet[3];
+  uint8_t instruction = bus -> packet[4];
+  const uint8_t* params = &(bus -> packet[5]);
+  uint8_t paramLength = length - 2;
+  uint8_t checksum = 0;
+  bool handled = false;
+  int i;
+
+  for (i = 2; i < length + 3; i++) {
+    checksum += bus -> packet[i];
+  }
+
+  if ((uint8_t)~checksum != bus -> packet[length + 3]) {
+    bus -> stats.checksumErrors++;
+    return;
+  }
+
+  bus -> stats.packetsReceived++;
+
+  if (id == DYNAMIXEL_BROADCAST_ID && instruction == DYNAMIXEL_SYNC_WRITE) {
+    DynamixelSimHandleSyncWrite(bus, params, paramLength, packetEnd);
+    return;
+  }
+
+  if (id == DYNAMIXEL_BROADCAST_ID && instruction == DYNAMIXEL_BULK_READ) {
+    DynamixelSimHandleBulkRead(bus, params, paramLength, packetEnd);
+    return;
+  }
+
+  for (i = 0; i < bus -> servoCount; i++) {
+    DynamixelSimServo* servo = &(bus -> servos[i]);
+
+    // a servo listening at another baud only hears garbage
+    if (!DynamixelSimHears(bus, servo)) {
+      continue;
+    }
+
+    if (servo -> id == id || id == DYNAMIXEL_BROADCAST_ID) {
+      DynamixelSimHandleInstruction(bus, servo, id == DYNAMIXEL_BROADCAST_ID, instruction, params, paramLength, packetEnd);
+      handled = true;
+    }
+  }
+
+  if (!handled) {
+    bus -> stats.packetsIgnored++;
+  }
+}
+
+void DynamixelSimInit(DynamixelSimBus* bus, uint32_t baud, DynamixelSimClock clock) {
+  memset(bus, 0, sizeof(DynamixelSimBus));
+
+  bus -> baud = baud;
+  bus -> clock = clock != NULL ? clock : DynamixelSimDefaultClock;
+  bus -> busFreeAt_us = bus -> clock();
+}
+
+void DynamixelSimSetBaud(DynamixelSimBus* bus, uint32_t baud) {
+  bus -> baud = baud;
+  bus -> packetLength = 0;
+}
+
+bool DynamixelSimAddServo(DynamixelSimBus* bus, DynamixelType type, uint8_t id, uint8_t baudByte) {
+  DynamixelSimServo* servo;
+
+  if (bus -> servoCount >= DYNAMIXEL_SIM_MAX_SERVOS) {
+    return false;
+  }
+
+  servo = &(bus -> servos[bus -> servoCount++]);
+  servo -> id = id;
+  servo -> type = type;
+  DynamixelSimFactoryDefaults(servo);
+  servo -> table[DYNAMIXEL_BAUD_RATE] = baudByte;
+  servo -> lastMotionUpdate_us = bus -> clock();
+
+  return true;
+}
+
+DynamixelSimServo* DynamixelSimGetServo(DynamixelSimBus* bus, uint8_t id) {
+  int i;
+
+  for (i = 0; i < bus -> servoCount; i++) {
+    if (bus -> servos[i].id == id) {
+      return &(bus -> servos[i]);
+    }
+  }
+  return NULL;
+}
+
+void DynamixelSimWrite(DynamixelSimBus* bus, const uint8_t* data, size_t length) {
+  uint32_t now = bus -> clock();
+  uint32_t byteTime = DynamixelSimByteTime(bus);
+  uint32_t byteEnd;
+  size_t i;
+
+  if (DynamixelSimReached(now, bus -> busFreeAt_us)) {
+    bus -> busFreeAt_us = now;
+  }
+
+  for (i = 0; i < length; i++) {
+    byteEnd = bus -> busFreeAt_us + byteTime;
+    bus -> busFreeAt_us = byteEnd;
+    bus -> stats.bytesFromHost++;
+
+    // half duplex: the host hears itself
+    DynamixelSimQueueByte(bus, data[i], byteEnd);
+
+    // resync on the header whenever the parser is lost
+    if (bus -> packetLength < 2 && data[i] != 0xFF) {
+      bus -> packetLength = 0;
+      continue;
+    }
+
+    bus -> packet[bus -> packetLength++] = data[i];
+
+    // a length under 2 can't hold an instruction and checksum; the buffer holds the longest any length byte allows
+    if (bus -> packetLength == 4 && bus -> packet[3] < 2) {
+      bus -> stats.packetsIgnored++;
+      bus -> packetLength = 0;
+    } else if (bus -> packetLength >= 4 && bus -> packetLength == bus -> packet[3] + 4) {
+      DynamixelSimHandlePacket(bus, byteEnd);
+      bus -> packetLength = 0;
+    }
+  }
+}
+
+bool DynamixelSimAvailable(DynamixelSimBus* bus) {
+  return bus -> rxCount > 0 && DynamixelSimReached(bus -> clock(), bus -> rxReadyAt[bus -> rxHead]);
+}
+
+size_t DynamixelSimRead(DynamixelSimBus* bus, uint8_t* data, size_t length) {
+  size_t count = 0;
+
+  while (count < length && DynamixelSimAvailable(bus)) {
+    if (data != NULL) {
+      data[count] = bus -> rxData[bus -> rxHead];
+    }
+    bus -> rxHead = (bus -> rxHead + 1) % DYNAMIXEL_SIM_RX_QUEUE_SIZE;
+    bus -> rxCount--;
+    count++;
+  }
+  return count;
+}
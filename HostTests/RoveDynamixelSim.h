@@ -0,0 +1,94 @@
+// RoveDynamixelSim.h
+// Host-side virtual dynamixel bus.
+//
+// Emulates a half-duplex TTL bus with a handful of AX/MX servos on it: control
+// table, instruction handling, status return level, return delay time and
+// byte timing at the bus baud. The host RoveBoard port in this directory routes
+// the uart calls for an attached handle here (write -> DynamixelSimWrite,
+// available -> DynamixelSimAvailable, read -> DynamixelSimRead, open ->
+// DynamixelSimSetBaud), which lets RoveDynamixel run unmodified off-target.
+//
+// Like the real bus, everything the host writes is echoed back into its own
+// receive queue, and servos ignore packets sent at a baud other than their own.
+
+#ifndef DYNAMIXELSIM_H
+#define DYNAMIXELSIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "RoveDynamixel.h"
+
+#define DYNAMIXEL_SIM_MAX_SERVOS           8
+#define DYNAMIXEL_SIM_RX_QUEUE_SIZE        512
+// header, id and length byte, then the most a length byte can count
+#define DYNAMIXEL_SIM_MAX_PACKET           (4 + 255)
+
+typedef uint32_t (*DynamixelSimClock)();
+
+typedef struct {
+  uint8_t id;
+  DynamixelType type;
+  uint8_t table[DYNAMIXEL_CONTROL_TABLE_SIZE];
+
+  // alarm bits (voltage, overheating, overload, ...) reported in every status packet
+  uint8_t alarms;
+
+  // REG_WRITE contents held until ACTION
+  uint8_t registeredAddress;
+  uint8_t registeredLength;
+  uint8_t registeredData[DYNAMIXEL_CONTROL_TABLE_SIZE];
+
+  // present position is slewed toward the goal in virtual time
+  float position;
+  uint32_t lastMotionUpdate_us;
+} DynamixelSimServo;
+
+typedef struct {
+  uint32_t packetsReceived;
+  uint32_t packetsIgnored;
+  uint32_t checksumErrors;
+  uint32_t statusPackets;
+  uint32_t bytesFromHost;
+  uint32_t bytesToHost;
+
+  // time from the end of the last instruction to the end of its status reply
+  uint32_t lastReplyLatency_us;
+} DynamixelSimStats;
+
+typedef struct {
+  uint32_t baud;
+  DynamixelSimClock clock;
+
+  DynamixelSimServo servos[DYNAMIXEL_SIM_MAX_SERVOS];
+  uint8_t servoCount;
+
+  // receive queue; each byte only becomes visible once it has finished crossing the wire
+  uint8_t rxData[DYNAMIXEL_SIM_RX_QUEUE_SIZE];
+  uint32_t rxReadyAt[DYNAMIXEL_SIM_RX_QUEUE_SIZE];
+  uint16_t rxHead;
+  uint16_t rxCount;
+
+  // the time the wire is next free, so back to back writes queue up behind each other
+  uint32_t busFreeAt_us;
+
+  uint8_t packet[DYNAMIXEL_SIM_MAX_PACKET];
+  uint16_t packetLength;
+
+  DynamixelSimStats stats;
+} DynamixelSimBus;
+
+// clock returns microseconds; pass NULL to use the host's monotonic clock
+void DynamixelSimInit(DynamixelSimBus* bus, uint32_t baud, DynamixelSimClock clock);
+void DynamixelSimSetBaud(DynamixelSimBus* bus, uint32_t baud);
+
+// adds a servo with factory defaults besides its id and baud byte; returns false if the bus is full
+bool DynamixelSimAddServo(DynamixelSimBus* bus, DynamixelType type, uint8_t id, uint8_t baudByte);
+DynamixelSimServo* DynamixelSimGetServo(DynamixelSimBus* bus, uint8_t id);
+
+void DynamixelSimWrite(DynamixelSimBus* bus, const uint8_t* data, size_t length);
+bool DynamixelSimAvailable(DynamixelSimBus* bus);
+
+// reads up to length bytes that have already arrived, discarding them if data is NULL; returns how many were read
+size_t DynamixelSimRead(DynamixelSimBus* bus, uint8_t* data, size_t length);
+
+#endif
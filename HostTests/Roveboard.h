@@ -0,0 +1,5 @@
+// Roveboard.h
+// A few older modules include the board header with this spelling, which
+// only works on case-insensitive file systems.
+
+#include "RoveBoard.h"
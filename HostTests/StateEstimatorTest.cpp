@@ -0,0 +1,196 @@
+// StateEstimatorTest.cpp
+// KalmanStateEstimator and LeastSquaresVelocity on the virtual clock, against
+// noisy ramps whose real speed is known, across the wrap at 360 degrees.
+
+#include <math.h>
+#include <stdlib.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/FeedbackDevices/KalmanStateEstimator.h"
+#include "RoveMotionControl/FeedbackDevices/LeastSquaresVelocity.h"
+#include "HostTest.h"
+
+static const uint32_t Period_us = 1000;
+
+// uniform noise, +-amplitude degrees
+static float noise(float amplitude) {
+  return amplitude * (2.0 * rand() / RAND_MAX - 1);
+}
+
+// signed distance from one angle to another the short way round, in degrees
+static float angleError(float from, float to) {
+  float error = fmodf(to - from, 360);
+  if (error > 180) error -= 360;
+  if (error < -180) error += 360;
+  return error;
+}
+
+// drives an estimator along start + speed * t + acceleration * t^2 / 2 with
+// the given noise on every reading, one reading per period. Returns how far
+// the speed estimate was off on average over the last second, in degrees/s
+static float runRamp(KalmanStateEstimator& estimator, FixedEncoder& encoder, float start, float speed, float acceleration,
+                     float readingNoise, int periods, float* truePosition, float* trueSpeed) {
+  const int lastSecond = 1000000 / Period_us;
+  float speedError = 0;
+  float t;
+  int i;
+
+  for (i = 0; i < periods; i++) {
+    t = i * Period_us / 1000000.0;
+    *truePosition = start + speed * t + acceleration * t * t / 2;
+    *trueSpeed = speed + acceleration * t;
+    encoder.position = degreesToPos(*truePosition + noise(readingNoise));
+    estimator.update();
+    if (i >= periods - lastSecond) {
+      speedError += estimator.getSpeedDegrees() - *trueSpeed;
+    }
+    roveBoardHost_Advance(Period_us);
+  }
+  return speedError / lastSecond;
+}
+
+static void testConstantVelocity() {
+  FixedEncoder encoder;
+  KalmanStateEstimator estimator(&encoder, KalmanModel_ConstantVelocity, 100, 0.0005);
+  float truePosition, trueSpeed;
+
+  // 40 degrees/s from 300, through 360, with 0.05 degrees of noise on the readings
+  srand(39);
+  HOST_CHECK(fabsf(runRamp(estimator, encoder, 300, 40, 0, 0.05, 3000, &truePosition, &trueSpeed)) < 0.1);
+
+  HOST_CHECK(fabsf(estimator.getSpeedDegrees() - 40) < 1);
+  HOST_CHECK(fabsf(angleError(estimator.getPositionDegrees(), truePosition)) < 0.05);
+  HOST_CHECK(estimator.getPositionDegrees() >= 0 && estimator.getPositionDegrees() < 360);
+  HOST_CHECK(estimator.getAccelerationDegrees() == 0);
+
+  // the views read the same estimate, in the framework's units
+  HOST_CHECK(labs(estimator.getSpeedFeedback()->getFeedback() - 40000) < 1000);
+  HOST_CHECK(labs(estimator.getPositionFeedback()->getFeedback() - degreesToPos(truePosition)) < 50);
+  HOST_CHECK(estimator.getSpeedFeedback()->getFeedbackStatus() == FeedbackStatus_Success);
+}
+
+static void testConstantAcceleration() {
+  FixedEncoder constantVelocityEncoder, constantAccelerationEncoder;
+  KalmanStateEstimator constantVelocity(&constantVelocityEncoder, KalmanModel_ConstantVelocity, 100, 0.0005);
+  KalmanStateEstimator constantAcceleration(&constantAccelerationEncoder, KalmanModel_ConstantAcceleration, 1000, 0.0005);
+  float truePosition, trueSpeed;
+  float lagging, tracking;
+
+  // speeding up at 20 degrees/s^2 from 10 degrees/s, the same readings going to both models
+  srand(40);
+  lagging = runRamp(constantVelocity, constantVelocityEncoder, 200, 10, 20, 0.05, 3000, &truePosition, &trueSpeed);
+  srand(40);
+  tracking = runRamp(constantAcceleration, constantAccelerationEncoder, 200, 10, 20, 0.05, 3000, &truePosition, &trueSpeed);
+
+  HOST_CHECK(fabsf(constantAcceleration.getSpeedDegrees() - trueSpeed) < 1);
+  HOST_CHECK(fabsf(constantAcceleration.getAccelerationDegrees() - 20) < 10);
+  HOST_CHECK(fabsf(angleError(constantAcceleration.getPositionDegrees(), truePosition)) < 0.05);
+
+  // the constant velocity model lags behind a changing speed; the constant acceleration one doesn't
+  HOST_CHECK(lagging < 0 && lagging > -1);
+  HOST_CHECK(fabsf(tracking) < fabsf(lagging) / 4);
+}
+
+static void testKalmanSameTime() {
+  FixedEncoder encoder;
+  KalmanStateEstimator estimator(&encoder, KalmanModel_ConstantVelocity, 100, 0.0005);
+  float truePosition, trueSpeed, speed;
+
+  srand(41);
+  runRamp(estimator, encoder, 10, 30, 0, 0, 1000, &truePosition, &trueSpeed);
+  speed = estimator.getSpeedDegrees();
+
+  // a second update with no time passed has nothing to predict over; it only
+  // corrects against the same reading again
+  encoder.position = degreesToPos(truePosition + 30 * Period_us / 1000000.0);
+  estimator.update();
+  estimator.update();
+  HOST_CHECK(!isnan(estimator.getSpeedDegrees()));
+  HOST_CHECK(fabsf(estimator.getSpeedDegrees() - speed) < 0.1);
+}
+
+static void testLeastSquaresRollover() {
+  FixedEncoder encoder;
+  LeastSquaresVelocity velocity(&encoder, 8);
+  float degrees = 358;
+  long worst = 0;
+  int i;
+
+  // -60 degrees/s would read as a jump of nearly a whole turn at 0 without the unwrapping,
+  // so going both ways through POS_MAX
+  encoder.position = degreesToPos(degrees);
+  velocity.getFeedback();
+  for (i = 0; i < 100; i++) {
+    roveBoardHost_Advance(Period_us);
+    degrees += 60 * Period_us / 1000000.0;
+    encoder.position = degreesToPos(degrees);
+    if (i >= 8) {
+      worst = fmax(worst, labs(velocity.getFeedback() - 60000));
+    } else {
+      velocity.getFeedback();
+    }
+  }
+  for (i = 0; i < 100; i++) {
+    roveBoardHost_Advance(Period_us);
+    degrees -= 60 * Period_us / 1000000.0;
+    encoder.position = degreesToPos(degrees);
+    if (i >= 8) {
+      worst = fmax(worst, labs(velocity.getFeedback() + 60000));
+    } else {
+      velocity.getFeedback();
+    }
+  }
+
+  // the readings are truncated to whole position units. Over a window of 8 a
+  // millisecond apart, that can tilt the fit by sum(|t - mean t|) / sum((t - mean t)^2)
+  // = 16 / 42 units per millisecond, about 380 milli-degrees/s; a reading taken
+  // the long way round would be off by the whole turn
+  HOST_CHECK(worst < 381);
+}
+
+static void testLeastSquaresDuplicates() {
+  FixedEncoder encoder;
+  LeastSquaresVelocity velocity(&encoder, 4);
+  long speed = 0;
+  int i;
+
+  // a sensor updating every 4ms read every millisecond repeats each reading
+  // three times. Those are skipped, rather than taken for the axis stopping
+  velocity.setSampleTimeout(6000);
+  for (i = 0; i < 200; i++) {
+    if (i % 4 == 0) {
+      encoder.position = degreesToPos(90 + 20 * i * Period_us / 1000000.0);
+    }
+    speed = velocity.getFeedback();
+    if (i >= 16) {
+      HOST_CHECK(labs(speed - 20000) < 100);
+    }
+    roveBoardHost_Advance(Period_us);
+  }
+
+  // held longer than the timeout, the same reading counts again, and the axis has stopped
+  for (i = 0; i < 40; i++) {
+    speed = velocity.getFeedback();
+    roveBoardHost_Advance(Period_us * 7);
+  }
+  HOST_CHECK(speed == 0);
+
+  // two readings in the same microsecond have no slope between them; the last
+  // speed is kept rather than dividing by no time
+  velocity.reset();
+  encoder.position = degreesToPos(10);
+  velocity.getFeedback();
+  encoder.position = degreesToPos(11);
+  HOST_CHECK(velocity.getFeedback() == 0);
+  HOST_CHECK(velocity.getFeedbackStatus() == FeedbackStatus_Success);
+}
+
+int main() {
+  testConstantVelocity();
+  testConstantAcceleration();
+  testKalmanSameTime();
+  testLeastSquaresRollover();
+  testLeastSquaresDuplicates();
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("StateEstimatorTest");
+}
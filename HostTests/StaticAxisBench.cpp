@@ -0,0 +1,91 @@
+// StaticAxisBench.cpp
+// One control step through StaticAxis against the same modules behind
+// SingleMotorAxis's virtual calls.
+
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/MotionAxises/SingleMotorAxis.h"
+#include "RoveMotionControl/MotionAxises/StaticAxis.h"
+#include "RoveMotionControl/IOConverters/PIAlgorithm.h"
+#include "HostBench.h"
+
+static const uint32_t Steps = 20000000;
+static const int Commands = 1024;
+
+// stands in for a motor driver; the volatile store keeps the move from being optimized out
+class BenchMotor : public OutputDevice
+{
+  template<class, class, class> friend class StaticAxis;
+
+  public:
+    static const ValueType StaticInType = InputPowerPercent;
+
+    volatile long lastMove;
+
+    BenchMotor() : OutputDevice(InputPowerPercent, false), lastMove(0) {}
+
+    long getCurrentMove() { return lastMove; }
+
+  protected:
+    void move(const long movement) { lastMove = movement; }
+    void stop() { lastMove = 0; }
+    void setPower(bool powerOn) { enabled = powerOn; }
+};
+
+class BenchEncoder : public FeedbackDevice
+{
+  public:
+    long position;
+
+    BenchEncoder() : FeedbackDevice(InputPosition), position(POS_MAX / 4) {}
+
+    long getFeedback() { return position; }
+    FeedbackDevice_Status getFeedbackStatus() { return FeedbackStatus_Success; }
+};
+
+static long commands[Commands];
+
+template<class Axis>
+static void benchAxis(const char* name, Axis& axis) {
+  uint64_t start;
+  uint32_t i;
+  long results = 0;
+
+  start = HostBenchNow_ns();
+  for (i = 0; i < Steps; i++) {
+    results += axis.runOutputControl(commands[i % Commands]);
+  }
+  HostBenchReport(name, HostBenchNow_ns() - start, Steps);
+
+  // keep the status sum live
+  if (results == -1) {
+    printf("%ld\n", results);
+  }
+}
+
+int main() {
+  BenchMotor motor;
+  BenchEncoder encoder;
+  PIAlgorithm pi(20, 5, 0.01, &encoder);
+  PassThroughConverter<InputPowerPercent> direct;
+  int i;
+
+  for (i = 0; i < Commands; i++) {
+    commands[i] = (i * 37) % (POWERPERCENT_MAX - POWERPERCENT_MIN) + POWERPERCENT_MIN;
+  }
+
+  SingleMotorAxis virtualDirect(InputPowerPercent, &motor);
+  StaticAxis<PassThroughConverter<InputPowerPercent>, BenchMotor> staticDirect(direct, motor);
+  benchAxis("SingleMotorAxis, no converter", virtualDirect);
+  benchAxis("StaticAxis<PassThroughConverter>", staticDirect);
+
+  for (i = 0; i < Commands; i++) {
+    commands[i] = ((long)i * 351) % POS_MAX;
+  }
+
+  SingleMotorAxis virtualPi(InputPosition, &pi, &motor);
+  StaticAxis<PIAlgorithm, BenchMotor> staticPi(pi, motor);
+  benchAxis("SingleMotorAxis, PIAlgorithm", virtualPi);
+  benchAxis("StaticAxis<PIAlgorithm>", staticPi);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+// TrajectoryConverterTest.cpp
+// TrajectoryProfile::planFrom from random starting states, and a
+// TrajectoryConverter given new destinations mid move on the virtual clock.
+
+#include <math.h>
+#include <stdlib.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/IOConverters/TrajectoryConverter.h"
+#include "HostTest.h"
+
+static const long POS_RANGE = POS_MAX - POS_MIN;
+static const float MaxSpeed = 90, MaxAcceleration = 180, MaxJerk = 1800;
+static const uint32_t Period_us = 1000;
+
+// a position loop that just takes the setpoints
+class SetpointSink : public IOConverter
+{
+  public:
+    SetpointSink() : IOConverter(InputPosition, InputPowerPercent) {}
+
+    long runAlgorithm(const long input, IOConverter_Status * ret_status) {
+      ret_status->flags = IOConverter_Complete;
+      return 0;
+    }
+    long addToOutput(const long inputValue, const long calculatedOutput) { return 0; }
+};
+
+static float randomIn(float low, float high) {
+  return low + (high - low) * rand() / (float)RAND_MAX;
+}
+
+// the profile starts in the given state, ends at rest on the distance, and
+// never goes past the limits, or past what the start commits it to: a start
+// that's still accelerating carries on speeding up while the jerk unwinds it
+static bool checkPlanFrom(float distance, float startSpeed, float startAcceleration, float maxJerk) {
+  TrajectoryProfile profile;
+  float p, v, a, lastP, lastV, lastA, t, dt;
+  float unwind = maxJerk == 0 ? 0 : startAcceleration * startAcceleration / (2 * maxJerk);
+  float speedBound = fmaxf(MaxSpeed, fabsf(startSpeed) + unwind) * 1.001f + 0.01f;
+  float accelBound = fmaxf(MaxAcceleration, fabsf(startAcceleration)) * 1.001f + 0.01f;
+  bool ok = true;
+
+  if (!profile.planFrom(distance, startSpeed, startAcceleration, MaxSpeed, MaxAcceleration, maxJerk)) {
+    return false;
+  }
+
+  profile.evaluate(0, &p, &v, &a);
+  ok = ok && p == 0 && fabsf(v - startSpeed) < 1e-3f;
+  ok = ok && (maxJerk == 0 || fabsf(a - startAcceleration) < 1e-3f);
+
+  // continuous position and speed, and acceleration too with a jerk limit
+  dt = profile.getDuration() / 2000;
+  lastP = p; lastV = v; lastA = a;
+  for (t = dt; t < profile.getDuration(); t += dt) {
+    profile.evaluate(t, &p, &v, &a);
+    ok = ok && fabsf(v) <= speedBound && fabsf(a) <= accelBound;
+    ok = ok && fabsf(p - lastP) <= speedBound * dt * 1.01f + 1e-3f;
+    ok = ok && fabsf(v - lastV) <= accelBound * dt * 1.01f + 1e-3f;
+    ok = ok && (maxJerk == 0 || fabsf(a - lastA) <= maxJerk * dt * 1.01f + 1e-3f);
+    lastP = p; lastV = v; lastA = a;
+  }
+
+  // the last step lands on the end without a jump
+  profile.evaluate(profile.getDuration(), &p, &v, &a);
+  ok = ok && p == distance && v == 0 && a == 0;
+  ok = ok && fabsf(p - lastP) < 0.01f + fabsf(distance) * 1e-4f;
+
+  if (!ok) {
+    printf("  planFrom(%g, %g, %g, jerk %g) misbehaves\n", distance, startSpeed, startAcceleration, maxJerk);
+  }
+  return ok;
+}
+
+// runs the converter for the given time, returning the largest change in the
+// setpoint's speed from one run to the next, in degrees/s
+static float runFor(IOConverter* converter, TrajectoryConverter& trajectory, long destination, uint32_t time_us, float* lastSpeed) {
+  IOConverter_Status status;
+  float worst = 0;
+  uint32_t start = micros();
+
+  while (micros() - start < time_us) {
+    converter->runAlgorithm(destination, &status);
+    worst = fmaxf(worst, fabsf(trajectory.getSetpointSpeed() - *lastSpeed));
+    *lastSpeed = trajectory.getSetpointSpeed();
+    roveBoardHost_Advance(Period_us);
+  }
+
+  return worst;
+}
+
+int main() {
+  SetpointSink sink;
+  FixedEncoder encoder;
+  TrajectoryConverter trajectory(&sink, &encoder, MaxSpeed, MaxAcceleration, MaxJerk);
+  IOConverter* converter = &trajectory;
+  float speed = 0, fastest, worstStep;
+  float stepBound = MaxAcceleration * Period_us / 1000000.0 * 1.01f;
+  int i, failures = 0;
+
+  // starting from rest is the same plan as plan()
+  TrajectoryProfile rest, from;
+  float p1, v1, p2, v2;
+  rest.plan(-50, MaxSpeed, MaxAcceleration, MaxJerk);
+  from.planFrom(-50, 0, 0, MaxSpeed, MaxAcceleration, MaxJerk);
+  rest.evaluate(0.3, &p1, &v1, 0);
+  from.evaluate(0.3, &p2, &v2, 0);
+  HOST_CHECK(p1 == p2 && v1 == v2 && rest.getDuration() == from.getDuration());
+
+  // onward, short, reversing, overshooting and over the limits, with and without a jerk limit
+  HOST_CHECK(checkPlanFrom(100, 60, 50, MaxJerk));
+  HOST_CHECK(checkPlanFrom(2, 60, 50, MaxJerk));
+  HOST_CHECK(checkPlanFrom(-30, 60, -100, MaxJerk));
+  HOST_CHECK(checkPlanFrom(0, 80, 0, MaxJerk));
+  HOST_CHECK(checkPlanFrom(40, 150, 300, MaxJerk));
+  HOST_CHECK(checkPlanFrom(100, 60, 0, 0));
+  HOST_CHECK(checkPlanFrom(-5, 80, 0, 0));
+
+  srand(37);
+  for (i = 0; i < 2000; i++) {
+    float jerk = (i % 4 == 0) ? 0 : MaxJerk;
+    float accel = jerk == 0 ? 0 : randomIn(-MaxAcceleration, MaxAcceleration);
+    if (!checkPlanFrom(randomIn(-300, 300), randomIn(-MaxSpeed, MaxSpeed), accel, jerk)) {
+      failures++;
+    }
+  }
+  HOST_CHECK(failures == 0);
+
+  // a move from 0 to 170 degrees, redirected to 240 at full speed, then back to 10 on the way
+  encoder.position = 0;
+  worstStep = runFor(converter, trajectory, degreesToPos(170), 1200000, &speed);
+  fastest = speed;
+  HOST_CHECK(fastest > MaxSpeed * 0.9f);
+  HOST_CHECK(!trajectory.isProfileDone());
+
+  worstStep = fmaxf(worstStep, runFor(converter, trajectory, degreesToPos(240), 400000, &speed));
+  HOST_CHECK(speed > MaxSpeed * 0.9f);
+
+  worstStep = fmaxf(worstStep, runFor(converter, trajectory, degreesToPos(10), 8000000, &speed));
+  HOST_CHECK(worstStep <= stepBound);
+  HOST_CHECK(trajectory.isProfileDone());
+  HOST_CHECK(trajectory.getSetpoint() == degreesToPos(10));
+  HOST_CHECK(speed == 0);
+
+  return HostTestResult("TrajectoryConverterTest");
+}
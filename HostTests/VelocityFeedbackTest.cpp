@@ -0,0 +1,111 @@
+// VelocityFeedbackTest.cpp
+// LeastSquaresVelocity and KalmanStateEstimator's speed view as what they
+// replace VelocityDeriver as: speed FeedbackDevices, read through the base
+// class at a loop rate faster than the position sensor updates.
+
+#include <math.h>
+#include "RoveBoardHost.h"
+#include "RoveMotionControl/FeedbackDevices/KalmanStateEstimator.h"
+#include "RoveMotionControl/FeedbackDevices/LeastSquaresVelocity.h"
+#include "RoveMotionControl/Experimental/VelocityDeriver.h"
+#include "RoveMotionControl/Experimental/PIVConverter.h"
+#include "HostTest.h"
+
+// a 4khz loop reading a sensor that updates every 2ms
+static const uint32_t Tick_us = 250;
+static const int TicksPerReading = 8;
+static const float Speed = 30;
+
+enum { Deriver, LeastSquares, Kalman, Devices };
+
+// a position sensor that can be made to fail
+class FailingEncoder : public FixedEncoder
+{
+  public:
+    bool failing;
+
+    FailingEncoder() : failing(false) {}
+
+    FeedbackDevice_Status getFeedbackStatus() { return failing ? FeedbackStatus_Fail : FeedbackStatus_Success; }
+};
+
+int main() {
+  FailingEncoder encoder;
+  VelocityDeriver deriver(&encoder, 0);
+  LeastSquaresVelocity leastSquares(&encoder, 8);
+  KalmanStateEstimator estimator(&encoder, KalmanModel_ConstantVelocity, 100, 0.0005);
+  FeedbackDevice* devices[Devices] = {&deriver, &leastSquares, estimator.getSpeedFeedback()};
+  long worst[Devices] = {0, 0, 0};
+  long readings[Devices];
+  float degrees = 350;
+  int deriverZeros = 0;
+  int tick, i;
+
+  leastSquares.setSampleTimeout(TicksPerReading * Tick_us * 3 / 2);
+
+  for (i = 0; i < Devices; i++) {
+    HOST_CHECK(devices[i]->getFeedbackType() == InputSpeed);
+  }
+
+  // a second at 30 degrees/s, through 0
+  encoder.position = degreesToPos(degrees);
+  for (tick = 0; tick < 4000; tick++) {
+    roveBoardHost_Advance(Tick_us);
+    if (tick % TicksPerReading == 0) {
+      degrees += Speed * TicksPerReading * Tick_us / 1000000.0;
+      encoder.position = degreesToPos(degrees);
+    }
+
+    // as an AxisGroup task would, ahead of anything reading the views
+    estimator.update();
+
+    for (i = 0; i < Devices; i++) {
+      readings[i] = devices[i]->getFeedback();
+      HOST_CHECK(devices[i]->getFeedbackStatus() == FeedbackStatus_Success);
+    }
+
+    if (tick >= 400) {
+      for (i = 0; i < Devices; i++) {
+        worst[i] = fmax(worst[i], labs(readings[i] - (long)(Speed * 1000)));
+      }
+      deriverZeros += readings[Deriver] == 0;
+    }
+  }
+
+  // VelocityDeriver reads 0 whenever a new millisecond comes without a new
+  // reading, which is every other one. The replacements hold steady; the
+  // estimator takes each repeat as a reading of its own, so it wobbles a bit
+  // between the sensor's updates, where least squares skips them
+  printf("worst speed error: deriver %ld, least squares %ld, kalman %ld milli-degrees/s\n",
+         worst[Deriver], worst[LeastSquares], worst[Kalman]);
+  HOST_CHECK(deriverZeros > 0);
+  HOST_CHECK(worst[LeastSquares] < 200);
+  HOST_CHECK(worst[Kalman] < 500);
+
+  // a failed sensor shows through each of them, and they hold their last speed rather than reading garbage
+  encoder.failing = true;
+  encoder.position = degreesToPos(degrees + 90);
+  roveBoardHost_Advance(TicksPerReading * Tick_us);
+  estimator.update();
+  for (i = 0; i < Devices; i++) {
+    readings[i] = devices[i]->getFeedback();
+    HOST_CHECK(devices[i]->getFeedbackStatus() == FeedbackStatus_Fail);
+  }
+  HOST_CHECK(labs(readings[LeastSquares] - (long)(Speed * 1000)) < 200);
+  HOST_CHECK(labs(readings[Kalman] - (long)(Speed * 1000)) < 500);
+
+  // and each plugs into a converter wanting a speed sensor
+  encoder.failing = false;
+  encoder.position = degreesToPos(degrees);
+  for (i = 0; i < Devices; i++) {
+    PIVConverter piv(10, 0, 1, 0, 0.001, &encoder, devices[i]);
+    IOConverter* loop = &piv;
+    IOConverter_Status status;
+
+    loop->runAlgorithm(degreesToPos(degrees + 90), &status);
+    HOST_CHECK(status.flags == IOConverter_RunAgain);
+  }
+
+  HOST_CHECK(roveBoardHost_FaultCount() == 0);
+  return HostTestResult("VelocityFeedbackTest");
+}
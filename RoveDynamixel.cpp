@@ -7,9 +7,192 @@ void DynamixelInit(Dynamixel* dyna, DynamixelType type, uint8_t id, uint8_t uart
   dyna -> type = type;
   dyna -> id = id;
   dyna -> uart = roveBoard_UART_open(uartIndex, baud, txPin, rxPin);
+  dyna -> baud = baud;
+  dyna -> shadow = NULL;
   delayMicroseconds(5000);
 }
 
+// Only registers that hold settings are cached: the EEPROM, and the RAM the
+// host writes and the servo never changes on its own. Everything else (present
+// values, current, moving flags, torque enable and torque limit, which an alarm
+// shutdown changes, and anything not listed) always goes to the bus.
+static bool DynamixelIsCacheable(uint8_t dynamixelRegister) {
+  switch (dynamixelRegister) {
+    case DYNAMIXEL_MODEL_NUMBER_L:
+    case DYNAMIXEL_MODEL_NUMBER_H:
+    case DYNAMIXEL_VERSION:
+    case DYNAMIXEL_ID:
+    case DYNAMIXEL_BAUD_RATE:
+    case DYNAMIXEL_RETURN_DELAY_TIME:
+    case DYNAMIXEL_CW_ANGLE_LIMIT_L:
+    case DYNAMIXEL_CW_ANGLE_LIMIT_H:
+    case DYNAMIXEL_CCW_ANGLE_LIMIT_L:
+    case DYNAMIXEL_CCW_ANGLE_LIMIT_H:
+    case DYNAMIXEL_LIMIT_TEMPERATURE:
+    case DYNAMIXEL_DOWN_LIMIT_VOLTAGE:
+    case DYNAMIXEL_UP_LIMIT_VOLTAGE:
+    case DYNAMIXEL_MAX_TORQUE_L:
+    case DYNAMIXEL_MAX_TORQUE_H:
+    case DYNAMIXEL_RETURN_LEVEL:
+    case DYNAMIXEL_ALARM_LED:
+    case DYNAMIXEL_ALARM_SHUTDOWN:
+    case MX_MULTI_TURN_OFFSET_L:
+    case MX_MULTI_TURN_OFFSET_H:
+    case MX_RESOLUTION_DIVIDER:
+    case DYNAMIXEL_LED:
+    case MX_D_GAIN:                 // AX_CW_COMPLIANCE_MARGIN
+    case MX_I_GAIN:                 // AX_CCW_COMPLIANCE_MARGIN
+    case MX_P_GAIN:                 // AX_CW_COMPLIANCE_SLOPE
+    case AX_CCW_COMPLIANCE_SLOPE:
+    case DYNAMIXEL_GOAL_POSITION_L:
+    case DYNAMIXEL_GOAL_POSITION_H:
+    case DYNAMIXEL_MOVING_SPEED_L:
+    case DYNAMIXEL_MOVING_SPEED_H:
+    case DYNAMIXEL_LOCK:
+    case DYNAMIXEL_PUNCH_L:
+    case DYNAMIXEL_PUNCH_H:
+    case MX_GOAL_ACCELERATION:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool DynamixelShadowHas(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t length) {
+  int i;
+
+  if (dyna.shadow == NULL) {
+    return false;
+  }
+
+  for (i = dynamixelRegister; i < dynamixelRegister + length; i++) {
+    if (!DynamixelIsCacheable(i) || !(dyna.shadow -> valid[i / 8] & (1 << (i % 8)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool DynamixelShadowMatches(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t length, uint8_t* data) {
+  if (!DynamixelShadowHas(dyna, dynamixelRegister, length)) {
+    return false;
+  }
+
+  return memcmp(&(dyna.shadow -> table[dynamixelRegister]), data, length) == 0;
+}
+
+static void DynamixelShadowStore(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t length, uint8_t* data) {
+  int i;
+
+  if (dyna.shadow == NULL) {
+    return;
+  }
+
+  for (i = 0; i < length; i++) {
+    uint8_t reg = dynamixelRegister + i;
+    if (DynamixelIsCacheable(reg)) {
+      dyna.shadow -> table[reg] = data[i];
+      dyna.shadow -> valid[reg / 8] |= (1 << (reg % 8));
+    }
+  }
+}
+
+static void DynamixelShadowForget(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t length) {
+  int i;
+
+  if (dyna.shadow == NULL) {
+    return;
+  }
+
+  for (i = dynamixelRegister; i < dynamixelRegister + length && i < DYNAMIXEL_CONTROL_TABLE_SIZE; i++) {
+    dyna.shadow -> valid[i / 8] &= ~(1 << (i % 8));
+  }
+}
+
+void DynamixelAttachShadow(Dynamixel* dyna, DynamixelShadow* shadow) {
+  dyna -> shadow = shadow;
+  DynamixelInvalidateShadow(*dyna);
+}
+
+void DynamixelInvalidateShadow(Dynamixel dyna) {
+  if (dyna.shadow != NULL) {
+    memset(dyna.shadow -> valid, 0, sizeof(dyna.shadow -> valid));
+  }
+}
+
+// Waits out the servo's return delay before a status packet is parsed. The
+// parser's own byte timeout covers the packet itself, so once the shadow knows
+// the return delay there's no need to sit through the whole of TXDELAY.
+static void DynamixelWaitForReply(Dynamixel dyna) {
+  if (DynamixelShadowHas(dyna, DYNAMIXEL_RETURN_DELAY_TIME, 1)) {
+    delayMicroseconds(dyna.shadow -> table[DYNAMIXEL_RETURN_DELAY_TIME] * DYNAMIXEL_RETURN_DELAY_UNIT);
+  } else {
+    delayMicroseconds(TXDELAY);
+  }
+}
+
+// Whether a write will be answered with a status packet. A write to the status
+// return level itself is answered according to the level it sets.
+static bool DynamixelRepliesToWrite(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  if (dynamixelRegister <= DYNAMIXEL_RETURN_LEVEL && dynamixelRegister + dataLength > DYNAMIXEL_RETURN_LEVEL) {
+    return data[DYNAMIXEL_RETURN_LEVEL - dynamixelRegister] >= DYNAMIXEL_RETURN_ALL;
+  }
+
+  if (DynamixelShadowHas(dyna, DYNAMIXEL_RETURN_LEVEL, 1)) {
+    return dyna.shadow -> table[DYNAMIXEL_RETURN_LEVEL] >= DYNAMIXEL_RETURN_ALL;
+  }
+
+  return true;
+}
+
+// Writes a register block, skipping the bus entirely when the shadow says the
+// servo already holds these bytes. Servos set to not answer writes are assumed
+// to have taken them.
+uint8_t DynamixelWriteRegisters(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  uint8_t error;
+
+  if (DynamixelShadowMatches(dyna, dynamixelRegister, dataLength, data)) {
+    return DYNAMIXEL_ERROR_SUCCESS;
+  }
+
+  if (!DynamixelRepliesToWrite(dyna, dynamixelRegister, dataLength, data)) {
+    DynamixelSendWriteCommand(dyna, dynamixelRegister, dataLength, data);
+    DynamixelShadowStore(dyna, dynamixelRegister, dataLength, data);
+    return DYNAMIXEL_ERROR_SUCCESS;
+  }
+
+  DynamixelSendWriteCommand(dyna, dynamixelRegister, dataLength, data);
+
+  DynamixelWaitForReply(dyna);
+  error = DynamixelGetError(dyna);
+
+  if (error == DYNAMIXEL_ERROR_SUCCESS) {
+    DynamixelShadowStore(dyna, dynamixelRegister, dataLength, data);
+  }
+  return error;
+}
+
+// Reads a register block, answering from the shadow when every byte is known.
+// A reply that only carries alarms still has good data, so it's shadowed too.
+uint8_t DynamixelReadRegisters(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  uint8_t error;
+
+  if (DynamixelShadowHas(dyna, dynamixelRegister, dataLength)) {
+    memcpy(data, &(dyna.shadow -> table[dynamixelRegister]), dataLength);
+    return DYNAMIXEL_ERROR_SUCCESS;
+  }
+
+  DynamixelSendReadCommand(dyna, dynamixelRegister, dataLength);
+
+  DynamixelWaitForReply(dyna);
+  error = DynamixelGetReturnPacket(dyna, data, dataLength);
+
+  if (DynamixelDataValid(error)) {
+    DynamixelShadowStore(dyna, dynamixelRegister, dataLength, data);
+  }
+  return error;
+}
+
 void DynamixelSendPacket(Dynamixel dyna, uint8_t length, uint8_t* instruction) {
   int i;
   uint8_t checksum;
@@ -30,84 +213,129 @@ void DynamixelSendPacket(Dynamixel dyna, uint8_t length, uint8_t* instruction) {
   packet[length + 4] = checksum;
 
   roveBoard_UART_write(dyna.uart, packet, length + 5);
-  delayMicroseconds(600);
+  delayMicroseconds(DYNAMIXEL_ECHO_DELAY);
   roveBoard_UART_read(dyna.uart, NULL, length + 5);
 }
 
+static bool DynamixelWaitForByte(RoveUart_Handle uart, uint32_t timeout_us) {
+  uint32_t start = micros();
+
+  while(roveBoard_UART_available(uart) == false) {
+    if (micros() - start > timeout_us) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// How long to wait for each byte of a reply: one byte time at the servo's
+// baud, plus the longest return delay in case the reply hasn't started yet.
+static uint32_t DynamixelByteTimeout(Dynamixel dyna) {
+  uint32_t baud = dyna.baud != 0 ? dyna.baud : DYNAMIXEL_MIN_BAUD;
+
+  return DYNAMIXEL_MAX_RETURN_DELAY + (DYNAMIXEL_BITS_PER_BYTE * 1000000UL + baud - 1) / baud;
+}
+
+static bool DynamixelReadByte(Dynamixel dyna, uint8_t* byte) {
+  if (!DynamixelWaitForByte(dyna.uart, DynamixelByteTimeout(dyna))) {
+    return false;
+  }
+
+  roveBoard_UART_read(dyna.uart, byte, 1);
+  return true;
+}
+
 uint8_t DynamixelGetReturnPacket(Dynamixel dyna, uint8_t* data, size_t dataSize) {
-  // To be fixed
-  while(roveBoard_UART_available(dyna.uart) == true)
-  {
-    roveBoard_UART_read(dyna.uart, NULL, 1);
-  }
-  return 0;
-
-  //might be added in later
-  /*uint8_t id, length, error = 0;
-  uint8_t temp1, temp2;
-  if(roveBoard_UART_available(dyna.uart) == true)
-  {
-    roveBoard_UART_read(dyna.uart, &temp2, 1);
-
-    while(roveBoard_UART_available(dyna.uart) == true)
-    {
-      temp1 = temp2;
-      roveBoard_UART_read(dyna.uart, &temp2, 1);
-      if (temp1 == 255 && temp2 == 255)
-      {
-        if(roveBoard_UART_available(dyna.uart) == true)
-        {
-          roveBoard_UART_read(dyna.uart, &id, 1);
-        }
-        else
-        {
-          return DYNAMIXEL_ERROR_UNKNOWN;
-        }
-
-        if(roveBoard_UART_available(dyna.uart) == true)
-        {
-          roveBoard_UART_read(dyna.uart, &length, 1);
-        }
-        else
-        {
-          return DYNAMIXEL_ERROR_UNKNOWN;
-        }
-
-        if (length > 0 && roveBoard_UART_available(dyna.uart) == true)
-        {
-          roveBoard_UART_read(dyna.uart, &error, 1);
-        }
-        else
-        {
-          return DYNAMIXEL_ERROR_UNKNOWN;
-        }
-
-        if (dataSize + 2 != length)
-        {
-          //roveBoard_UART_read(dyna.uart, NULL, length-2);
-          return (error & DYNAMIXEL_ERROR_UNKNOWN);
-        }
-        else
-        {
-          roveBoard_UART_read(dyna.uart, data, length-2);
-          roveBoard_UART_read(dyna.uart, NULL, 1);
-          return error;
-        }
+  uint8_t id, length, error, checksum, received;
+  uint8_t previous = 0, current = 0;
+  int huntLimit = DYNAMIXEL_HEADER_HUNT_LIMIT;
+  size_t i;
+
+  // find the 0xFF 0xFF header, giving up if the line is silent or full of junk
+  while (!(previous == 0xFF && current == 0xFF)) {
+    previous = current;
+    if (huntLimit-- <= 0 || !DynamixelReadByte(dyna, &current)) {
+      return DYNAMIXEL_ERROR_UNKNOWN;
+    }
+  }
+
+  if (!DynamixelReadByte(dyna, &id) || !DynamixelReadByte(dyna, &length) || !DynamixelReadByte(dyna, &error)) {
+    return DYNAMIXEL_ERROR_UNKNOWN;
+  }
+
+  if (length != dataSize + 2) {
+    for (i = 0; i + 1 < length; i++) {
+      if (!DynamixelReadByte(dyna, &received)) {
+        break;
       }
     }
+    return (error | DYNAMIXEL_ERROR_UNKNOWN);
+  }
+
+  checksum = id + length + error;
+  for (i = 0; i < dataSize; i++) {
+    if (!DynamixelReadByte(dyna, &data[i])) {
+      return DYNAMIXEL_ERROR_UNKNOWN;
+    }
+    checksum += data[i];
+  }
+
+  if (!DynamixelReadByte(dyna, &received) || received != (uint8_t)(~checksum) || id != dyna.id) {
+    return DYNAMIXEL_ERROR_UNKNOWN;
   }
-  return DYNAMIXEL_ERROR_UNKNOWN;*/
+
+  return error;
 }
 
 uint8_t DynamixelGetError(Dynamixel dyna) {
   return DynamixelGetReturnPacket(dyna, NULL, 0);
 }
 
+bool DynamixelDataValid(uint8_t error) {
+  return (error & ~DYNAMIXEL_ALARM_ERRORS) == 0;
+}
+
 uint8_t DynamixelPing(Dynamixel dyna) {
   uint8_t msgLength = 1;
   uint8_t data = DYNAMIXEL_PING;
 
   DynamixelSendPacket(dyna, msgLength, &data);
+  DynamixelWaitForReply(dyna);
+  return DynamixelGetError(dyna);
+}
+
+uint8_t DynamixelProbe(Dynamixel dyna, uint32_t listenWindow_us) {
+  uint8_t msgLength = 1;
+  uint8_t data = DYNAMIXEL_PING;
+
+  DynamixelSendPacket(dyna, msgLength, &data);
+  if (!DynamixelWaitForByte(dyna.uart, listenWindow_us)) {
+    return DYNAMIXEL_ERROR_UNKNOWN;
+  }
+  return DynamixelGetError(dyna);
+}
+
+uint32_t DynamixelBaudFromByte(DynamixelType type, uint8_t baudByte) {
+  if (type == MX) {
+    switch (baudByte) {
+      case 250:
+        return 2250000;
+      case 251:
+        return 2500000;
+      case 252:
+        return 3000000;
+    }
+  }
+
+  return 2000000UL / (baudByte + 1);
+}
+
+uint8_t DynamixelReset(Dynamixel dyna) {
+  uint8_t msgLength = 1;
+  uint8_t data = DYNAMIXEL_RESET;
+
+  DynamixelSendPacket(dyna, msgLength, &data);
+  DynamixelInvalidateShadow(dyna);
   delayMicroseconds(TXDELAY);
   return DynamixelGetError(dyna);
 }
@@ -119,6 +347,8 @@ void DynamixelSendWriteCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_
   buffer[1] = dynamixelRegister;
   memcpy(&(buffer[2]), data, dataLength);
 
+  // raw writes bypass the cache, so whatever we knew about these bytes is stale
+  DynamixelShadowForget(dyna, dynamixelRegister, dataLength);
   DynamixelSendPacket(dyna, dataLength + 2, buffer);
 }
 
@@ -132,6 +362,130 @@ void DynamixelSendReadCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t
   DynamixelSendPacket(dyna, 3, buffer);
 }
 
+void DynamixelSendRegWriteCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  uint8_t buffer[dataLength + 2];
+
+  buffer[0] = DYNAMIXEL_REG_WRITE;
+  buffer[1] = dynamixelRegister;
+  memcpy(&(buffer[2]), data, dataLength);
+
+  // the servo only applies these bytes on ACTION, so we can't vouch for them either way
+  DynamixelShadowForget(dyna, dynamixelRegister, dataLength);
+  DynamixelSendPacket(dyna, dataLength + 2, buffer);
+}
+
+void DynamixelAction(RoveUart_Handle uart) {
+  Dynamixel broadcast;
+  uint8_t data = DYNAMIXEL_ACTION;
+
+  broadcast.id = DYNAMIXEL_BROADCAST_ID;
+  broadcast.type = AX;
+  broadcast.uart = uart;
+  broadcast.baud = 0;
+  broadcast.shadow = NULL;
+
+  // broadcast packets never get a status reply, so there's nothing to wait for
+  DynamixelSendPacket(broadcast, 1, &data);
+}
+
+// data holds dataLength bytes for each servo, in the same order as dynas
+uint8_t DynamixelSendSyncWriteCommand(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  Dynamixel broadcast;
+  int i;
+
+  // register, data length, then an id and the data for each servo
+  if (count == 0 || 2 + count * (dataLength + 1) > DYNAMIXEL_MAX_PARAMETERS) {
+    return DYNAMIXEL_ERROR_RANGE;
+  }
+
+  uint8_t buffer[3 + count * (dataLength + 1)];
+
+  buffer[0] = DYNAMIXEL_SYNC_WRITE;
+  buffer[1] = dynamixelRegister;
+  buffer[2] = dataLength;
+  for (i = 0; i < count; i++) {
+    buffer[3 + i * (dataLength + 1)] = dynas[i].id;
+    memcpy(&(buffer[4 + i * (dataLength + 1)]), &(data[i * dataLength]), dataLength);
+
+    // no status comes back from a broadcast, so the shadow can't be trusted afterwards
+    DynamixelShadowForget(dynas[i], dynamixelRegister, dataLength);
+  }
+
+  broadcast.id = DYNAMIXEL_BROADCAST_ID;
+  broadcast.type = dynas[0].type;
+  broadcast.uart = dynas[0].uart;
+  broadcast.baud = dynas[0].baud;
+  broadcast.shadow = NULL;
+
+  DynamixelSendPacket(broadcast, 3 + count * (dataLength + 1), buffer);
+  return DYNAMIXEL_ERROR_SUCCESS;
+}
+
+uint8_t DynamixelSendBulkReadCommand(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t readLength) {
+  Dynamixel broadcast;
+  int i;
+
+  // a leading 0, then length, id and register for each servo
+  if (count == 0 || 1 + count * 3 > DYNAMIXEL_MAX_PARAMETERS) {
+    return DYNAMIXEL_ERROR_RANGE;
+  }
+
+  uint8_t buffer[2 + count * 3];
+
+  buffer[0] = DYNAMIXEL_BULK_READ;
+  buffer[1] = 0x00;
+  for (i = 0; i < count; i++) {
+    buffer[2 + i * 3] = readLength;
+    buffer[3 + i * 3] = dynas[i].id;
+    buffer[4 + i * 3] = dynamixelRegister;
+  }
+
+  broadcast.id = DYNAMIXEL_BROADCAST_ID;
+  broadcast.type = dynas[0].type;
+  broadcast.uart = dynas[0].uart;
+  broadcast.baud = dynas[0].baud;
+  broadcast.shadow = NULL;
+
+  DynamixelSendPacket(broadcast, 2 + count * 3, buffer);
+  return DYNAMIXEL_ERROR_SUCCESS;
+}
+
+uint8_t DynamixelBulkRead(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t readLength, uint8_t* data, uint8_t* errors) {
+  uint8_t error;
+  int i;
+
+  // a read that was never sent gets no data back from anybody
+  error = DynamixelSendBulkReadCommand(dynas, count, dynamixelRegister, readLength);
+  if (error != DYNAMIXEL_ERROR_SUCCESS) {
+    for (i = 0; i < count; i++) {
+      errors[i] = error | DYNAMIXEL_ERROR_UNKNOWN;
+    }
+    return error | DYNAMIXEL_ERROR_UNKNOWN;
+  }
+
+  DynamixelWaitForReply(dynas[0]);
+
+  for (i = 0; i < count; i++) {
+    errors[i] = DynamixelGetReturnPacket(dynas[i], &(data[i * readLength]), readLength);
+    error |= errors[i];
+
+    // everyone after a servo that didn't answer is still waiting on it, so nothing more is coming
+    if (errors[i] & DYNAMIXEL_ERROR_UNKNOWN) {
+      for (i++; i < count; i++) {
+        errors[i] = DYNAMIXEL_ERROR_UNKNOWN;
+      }
+      break;
+    }
+
+    // an overloaded or overheating servo still sent good data
+    if (DynamixelDataValid(errors[i])) {
+      DynamixelShadowStore(dynas[i], dynamixelRegister, readLength, &(data[i * readLength]));
+    }
+  }
+
+  return error;
+}
+
 uint8_t DynamixelRotateJoint(Dynamixel dyna, uint16_t position) {
   uint8_t msgLength = 2;
   uint8_t data[msgLength];
@@ -139,10 +493,7 @@ uint8_t DynamixelRotateJoint(Dynamixel dyna, uint16_t position) {
   data[0] = position & 0x00FF;
   data[1] = position >> 8;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_GOAL_POSITION_L, msgLength, data);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_GOAL_POSITION_L, msgLength, data);
 }
 
 uint8_t DynamixelSpinWheel(Dynamixel dyna, uint16_t speed) {
@@ -152,18 +503,72 @@ uint8_t DynamixelSpinWheel(Dynamixel dyna, uint16_t speed) {
   data[0] = speed & 0x00FF;
   data[1] = speed >> 8;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_MOVING_SPEED_L, msgLength, data);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_MOVING_SPEED_L, msgLength, data);
+}
 
-  delayMicroseconds(TXDELAY);
+// REG_WRITE is answered like any other write, so a servo set to only answer
+// reads and pings gives nothing back and isn't waited on.
+static uint8_t DynamixelStageRegisters(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data) {
+  DynamixelSendRegWriteCommand(dyna, dynamixelRegister, dataLength, data);
+
+  if (!DynamixelRepliesToWrite(dyna, dynamixelRegister, dataLength, data)) {
+    return DYNAMIXEL_ERROR_SUCCESS;
+  }
+
+  DynamixelWaitForReply(dyna);
   return DynamixelGetError(dyna);
 }
 
+uint8_t DynamixelStageJoint(Dynamixel dyna, uint16_t position, uint16_t speed) {
+  uint8_t msgLength = 4;
+  uint8_t data[msgLength];
+
+  data[0] = position & 0x00FF;
+  data[1] = position >> 8;
+  data[2] = speed & 0x00FF;
+  data[3] = speed >> 8;
+
+  return DynamixelStageRegisters(dyna, DYNAMIXEL_GOAL_POSITION_L, msgLength, data);
+}
+
+uint8_t DynamixelStagePosition(Dynamixel dyna, uint16_t position) {
+  uint8_t msgLength = 2;
+  uint8_t data[msgLength];
+
+  data[0] = position & 0x00FF;
+  data[1] = position >> 8;
+
+  return DynamixelStageRegisters(dyna, DYNAMIXEL_GOAL_POSITION_L, msgLength, data);
+}
+
+uint8_t DynamixelCoordinatedMove(Dynamixel* dynas, uint8_t count, uint16_t* positions, uint16_t* speeds) {
+  uint8_t error = DYNAMIXEL_ERROR_SUCCESS;
+  int i;
+
+  if (count == 0) {
+    return error;
+  }
+
+  for (i = 0; i < count; i++) {
+    if (speeds != NULL) {
+      error |= DynamixelStageJoint(dynas[i], positions[i], speeds[i]);
+    } else {
+      error |= DynamixelStagePosition(dynas[i], positions[i]);
+    }
+  }
+
+  // ACTION is broadcast on the first servo's bus; all servos in one move must share it
+  DynamixelAction(dynas[0].uart);
+  return error;
+}
+
 uint8_t DynamixelSetId(Dynamixel* dyna, uint8_t id) {
   uint8_t msgLength = 1;
 
   DynamixelSendWriteCommand(*dyna, DYNAMIXEL_ID, msgLength, &id);
 
   dyna -> id = id;
+  DynamixelInvalidateShadow(*dyna);
 
   delayMicroseconds(TXDELAY);
   return DynamixelGetError(*dyna);
@@ -172,19 +577,13 @@ uint8_t DynamixelSetId(Dynamixel* dyna, uint8_t id) {
 uint8_t DynamixelSetBaudRate(Dynamixel dyna, uint8_t baudByte) {
   uint8_t msgLength = 1;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_BAUD_RATE, msgLength, &baudByte);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_BAUD_RATE, msgLength, &baudByte);
 }
 
 uint8_t DynamixelSetReturnDelayTime(Dynamixel dyna, uint8_t returnDelayByte) {
   uint8_t msgLength = 1;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_RETURN_DELAY_TIME, msgLength, &returnDelayByte);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_RETURN_DELAY_TIME, msgLength, &returnDelayByte);
 }
 
 uint8_t DynamixelSetMaxTorque(Dynamixel dyna, uint16_t maxTorque) {
@@ -194,19 +593,13 @@ uint8_t DynamixelSetMaxTorque(Dynamixel dyna, uint16_t maxTorque) {
   data[0] = maxTorque & 0x00FF;
   data[1] = maxTorque >> 8;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_MAX_TORQUE_L, msgLength, data);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_MAX_TORQUE_L, msgLength, data);
 }
 
 uint8_t DynamixelSetStatusReturnLevel(Dynamixel dyna, uint8_t level) {
   uint8_t msgLength = 1;
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_RETURN_LEVEL, msgLength, &level);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_RETURN_LEVEL, msgLength, &level);
 }
 
 uint8_t DynamixelSetMode(Dynamixel dyna, DynamixelMode mode) {
@@ -252,10 +645,7 @@ uint8_t DynamixelSetMode(Dynamixel dyna, DynamixelMode mode) {
       return DYNAMIXEL_ERROR_UNKNOWN;
   }
 
-  DynamixelSendWriteCommand(dyna, DYNAMIXEL_CW_ANGLE_LIMIT_L, msgLength, data);
-
-  delayMicroseconds(TXDELAY);
-  return DynamixelGetError(dyna);
+  return DynamixelWriteRegisters(dyna, DYNAMIXEL_CW_ANGLE_LIMIT_L, msgLength, data);
 }
 
 uint8_t DynamixelGetMode(Dynamixel dyna, DynamixelMode* mode) {
@@ -266,10 +656,7 @@ uint8_t DynamixelGetMode(Dynamixel dyna, DynamixelMode* mode) {
   uint8_t buffer[dataSize];
   uint16_t cwAngleLimit, ccwAngleLimit;
 
-  DynamixelSendReadCommand(dyna, DYNAMIXEL_CW_ANGLE_LIMIT_L, dataSize);
-
-  delayMicroseconds(TXDELAY);
-  error = DynamixelGetReturnPacket(dyna, buffer, dataSize);
+  error = DynamixelReadRegisters(dyna, DYNAMIXEL_CW_ANGLE_LIMIT_L, dataSize, buffer);
 
   cwAngleLimit = buffer[1];
   cwAngleLimit = (cwAngleLimit << 8) | buffer[0];
@@ -297,6 +684,14 @@ uint8_t DynamixelGetMode(Dynamixel dyna, DynamixelMode* mode) {
   return error;
 }
 
+uint8_t DynamixelGetReturnDelayTime(Dynamixel dyna, uint8_t* returnDelayByte) {
+  return DynamixelReadRegisters(dyna, DYNAMIXEL_RETURN_DELAY_TIME, 1, returnDelayByte);
+}
+
+uint8_t DynamixelGetStatusReturnLevel(Dynamixel dyna, uint8_t* level) {
+  return DynamixelReadRegisters(dyna, DYNAMIXEL_RETURN_LEVEL, 1, level);
+}
+
 uint8_t DynamixelGetPresentPosition(Dynamixel dyna, uint16_t* pos) {
   uint8_t dataSize = 2, error;
   uint8_t buffer[dataSize];
@@ -73,11 +73,43 @@
 #define DYNAMIXEL_REG_WRITE                4
 #define DYNAMIXEL_ACTION                   5
 #define DYNAMIXEL_RESET                    6
+#define DYNAMIXEL_SYNC_WRITE               0x83
+#define DYNAMIXEL_BULK_READ                0x92
+
+#define DYNAMIXEL_BROADCAST_ID             0xFE
 
 #define MX_HIGH_BYTE_MASK                  0x0F
 #define AX_HIGH_BYTE_MASK                  0x03
 
+// Status return levels
+#define DYNAMIXEL_RETURN_PING              0
+#define DYNAMIXEL_RETURN_READ              1
+#define DYNAMIXEL_RETURN_ALL               2
+
 #define TXDELAY 2000
+#define DYNAMIXEL_ECHO_DELAY 600
+
+// microseconds per count of the return delay time register
+#define DYNAMIXEL_RETURN_DELAY_UNIT        2
+
+// longest a servo can take to start answering: return delay time 254 at 2us a count
+#define DYNAMIXEL_MAX_RETURN_DELAY         510
+
+// 8 data bits, start and stop bit
+#define DYNAMIXEL_BITS_PER_BYTE            10
+
+// slowest rate a BAUD_RATE register can select, 2000000 / (254 + 1); used when a servo's baud isn't known
+#define DYNAMIXEL_MIN_BAUD                 7843
+
+// junk bytes skipped looking for a status header before giving up; a whole
+// stale reply to a read of every tracked register fits
+#define DYNAMIXEL_HEADER_HUNT_LIMIT        80
+
+// most parameter bytes one packet can carry: its length byte counts them plus the instruction and checksum
+#define DYNAMIXEL_MAX_PARAMETERS           253
+
+// one byte past the last register (MX_GOAL_ACCELERATION) we track
+#define DYNAMIXEL_CONTROL_TABLE_SIZE       74
 
 typedef enum {
   AX,
@@ -90,10 +122,21 @@ typedef enum {
   MultiTurn = 2
 } DynamixelMode;
 
+// Host-side copy of a servo's control table. Writes matching the copy are
+// elided and static registers are read back from it instead of the bus.
+typedef struct {
+  uint8_t table[DYNAMIXEL_CONTROL_TABLE_SIZE];
+  uint8_t valid[(DYNAMIXEL_CONTROL_TABLE_SIZE + 7) / 8];
+} DynamixelShadow;
+
 typedef struct {
   uint8_t id;
   DynamixelType type;
   RoveUart_Handle uart;
+
+  // baud the uart is open at, which sets how long a reply byte is waited for; 0 if unknown
+  uint32_t baud;
+  DynamixelShadow* shadow;
 } Dynamixel;
 
 typedef enum {
@@ -107,19 +150,59 @@ typedef enum {
   DYNAMIXEL_ERROR_UNKNOWN = 64
 } Dynamixel_Error;
 
-void DynamixelInit(Dynamixel* dyna, DynamixelType type, uint8_t id, uint8_t uartIndex, int baud);
+// Alarm bits describe the servo rather than the packet they came back in, so
+// a reply whose only errors are alarms still carries good data.
+#define DYNAMIXEL_ALARM_ERRORS (DYNAMIXEL_ERROR_VOLTAGE | DYNAMIXEL_ERROR_OVERHEATING | DYNAMIXEL_ERROR_OVERLOAD)
+
+void DynamixelInit(Dynamixel* dyna, DynamixelType type, uint8_t id, uint8_t uartIndex, int baud, uint8_t txPin, uint8_t rxPin);
+
+void DynamixelAttachShadow(Dynamixel* dyna, DynamixelShadow* shadow);
+void DynamixelInvalidateShadow(Dynamixel dyna);
 
 void DynamixelSendPacket(Dynamixel dyna, uint8_t length, uint8_t* instruction);
 uint8_t DynamixelGetReturnPacket(Dynamixel dyna, uint8_t* buffer, size_t bufferSize);
 uint8_t DynamixelGetError(Dynamixel dyna);
 
+// whether the data that came with an error is good: no error besides alarms
+bool DynamixelDataValid(uint8_t error);
+
 uint8_t DynamixelPing(Dynamixel dyna);
+// ping that gives up if no reply has started within the listen window, for sweeping a bus
+uint8_t DynamixelProbe(Dynamixel dyna, uint32_t listenWindow_us);
+uint8_t DynamixelReset(Dynamixel dyna);
 void DynamixelSendWriteCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data);
 void DynamixelSendReadCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t readLength);
+void DynamixelSendRegWriteCommand(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data);
+void DynamixelAction(RoveUart_Handle uart);
+
+// Sync-write and bulk read put every servo in one packet, so count must be at
+// least 1 and small enough for the packet's length byte: count * (dataLength + 1)
+// at most 251 for a sync-write, and count at most 84 for a bulk read. Anything
+// else sends nothing and returns DYNAMIXEL_ERROR_RANGE.
+uint8_t DynamixelSendSyncWriteCommand(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data);
+
+// MX series only. Every servo listed answers in turn, each waiting for the status
+// packet of the one before it. data holds readLength bytes per servo and errors
+// one error per servo; returns the or of every error.
+uint8_t DynamixelSendBulkReadCommand(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t readLength);
+uint8_t DynamixelBulkRead(Dynamixel* dynas, uint8_t count, uint8_t dynamixelRegister, uint8_t readLength, uint8_t* data, uint8_t* errors);
+
+uint8_t DynamixelWriteRegisters(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data);
+uint8_t DynamixelReadRegisters(Dynamixel dyna, uint8_t dynamixelRegister, uint8_t dataLength, uint8_t* data);
 
 uint8_t DynamixelRotateJoint(Dynamixel dyna, uint16_t position);
 uint8_t DynamixelSpinWheel(Dynamixel dyna, uint16_t speed);
 
+// Coordinated motion: stage goals with REG_WRITE ahead of time, then start
+// every staged servo at once with a single broadcast ACTION.
+uint8_t DynamixelStageJoint(Dynamixel dyna, uint16_t position, uint16_t speed);
+uint8_t DynamixelStagePosition(Dynamixel dyna, uint16_t position);
+uint8_t DynamixelCoordinatedMove(Dynamixel* dynas, uint8_t count, uint16_t* positions, uint16_t* speeds);
+
+// the baud a servo's BAUD_RATE register selects. Every value is 2000000 / (value + 1)
+// except that MX servos read 250, 251 and 252 as 2.25M, 2.5M and 3M
+uint32_t DynamixelBaudFromByte(DynamixelType type, uint8_t baudByte);
+
 uint8_t DynamixelSetId(Dynamixel* dyna, uint8_t id);
 uint8_t DynamixelSetBaudRate(Dynamixel dyna, uint8_t baudByte);
 uint8_t DynamixelSetReturnDelayTime(Dynamixel dyna, uint8_t returnDelayByte);
@@ -128,6 +211,8 @@ uint8_t DynamixelSetStatusReturnLevel(Dynamixel dyna, uint8_t level);
 uint8_t DynamixelSetMode(Dynamixel dyna, DynamixelMode mode);
 
 uint8_t DynamixelGetMode(Dynamixel dyna, DynamixelMode* mode);
+uint8_t DynamixelGetReturnDelayTime(Dynamixel dyna, uint8_t* returnDelayByte);
+uint8_t DynamixelGetStatusReturnLevel(Dynamixel dyna, uint8_t* level);
 uint8_t DynamixelGetPresentPosition(Dynamixel dyna, uint16_t* pos);
 uint8_t DynamixelGetPresentSpeed(Dynamixel dyna, uint16_t* speed);
 uint8_t DynamixelGetLoad(Dynamixel dyna, uint16_t* load);
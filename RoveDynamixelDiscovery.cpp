@@ -0,0 +1,232 @@
+// RoveDynamixelDiscovery.cpp
+
+#include "RoveDynamixelDiscovery.h"
+
+static void DynamixelBusOpen(DynamixelBus* bus, uint32_t baud) {
+  int i;
+
+  if (baud == bus -> baud) {
+    return;
+  }
+
+  bus -> uart = roveBoard_UART_open(bus -> uartIndex, baud, bus -> txPin, bus -> rxPin);
+  bus -> baud = baud;
+
+  for (i = 0; i < bus -> servoCount; i++) {
+    bus -> servos[i].uart = bus -> uart;
+    bus -> servos[i].baud = baud;
+  }
+}
+
+// throws away anything left on the line, e.g. a reply sent at a baud we've since left
+static void DynamixelBusDrain(DynamixelBus* bus) {
+  while (roveBoard_UART_available(bus -> uart)) {
+    roveBoard_UART_read(bus -> uart, NULL, 1);
+  }
+}
+
+// the slowest a reply can start once the ping has finished going out
+static uint32_t DynamixelBusListenWindow(uint32_t baud) {
+  return DYNAMIXEL_MAX_RETURN_DELAY + (7 * DYNAMIXEL_BITS_PER_BYTE * 1000000UL) / baud;
+}
+
+static DynamixelType DynamixelTypeFromModel(uint16_t model) {
+  switch (model) {
+    case 12:  // AX-12A
+    case 18:  // AX-18A
+    case 300: // AX-12W
+      return AX;
+    default:
+      return MX;
+  }
+}
+
+// Reads the EEPROM up to the status return level into the servo's shadow, so
+// it knows its return delay and whether writes get answered, and takes the
+// model from it. Alarm bits in the reply don't make the data any less valid,
+// and DynamixelReadRegisters shadows it all the same.
+static void DynamixelBusReadSettings(DynamixelBus* bus, int i) {
+  uint8_t eeprom[DYNAMIXEL_RETURN_LEVEL + 1];
+
+  DynamixelInvalidateShadow(bus -> servos[i]);
+
+  if (!DynamixelDataValid(DynamixelReadRegisters(bus -> servos[i], DYNAMIXEL_MODEL_NUMBER_L, sizeof(eeprom), eeprom))) {
+    eeprom[DYNAMIXEL_MODEL_NUMBER_L] = 0;
+    eeprom[DYNAMIXEL_MODEL_NUMBER_H] = 0;
+  }
+
+  bus -> models[i] = eeprom[DYNAMIXEL_MODEL_NUMBER_L] | (eeprom[DYNAMIXEL_MODEL_NUMBER_H] << 8);
+  bus -> servos[i].type = DynamixelTypeFromModel(bus -> models[i]);
+}
+
+void DynamixelBusInit(DynamixelBus* bus, uint8_t uartIndex, uint8_t txPin, uint8_t rxPin) {
+  memset(bus, 0, sizeof(DynamixelBus));
+
+  bus -> uartIndex = uartIndex;
+  bus -> txPin = txPin;
+  bus -> rxPin = rxPin;
+}
+
+uint8_t DynamixelBusDiscover(DynamixelBus* bus, const uint32_t* bauds, uint8_t baudCount, uint8_t expectedCount) {
+  uint32_t start = micros();
+  uint32_t window;
+  Dynamixel probe;
+  int b, id;
+
+  bus -> servoCount = 0;
+  bus -> probes = 0;
+
+  for (b = 0; b < baudCount; b++) {
+    DynamixelBusOpen(bus, bauds[b]);
+    window = DynamixelBusListenWindow(bauds[b]);
+
+    probe.type = AX;
+    probe.uart = bus -> uart;
+    probe.baud = bauds[b];
+    probe.shadow = NULL;
+
+    for (id = 0; id <= DYNAMIXEL_DISCOVERY_MAX_ID; id++) {
+      probe.id = id;
+      bus -> probes++;
+
+      // a servo with an alarm raised still answers, and still counts as found
+      if (DynamixelProbe(probe, window) & DYNAMIXEL_ERROR_UNKNOWN) {
+        DynamixelBusDrain(bus);
+        continue;
+      }
+
+      bus -> servoBauds[bus -> servoCount] = bauds[b];
+      bus -> servos[bus -> servoCount] = probe;
+      DynamixelAttachShadow(&(bus -> servos[bus -> servoCount]), &(bus -> shadows[bus -> servoCount]));
+      DynamixelBusReadSettings(bus, bus -> servoCount);
+      bus -> servoCount++;
+
+      if (bus -> servoCount == DYNAMIXEL_DISCOVERY_MAX_SERVOS || bus -> servoCount == expectedCount) {
+        bus -> discoveryTime_us = micros() - start;
+        return bus -> servoCount;
+      }
+    }
+  }
+
+  bus -> discoveryTime_us = micros() - start;
+  return bus -> servoCount;
+}
+
+// A register value only works for the bus if every servo on it reads it as the
+// same baud; AX and MX servos disagree about 250 through 252. Returns 0 if they don't.
+static uint32_t DynamixelBusBaudFromByte(DynamixelBus* bus, uint8_t baudByte) {
+  uint32_t baud = 0;
+  int i;
+
+  for (i = 0; i < bus -> servoCount; i++) {
+    if (i > 0 && DynamixelBaudFromByte(bus -> servos[i].type, baudByte) != baud) {
+      return 0;
+    }
+    baud = DynamixelBaudFromByte(bus -> servos[i].type, baudByte);
+  }
+  return baud;
+}
+
+static bool DynamixelBusAnswers(DynamixelBus* bus, int i) {
+  if (DynamixelProbe(bus -> servos[i], DynamixelBusListenWindow(bus -> baud)) & DYNAMIXEL_ERROR_UNKNOWN) {
+    DynamixelBusDrain(bus);
+    return false;
+  }
+  return true;
+}
+
+// raw write: any reply comes back at the old baud and is simply drained
+static void DynamixelBusWriteBaud(DynamixelBus* bus, int i, uint8_t baudByte) {
+  DynamixelSendWriteCommand(bus -> servos[i], DYNAMIXEL_BAUD_RATE, 1, &baudByte);
+  delayMicroseconds(TXDELAY);
+  DynamixelBusDrain(bus);
+}
+
+// Moves one servo to the new baud and only records it there once it answers a
+// ping at it. One that doesn't is sent its old value at the new baud, in case
+// the switch went through and only the ping was lost, and left recorded at its
+// old baud.
+static bool DynamixelBusMoveServo(DynamixelBus* bus, int i, uint8_t baudByte, uint32_t target) {
+  uint32_t previous = bus -> servoBauds[i];
+  uint8_t previousByte;
+
+  DynamixelBusOpen(bus, previous);
+  if (!DynamixelDataValid(DynamixelReadRegisters(bus -> servos[i], DYNAMIXEL_BAUD_RATE, 1, &previousByte))) {
+    return false;
+  }
+
+  DynamixelBusWriteBaud(bus, i, baudByte);
+
+  DynamixelBusOpen(bus, target);
+  if (DynamixelBusAnswers(bus, i)) {
+    bus -> servoBauds[i] = target;
+    return true;
+  }
+
+  DynamixelBusWriteBaud(bus, i, previousByte);
+  DynamixelBusOpen(bus, previous);
+  if (!DynamixelBusAnswers(bus, i)) {
+    debugFault("DynamixelBusMigrate: servo lost moving to a new baud");
+  }
+  return false;
+}
+
+uint32_t DynamixelBusMigrate(DynamixelBus* bus, const uint8_t* baudBytes, uint8_t count) {
+  uint32_t target;
+  int c, i;
+
+  for (c = 0; c < count; c++) {
+    target = DynamixelBusBaudFromByte(bus, baudBytes[c]);
+    if (target == 0) {
+      continue;
+    }
+
+    for (i = 0; i < bus -> servoCount; i++) {
+      if (bus -> servoBauds[i] != target && !DynamixelBusMoveServo(bus, i, baudBytes[c], target)) {
+        break;
+      }
+    }
+
+    if (i == bus -> servoCount) {
+      DynamixelBusOpen(bus, target);
+
+      // the raw baud writes bypassed the shadows, so refill them
+      for (i = 0; i < bus -> servoCount; i++) {
+        DynamixelBusReadSettings(bus, i);
+      }
+      return target;
+    }
+  }
+
+  return 0;
+}
+
+uint8_t DynamixelBusConfigureReplies(DynamixelBus* bus, uint8_t returnDelayByte, uint8_t statusReturnLevel) {
+  uint8_t error = DYNAMIXEL_ERROR_SUCCESS;
+  uint8_t settings[DYNAMIXEL_RETURN_LEVEL - DYNAMIXEL_RETURN_DELAY_TIME + 1];
+  Dynamixel direct;
+  int i;
+
+  for (i = 0; i < bus -> servoCount; i++) {
+    DynamixelBusOpen(bus, bus -> servoBauds[i]);
+
+    error |= DynamixelSetReturnDelayTime(bus -> servos[i], returnDelayByte);
+    error |= DynamixelSetStatusReturnLevel(bus -> servos[i], statusReturnLevel);
+
+    // A write that's no longer answered can't report failure, so read both
+    // settings back, past the shadow that just recorded them. At the ping only
+    // level there's nothing that would answer a read.
+    if (statusReturnLevel == DYNAMIXEL_RETURN_READ) {
+      direct = bus -> servos[i];
+      direct.shadow = NULL;
+
+      if (!DynamixelDataValid(DynamixelReadRegisters(direct, DYNAMIXEL_RETURN_DELAY_TIME, sizeof(settings), settings))
+          || settings[0] != returnDelayByte || settings[DYNAMIXEL_RETURN_LEVEL - DYNAMIXEL_RETURN_DELAY_TIME] != statusReturnLevel) {
+        DynamixelInvalidateShadow(bus -> servos[i]);
+        error |= DYNAMIXEL_ERROR_UNKNOWN;
+      }
+    }
+  }
+
+  return error;
+}
@@ -0,0 +1,61 @@
+// RoveDynamixelDiscovery.h
+// Startup discovery and baud negotiation for a chain of dynamixels on one uart.
+//
+// DynamixelBusDiscover sweeps a list of candidate bauds, probing every id with
+// a ping and a listen window just long enough for the slowest possible reply,
+// and records each servo it finds along with its baud and model.
+// DynamixelBusMigrate then moves the whole chain to the fastest baud that
+// every servo can still be reached at, and DynamixelBusConfigureReplies trims
+// the return delay and status return level so writes stop costing a reply.
+
+#ifndef DYNAMIXELDISCOVERY_H
+#define DYNAMIXELDISCOVERY_H
+
+#include "RoveBoard.h"
+#include "RoveDynamixel.h"
+
+#define DYNAMIXEL_DISCOVERY_MAX_SERVOS     16
+#define DYNAMIXEL_DISCOVERY_MAX_ID         253
+
+typedef struct {
+  uint8_t uartIndex;
+  uint8_t txPin;
+  uint8_t rxPin;
+
+  // baud the uart was last opened at
+  RoveUart_Handle uart;
+  uint32_t baud;
+
+  // each servo found gets a shadow here, so the bus mustn't be copied or moved once discovery has run
+  Dynamixel servos[DYNAMIXEL_DISCOVERY_MAX_SERVOS];
+  DynamixelShadow shadows[DYNAMIXEL_DISCOVERY_MAX_SERVOS];
+  uint32_t servoBauds[DYNAMIXEL_DISCOVERY_MAX_SERVOS];
+  uint16_t models[DYNAMIXEL_DISCOVERY_MAX_SERVOS];
+  uint8_t servoCount;
+
+  uint32_t probes;
+  uint32_t discoveryTime_us;
+} DynamixelBus;
+
+void DynamixelBusInit(DynamixelBus* bus, uint8_t uartIndex, uint8_t txPin, uint8_t rxPin);
+
+// Sweeps the bauds in the order given, probing ids 0 through 253 at each, and
+// stops as soon as expectedCount servos have been found (0 sweeps everything).
+// Returns the number of servos found.
+uint8_t DynamixelBusDiscover(DynamixelBus* bus, const uint32_t* bauds, uint8_t baudCount, uint8_t expectedCount);
+
+// Tries each BAUD_RATE register value in the order given, fastest first, until
+// every discovered servo has moved to it. A value AX and MX servos on the bus
+// read as different bauds is skipped. Servos are moved one at a time and each
+// is pinged at its new baud before it's recorded there; one that doesn't
+// answer is put back at its old baud and the next value is tried. Returns the
+// bus baud, or 0 if no value worked, leaving every servo at its recorded baud.
+uint32_t DynamixelBusMigrate(DynamixelBus* bus, const uint8_t* baudBytes, uint8_t count);
+
+// Sets every discovered servo's return delay and status return level, e.g. 0
+// and DYNAMIXEL_RETURN_READ so only reads and pings are answered, immediately.
+// Each servo's shadow carries the level from then on, so later writes through
+// bus -> servos know not to wait for a reply. Returns the or of every servo's error.
+uint8_t DynamixelBusConfigureReplies(DynamixelBus* bus, uint8_t returnDelayByte, uint8_t statusReturnLevel);
+
+#endif
@@ -0,0 +1,174 @@
+// RoveDynamixelScheduler.cpp
+
+#include "RoveDynamixelScheduler.h"
+
+static uint32_t DynamixelWireTime(DynamixelScheduler* sched, uint32_t bytes) {
+  return (bytes * DYNAMIXEL_BITS_PER_BYTE * 1000000UL) / sched -> baud;
+}
+
+void DynamixelSchedulerInit(DynamixelScheduler* sched, RoveUart_Handle uart, uint32_t baud, uint32_t frameRate_hz, uint8_t commandRegister, uint8_t commandLength) {
+  memset(sched, 0, sizeof(DynamixelScheduler));
+
+  sched -> uart = uart;
+  sched -> baud = baud;
+  sched -> frameRate_hz = frameRate_hz;
+  sched -> frameBudget_us = 1000000UL / frameRate_hz;
+  sched -> commandRegister = commandRegister;
+  sched -> commandLength = commandLength > DYNAMIXEL_SCHEDULER_MAX_COMMAND ? DYNAMIXEL_SCHEDULER_MAX_COMMAND : commandLength;
+}
+
+int DynamixelSchedulerAddServo(DynamixelScheduler* sched, Dynamixel dyna, uint32_t commandRate_hz, uint32_t telemetryRate_hz, uint8_t telemetryRegister, uint8_t telemetryLength) {
+  DynamixelScheduledServo* servo;
+
+  if (sched -> servoCount >= DYNAMIXEL_SCHEDULER_MAX_SERVOS || telemetryLength > DYNAMIXEL_SCHEDULER_MAX_TELEMETRY) {
+    return -1;
+  }
+
+  if (commandRate_hz > sched -> frameRate_hz || telemetryRate_hz > sched -> frameRate_hz) {
+    return -1;
+  }
+
+  // a period in whole frames can only hit the rate exactly if it divides the frame rate
+  if (commandRate_hz && sched -> frameRate_hz % commandRate_hz != 0) {
+    return -1;
+  }
+
+  if (telemetryRate_hz && telemetryLength && sched -> frameRate_hz % telemetryRate_hz != 0) {
+    return -1;
+  }
+
+  servo = &(sched -> servos[sched -> servoCount]);
+  memset(servo, 0, sizeof(DynamixelScheduledServo));
+
+  servo -> dyna = dyna;
+  servo -> dyna.uart = sched -> uart;
+  servo -> dyna.baud = sched -> baud;
+  servo -> commandPeriod = commandRate_hz ? sched -> frameRate_hz / commandRate_hz : 0;
+  servo -> telemetryPeriod = (telemetryRate_hz && telemetryLength) ? sched -> frameRate_hz / telemetryRate_hz : 0;
+  servo -> commandCountdown = 1;
+  servo -> telemetryCountdown = 1;
+  servo -> telemetryRegister = telemetryRegister;
+  servo -> telemetryLength = telemetryLength;
+  servo -> telemetryError = DYNAMIXEL_ERROR_UNKNOWN;
+
+  return sched -> servoCount++;
+}
+
+void DynamixelSchedulerSetCommand(DynamixelScheduler* sched, int slot, uint8_t* data) {
+  DynamixelScheduledServo* servo = &(sched -> servos[slot]);
+
+  memcpy(servo -> command, data, sched -> commandLength);
+  servo -> hasCommand = true;
+}
+
+void DynamixelSchedulerSetGoalPosition(DynamixelScheduler* sched, int slot, uint16_t position) {
+  DynamixelScheduledServo* servo = &(sched -> servos[slot]);
+
+  servo -> command[0] = position & 0x00FF;
+  servo -> command[1] = position >> 8;
+  servo -> hasCommand = true;
+}
+
+uint8_t DynamixelSchedulerGetTelemetry(DynamixelScheduler* sched, int slot, uint8_t* data, uint32_t* timestamp_us) {
+  DynamixelScheduledServo* servo = &(sched -> servos[slot]);
+
+  memcpy(data, servo -> telemetry, servo -> telemetryLength);
+  if (timestamp_us != NULL) {
+    *timestamp_us = servo -> telemetryTime_us;
+  }
+  return servo -> telemetryError;
+}
+
+uint32_t DynamixelSchedulerSyncWriteCost(DynamixelScheduler* sched, uint8_t servoCount) {
+  // header, id, length, instruction, address, data length, checksum, then id + data per servo
+  return DynamixelWireTime(sched, 8 + servoCount * (sched -> commandLength + 1)) + DYNAMIXEL_ECHO_DELAY;
+}
+
+uint32_t DynamixelSchedulerReadCost(DynamixelScheduler* sched, uint8_t readLength) {
+  // the request is 8 bytes, the status reply 6 plus data, and the driver waits out TXDELAY in between
+  return DynamixelWireTime(sched, 8) + DYNAMIXEL_ECHO_DELAY + TXDELAY + DynamixelWireTime(sched, 6 + readLength);
+}
+
+bool DynamixelSchedulerRunFrame(DynamixelScheduler* sched) {
+  Dynamixel dueServos[DYNAMIXEL_SCHEDULER_MAX_SERVOS];
+  uint8_t dueData[DYNAMIXEL_SCHEDULER_MAX_SERVOS * DYNAMIXEL_SCHEDULER_MAX_COMMAND];
+  uint8_t dueCount = 0;
+  uint32_t start = micros();
+  uint32_t budgetLeft = sched -> frameBudget_us;
+  uint32_t cost, elapsed;
+  bool overrun = false;
+  bool readThisFrame = false;
+  int i, n;
+
+  for (i = 0; i < sched -> servoCount; i++) {
+    DynamixelScheduledServo* servo = &(sched -> servos[i]);
+
+    if (servo -> commandPeriod && --(servo -> commandCountdown) == 0) {
+      servo -> commandCountdown = servo -> commandPeriod;
+      if (servo -> hasCommand) {
+        dueServos[dueCount] = servo -> dyna;
+        memcpy(&(dueData[dueCount * sched -> commandLength]), servo -> command, sched -> commandLength);
+        dueCount++;
+      }
+    }
+
+    if (servo -> telemetryPeriod && --(servo -> telemetryCountdown) == 0) {
+      servo -> telemetryCountdown = servo -> telemetryPeriod;
+      if (servo -> telemetryDue) {
+        // last period's read never got bus time
+        sched -> deferredReads++;
+        overrun = true;
+      }
+      servo -> telemetryDue = true;
+    }
+  }
+
+  // commands go first; they're what keeps the joints moving
+  if (dueCount > 0) {
+    cost = DynamixelSchedulerSyncWriteCost(sched, dueCount);
+    DynamixelSendSyncWriteCommand(dueServos, dueCount, sched -> commandRegister, sched -> commandLength, dueData);
+    budgetLeft = cost < budgetLeft ? budgetLeft - cost : 0;
+  }
+
+  // telemetry fills the rest of the frame, picking up where the last frame stopped
+  for (n = 0; n < sched -> servoCount; n++) {
+    i = (sched -> nextTelemetry + n) % sched -> servoCount;
+    DynamixelScheduledServo* servo = &(sched -> servos[i]);
+
+    if (!servo -> telemetryDue) {
+      continue;
+    }
+
+    cost = DynamixelSchedulerReadCost(sched, servo -> telemetryLength);
+
+    // always let one read through so an oversized read can't wedge the queue forever
+    if (cost > budgetLeft && readThisFrame) {
+      sched -> nextTelemetry = i;
+      break;
+    }
+
+    servo -> telemetryError = DynamixelReadRegisters(servo -> dyna, servo -> telemetryRegister, servo -> telemetryLength, servo -> telemetry);
+    servo -> telemetryTime_us = micros();
+    servo -> telemetryDue = false;
+    readThisFrame = true;
+    budgetLeft = cost < budgetLeft ? budgetLeft - cost : 0;
+    sched -> nextTelemetry = (i + 1) % sched -> servoCount;
+  }
+
+  elapsed = micros() - start;
+  sched -> lastFrameTime_us = elapsed;
+  if (elapsed > sched -> worstFrameTime_us) {
+    sched -> worstFrameTime_us = elapsed;
+  }
+
+  if (elapsed > sched -> frameBudget_us) {
+    overrun = true;
+  }
+
+  sched -> frames++;
+  if (overrun) {
+    sched -> overruns++;
+  }
+
+  return !overrun;
+}
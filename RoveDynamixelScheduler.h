@@ -0,0 +1,79 @@
+// RoveDynamixelScheduler.h
+// Round-robin bus scheduler for a chain of dynamixels sharing one uart.
+//
+// Every servo registers a command rate and a telemetry rate. Each call to
+// DynamixelSchedulerRunFrame sends one sync-write carrying every command that
+// is due, then spends whatever is left of the frame's bus time on telemetry
+// reads, resuming where the previous frame left off so slow reads can't
+// starve anybody. Work that doesn't fit is deferred and counted as an overrun.
+
+#ifndef DYNAMIXELSCHEDULER_H
+#define DYNAMIXELSCHEDULER_H
+
+#include "RoveBoard.h"
+#include "RoveDynamixel.h"
+
+#define DYNAMIXEL_SCHEDULER_MAX_SERVOS     16
+#define DYNAMIXEL_SCHEDULER_MAX_COMMAND    4
+#define DYNAMIXEL_SCHEDULER_MAX_TELEMETRY  4
+
+typedef struct {
+  Dynamixel dyna;
+
+  // rates expressed in frames; 0 means never
+  uint16_t commandPeriod;
+  uint16_t telemetryPeriod;
+  uint16_t commandCountdown;
+  uint16_t telemetryCountdown;
+
+  bool hasCommand;
+  bool telemetryDue;
+  uint8_t command[DYNAMIXEL_SCHEDULER_MAX_COMMAND];
+
+  uint8_t telemetryRegister;
+  uint8_t telemetryLength;
+  uint8_t telemetry[DYNAMIXEL_SCHEDULER_MAX_TELEMETRY];
+  uint8_t telemetryError;
+  uint32_t telemetryTime_us;
+} DynamixelScheduledServo;
+
+typedef struct {
+  RoveUart_Handle uart;
+  uint32_t baud;
+  uint32_t frameRate_hz;
+  uint32_t frameBudget_us;
+
+  // every servo shares the sync-write block, e.g. goal position (2 bytes) or goal position + speed (4 bytes)
+  uint8_t commandRegister;
+  uint8_t commandLength;
+
+  DynamixelScheduledServo servos[DYNAMIXEL_SCHEDULER_MAX_SERVOS];
+  uint8_t servoCount;
+  uint8_t nextTelemetry;
+
+  uint32_t frames;
+  uint32_t overruns;
+  uint32_t deferredReads;
+  uint32_t lastFrameTime_us;
+  uint32_t worstFrameTime_us;
+} DynamixelScheduler;
+
+void DynamixelSchedulerInit(DynamixelScheduler* sched, RoveUart_Handle uart, uint32_t baud, uint32_t frameRate_hz, uint8_t commandRegister, uint8_t commandLength);
+
+// returns the servo's slot in the scheduler, or -1 if it's full or the rates don't divide into the frame rate
+int DynamixelSchedulerAddServo(DynamixelScheduler* sched, Dynamixel dyna, uint32_t commandRate_hz, uint32_t telemetryRate_hz, uint8_t telemetryRegister, uint8_t telemetryLength);
+
+void DynamixelSchedulerSetCommand(DynamixelScheduler* sched, int slot, uint8_t* data);
+void DynamixelSchedulerSetGoalPosition(DynamixelScheduler* sched, int slot, uint16_t position);
+
+// copies out the last telemetry read and returns the error that read reported
+uint8_t DynamixelSchedulerGetTelemetry(DynamixelScheduler* sched, int slot, uint8_t* data, uint32_t* timestamp_us);
+
+// estimated bus time for the given transactions under the driver's current timing
+uint32_t DynamixelSchedulerSyncWriteCost(DynamixelScheduler* sched, uint8_t servoCount);
+uint32_t DynamixelSchedulerReadCost(DynamixelScheduler* sched, uint8_t readLength);
+
+// call once per frame at frameRate_hz. Returns true if the frame ran within budget
+bool DynamixelSchedulerRunFrame(DynamixelScheduler* sched);
+
+#endif
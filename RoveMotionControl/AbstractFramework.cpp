@@ -1,6 +1,7 @@
 ﻿#include "AbstractFramework.h"
 #include "RoveMotionUtilities.h"
 #include "RoveBoard.h"
+#include "RoveMotionProfiler.h"
 
 bool MotionAxis::verifyInput(long inputToVerify)
 {
@@ -16,6 +17,8 @@ bool MotionAxis::verifyInput(long inputToVerify)
     return TORQUE_MIN <= inputToVerify && inputToVerify <= TORQUE_MAX;
     case InputVoltage:
     return VOLT_MIN <= inputToVerify && inputToVerify <= VOLT_MAX;
+    case InputAcceleration:
+    return ACCEL_MIN <= inputToVerify && inputToVerify <= ACCEL_MAX;
     default:
       return inputToVerify == 0;
   }
@@ -140,7 +143,9 @@ bool MotionAxis::handleStopCap(long *move, ValueType valueType)
     return true;
   }
 
-  StopcapStatus status = stopcap->getStopcapStatus();
+  StopcapStatus status;
+
+  ROVEMOTION_PROFILE(stopcap, ProfileSite_Stopcap, status = stopcap->getStopcapStatus());
 
   if(status == StopcapStatus_FullStop)
   {
@@ -148,7 +153,7 @@ bool MotionAxis::handleStopCap(long *move, ValueType valueType)
   }
   else if(status != StopcapStatus_None)
   {
-    if(valueType == InputPowerPercent || valueType == InputTorque || valueType == InputSpeed || valueType == InputVoltage)
+    if(valueType == InputPowerPercent || valueType == InputTorque || valueType == InputSpeed || valueType == InputVoltage || valueType == InputAcceleration)
     {
       if(status == StopcapStatus_OnlyPositive && *move < 0)
       {
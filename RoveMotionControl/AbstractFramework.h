@@ -12,6 +12,9 @@ class StopcapMechanism;
 class DifferentialAxis;
 class SingleMotorAxis;
 
+//compile-time composed axis; concrete modules befriend it so it can call their protected functions directly
+template<class Converter, class Device, class Stopcap> class StaticAxis;
+
 //Primary interface class for controlling the axis; manages the other classes and
 //computes any calculations that depend on the nature of the axis itself
 //see README.md for more info
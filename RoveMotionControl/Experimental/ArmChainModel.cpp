@@ -0,0 +1,188 @@
+#include "ArmChainModel.h"
+#include "RoveBoard.h"
+
+static const float STANDARD_GRAVITY = 9.81;
+
+ArmChainModel::ArmChainModel()
+  : linkCount(0), gravity(0, 0, -STANDARD_GRAVITY)
+{
+  for(int i = 0; i < MaxLinks; i++)
+  {
+    jointSensors[i] = 0;
+  }
+}
+
+int ArmChainModel::addLink(const ArmLink& link, FeedbackDevice* jointSensor)
+{
+  if(linkCount >= MaxLinks || (jointSensor && jointSensor->getFeedbackType() != InputPosition))
+  {
+    return -1;
+  }
+
+  links[linkCount] = link;
+  jointSensors[linkCount] = jointSensor;
+  linkCount++;
+
+  return linkCount - 1;
+}
+
+bool ArmChainModel::loadConfig(const float* blob, uint16_t blobLength)
+{
+  linkCount = 0;
+  for(int i = 0; i < MaxLinks; i++)
+  {
+    jointSensors[i] = 0;
+  }
+
+  if(blobLength < ConfigHeaderFloats || blob[0] != ArmChainConfigVersion)
+  {
+    return false;
+  }
+
+  int count = blob[1];
+  if(count < 0 || count > MaxLinks || blobLength != ConfigHeaderFloats + count * ConfigFloatsPerLink)
+  {
+    return false;
+  }
+
+  for(int i = 0; i < count; i++)
+  {
+    const float* entry = &blob[ConfigHeaderFloats + i * ConfigFloatsPerLink];
+    ArmLink& link = links[i];
+
+    link.thetaOffset = entry[0];
+    link.d = entry[1];
+    link.a = entry[2];
+    link.alpha = entry[3];
+    link.mass = entry[4];
+    for(int j = 0; j < 3; j++)
+    {
+      link.cog[j] = entry[5 + j];
+    }
+    for(int j = 0; j < 6; j++)
+    {
+      link.inertia[j] = entry[8 + j];
+    }
+  }
+
+  linkCount = count;
+  return true;
+}
+
+void ArmChainModel::setJointSensor(uint8_t index, FeedbackDevice* jointSensor)
+{
+  if(index >= linkCount)
+  {
+    return;
+  }
+  else if(jointSensor && jointSensor->getFeedbackType() != InputPosition)
+  {
+    debugFault("ArmChainModel::setJointSensor: feedback device doesn't give position data");
+  }
+
+  jointSensors[index] = jointSensor;
+}
+
+void ArmChainModel::setGravity(float x, float y, float z)
+{
+  gravity = Vec3<float>(x, y, z);
+}
+
+bool ArmChainModel::readJointAngles(float angles[])
+{
+  bool allGood = true;
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    if(jointSensors[i])
+    {
+      angles[i] = radians(jointSensors[i]->getFeedback() * POS_TO_DEGREES);
+      if(jointSensors[i]->getFeedbackStatus() != FeedbackStatus_Success)
+      {
+        allGood = false;
+      }
+    }
+    else
+    {
+      angles[i] = 0;
+    }
+  }
+
+  return allGood;
+}
+
+void ArmChainModel::forwardKinematics(const float angles[], Mat4<float> frames[])
+{
+  Mat4<float> toLink;
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    const ArmLink& link = links[i];
+    toLink = toLink * Mat4<float>::fromDH(angles[i] + link.thetaOffset, link.d, link.a, link.alpha);
+    frames[i] = toLink;
+  }
+}
+
+void ArmChainModel::gravityTorques(const float angles[], float torques[])
+{
+  Mat4<float> frames[MaxLinks];
+
+  forwardKinematics(angles, frames);
+  gravityTorquesFromFrames(frames, torques);
+}
+
+void ArmChainModel::gravityTorquesFromFrames(const Mat4<float> frames[], float torques[])
+{
+  Vec3<float> massMoment;
+  float massPast = 0;
+
+  //walking from the tip towards the base, keep the total mass past the joint and the sum of mass * cog position.
+  //Joint i turns about the z axis of the frame before it, and the torque it needs is the same as if all that mass
+  //sat at the combined center of gravity: z x (sum(m * c) - M * o) . -g
+  for(int i = linkCount - 1; i >= 0; i--)
+  {
+    const ArmLink& link = links[i];
+    massMoment += frames[i].transformPoint(Vec3<float>(link.cog[0], link.cog[1], link.cog[2])) * link.mass;
+    massPast += link.mass;
+
+    Vec3<float> jointAxis(0, 0, 1);
+    Vec3<float> jointOrigin;
+    if(i > 0)
+    {
+      jointAxis = frames[i - 1].zAxis();
+      jointOrigin = frames[i - 1].origin();
+    }
+
+    torques[i] = dot(cross(jointAxis, massMoment - jointOrigin * massPast), -gravity) * 1000;
+  }
+}
+
+uint8_t ArmChainModel::getLinkCount()
+{
+  return linkCount;
+}
+
+const ArmLink* ArmChainModel::getLink(uint8_t index)
+{
+  if(index >= linkCount)
+  {
+    return 0;
+  }
+
+  return &links[index];
+}
+
+FeedbackDevice* ArmChainModel::getJointSensor(uint8_t index)
+{
+  if(index >= linkCount)
+  {
+    return 0;
+  }
+
+  return jointSensors[index];
+}
+
+Vec3<float> ArmChainModel::getGravity()
+{
+  return gravity;
+}
@@ -0,0 +1,110 @@
+#ifndef ROVEJOINTCONTROL_ARMCHAINMODEL_H_
+#define ROVEJOINTCONTROL_ARMCHAINMODEL_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+#include "KinematicsMath.h"
+
+//one link of an ArmChainModel: the Denavit-Hartenberg parameters of the revolute joint that moves it, and its mass
+//properties. Lengths in meters, angles in radians, mass in kg, inertia in kg*m^2.
+struct ArmLink
+{
+  //DH parameters. The joint's angle is added to thetaOffset
+  float thetaOffset;
+  float d;
+  float a;
+  float alpha;
+
+  float mass;
+
+  //center of gravity, in the link's own frame (the frame at the end of its DH transform)
+  float cog[3];
+
+  //inertia tensor about the center of gravity, in the link's own frame: Ixx, Iyy, Izz, Ixy, Ixz, Iyz
+  float inertia[6];
+};
+
+//Describes any serial chain arm of revolute joints as an array of DH links with mass properties, so that the same
+//forward kinematics and gravity passes serve any arm instead of each arm needing its own hand expanded math.
+//
+//The links can be added one at a time, or loaded from a config blob: a flat array of floats laid out as
+//  {ArmChainConfigVersion, link count, then per link: thetaOffset, d, a, alpha, mass, cog x, cog y, cog z,
+//   Ixx, Iyy, Izz, Ixy, Ixz, Iyz}
+//which can live in flash as a const array, so a new arm is just a new table.
+//see the readme.md for more info
+class ArmChainModel
+{
+  public:
+    static const uint8_t MaxLinks = 8;
+
+    //how many floats each link takes up in a config blob, and how many come before the first link
+    static const uint8_t ConfigFloatsPerLink = 14;
+    static const uint8_t ConfigHeaderFloats = 2;
+
+  private:
+    ArmLink links[MaxLinks];
+    FeedbackDevice* jointSensors[MaxLinks];
+    uint8_t linkCount;
+
+    //acceleration of gravity in the base frame, m/s^2
+    Vec3<float> gravity;
+
+  public:
+
+    //constructs an empty chain, with gravity along the base's -z
+    ArmChainModel();
+
+    //overview: adds a link to the end of the chain.
+    //inputs:   link: the link's parameters
+    //          jointSensor: position feedback device reading the angle of the joint that moves the link, or 0 if
+    //                       the joint is fixed at its offset
+    //returns:  the link's index, starting at 0, or -1 if the chain is full or the sensor doesn't give position
+    int addLink(const ArmLink& link, FeedbackDevice* jointSensor);
+
+    //overview: replaces the chain's links with the ones in a config blob, see the class description for the layout.
+    //          The joint sensors are cleared; attach them afterwards with setJointSensor.
+    //returns:  false if the blob's version or length doesn't match, in which case the chain is left empty
+    bool loadConfig(const float* blob, uint16_t blobLength);
+
+    //sets the position feedback device reading a joint's angle. 0 for a fixed joint
+    void setJointSensor(uint8_t index, FeedbackDevice* jointSensor);
+
+    //sets the acceleration of gravity in the base frame, in m/s^2. Default is 9.81 along -z
+    void setGravity(float x, float y, float z);
+
+    //overview: reads every joint's sensor, in radians, into angles. Joints without a sensor read 0.
+    //returns:  false if any sensor reported a failure
+    bool readJointAngles(float angles[]);
+
+    //overview: forward kinematics; the transform from the base to the end of each link.
+    //inputs:   angles: the joint angles, in radians, one per link
+    //          frames: returned, one per link
+    void forwardKinematics(const float angles[], Mat4<float> frames[]);
+
+    //overview: the torque each joint has to make to hold the arm up against gravity, in milli newton-meters to match
+    //          the framework's torque values. Done in one pass towards the base, summing the mass and mass moment of
+    //          everything past each joint as it goes.
+    //inputs:   angles: the joint angles, in radians, one per link
+    //          torques: returned, one per link
+    void gravityTorques(const float angles[], float torques[]);
+
+    //overview: gravityTorques for frames that have already been worked out, ex by forwardKinematics or an
+    //          ArmKinematicsCache
+    void gravityTorquesFromFrames(const Mat4<float> frames[], float torques[]);
+
+    uint8_t getLinkCount();
+
+    //returns a link's parameters, or 0 if the index is past the end of the chain
+    const ArmLink* getLink(uint8_t index);
+
+    //returns the feedback device reading a joint's angle, or 0 if the joint is fixed or past the end of the chain
+    FeedbackDevice* getJointSensor(uint8_t index);
+
+    Vec3<float> getGravity();
+};
+
+//the config blob format version ArmChainModel::loadConfig understands
+const float ArmChainConfigVersion = 1;
+
+#endif
@@ -0,0 +1,147 @@
+#include "ArmDynamics.h"
+
+//the link's inertia tensor times a vector, both in the link's own frame
+static Vec3<float> inertiaTimes(const ArmLink& link, const Vec3<float>& v)
+{
+  const float* I = link.inertia; //Ixx, Iyy, Izz, Ixy, Ixz, Iyz
+
+  return Vec3<float>(I[0] * v.x + I[3] * v.y + I[4] * v.z,
+                     I[3] * v.x + I[1] * v.y + I[5] * v.z,
+                     I[4] * v.x + I[5] * v.y + I[2] * v.z);
+}
+
+ArmDynamics::ArmDynamics(ArmChainModel* armChain)
+  : chain(armChain)
+{
+}
+
+void ArmDynamics::recursiveNewtonEuler(const Mat4<float> frames[], const float speeds[], const float accelerations[], const Vec3<float>& gravity, float torques[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+
+  //per link: the joint it turns on (axis and origin), its center of gravity, and the force and moment it takes to
+  //move it, all in the base frame
+  Vec3<float> jointAxis[ArmChainModel::MaxLinks];
+  Vec3<float> jointOrigin[ArmChainModel::MaxLinks];
+  Vec3<float> cog[ArmChainModel::MaxLinks];
+  Vec3<float> linkForce[ArmChainModel::MaxLinks];
+  Vec3<float> linkMoment[ArmChainModel::MaxLinks];
+
+  //outwards: the motion of each link. Accelerating the base up at g is the same as gravity pulling every link down,
+  //so gravity comes along for free
+  Vec3<float> omega;
+  Vec3<float> alpha;
+  Vec3<float> originAccel = -gravity;
+  Vec3<float> lastOrigin;
+  Vec3<float> lastAxis(0, 0, 1);
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    const ArmLink& link = *chain->getLink(i);
+    Vec3<float> jointSpin = lastAxis * speeds[i];
+
+    jointAxis[i] = lastAxis;
+    jointOrigin[i] = lastOrigin;
+
+    alpha += lastAxis * accelerations[i] + cross(omega, jointSpin);
+    omega += jointSpin;
+
+    //the joint's origin is on the link too, so the link's other points accelerate relative to it
+    Vec3<float> toOrigin = frames[i].origin() - lastOrigin;
+    originAccel += cross(alpha, toOrigin) + cross(omega, cross(omega, toOrigin));
+
+    cog[i] = frames[i].transformPoint(Vec3<float>(link.cog[0], link.cog[1], link.cog[2]));
+    Vec3<float> toCog = cog[i] - frames[i].origin();
+    Vec3<float> cogAccel = originAccel + cross(alpha, toCog) + cross(omega, cross(omega, toCog));
+
+    //F = m * a, N = I * alpha + omega x (I * omega), with the inertia worked in the link's frame
+    Vec3<float> localOmega = frames[i].inverseRotate(omega);
+    Vec3<float> localAlpha = frames[i].inverseRotate(alpha);
+    linkForce[i] = cogAccel * link.mass;
+    linkMoment[i] = frames[i].rotate(inertiaTimes(link, localAlpha) + cross(localOmega, inertiaTimes(link, localOmega)));
+
+    lastAxis = frames[i].zAxis();
+    lastOrigin = frames[i].origin();
+  }
+
+  //inwards: each joint carries the force and moment for its own link plus everything past it. Moments are taken
+  //about the joint's origin
+  Vec3<float> force;
+  Vec3<float> moment;
+  Vec3<float> nextOrigin;
+
+  for(int i = linkCount - 1; i >= 0; i--)
+  {
+    //the moment past this link was about the next joint; move it to this one
+    moment += cross(nextOrigin - jointOrigin[i], force);
+
+    force += linkForce[i];
+    moment += linkMoment[i] + cross(cog[i] - jointOrigin[i], linkForce[i]);
+
+    torques[i] = dot(moment, jointAxis[i]) * 1000;
+    nextOrigin = jointOrigin[i];
+  }
+}
+
+void ArmDynamics::inverseDynamics(const float angles[], const float speeds[], const float accelerations[], float torques[])
+{
+  Mat4<float> frames[ArmChainModel::MaxLinks];
+
+  chain->forwardKinematics(angles, frames);
+  recursiveNewtonEuler(frames, speeds, accelerations, chain->getGravity(), torques);
+}
+
+void ArmDynamics::gravityTorques(const float angles[], float torques[])
+{
+  Mat4<float> frames[ArmChainModel::MaxLinks];
+  float zeros[ArmChainModel::MaxLinks] = {0};
+
+  chain->forwardKinematics(angles, frames);
+  recursiveNewtonEuler(frames, zeros, zeros, chain->getGravity(), torques);
+}
+
+void ArmDynamics::velocityTorques(const float angles[], const float speeds[], float torques[])
+{
+  Mat4<float> frames[ArmChainModel::MaxLinks];
+  float zeros[ArmChainModel::MaxLinks] = {0};
+
+  chain->forwardKinematics(angles, frames);
+  recursiveNewtonEuler(frames, speeds, zeros, Vec3<float>(), torques);
+}
+
+void ArmDynamics::jointInertias(const float angles[], float inertias[])
+{
+  Mat4<float> frames[ArmChainModel::MaxLinks];
+
+  chain->forwardKinematics(angles, frames);
+  jointInertiasFromFrames(frames, inertias);
+}
+
+void ArmDynamics::jointInertiasFromFrames(const Mat4<float> frames[], float inertias[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+  float zeros[ArmChainModel::MaxLinks] = {0};
+  float unitAcceleration[ArmChainModel::MaxLinks] = {0};
+  float torques[ArmChainModel::MaxLinks];
+
+  //with no gravity or speed, the torques for a unit acceleration of joint i are column i of the mass matrix
+  for(int i = 0; i < linkCount; i++)
+  {
+    unitAcceleration[i] = 1;
+    recursiveNewtonEuler(frames, zeros, unitAcceleration, Vec3<float>(), torques);
+    unitAcceleration[i] = 0;
+
+    //back to N*m, IE kg*m^2 per rad/s^2
+    inertias[i] = torques[i] / 1000;
+  }
+}
+
+void ArmDynamics::motionTorquesFromFrames(const Mat4<float> frames[], const float speeds[], const float accelerations[], float torques[])
+{
+  recursiveNewtonEuler(frames, speeds, accelerations, Vec3<float>(), torques);
+}
+
+ArmChainModel* ArmDynamics::getChain()
+{
+  return chain;
+}
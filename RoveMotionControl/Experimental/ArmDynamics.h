@@ -0,0 +1,61 @@
+#ifndef ROVEJOINTCONTROL_ARMDYNAMICS_H_
+#define ROVEJOINTCONTROL_ARMDYNAMICS_H_
+
+#include <stdint.h>
+#include "ArmChainModel.h"
+#include "KinematicsMath.h"
+
+//Inverse dynamics for an ArmChainModel, by the recursive Newton-Euler algorithm: given where each joint is, how fast
+//it's turning and how fast it's speeding up, the torque each joint has to make for the arm to move that way,
+//including holding it up against gravity, the coriolis and centrifugal torques of the links swinging each other
+//around, and the torque it takes to accelerate the links' masses and inertias.
+//
+//One pass out from the base works out each link's motion, and one pass back in works out the forces each link
+//passes on to the one before it, so it's O(n) in the number of links. Done in the base frame, in floats, with the
+//forward kinematics worked out once per call.
+//see the readme.md for more info
+class ArmDynamics
+{
+  private:
+    ArmChainModel* chain;
+
+    //the algorithm itself, from the links' frames. gravity is the acceleration of gravity to include, so the same
+    //passes serve the full dynamics and the gravity free versions
+    void recursiveNewtonEuler(const Mat4<float> frames[], const float speeds[], const float accelerations[], const Vec3<float>& gravity, float torques[]);
+
+  public:
+
+    //constructs for the given arm. The chain's links shouldn't change while this is in use
+    ArmDynamics(ArmChainModel* armChain);
+
+    //overview: the full torque each joint needs, in milli newton-meters.
+    //inputs:   angles: joint angles in radians, one per link
+    //          speeds: joint speeds in radians/s
+    //          accelerations: joint accelerations in radians/s^2
+    //          torques: returned, one per link
+    void inverseDynamics(const float angles[], const float speeds[], const float accelerations[], float torques[]);
+
+    //overview: the torque each joint needs just to hold the arm still against gravity, in milli newton-meters. The
+    //          same as inverseDynamics with no speed or acceleration.
+    void gravityTorques(const float angles[], float torques[]);
+
+    //overview: the coriolis and centrifugal torques at the given speeds, without gravity or acceleration, in milli
+    //          newton-meters.
+    void velocityTorques(const float angles[], const float speeds[], float torques[]);
+
+    //overview: the inertia each joint sees when it alone accelerates with the rest of the arm held still, in
+    //          kg*m^2; IE the diagonal of the arm's mass matrix. Takes one pass per joint, so it's O(n^2).
+    void jointInertias(const float angles[], float inertias[]);
+
+    //overview: jointInertias for frames that have already been worked out, ex by an ArmKinematicsCache
+    void jointInertiasFromFrames(const Mat4<float> frames[], float inertias[]);
+
+    //overview: inverseDynamics without gravity, for frames that have already been worked out; IE just the torques it
+    //          takes to move the arm that way, to add onto gravity torques from somewhere else, ex a GravityLookupTable.
+    //          In milli newton-meters.
+    void motionTorquesFromFrames(const Mat4<float> frames[], const float speeds[], const float accelerations[], float torques[]);
+
+    ArmChainModel* getChain();
+};
+
+#endif
@@ -0,0 +1,414 @@
+#include "ArmInverseKinematics.h"
+
+static const float TwoPi = 6.2831853;
+
+static const float DefaultTolerance = 0.0005; //meters
+static const float DefaultDamping = 0.005; //meters
+static const uint8_t DefaultMaxIterations = 20;
+
+//the most any joint moves in one iteration, in radians. Far from the target the linearisation isn't worth trusting
+//any further than this
+static const float MaxStep = 0.5;
+
+//seed table angles are fractions of a turn, 65535 units to the turn so the top value is free for unreachable
+static const float SeedScale = 65535 / TwoPi;
+
+static float wrapAngle(float angle)
+{
+  while(angle < 0)
+  {
+    angle += TwoPi;
+  }
+  while(angle >= TwoPi)
+  {
+    angle -= TwoPi;
+  }
+
+  return angle;
+}
+
+uint16_t ArmInverseKinematics::packSeedAngle(float angle)
+{
+  uint32_t packed = wrapAngle(angle) * SeedScale + 0.5;
+
+  //angles within half a unit of a whole turn round up to it, which is 0 again
+  return packed >= 65535 ? 0 : packed;
+}
+
+float ArmInverseKinematics::unpackSeedAngle(uint16_t packed)
+{
+  return packed / SeedScale;
+}
+
+ArmInverseKinematics::ArmInverseKinematics(ArmChainModel* armChain)
+  : chain(armChain), tolerance(DefaultTolerance), damping(DefaultDamping), maxIterations(DefaultMaxIterations), seedTable(0)
+{
+  for(int i = 0; i < MaxJoints; i++)
+  {
+    hasLimits[i] = false;
+    minAngle[i] = 0;
+    maxAngle[i] = 0;
+  }
+
+  for(int i = 0; i < 3; i++)
+  {
+    gridPoints[i] = 0;
+  }
+}
+
+int ArmInverseKinematics::solve(const Vec3<float>& target, const float seed[], float angles[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+  Mat4<float> frames[MaxJoints];
+  uint8_t heldJoints = 0;
+
+  if(linkCount == 0)
+  {
+    return -1;
+  }
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    if(chain->getJointSensor(i))
+    {
+      angles[i] = clampToLimits(i, wrapAngle(seed[i]));
+    }
+    else
+    {
+      angles[i] = 0;
+      heldJoints |= 1 << i;
+    }
+  }
+
+  for(int iteration = 0; ; iteration++)
+  {
+    chain->forwardKinematics(angles, frames);
+    Vec3<float> tool = frames[linkCount - 1].transformPoint(toolOffset);
+    Vec3<float> error = target - tool;
+
+    if(dot(error, error) <= tolerance * tolerance)
+    {
+      return iteration;
+    }
+    else if(iteration >= maxIterations)
+    {
+      return -1;
+    }
+
+    //position jacobian; column i is z x (tool - origin) for the frame before joint i. A joint sitting on one of its
+    //limits that would be pushed further into it is held for this iteration, IE its column zeroed, so the other joints
+    //make up for it instead
+    Vec3<float> columns[MaxJoints];
+    for(int i = 0; i < linkCount; i++)
+    {
+      if(heldJoints & (1 << i))
+      {
+        columns[i] = Vec3<float>();
+        continue;
+      }
+
+      columns[i] = (i == 0) ? cross(Vec3<float>(0, 0, 1), tool) : cross(frames[i - 1].zAxis(), tool - frames[i - 1].origin());
+
+      float pull = dot(columns[i], error);
+      if(hasLimits[i] && ((angles[i] == minAngle[i] && pull < 0) || (angles[i] == maxAngle[i] && pull > 0)))
+      {
+        columns[i] = Vec3<float>();
+      }
+    }
+
+    //A = J * J^T + damping^2 * I, 3x3 and symmetric
+    float a00 = damping * damping, a11 = a00, a22 = a00, a10 = 0, a20 = 0, a21 = 0;
+    for(int i = 0; i < linkCount; i++)
+    {
+      const Vec3<float>& c = columns[i];
+      a00 += c.x * c.x;
+      a11 += c.y * c.y;
+      a22 += c.z * c.z;
+      a10 += c.y * c.x;
+      a20 += c.z * c.x;
+      a21 += c.z * c.y;
+    }
+
+    //cholesky, then A * y = error forwards and backwards
+    float l00 = sqrt(a00);
+    float l10 = a10 / l00;
+    float l20 = a20 / l00;
+    float l11 = sqrt(a11 - l10 * l10);
+    float l21 = (a21 - l20 * l10) / l11;
+    float l22 = sqrt(a22 - l20 * l20 - l21 * l21);
+
+    float y0 = error.x / l00;
+    float y1 = (error.y - l10 * y0) / l11;
+    float y2 = (error.z - l20 * y0 - l21 * y1) / l22;
+    y2 = y2 / l22;
+    y1 = (y1 - l21 * y2) / l11;
+    y0 = (y0 - l10 * y1 - l20 * y2) / l00;
+    Vec3<float> y(y0, y1, y2);
+
+    //dq = J^T * y, no joint moving more than MaxStep
+    float steps[MaxJoints];
+    float largest = 0;
+    for(int i = 0; i < linkCount; i++)
+    {
+      steps[i] = dot(columns[i], y);
+      float size = steps[i] < 0 ? -steps[i] : steps[i];
+      if(size > largest)
+      {
+        largest = size;
+      }
+    }
+
+    float scale = (largest > MaxStep) ? MaxStep / largest : 1;
+    for(int i = 0; i < linkCount; i++)
+    {
+      if(!(heldJoints & (1 << i)))
+      {
+        angles[i] = clampToLimits(i, wrapAngle(angles[i] + steps[i] * scale));
+      }
+    }
+  }
+}
+
+int ArmInverseKinematics::solveFromTable(const Vec3<float>& target, const float fallbackSeed[], float angles[])
+{
+  float seed[MaxJoints];
+
+  if(getSeed(target, seed))
+  {
+    return solve(target, seed, angles);
+  }
+
+  return solve(target, fallbackSeed, angles);
+}
+
+uint32_t ArmInverseKinematics::solveBatch(const Vec3<float> targets[], uint32_t count, const float seed[], float angles[], int8_t iterations[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+  const float* start = seed;
+  uint32_t reached = 0;
+
+  for(uint32_t t = 0; t < count; t++)
+  {
+    float* solution = &angles[t * linkCount];
+    int result = solve(targets[t], start, solution);
+
+    if(iterations)
+    {
+      iterations[t] = result;
+    }
+
+    //an unreached target's angles are no better a start than the last reached one's
+    if(result >= 0)
+    {
+      start = solution;
+      reached++;
+    }
+  }
+
+  return reached;
+}
+
+bool ArmInverseKinematics::setSeedGrid(const Vec3<float>& minCorner, const Vec3<float>& maxCorner, uint16_t pointsX, uint16_t pointsY, uint16_t pointsZ)
+{
+  seedTable = 0;
+
+  if(pointsX < 2 || pointsY < 2 || pointsZ < 2 || !(maxCorner.x > minCorner.x) || !(maxCorner.y > minCorner.y) || !(maxCorner.z > minCorner.z))
+  {
+    gridPoints[0] = gridPoints[1] = gridPoints[2] = 0;
+    return false;
+  }
+
+  gridMin = minCorner;
+  gridPoints[0] = pointsX;
+  gridPoints[1] = pointsY;
+  gridPoints[2] = pointsZ;
+  gridStep = Vec3<float>((maxCorner.x - minCorner.x) / (pointsX - 1), (maxCorner.y - minCorner.y) / (pointsY - 1), (maxCorner.z - minCorner.z) / (pointsZ - 1));
+
+  return true;
+}
+
+uint32_t ArmInverseKinematics::gridPointCount()
+{
+  return (uint32_t)gridPoints[0] * gridPoints[1] * gridPoints[2];
+}
+
+uint32_t ArmInverseKinematics::getSeedTableLength()
+{
+  return gridPointCount() * chain->getLinkCount();
+}
+
+Vec3<float> ArmInverseKinematics::gridPosition(uint16_t x, uint16_t y, uint16_t z)
+{
+  return Vec3<float>(gridMin.x + x * gridStep.x, gridMin.y + y * gridStep.y, gridMin.z + z * gridStep.z);
+}
+
+uint32_t ArmInverseKinematics::buildSeedTable(uint16_t* storage, uint32_t length, const float startAngles[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+  float last[MaxJoints];
+  float solution[MaxJoints];
+  bool lastReached = false;
+  uint32_t reached = 0;
+
+  if(gridPointCount() == 0 || linkCount == 0 || !storage || length < getSeedTableLength())
+  {
+    return 0;
+  }
+
+  //back and forth along x, and along y, so every point is next to the one solved before it
+  for(uint16_t z = 0; z < gridPoints[2]; z++)
+  {
+    for(uint16_t yStep = 0; yStep < gridPoints[1]; yStep++)
+    {
+      uint16_t y = (z % 2 == 0) ? yStep : gridPoints[1] - 1 - yStep;
+      bool xForwards = ((z * gridPoints[1] + yStep) % 2 == 0);
+
+      for(uint16_t xStep = 0; xStep < gridPoints[0]; xStep++)
+      {
+        uint16_t x = xForwards ? xStep : gridPoints[0] - 1 - xStep;
+        Vec3<float> target = gridPosition(x, y, z);
+        uint16_t* entry = &storage[(((uint32_t)z * gridPoints[1] + y) * gridPoints[0] + x) * linkCount];
+
+        int result = solve(target, lastReached ? last : startAngles, solution);
+        if(result < 0 && lastReached)
+        {
+          result = solve(target, startAngles, solution);
+        }
+
+        lastReached = (result >= 0);
+        if(lastReached)
+        {
+          for(int i = 0; i < linkCount; i++)
+          {
+            entry[i] = packSeedAngle(solution[i]);
+            last[i] = solution[i];
+          }
+          reached++;
+        }
+        else
+        {
+          for(int i = 0; i < linkCount; i++)
+          {
+            entry[i] = UnreachableSeed;
+          }
+        }
+      }
+    }
+  }
+
+  seedTable = storage;
+  return reached;
+}
+
+bool ArmInverseKinematics::useSeedTable(const uint16_t* table, uint32_t length)
+{
+  if(gridPointCount() == 0 || !table || length != getSeedTableLength())
+  {
+    return false;
+  }
+
+  seedTable = table;
+  return true;
+}
+
+int32_t ArmInverseKinematics::nearestGridPoint(const Vec3<float>& target)
+{
+  float position[3] = {(target.x - gridMin.x) / gridStep.x, (target.y - gridMin.y) / gridStep.y, (target.z - gridMin.z) / gridStep.z};
+  int32_t index[3];
+
+  for(int i = 0; i < 3; i++)
+  {
+    if(position[i] < -0.5 || position[i] > gridPoints[i] - 0.5)
+    {
+      return -1;
+    }
+
+    index[i] = position[i] + 0.5;
+    if(index[i] > gridPoints[i] - 1)
+    {
+      index[i] = gridPoints[i] - 1;
+    }
+  }
+
+  return (index[2] * gridPoints[1] + index[1]) * gridPoints[0] + index[0];
+}
+
+bool ArmInverseKinematics::getSeed(const Vec3<float>& target, float seed[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+
+  if(!seedTable)
+  {
+    return false;
+  }
+
+  int32_t point = nearestGridPoint(target);
+  if(point < 0)
+  {
+    return false;
+  }
+
+  const uint16_t* entry = &seedTable[point * linkCount];
+  if(linkCount == 0 || entry[0] == UnreachableSeed)
+  {
+    return false;
+  }
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    seed[i] = unpackSeedAngle(entry[i]);
+  }
+
+  return true;
+}
+
+float ArmInverseKinematics::clampToLimits(uint8_t joint, float angle)
+{
+  if(!hasLimits[joint])
+  {
+    return angle;
+  }
+
+  float span = wrapAngle(maxAngle[joint] - minAngle[joint]);
+  float offset = wrapAngle(angle - minAngle[joint]);
+
+  if(offset <= span)
+  {
+    return angle;
+  }
+
+  //outside; go to whichever limit is closer around the circle
+  return (offset - span < TwoPi - offset) ? maxAngle[joint] : minAngle[joint];
+}
+
+void ArmInverseKinematics::setToolOffset(float x, float y, float z)
+{
+  toolOffset = Vec3<float>(x, y, z);
+}
+
+void ArmInverseKinematics::setTolerance(float meters)
+{
+  tolerance = meters;
+}
+
+void ArmInverseKinematics::setMaxIterations(uint8_t iterations)
+{
+  maxIterations = iterations;
+}
+
+void ArmInverseKinematics::setDamping(float lambda)
+{
+  damping = lambda;
+}
+
+void ArmInverseKinematics::setJointLimits(uint8_t joint, float minimum, float maximum)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  hasLimits[joint] = true;
+  minAngle[joint] = wrapAngle(minimum);
+  maxAngle[joint] = wrapAngle(maximum);
+}
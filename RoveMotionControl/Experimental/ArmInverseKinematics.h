@@ -0,0 +1,136 @@
+#ifndef ROVEJOINTCONTROL_ARMINVERSEKINEMATICS_H_
+#define ROVEJOINTCONTROL_ARMINVERSEKINEMATICS_H_
+
+#include <stdint.h>
+#include "ArmChainModel.h"
+#include "KinematicsMath.h"
+
+//Position inverse kinematics for an ArmChainModel: finds joint angles that put the tool at a target point.
+//
+//Solved iteratively by damped least squares on the arm's position jacobian, starting from a seed; with a seed that's
+//close, it converges in a couple iterations. Seeds come from wherever the caller has them (ex the arm's current
+//angles), or from a seed table: a grid over a box of the workspace holding, for every grid point, the angles that
+//reach it, or that it can't be reached. The table is built by solving the whole grid as one batch, each point
+//starting from the solution of the one next to it, either at boot or offline on a computer and then compiled in with
+//useSeedTable. Angles are stored as 16 bit fractions of a turn to keep it small.
+//
+//Batches are solved one target after another rather than several at once across SIMD lanes: what makes them fast is
+//each target starting from the solution before it, which is a chain of dependencies lanes would have to break, and
+//most of each iteration is the forward kinematics' sines and cosines, which don't vectorise without a vector math
+//library. The boards have no SIMD to use either way.
+//
+//Joints without a sensor in the chain are held at their offset. Joint limits, if set, clamp the solution.
+//Works in floats, with lengths in meters and angles in radians, [0, 2pi) the same as the joint sensors read.
+//see the readme.md for more info
+class ArmInverseKinematics
+{
+  public:
+    //a seed table entry meaning the grid point couldn't be reached
+    static const uint16_t UnreachableSeed = 0xFFFF;
+
+  private:
+    static const uint8_t MaxJoints = ArmChainModel::MaxLinks;
+
+    ArmChainModel* chain;
+
+    Vec3<float> toolOffset;
+    float tolerance;
+    float damping;
+    uint8_t maxIterations;
+
+    bool hasLimits[MaxJoints];
+    float minAngle[MaxJoints];
+    float maxAngle[MaxJoints];
+
+    //the seed grid
+    Vec3<float> gridMin;
+    Vec3<float> gridStep;
+    uint16_t gridPoints[3];
+    const uint16_t* seedTable;
+
+    //keeps an angle inside the joint's limits, going to whichever one is closer if it's outside them
+    float clampToLimits(uint8_t joint, float angle);
+
+    //the grid point nearest a target, or -1 if the target's off the grid
+    int32_t nearestGridPoint(const Vec3<float>& target);
+
+    uint32_t gridPointCount();
+
+    Vec3<float> gridPosition(uint16_t x, uint16_t y, uint16_t z);
+
+  public:
+
+    //constructs for the given arm, with no seed table and no joint limits
+    ArmInverseKinematics(ArmChainModel* armChain);
+
+    //overview: packs an angle in radians into a seed table entry, 65535 units to the turn, to within half a unit
+    //          (0.000048 rad). Never gives UnreachableSeed. For building tables some other way than buildSeedTable
+    static uint16_t packSeedAngle(float angle);
+
+    //the angle in radians, [0, 2pi), of a packed seed table entry
+    static float unpackSeedAngle(uint16_t packed);
+
+    //overview: solves for joint angles that put the tool at the target.
+    //inputs:   target: where the tool should go, in the base frame
+    //          seed: the angles to start from, one per link
+    //          angles: returned, one per link. Holds the closest the solver got even if it didn't converge
+    //returns:  how many iterations it took, or -1 if it didn't get within tolerance, ex because the target's out
+    //          of reach
+    int solve(const Vec3<float>& target, const float seed[], float angles[]);
+
+    //overview: solve, starting from the seed table's entry for the grid point nearest the target. Uses fallbackSeed
+    //          instead if there's no table, the target's off the grid, or the nearest grid point was unreachable
+    int solveFromTable(const Vec3<float>& target, const float fallbackSeed[], float angles[]);
+
+    //overview: solves a batch of targets, each one starting from the last one's solution, so a batch of targets close
+    //          together (ex a path, or a sweep over a grid) converges much faster than solving each one cold.
+    //inputs:   targets, count: the targets
+    //          seed: the angles the first target starts from
+    //          angles: returned, count * links of them, one target's after another
+    //          iterations: returned, count of them, what solve returned for each target. Can be 0
+    //returns:  how many of the targets were reached
+    uint32_t solveBatch(const Vec3<float> targets[], uint32_t count, const float seed[], float angles[], int8_t iterations[]);
+
+    //overview: sets up the seed table's grid, a box of the workspace in the base frame with evenly spaced points.
+    //          Any table in use is dropped, since its layout no longer matches.
+    //returns:  false if any axis has less than 2 points or the box is empty
+    bool setSeedGrid(const Vec3<float>& minCorner, const Vec3<float>& maxCorner, uint16_t pointsX, uint16_t pointsY, uint16_t pointsZ);
+
+    //returns how many entries the seed table takes up with the grid as it is; points * links
+    uint32_t getSeedTableLength();
+
+    //overview: builds the seed table by solving every grid point as one batch, sweeping back and forth through the
+    //          grid so each point starts from its neighbour's solution, then uses it.
+    //inputs:   storage, length: where to build it, see getSeedTableLength
+    //          startAngles: the angles the sweep starts from, and restarts from after an unreachable point
+    //returns:  how many grid points were reachable, or 0 if the storage is too small or there's no grid
+    uint32_t buildSeedTable(uint16_t* storage, uint32_t length, const float startAngles[]);
+
+    //overview: uses a seed table that's already been built, ex on a computer and compiled into flash. The grid and the
+    //          chain have to be set up the same as when it was built.
+    //returns:  false if the length doesn't match
+    bool useSeedTable(const uint16_t* table, uint32_t length);
+
+    //overview: finds the seed table's entry for the grid point nearest the target.
+    //returns:  false if there's no table, the target's off the grid, or the point was unreachable
+    bool getSeed(const Vec3<float>& target, float seed[]);
+
+    //sets the tool point that's solved for, in the frame of the last link. Default is that frame's origin
+    void setToolOffset(float x, float y, float z);
+
+    //sets how close to the target counts as there, in meters. Default 0.0005 (0.5mm)
+    void setTolerance(float meters);
+
+    //sets the most iterations solve will take before giving up. Default 20
+    void setMaxIterations(uint8_t iterations);
+
+    //sets the least squares damping, in meters. Higher is steadier near singularities and out of reach targets, but
+    //slower to converge. Default 0.005
+    void setDamping(float lambda);
+
+    //sets the range a joint's solutions have to stay in, in radians. The range goes positive from minimum to
+    //maximum, so it can wrap through 0 the same as hard stops can
+    void setJointLimits(uint8_t joint, float minimum, float maximum);
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "ArmKinematicsCache.h"
+
+static const float DefaultThreshold = 0.001; //radians
+
+ArmKinematicsCache::ArmKinematicsCache(ArmChainModel* armChain)
+  : chain(armChain), cachedLinks(0), firstRebuiltLink(0), threshold(DefaultThreshold), torquesValid(false)
+{
+}
+
+void ArmKinematicsCache::setUp()
+{
+  cachedLinks = chain->getLinkCount();
+
+  for(int i = 0; i < cachedLinks; i++)
+  {
+    const ArmLink& link = *chain->getLink(i);
+    cosAlpha[i] = cos(link.alpha);
+    sinAlpha[i] = sin(link.alpha);
+  }
+}
+
+const Mat4<float>* ArmKinematicsCache::update(const float jointAngles[])
+{
+  const uint8_t linkCount = chain->getLinkCount();
+  bool rebuildAll = (cachedLinks == 0 || cachedLinks != linkCount);
+  uint8_t first = linkCount;
+
+  if(rebuildAll)
+  {
+    setUp();
+  }
+
+  //redo the trig of just the joints that moved
+  for(int i = 0; i < linkCount; i++)
+  {
+    float moved = jointAngles[i] - cachedAngles[i];
+    if(rebuildAll || moved > threshold || moved < -threshold)
+    {
+      const ArmLink& link = *chain->getLink(i);
+      float theta = jointAngles[i] + link.thetaOffset;
+
+      cachedAngles[i] = jointAngles[i];
+      linkTransforms[i] = Mat4<float>::fromDH(cos(theta), sin(theta), link.d, link.a, cosAlpha[i], sinAlpha[i]);
+      if(first == linkCount)
+      {
+        first = i;
+      }
+    }
+  }
+
+  //every frame past the first joint that moved depends on it
+  for(int i = first; i < linkCount; i++)
+  {
+    frames[i] = (i == 0) ? linkTransforms[0] : frames[i - 1] * linkTransforms[i];
+  }
+
+  if(first < linkCount)
+  {
+    torquesValid = false;
+  }
+  firstRebuiltLink = first;
+
+  return frames;
+}
+
+void ArmKinematicsCache::gravityTorques(const float jointAngles[], float torques[])
+{
+  const Mat4<float>* linkFrames = update(jointAngles);
+  Vec3<float> gravity = chain->getGravity();
+
+  if(!torquesValid || gravity.x != torqueGravity.x || gravity.y != torqueGravity.y || gravity.z != torqueGravity.z)
+  {
+    chain->gravityTorquesFromFrames(linkFrames, cachedTorques);
+    torqueGravity = gravity;
+    torquesValid = true;
+  }
+
+  for(int i = 0; i < cachedLinks; i++)
+  {
+    torques[i] = cachedTorques[i];
+  }
+}
+
+void ArmKinematicsCache::setThreshold(float thresholdRadians)
+{
+  threshold = thresholdRadians;
+}
+
+void ArmKinematicsCache::invalidate()
+{
+  cachedLinks = 0;
+  torquesValid = false;
+}
+
+uint8_t ArmKinematicsCache::getFirstRebuiltLink()
+{
+  return firstRebuiltLink;
+}
@@ -0,0 +1,73 @@
+#ifndef ROVEJOINTCONTROL_ARMKINEMATICSCACHE_H_
+#define ROVEJOINTCONTROL_ARMKINEMATICSCACHE_H_
+
+#include <stdint.h>
+#include "ArmChainModel.h"
+#include "KinematicsMath.h"
+
+//Keeps an ArmChainModel's forward kinematics from one update to the next, and only redoes what the joints that
+//moved actually change.
+//
+//Each link's own DH transform is kept, along with the angle it was made for, so only joints that moved past the
+//threshold get their sines and cosines redone. The base-to-link frames are rebuilt from the first of those joints
+//outwards; the ones before it don't depend on it. When nothing moved past the threshold the frames, and the gravity
+//torques worked out from them, are reused as is, so on an arm that's sitting still an update costs a few compares.
+//
+//The threshold trades accuracy for skipped work: the frames can lag the joints by up to that much. Keep it above
+//the joint sensors' noise, or the noise alone will keep rebuilding them.
+//
+//Each user of the chain should have its own cache; it's changed by every call, so it isn't safe to share between
+//threads the way the chain itself is.
+//see the readme.md for more info
+class ArmKinematicsCache
+{
+  private:
+    ArmChainModel* chain;
+
+    //per link: its own transform, the angle that was made for, and the frame at its end
+    Mat4<float> linkTransforms[ArmChainModel::MaxLinks];
+    float cachedAngles[ArmChainModel::MaxLinks];
+    Mat4<float> frames[ArmChainModel::MaxLinks];
+
+    //the links' alphas never change, so their trig is done once
+    float cosAlpha[ArmChainModel::MaxLinks];
+    float sinAlpha[ArmChainModel::MaxLinks];
+
+    //how many links were set up last time, 0 if the cache needs setting up from scratch
+    uint8_t cachedLinks;
+    uint8_t firstRebuiltLink;
+    float threshold;
+
+    float cachedTorques[ArmChainModel::MaxLinks];
+    bool torquesValid;
+    Vec3<float> torqueGravity;
+
+    void setUp();
+
+  public:
+
+    //constructs a cache for the given chain, with the default threshold
+    ArmKinematicsCache(ArmChainModel* armChain);
+
+    //overview: brings the frames up to date with the given joint angles, rebuilding only from the first joint that
+    //          moved past the threshold.
+    //inputs:   jointAngles: radians, one per link
+    //returns:  the frame at the end of each link, see ArmChainModel::forwardKinematics. Stays valid until the next call
+    const Mat4<float>* update(const float jointAngles[]);
+
+    //overview: ArmChainModel::gravityTorques through the cache; the torques are only redone if the frames changed
+    //          or the chain's gravity did.
+    void gravityTorques(const float jointAngles[], float torques[]);
+
+    //sets how far a joint has to move, in radians, before its part of the kinematics gets redone. Default is
+    //0.001 rad (0.057 degrees)
+    void setThreshold(float thresholdRadians);
+
+    //forgets everything, so the next update redoes all of it. Call after changing the chain's links
+    void invalidate();
+
+    //returns the index of the first link the last update rebuilt, or the link count if it rebuilt nothing
+    uint8_t getFirstRebuiltLink();
+};
+
+#endif
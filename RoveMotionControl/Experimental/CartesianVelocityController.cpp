@@ -0,0 +1,384 @@
+#include "CartesianVelocityController.h"
+#include "RoveBoard.h"
+
+static const float TwoPi = 6.2831853;
+static const float RadiansToMilliDegrees = 57295.78;
+
+static const uint32_t DefaultCommandTimeout_ms = 250;
+static const float DefaultDamping = 0.01;
+static const float DefaultLimitMargin = 0.035; //radians, about 2 degrees
+
+//puts an angle into [0, 2pi)
+static float wrapAngle(float angle)
+{
+  while(angle < 0)
+  {
+    angle += TwoPi;
+  }
+  while(angle >= TwoPi)
+  {
+    angle -= TwoPi;
+  }
+
+  return angle;
+}
+
+CartesianVelocityController::CartesianVelocityController(ArmChainModel* armChain)
+  : chain(armChain), kinematics(armChain), twistTime_ms(0), commandTimeout_ms(DefaultCommandTimeout_ms), moving(false),
+    damping(DefaultDamping), linearWeight(1), angularWeight(1), limitMargin(DefaultLimitMargin), limitedJoints(0)
+{
+  for(int i = 0; i < TwistSize; i++)
+  {
+    twist[i] = 0;
+  }
+
+  for(int i = 0; i < MaxJoints; i++)
+  {
+    hasLimits[i] = false;
+    minAngle[i] = 0;
+    maxAngle[i] = 0;
+    maxSpeed[i] = SPEED_MAX / RadiansToMilliDegrees;
+    axisGroups[i] = 0;
+    axisTasks[i] = -1;
+    jointSpeeds[i] = 0;
+  }
+}
+
+void CartesianVelocityController::setTwist(float vx, float vy, float vz, float wx, float wy, float wz)
+{
+  twist[0] = vx;
+  twist[1] = vy;
+  twist[2] = vz;
+  twist[3] = wx;
+  twist[4] = wy;
+  twist[5] = wz;
+
+  twistTime_ms = millis();
+  moving = true;
+}
+
+void CartesianVelocityController::stop()
+{
+  moving = false;
+}
+
+bool CartesianVelocityController::update()
+{
+  const uint8_t jointCount = chain->getLinkCount();
+  float angles[MaxJoints];
+  float jacobian[TwistSize][MaxJoints];
+  uint8_t heldJoints = 0;
+
+  for(int i = 0; i < MaxJoints; i++)
+  {
+    jointSpeeds[i] = 0;
+  }
+  limitedJoints = 0;
+
+  if(!chain->readJointAngles(angles) || jointCount == 0)
+  {
+    sendSpeeds(jointCount);
+    return false;
+  }
+
+  if(moving && commandTimeout_ms != 0 && millis() - twistTime_ms > commandTimeout_ms)
+  {
+    moving = false;
+  }
+
+  if(!moving)
+  {
+    sendSpeeds(jointCount);
+    return true;
+  }
+
+  //column i of the jacobian is how the tool moves when joint i turns, which turns about the z axis of the frame
+  //before it: linear z x (tool - origin), angular z
+  const Mat4<float>* frames = kinematics.update(angles);
+  Vec3<float> tool = frames[jointCount - 1].transformPoint(toolOffset);
+
+  for(int i = 0; i < jointCount; i++)
+  {
+    Vec3<float> axis(0, 0, 1);
+    Vec3<float> origin;
+    if(i > 0)
+    {
+      axis = frames[i - 1].zAxis();
+      origin = frames[i - 1].origin();
+    }
+
+    Vec3<float> linear = cross(axis, tool - origin);
+    jacobian[0][i] = linear.x;
+    jacobian[1][i] = linear.y;
+    jacobian[2][i] = linear.z;
+    jacobian[3][i] = axis.x;
+    jacobian[4][i] = axis.y;
+    jacobian[5][i] = axis.z;
+
+    //joints without sensors are fixed
+    if(!chain->getJointSensor(i))
+    {
+      heldJoints |= 1 << i;
+    }
+  }
+
+  //hold the joints that would go into their limits and solve again without them, until none do. Each pass holds at
+  //least one more joint, so it ends within jointCount passes
+  for(int pass = 0; pass <= jointCount; pass++)
+  {
+    uint8_t newlyLimited = 0;
+
+    if(!solve(jacobian, jointCount, heldJoints | limitedJoints, jointSpeeds))
+    {
+      for(int i = 0; i < MaxJoints; i++)
+      {
+        jointSpeeds[i] = 0;
+      }
+      sendSpeeds(jointCount);
+      return false;
+    }
+
+    for(int i = 0; i < jointCount; i++)
+    {
+      if(!((heldJoints | limitedJoints) & (1 << i)) && headsIntoLimit(i, angles[i], jointSpeeds[i]))
+      {
+        newlyLimited |= 1 << i;
+      }
+    }
+
+    if(newlyLimited == 0)
+    {
+      break;
+    }
+    limitedJoints |= newlyLimited;
+  }
+
+  //slow every joint down by the same ratio if any are going too fast, so the tool keeps its direction
+  float slowest = 1;
+  for(int i = 0; i < jointCount; i++)
+  {
+    float speed = jointSpeeds[i] < 0 ? -jointSpeeds[i] : jointSpeeds[i];
+    if(speed * slowest > maxSpeed[i])
+    {
+      slowest = maxSpeed[i] / speed;
+    }
+  }
+  for(int i = 0; i < jointCount; i++)
+  {
+    jointSpeeds[i] *= slowest;
+  }
+
+  sendSpeeds(jointCount);
+  return true;
+}
+
+bool CartesianVelocityController::solve(const float jacobian[TwistSize][MaxJoints], uint8_t jointCount, uint8_t heldJoints, float speeds[])
+{
+  const float weights[TwistSize] = {linearWeight, linearWeight, linearWeight, angularWeight, angularWeight, angularWeight};
+  float weighted[TwistSize][MaxJoints];
+  float A[TwistSize][TwistSize];
+  float y[TwistSize];
+
+  //held joints' columns are left out, IE zeroed
+  for(int r = 0; r < TwistSize; r++)
+  {
+    for(int i = 0; i < jointCount; i++)
+    {
+      weighted[r][i] = (heldJoints & (1 << i)) ? 0 : jacobian[r][i] * weights[r];
+    }
+  }
+
+  //A = Jw * Jw^T + damping^2 * I, symmetric so only the lower half is worked out
+  for(int r = 0; r < TwistSize; r++)
+  {
+    for(int c = 0; c <= r; c++)
+    {
+      float sum = (r == c) ? damping * damping : 0;
+      for(int i = 0; i < jointCount; i++)
+      {
+        sum += weighted[r][i] * weighted[c][i];
+      }
+      A[r][c] = sum;
+    }
+  }
+
+  //cholesky factor A = L * L^T in place, in the lower half
+  for(int c = 0; c < TwistSize; c++)
+  {
+    float diagonal = A[c][c];
+    for(int k = 0; k < c; k++)
+    {
+      diagonal -= A[c][k] * A[c][k];
+    }
+    if(!(diagonal > 0))
+    {
+      return false;
+    }
+    A[c][c] = sqrt(diagonal);
+
+    for(int r = c + 1; r < TwistSize; r++)
+    {
+      float sum = A[r][c];
+      for(int k = 0; k < c; k++)
+      {
+        sum -= A[r][k] * A[c][k];
+      }
+      A[r][c] = sum / A[c][c];
+    }
+  }
+
+  //L * L^T * y = Wv, forwards then backwards
+  for(int r = 0; r < TwistSize; r++)
+  {
+    float sum = twist[r] * weights[r];
+    for(int k = 0; k < r; k++)
+    {
+      sum -= A[r][k] * y[k];
+    }
+    y[r] = sum / A[r][r];
+  }
+  for(int r = TwistSize - 1; r >= 0; r--)
+  {
+    float sum = y[r];
+    for(int k = r + 1; k < TwistSize; k++)
+    {
+      sum -= A[k][r] * y[k];
+    }
+    y[r] = sum / A[r][r];
+  }
+
+  //qd = Jw^T * y
+  for(int i = 0; i < jointCount; i++)
+  {
+    float sum = 0;
+    for(int r = 0; r < TwistSize; r++)
+    {
+      sum += weighted[r][i] * y[r];
+    }
+    speeds[i] = sum;
+  }
+
+  return true;
+}
+
+bool CartesianVelocityController::headsIntoLimit(uint8_t joint, float angle, float speed)
+{
+  if(!hasLimits[joint] || speed == 0)
+  {
+    return false;
+  }
+
+  float span = wrapAngle(maxAngle[joint] - minAngle[joint]);
+  float offset = wrapAngle(angle - minAngle[joint]);
+  float toMax, toMin;
+
+  if(offset <= span)
+  {
+    toMax = span - offset;
+    toMin = offset;
+  }
+  //outside of the range; it's past whichever limit is closer, and can only move back towards the range
+  else if(offset - span < TwoPi - offset)
+  {
+    toMax = 0;
+    toMin = TwoPi;
+  }
+  else
+  {
+    toMax = TwoPi;
+    toMin = 0;
+  }
+
+  return (speed > 0 && toMax <= limitMargin) || (speed < 0 && toMin <= limitMargin);
+}
+
+void CartesianVelocityController::sendSpeeds(uint8_t jointCount)
+{
+  for(int i = 0; i < jointCount; i++)
+  {
+    if(axisGroups[i])
+    {
+      long command = jointSpeeds[i] * RadiansToMilliDegrees;
+      axisGroups[i]->setCommand(axisTasks[i], constrain(command, SPEED_MIN, SPEED_MAX));
+    }
+  }
+}
+
+void CartesianVelocityController::updateTask(void* controller)
+{
+  ((CartesianVelocityController*)controller)->update();
+}
+
+void CartesianVelocityController::setAxisTask(uint8_t joint, AxisGroup* group, int taskIndex)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  axisGroups[joint] = group;
+  axisTasks[joint] = taskIndex;
+}
+
+void CartesianVelocityController::setJointLimits(uint8_t joint, float minimum, float maximum)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  hasLimits[joint] = true;
+  minAngle[joint] = wrapAngle(minimum);
+  maxAngle[joint] = wrapAngle(maximum);
+}
+
+void CartesianVelocityController::setLimitMargin(float margin)
+{
+  limitMargin = margin;
+}
+
+void CartesianVelocityController::setMaxJointSpeed(uint8_t joint, float speed)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  maxSpeed[joint] = speed;
+}
+
+void CartesianVelocityController::setDamping(float lambda)
+{
+  damping = lambda;
+}
+
+void CartesianVelocityController::setTaskWeights(float linear, float angular)
+{
+  linearWeight = linear;
+  angularWeight = angular;
+}
+
+void CartesianVelocityController::setToolOffset(float x, float y, float z)
+{
+  toolOffset = Vec3<float>(x, y, z);
+}
+
+void CartesianVelocityController::setCommandTimeout(uint32_t timeout_ms)
+{
+  commandTimeout_ms = timeout_ms;
+}
+
+float CartesianVelocityController::getJointSpeed(uint8_t joint)
+{
+  if(joint >= MaxJoints)
+  {
+    return 0;
+  }
+
+  return jointSpeeds[joint];
+}
+
+uint8_t CartesianVelocityController::getLimitedJoints()
+{
+  return limitedJoints;
+}
@@ -0,0 +1,126 @@
+#ifndef ROVEJOINTCONTROL_CARTESIANVELOCITYCONTROLLER_H_
+#define ROVEJOINTCONTROL_CARTESIANVELOCITYCONTROLLER_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+#include "../MotionAxises/AxisGroup.h"
+#include "ArmChainModel.h"
+#include "ArmKinematicsCache.h"
+
+//Moves an arm's tool in a straight line: takes the velocity the tool should move at (a twist; linear velocity in m/s
+//and angular velocity in rad/s, both in the arm's base frame) and works out the joint speeds that do it, for each
+//joint's axis to be given as its speed command.
+//
+//Every update it reads the joints, builds the arm's jacobian at the tool, and solves for the joint speeds by damped
+//least squares: qd = J^T * (J * J^T + damping^2 * I)^-1 * twist. The damping keeps the joint speeds finite near
+//singularities at the cost of following the twist a bit less exactly there. A joint that's within the limit margin
+//of one of its limits and would be moved further into it is held still, and the rest of the arm solved for without
+//it; then if any joint would go past its max speed, all of them are slowed by the same ratio so the tool still moves
+//in the same direction.
+//
+//The speeds go out through an AxisGroup as each joint axis's command, in SPEED units, so the axises need to take
+//speed input. Positive joint speed is taken to turn the joint's sensor positive. Run update() from an AxisGroup task
+//using updateTask; 200hz is plenty. While it's running it owns those axises' commands, sending 0 when stopped. If
+//setTwist isn't called again within the command timeout the arm is stopped, so a lost operator link doesn't leave it
+//moving.
+//see the readme.md for more info
+class CartesianVelocityController
+{
+  public:
+    static const uint8_t TwistSize = 6;
+
+  private:
+    static const uint8_t MaxJoints = ArmChainModel::MaxLinks;
+
+    ArmChainModel* chain;
+    ArmKinematicsCache kinematics;
+
+    float twist[TwistSize];
+    uint32_t twistTime_ms;
+    uint32_t commandTimeout_ms;
+    bool moving;
+
+    Vec3<float> toolOffset;
+    float damping;
+    float linearWeight;
+    float angularWeight;
+    float limitMargin;
+
+    bool hasLimits[MaxJoints];
+    float minAngle[MaxJoints];
+    float maxAngle[MaxJoints];
+    float maxSpeed[MaxJoints];
+
+    AxisGroup* axisGroups[MaxJoints];
+    int axisTasks[MaxJoints];
+
+    float jointSpeeds[MaxJoints];
+    uint8_t limitedJoints;
+
+    //solves for the joint speeds with the given joints held still, returns false if the solve failed
+    bool solve(const float jacobian[TwistSize][MaxJoints], uint8_t jointCount, uint8_t heldJoints, float speeds[]);
+
+    //whether moving the joint at the given speed takes it within the limit margin of one of its limits
+    bool headsIntoLimit(uint8_t joint, float angle, float speed);
+
+    //sends the joint speeds to the axises
+    void sendSpeeds(uint8_t jointCount);
+
+  public:
+
+    //constructs for the given arm, stopped, with no joint limits and every joint's max speed at SPEED_MAX
+    CartesianVelocityController(ArmChainModel* armChain);
+
+    //overview: sets the velocity the tool should move at, in the base frame. Starts the command timeout over.
+    //inputs:   vx, vy, vz: linear velocity in m/s
+    //          wx, wy, wz: angular velocity in rad/s
+    void setTwist(float vx, float vy, float vz, float wx, float wy, float wz);
+
+    //stops the arm; every joint's speed command goes to 0 on the next update
+    void stop();
+
+    //overview: reads the joints, solves for their speeds and sends them to the axises.
+    //returns:  false if a joint sensor failed or the solve did, in which case every joint is sent 0
+    bool update();
+
+    //update() in the shape AxisGroup::addTask wants, with the controller passed as the context
+    static void updateTask(void* controller);
+
+    //sets the axis task a joint's speed commands go to. Joints without one can be read with getJointSpeed instead
+    void setAxisTask(uint8_t joint, AxisGroup* group, int taskIndex);
+
+    //overview: sets the range a joint is allowed to move in, in radians as its sensor reads them. The range goes
+    //          positive from minimum to maximum, so it can wrap through 0 the same as hard stops can
+    void setJointLimits(uint8_t joint, float minimum, float maximum);
+
+    //sets how close to a limit, in radians, a joint can get before it's held from moving further into it. Default
+    //is 0.035 rad (2 degrees)
+    void setLimitMargin(float margin);
+
+    //sets a joint's max speed, in rad/s. Default is SPEED_MAX
+    void setMaxJointSpeed(uint8_t joint, float speed);
+
+    //sets the least squares damping, in m or rad. Higher is steadier around singularities but follows the twist less
+    //exactly everywhere. Default is 0.01, for arms around a meter long
+    void setDamping(float lambda);
+
+    //sets how much the linear and angular parts of the twist weigh against each other in the solve. 0 for the angular
+    //weight lets the tool's orientation go wherever it needs to for the linear velocity to be followed. Default 1, 1
+    void setTaskWeights(float linear, float angular);
+
+    //sets the tool point that's moved, in the frame of the last link. Default is that frame's origin
+    void setToolOffset(float x, float y, float z);
+
+    //sets how long a twist is followed for after setTwist, in milliseconds. 0 follows it until told otherwise.
+    //Default is 250
+    void setCommandTimeout(uint32_t timeout_ms);
+
+    //returns a joint's speed from the last update, in rad/s
+    float getJointSpeed(uint8_t joint);
+
+    //returns a bitmask of the joints the last update held still because of their limits, bit 0 being the first
+    uint8_t getLimitedJoints();
+};
+
+#endif
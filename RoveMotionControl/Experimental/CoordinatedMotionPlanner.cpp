@@ -0,0 +1,280 @@
+#include "CoordinatedMotionPlanner.h"
+#include "RoveBoard.h"
+
+static const long POS_RANGE = POS_MAX - POS_MIN;
+static const float RadiansToDegrees = 57.29578;
+
+CoordinatedMotionPlanner::CoordinatedMotionPlanner()
+  : axisCount(0), gravityStatus(0), moving(false), startTime_us(0), moveDuration(0)
+{
+}
+
+int CoordinatedMotionPlanner::addAxis(FeedbackDevice* posFeedback, AxisGroup* group, int taskIndex, float speedLimit, float accelerationLimit, float jerkLimit)
+{
+  if(axisCount >= MaxAxises || posFeedback->getFeedbackType() != InputPosition)
+  {
+    return -1;
+  }
+
+  PlannedAxis& axis = axises[axisCount];
+  axis.positionFeedback = posFeedback;
+  axis.group = group;
+  axis.taskIndex = taskIndex;
+  axis.maxSpeed = speedLimit;
+  axis.maxAcceleration = accelerationLimit;
+  axis.maxJerk = jerkLimit;
+  axis.maxTorque = 0;
+  axis.statusId = 0;
+  axis.startPosition = axis.destination = axis.setpoint = 0;
+
+  return axisCount++;
+}
+
+void CoordinatedMotionPlanner::setLimits(uint8_t axis, float speedLimit, float accelerationLimit, float jerkLimit)
+{
+  if(axis >= axisCount)
+  {
+    return;
+  }
+
+  axises[axis].maxSpeed = speedLimit;
+  axises[axis].maxAcceleration = accelerationLimit;
+  axises[axis].maxJerk = jerkLimit;
+}
+
+void CoordinatedMotionPlanner::setTorqueLimit(uint8_t axis, float maxTorque, GravityInertiaSystemStatus* status, uint32_t statusId)
+{
+  if(axis >= axisCount)
+  {
+    return;
+  }
+
+  axises[axis].maxTorque = maxTorque;
+  axises[axis].statusId = statusId;
+  gravityStatus = status;
+}
+
+void CoordinatedMotionPlanner::setHardStopPositions(uint8_t axis, float hardStopPos1_deg, float hardStopPos2_deg)
+{
+  if(axis >= axisCount)
+  {
+    return;
+  }
+
+  if(!(hardStopPos1_deg == -1 || hardStopPos2_deg == -1))
+  {
+    axises[axis].routePlanner.setHardStops(abs(hardStopPos1_deg) * POS_RANGE / 360.0 + 0.5, abs(hardStopPos2_deg) * POS_RANGE / 360.0 + 0.5);
+  }
+  else
+  {
+    axises[axis].routePlanner.clearHardStops();
+  }
+}
+
+float CoordinatedMotionPlanner::accelerationLimit(const PlannedAxis& axis)
+{
+  if(axis.maxTorque == 0 || !gravityStatus)
+  {
+    return axis.maxAcceleration;
+  }
+
+  //whatever torque isn't holding the arm up is left for accelerating it
+  float gravity = gravityStatus->getGravity(axis.statusId);
+  float inertia = gravityStatus->getInertia(axis.statusId);
+  float spare = axis.maxTorque - (gravity < 0 ? -gravity : gravity);
+
+  if(spare <= 0)
+  {
+    return 0;
+  }
+  else if(inertia <= 0)
+  {
+    return axis.maxAcceleration;
+  }
+
+  //milli newton-meters over kg*m^2 is milli rad/s^2
+  float torqueLimited = spare / 1000 / inertia * RadiansToDegrees;
+  return torqueLimited < axis.maxAcceleration ? torqueLimited : axis.maxAcceleration;
+}
+
+long CoordinatedMotionPlanner::profilePosition(const PlannedAxis& axis, float distanceMoved)
+{
+  long position = (axis.startPosition + (long)(distanceMoved * POS_RANGE / 360.0)) % POS_RANGE;
+  if(position < 0)
+  {
+    position += POS_RANGE;
+  }
+
+  return position;
+}
+
+bool CoordinatedMotionPlanner::moveTo(const long destinations[])
+{
+  float distances[MaxAxises];
+  float accelerations[MaxAxises];
+  float startSpeeds[MaxAxises];
+  float startAccelerations[MaxAxises];
+  long starts[MaxAxises];
+  float elapsed = (micros() - startTime_us) / 1000000.0;
+  float duration = 0;
+
+  //work out every axis's route before touching any of them, so a bad one leaves the last move as it was
+  for(int i = 0; i < axisCount; i++)
+  {
+    PlannedAxis& axis = axises[i];
+
+    //mid move, carry on from wherever the old profile has got to by now, at the speed and acceleration it's got to, so
+    //the setpoints don't stop dead. Otherwise start from rest where the axis actually is
+    if(moving)
+    {
+      float moved;
+      axis.profile.evaluate(elapsed, &moved, &startSpeeds[i], &startAccelerations[i]);
+      starts[i] = profilePosition(axis, moved);
+    }
+    else
+    {
+      startSpeeds[i] = startAccelerations[i] = 0;
+
+      starts[i] = axis.positionFeedback->getFeedback();
+      if(axis.positionFeedback->getFeedbackStatus() != FeedbackStatus_Success)
+      {
+        return false;
+      }
+    }
+
+    long route = axis.routePlanner.routeTo(starts[i], destinations[i]);
+    accelerations[i] = accelerationLimit(axis);
+    if(route == PositionRoutePlanner::ImpossibleRoute || accelerations[i] <= 0)
+    {
+      return false;
+    }
+
+    //the profiles work in degrees
+    distances[i] = route * 360.0 / POS_RANGE;
+  }
+
+  //the move takes as long as its slowest axis needs
+  for(int i = 0; i < axisCount; i++)
+  {
+    PlannedAxis& axis = axises[i];
+    if(!axis.profile.planFrom(distances[i], startSpeeds[i], startAccelerations[i], axis.maxSpeed, accelerations[i], axis.maxJerk))
+    {
+      return false;
+    }
+
+    if(axis.profile.getDuration() > duration)
+    {
+      duration = axis.profile.getDuration();
+    }
+  }
+
+  //then every axis is slowed to take that long too
+  for(int i = 0; i < axisCount; i++)
+  {
+    PlannedAxis& axis = axises[i];
+    axis.profile.planFromWithDuration(distances[i], startSpeeds[i], startAccelerations[i], axis.maxSpeed, accelerations[i], axis.maxJerk, duration);
+    axis.startPosition = starts[i];
+    axis.destination = destinations[i];
+  }
+
+  moveDuration = duration;
+  startTime_us = micros();
+  moving = true;
+  update();
+
+  return true;
+}
+
+void CoordinatedMotionPlanner::stop()
+{
+  moving = false;
+
+  for(int i = 0; i < axisCount; i++)
+  {
+    if(gravityStatus && axises[i].statusId != 0)
+    {
+      gravityStatus->setJointMotion(axises[i].statusId, 0, 0);
+    }
+  }
+}
+
+bool CoordinatedMotionPlanner::update()
+{
+  if(!moving)
+  {
+    return false;
+  }
+
+  //one time for every axis, so they stay in step
+  float elapsed = (micros() - startTime_us) / 1000000.0;
+  bool done = (elapsed >= moveDuration);
+
+  for(int i = 0; i < axisCount; i++)
+  {
+    PlannedAxis& axis = axises[i];
+    float speed = 0, acceleration = 0;
+
+    if(done)
+    {
+      axis.setpoint = axis.destination;
+    }
+    else
+    {
+      float distanceMoved;
+      axis.profile.evaluate(elapsed, &distanceMoved, &speed, &acceleration);
+
+      axis.setpoint = profilePosition(axis, distanceMoved);
+    }
+
+    if(gravityStatus && axis.statusId != 0)
+    {
+      gravityStatus->setJointMotion(axis.statusId, speed, acceleration);
+    }
+  }
+
+  sendSetpoints();
+  moving = !done;
+
+  return moving;
+}
+
+void CoordinatedMotionPlanner::sendSetpoints()
+{
+  for(int i = 0; i < axisCount; i++)
+  {
+    if(axises[i].group)
+    {
+      axises[i].group->setCommand(axises[i].taskIndex, axises[i].setpoint);
+    }
+  }
+}
+
+void CoordinatedMotionPlanner::updateTask(void* planner)
+{
+  ((CoordinatedMotionPlanner*)planner)->update();
+}
+
+bool CoordinatedMotionPlanner::isMoveDone()
+{
+  return !moving;
+}
+
+float CoordinatedMotionPlanner::getMoveDuration()
+{
+  return moveDuration;
+}
+
+long CoordinatedMotionPlanner::getSetpoint(uint8_t axis)
+{
+  if(axis >= axisCount)
+  {
+    return 0;
+  }
+
+  return axises[axis].setpoint;
+}
+
+uint8_t CoordinatedMotionPlanner::getAxisCount()
+{
+  return axisCount;
+}
@@ -0,0 +1,138 @@
+#ifndef ROVEJOINTCONTROL_COORDINATEDMOTIONPLANNER_H_
+#define ROVEJOINTCONTROL_COORDINATEDMOTIONPLANNER_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+#include "../MotionAxises/AxisGroup.h"
+#include "../IOConverters/TrajectoryProfile.h"
+#include "../IOConverters/PositionRoutePlanner.h"
+#include "GravityInertiaSystemStatus.h"
+
+//Moves a group of axises to their destinations together, so they all start and finish at the same time rather than
+//each one getting there whenever its own loop does.
+//
+//A move plans a TrajectoryProfile for every axis from where it is to its destination within its own limits, takes the
+//longest of their durations, and plans every axis again slowed to take exactly that long (see
+//TrajectoryProfile::planWithDuration). So the move takes as long as its slowest axis needs and no longer, and every
+//axis speeds up, cruises and slows down over the same stretches of time. Each update then evaluates every profile at
+//the same time since the move started and sends each axis its setpoint, in position units, through its AxisGroup axis
+//task; the axises need to take position input, ex through PIAlgorithm or PIVConverter.
+//
+//A move given while another is still going carries every axis on from where its setpoint has got to, at the speed and
+//acceleration it's got to (see TrajectoryProfile::planFrom). Those axises are brought to the common duration by
+//lowering their speed limits instead, so they still start and finish together, though they don't keep quite the same
+//phases as each other.
+//
+//An axis can also be given a torque limit, in which case its acceleration limit is brought down to what its motor can
+//manage with the arm's present gravity load and inertia on it, from a GravityInertiaSystemStatus, as of the start of
+//the move. Each update also tells the status how those axises are moving (see
+//GravityInertiaSystemStatus::setJointMotion), so a GravityCompensator set to compensateMotion covers the torque to
+//move the arm along the planned motion as well as to hold it up.
+//
+//Run update() from an AxisGroup task with updateTask, at the axises' rate or faster. While it's running it owns the
+//axises' commands.
+//see the readme.md for more info
+class CoordinatedMotionPlanner
+{
+  public:
+    static const uint8_t MaxAxises = 8;
+
+  private:
+    struct PlannedAxis
+    {
+      FeedbackDevice* positionFeedback;
+      AxisGroup* group;
+      int taskIndex;
+
+      //limits, in degrees/s, degrees/s^2 and degrees/s^3
+      float maxSpeed, maxAcceleration, maxJerk;
+
+      //torque limit in milli newton-meters, 0 for none, and the axis's id in the gravity status
+      float maxTorque;
+      uint32_t statusId;
+
+      PositionRoutePlanner routePlanner;
+      TrajectoryProfile profile;
+
+      //where the move started from and is going, and the last setpoint sent, in position units
+      long startPosition;
+      long destination;
+      long setpoint;
+    };
+
+    PlannedAxis axises[MaxAxises];
+    uint8_t axisCount;
+
+    GravityInertiaSystemStatus* gravityStatus;
+
+    bool moving;
+    uint32_t startTime_us;
+    float moveDuration;
+
+    //the acceleration limit an axis is planned with, its own or less if its torque limit says so. 0 if the axis
+    //can't hold itself up
+    float accelerationLimit(const PlannedAxis& axis);
+
+    //sends every axis its setpoint
+    void sendSetpoints();
+
+    //where an axis's profile has moved its setpoint to, in position units, from how far along it is in degrees
+    long profilePosition(const PlannedAxis& axis, float distanceMoved);
+
+  public:
+
+    //constructs a planner with no axises
+    CoordinatedMotionPlanner();
+
+    //overview: adds an axis to the group.
+    //inputs:   posFeedback: the axis's position sensor, read to find where moves start from
+    //          group, taskIndex: the AxisGroup axis task its setpoints are sent to
+    //          speedLimit, accelerationLimit: in degrees/s and degrees/s^2
+    //          jerkLimit: in degrees/s^3, 0 for no limit, making its profiles trapezoids
+    //returns:  the axis's index in the planner, or -1 if it's full or the feedback doesn't give position
+    int addAxis(FeedbackDevice* posFeedback, AxisGroup* group, int taskIndex, float speedLimit, float accelerationLimit, float jerkLimit);
+
+    //changes an axis's limits. Takes effect at the next move
+    void setLimits(uint8_t axis, float speedLimit, float accelerationLimit, float jerkLimit);
+
+    //overview: limits an axis's acceleration to what the given torque can do once it's holding the arm up.
+    //inputs:   maxTorque: the most torque the axis's motor can put out, in milli newton-meters; ex from its Kt, supply
+    //                     voltage and winding resistance. 0 turns the limit back off
+    //          status: where the gravity and inertia come from, shared by every axis
+    //          statusId: the axis's id in status
+    void setTorqueLimit(uint8_t axis, float maxTorque, GravityInertiaSystemStatus* status, uint32_t statusId);
+
+    //overview: positions of an axis's hard stops, in degrees, that its moves have to go around rather than through.
+    //          To disable, set one or both to -1.
+    void setHardStopPositions(uint8_t axis, float hardStopPos1_deg, float hardStopPos2_deg);
+
+    //overview: plans a move of every axis to its destination, starting now, and sends the first setpoints.
+    //inputs:   destinations: one per axis, in position units, in the order they were added
+    //returns:  false if an axis's feedback failed, a destination is past its hard stops, or an axis's torque limit
+    //          can't hold it up; nothing moves then
+    bool moveTo(const long destinations[]);
+
+    //stops the move where the setpoints are now. The axises' loops hold them there
+    void stop();
+
+    //overview: sends every axis its setpoint for the present time in the move.
+    //returns:  whether the move is still going
+    bool update();
+
+    //update() in the shape AxisGroup::addTask wants, with the planner passed as the context
+    static void updateTask(void* planner);
+
+    //whether the setpoints have reached the destinations. The axises themselves might still be catching up to them
+    bool isMoveDone();
+
+    //how long the last planned move takes, in seconds
+    float getMoveDuration();
+
+    //the setpoint last sent to an axis, in position units
+    long getSetpoint(uint8_t axis);
+
+    uint8_t getAxisCount();
+};
+
+#endif
@@ -27,7 +27,14 @@ long GravityCompensator::addToOutput(const long inputValue, const long calculate
   long gravPwm;
   IOConverter_Status dummy;
 
-  gravTorque = -1 * systemStatus->getGravity(axisId);
+  if(compensatingMotion)
+  {
+    gravTorque = -1 * systemStatus->getTorque(axisId);
+  }
+  else
+  {
+    gravTorque = -1 * systemStatus->getGravity(axisId);
+  }
 
   if(useErrorComp && abs(calculatedOutput) != POWERPERCENT_MAX && calculatedOutput != 0) //don't change compensation if motor's already saturated
   {
@@ -71,13 +78,13 @@ long GravityCompensator::addToOutput(const long inputValue, const long calculate
 }
 
 GravityCompensator::GravityCompensator(GravityInertiaSystemStatus* sysStatus, TorqueConverterMotorTypes motor_type, float Kt, int motResistance_milliOhms, int staticMillivolts, uint8_t axis_Id)
-  : IOConverter(InputPosition, InputPowerPercent), systemStatus(sysStatus), axisId(axis_Id), torqueConverter(motor_type, Kt, motResistance_milliOhms, staticMillivolts), scalar(1),
+  : IOConverter(InputPosition, InputPowerPercent), systemStatus(sysStatus), axisId(axis_Id), torqueConverter(motor_type, Kt, motResistance_milliOhms, staticMillivolts), scalar(1), compensatingMotion(false),
     useErrorComp(false), loopsTillErrorComp(DefaultLoopsTillErrorComp), acceptableError(DefaultAcceptableError), lastError(0), errorReadingDeadband(DefaultErrorReadingDeadband), compensationValue(0)
 {
 }
 
 GravityCompensator::GravityCompensator(GravityInertiaSystemStatus* sysStatus, TorqueConverterMotorTypes motor_type, float Kt, int motResistance_milliOhms, FeedbackDevice* fdev, uint8_t axis_Id)
-  : IOConverter(InputPosition, InputPowerPercent), systemStatus(sysStatus), axisId(axis_Id), torqueConverter(motor_type, Kt, motResistance_milliOhms, fdev), scalar(1),
+  : IOConverter(InputPosition, InputPowerPercent), systemStatus(sysStatus), axisId(axis_Id), torqueConverter(motor_type, Kt, motResistance_milliOhms, fdev), scalar(1), compensatingMotion(false),
     useErrorComp(false), loopsTillErrorComp(DefaultLoopsTillErrorComp), acceptableError(DefaultAcceptableError), lastError(0), errorReadingDeadband(DefaultErrorReadingDeadband), compensationValue(0)
 {
 }
@@ -87,6 +94,16 @@ void GravityCompensator::setScalar(float scale)
   scalar = scale;
 }
 
+void GravityCompensator::compensateMotion(bool compensate)
+{
+  compensatingMotion = compensate;
+}
+
+void GravityCompensator::setFeedforward(float speed, float acceleration)
+{
+  systemStatus->setJointMotion(axisId, speed, acceleration);
+}
+
 void GravityCompensator::useErrorCompensation(FeedbackDevice *torqueDev)
 {
   if(torqueDev->getFeedbackType() == InputTorque)
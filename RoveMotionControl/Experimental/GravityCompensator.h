@@ -19,6 +19,8 @@
 //see the README.md for more info
 class GravityCompensator: public IOConverter
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
 
     long addToOutput(const long inputValue, const long calculatedOutput);
@@ -28,6 +30,7 @@ class GravityCompensator: public IOConverter
     GravityInertiaSystemStatus* systemStatus;
     TtoPPOpenLConverter torqueConverter;
     float scalar;
+    bool compensatingMotion;
 
     FeedbackDevice *errorTorqueSensor;
     bool useErrorComp;
@@ -39,6 +42,8 @@ class GravityCompensator: public IOConverter
     int64_t  compensationValue;
 
   public:
+    static const ValueType StaticInType = InputPosition;
+    static const ValueType StaticOutType = InputPowerPercent;
 
     //public constructor, when the motor's voltage line doesn't vary in voltage level.
     //Inputs:
@@ -72,6 +77,18 @@ class GravityCompensator: public IOConverter
     //sets a scalar to apply to the output of the class, so you can tune it. Default is 1.
     void setScalar(float scale);
 
+    //sets whether to compensate for the torque it takes to move the arm as well as for gravity, using the torque
+    //systemStatus works out from how the axises are moving (see GravityInertiaSystemStatus::setJointMotion). Only
+    //chain arms work that out. Default is false.
+    void compensateMotion(bool compensate);
+
+    //overview: tells systemStatus how this axis is being moved, for compensateMotion. Stays in effect until changed; set
+    //          both to 0 when the axis stops. Something that plans the motion, like a TrajectoryConverter's setpoint
+    //          or a CoordinatedMotionPlanner given the status, should be what calls this.
+    //inputs:   speed: in degrees/s
+    //          acceleration: in degrees/s^2
+    void setFeedforward(float speed, float acceleration);
+
     void useErrorCompensation(FeedbackDevice *torqueDev);
     void setLoopsTillErrorCompensation(uint32_t loopsTillErrorCompensation);
     void setAcceptableErrorRange(uint32_t errorRange_milliNewtonMeters);
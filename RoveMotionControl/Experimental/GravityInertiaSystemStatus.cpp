@@ -2,13 +2,41 @@
 #include "RoveBoard.h"
 #include "../RoveMotionUtilities.h"
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "KinematicsMath.h"
 
 const float FootPoundToNewtonMeter = 1.36;
 
+//the arm math is done in float, which the boards' fpus handle in hardware
+typedef float GravityReal;
+
 GravityInertiaSystemStatus::GravityInertiaSystemStatus(ArmModel model, void* armModelConstants)
-  : Model(model), ArmModelConstants(armModelConstants)
+  : publishCount(0), gravityTable(0), dynamics(model == ChainArm ? (ArmChainModel*)armModelConstants : 0),
+    kinematics(model == ChainArm ? (ArmChainModel*)armModelConstants : 0), Model(model), ArmModelConstants(armModelConstants)
 {
+  //the words are all zero until the first update, which reads back as a sample of all zeroes
+  memset(&next, 0, sizeof(next));
+  for(int i = 0; i < 2; i++)
+  {
+    published[i].sequence = 0;
+    for(int j = 0; j < SampleWords; j++)
+    {
+      published[i].words[j] = 0;
+    }
+  }
 
+  for(int i = 0; i < MaxJoints; i++)
+  {
+    chainInertias[i] = 0;
+    jointSpeeds[i] = 0;
+    jointAccelerations[i] = 0;
+  }
+}
+
+GravityInertiaSystemStatus::GravityInertiaSystemStatus(ArmChainModel* chain)
+  : GravityInertiaSystemStatus(ChainArm, chain)
+{
 }
 
 // Empty because there is no dynamic memory
@@ -18,16 +46,168 @@ GravityInertiaSystemStatus::~GravityInertiaSystemStatus()
 
 void GravityInertiaSystemStatus::update()
 {
+	double* gravity = next.gravity;
+	double* inertia = next.inertia;
+	float* jointAngles = next.jointAngles;
+	float torques[MaxJoints];
+	const Mat4<float>* frames = 0;
+	bool kinematicsChanged = false;
+
+	next.timestamp_us = micros();
+
 	if(Model == GryphonArm)
 	{
 	  GryphonArmConstants *consts = ((GryphonArmConstants*)ArmModelConstants);
 
-	  uint32_t axis1Feed = consts->JOINT1ANGLE->getFeedback();
-	  uint32_t axis2Feed = consts->JOINT2ANGLE->getFeedback();
-	  uint32_t axis3Feed = consts->JOINT3ANGLE->getFeedback();
-	  uint32_t axis4Feed = consts->JOINT4ANGLE->getFeedback();
-	  uint32_t axis5Feed = consts->JOINT5ANGLE->getFeedback();
-	  uint32_t axis6Feed = consts->JOINT6ANGLE->getFeedback();
+	  jointAngles[0] = positionToRad(consts->JOINT1ANGLE->getFeedback());
+	  jointAngles[1] = positionToRad(consts->JOINT2ANGLE->getFeedback());
+	  jointAngles[2] = positionToRad(consts->JOINT3ANGLE->getFeedback());
+	  jointAngles[3] = positionToRad(consts->JOINT4ANGLE->getFeedback());
+	  jointAngles[4] = positionToRad(consts->JOINT5ANGLE->getFeedback());
+	  jointAngles[5] = positionToRad(consts->JOINT6ANGLE->getFeedback());
+	}
+	else if(Model == AtlasArm)
+	{
+	  AtlasArmConstants *consts = ((AtlasArmConstants*)ArmModelConstants);
+
+	  jointAngles[0] = positionToRad(consts->JOINT1ANGLE->getFeedback());
+	  jointAngles[1] = positionToRad(consts->JOINT2ANGLE->getFeedback());
+	  jointAngles[2] = positionToRad(consts->JOINT3ANGLE->getFeedback());
+	}
+	else if(Model == ChainArm)
+	{
+	  ((ArmChainModel*)ArmModelConstants)->readJointAngles(jointAngles);
+
+	  frames = kinematics.update(jointAngles);
+	  kinematicsChanged = kinematics.getFirstRebuiltLink() < ((ArmChainModel*)ArmModelConstants)->getLinkCount();
+	}
+
+	if(gravityTable && gravityTable->isReady())
+	{
+	  gravityTable->lookup(jointAngles, torques);
+	}
+	else if(Model == ChainArm)
+	{
+	  //through update()'s own kinematics cache, which modelGravity leaves alone so it can run on another thread
+	  kinematics.gravityTorques(jointAngles, torques);
+	}
+	else
+	{
+	  modelGravity(jointAngles, torques);
+	}
+
+	for(int i = 0; i < MaxJoints; i++)
+	{
+	  gravity[i] = torques[i];
+	  next.torque[i] = torques[i];
+	}
+
+	if(Model == ChainArm)
+	{
+	  ArmChainModel *chain = ((ArmChainModel*)ArmModelConstants);
+
+	  //the inertias only depend on where the arm is, so they can wait for it to move
+	  if(kinematicsChanged)
+	  {
+	    dynamics.jointInertiasFromFrames(frames, chainInertias);
+	  }
+
+	  for(int i = 0; i < chain->getLinkCount(); i++)
+	  {
+	    inertia[i] = chainInertias[i];
+	  }
+
+	  //the torque for the motion goes on top of gravity, with one more dynamics pass when anything's moving
+	  float speeds[MaxJoints];
+	  float accelerations[MaxJoints];
+	  bool moving = false;
+
+	  for(int i = 0; i < chain->getLinkCount(); i++)
+	  {
+	    speeds[i] = jointSpeeds[i].load(std::memory_order_relaxed);
+	    accelerations[i] = jointAccelerations[i].load(std::memory_order_relaxed);
+	    moving = moving || speeds[i] != 0 || accelerations[i] != 0;
+	  }
+
+	  if(moving)
+	  {
+	    dynamics.motionTorquesFromFrames(frames, speeds, accelerations, torques);
+
+	    for(int i = 0; i < chain->getLinkCount(); i++)
+	    {
+	      next.torque[i] += torques[i];
+	    }
+	  }
+	}
+
+	next.sequence = publishCount.load(std::memory_order_relaxed) + 1;
+	publish();
+}
+
+void GravityInertiaSystemStatus::publish()
+{
+  //only update() changes publishCount, so it can read it relaxed
+  uint32_t count = publishCount.load(std::memory_order_relaxed);
+  PublishedSample& buffer = published[(count + 1) % 2];
+  uint32_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+
+  //odd for the copy, with the fence keeping the words from being written before readers can see it's odd
+  buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for(int i = 0; i < SampleWords; i++)
+  {
+    uint32_t word;
+    memcpy(&word, (const char*)&next + i * sizeof(uint32_t), sizeof(word));
+    buffer.words[i].store(word, std::memory_order_relaxed);
+  }
+
+  buffer.sequence.store(sequence + 2, std::memory_order_release);
+  publishCount.store(count + 1, std::memory_order_release);
+}
+
+void GravityInertiaSystemStatus::readPublished(uint8_t firstWord, uint8_t count, uint32_t words[])
+{
+  uint32_t sequence;
+  bool torn;
+
+  do
+  {
+    PublishedSample& buffer = published[publishCount.load(std::memory_order_acquire) % 2];
+    sequence = buffer.sequence.load(std::memory_order_acquire);
+
+    for(int i = 0; i < count; i++)
+    {
+      words[i] = buffer.words[firstWord + i].load(std::memory_order_relaxed);
+    }
+
+    //the words have to be read before the sequence is checked again. If it changed, or was odd to begin with,
+    //update() has since come back round to this buffer and the words might be from two different updates
+    std::atomic_thread_fence(std::memory_order_acquire);
+    torn = (sequence & 1) || buffer.sequence.load(std::memory_order_relaxed) != sequence;
+  } while(torn);
+}
+
+double GravityInertiaSystemStatus::readPublishedDouble(size_t offset)
+{
+  uint32_t words[sizeof(double) / sizeof(uint32_t)];
+  double value;
+
+  readPublished(offset / sizeof(uint32_t), sizeof(double) / sizeof(uint32_t), words);
+  memcpy(&value, words, sizeof(value));
+  return value;
+}
+
+void GravityInertiaSystemStatus::modelGravity(const float angles[], float torques[])
+{
+	for(int i = 0; i < MaxJoints; i++)
+	{
+	  torques[i] = 0;
+	}
+
+	if(Model == GryphonArm)
+	{
+	  GryphonArmConstants *consts = ((GryphonArmConstants*)ArmModelConstants);
 
 	  float FOREARM_WEIGHT = consts->FOREARM_WEIGHT;
 	  float FOREARM_CENTER_OF_GRAVITY = consts->FOREARM_CENTER_OF_GRAVITY;
@@ -41,254 +221,146 @@ void GravityInertiaSystemStatus::update()
     float BICEP_CENTER_OF_GRAVITY = consts->BICEP_CENTER_OF_GRAVITY;
     float BICEP_LENGTH = consts->BICEP_LENGTH;
 
-		j2Gravity = 0;
-		j3Gravity = (FOREARM_WEIGHT*FOREARM_CENTER_OF_GRAVITY+GRIPPER_WEIGHT*FOREARM_LENGTH)*cosLW(positionToRad(axis1Feed)+positionToRad(axis3Feed)) + GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*cosLW(positionToRad(axis1Feed)+positionToRad(axis3Feed))*cosLW(positionToRad(axis4Feed));
-		j4Gravity = GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*sinLW(positionToRad(axis5Feed))*cos(positionToRad(axis1Feed)+positionToRad(axis3Feed))*-sinLW(positionToRad(axis4Feed));
-		j5Gravity = GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*cosLW(positionToRad(axis1Feed)+positionToRad(axis3Feed)+positionToRad(axis5Feed));
-		j6Gravity = 0;
+		torques[1] = 0;
+		torques[2] = (FOREARM_WEIGHT*FOREARM_CENTER_OF_GRAVITY+GRIPPER_WEIGHT*FOREARM_LENGTH)*cosLW(angles[0]+angles[2]) + GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*cosLW(angles[0]+angles[2])*cosLW(angles[3]);
+		torques[3] = GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*sinLW(angles[4])*cos(angles[0]+angles[2])*-sinLW(angles[3]);
+		torques[4] = GRIPPER_WEIGHT*GRIPPER_CENTER_OF_GRAVITY*cosLW(angles[0]+angles[2]+angles[4]);
+		torques[5] = 0;
 		//depends on torque calculated for axis 3
-		j1Gravity = ((FOREARM_WEIGHT+GRIPPER_WEIGHT)*BICEP_LENGTH + BICEP_WEIGHT*BICEP_CENTER_OF_GRAVITY)*cosLW(positionToRad(axis1Feed))+j3Gravity;
+		torques[0] = ((FOREARM_WEIGHT+GRIPPER_WEIGHT)*BICEP_LENGTH + BICEP_WEIGHT*BICEP_CENTER_OF_GRAVITY)*cosLW(angles[0])+torques[2];
 
-		j3Gravity *= FootPoundToNewtonMeter * 1000;
-		j4Gravity *= FootPoundToNewtonMeter * 1000;
-		j5Gravity *= FootPoundToNewtonMeter * 1000;
-		j1Gravity *= FootPoundToNewtonMeter * 1000;
+		torques[2] *= FootPoundToNewtonMeter * 1000;
+		torques[3] *= FootPoundToNewtonMeter * 1000;
+		torques[4] *= FootPoundToNewtonMeter * 1000;
+		torques[0] *= FootPoundToNewtonMeter * 1000;
 	}
 	else if(Model == AtlasArm)
 	{
 	  AtlasArmConstants *consts = ((AtlasArmConstants*)ArmModelConstants);
 
-	  double th1 = consts->JOINT1ANGLE->getFeedback();
-	  double th2 = consts->JOINT2ANGLE->getFeedback();
-	  double th3 = consts->JOINT3ANGLE->getFeedback();
-    double th4 = consts->JOINT4ANGLE->getFeedback();
-    double th5 = consts->JOINT5ANGLE->getFeedback();
-    double th6 = consts->JOINT6ANGLE->getFeedback();
-
-    th1 = radians((th1 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN); //convert to radians
-    th2 = radians((th2 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN);
-    th3 = radians((th3 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN);
-    th4 = radians((th4 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN);
-    th5 = radians((th5 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN);
-    th6 = radians((th6 * 360.0) / ((float)(POS_MAX-POS_MIN)) + POS_MIN);
-
-    double AforearmCG[4][4];
-    AforearmCG[0][0] =1;
-    AforearmCG[0][1] = 0;
-    AforearmCG[0][2] = 0;
-    AforearmCG[0][3] = consts->fcgz-consts->a3;
-    AforearmCG[1][0] = 0;
-    AforearmCG[1][1] = 1;
-    AforearmCG[1][2] = 0;
-    AforearmCG[1][3] = consts->fcgx;
-    AforearmCG[2][0] = 0;
-    AforearmCG[2][1] = 0;
-    AforearmCG[2][2] = 1;
-    AforearmCG[2][3] = consts->fcgy;
-    AforearmCG[3][0] = 0;
-    AforearmCG[3][1] = 0;
-    AforearmCG[3][2] = 0;
-    AforearmCG[3][3] = 1;
-
-    double A1[4][4];
-    DHTrans((th1+consts->th1offset), consts->d1, consts->a1, consts->alpha1,A1);
-    double A2[4][4];
-    DHTrans((th2+consts->th2offset), consts->d2, consts->a2, consts->alpha2,A2);
-    double A3[4][4];
-    DHTrans((th3+consts->th3offset), consts->d3, consts->a3, consts->alpha3,A3);
-    //double T1[4][4] = A1;
-    double T2[4][4];
-    matrixMathMultiply((float*)A1, (float*)A2, 4, 4, 4, (float*)T2);
-    double T3[4][4];
-    matrixMathMultiply((float*)T2, (float*)A3, 4, 4, 4, (float*)T3);
-
-    double TforearmCG[4][4];
-    matrixMathMultiply((float*)T3, (float*)AforearmCG, 4, 4, 4, (float*)TforearmCG);
-    double o0[3];
-    o0[0] = 0;
-    o0[1] = 0;
-    o0[2] = 0;
-    double o1[3];
-    o1[0] = A1[0][3];
-    o1[1] = A1[1][3];
-    o1[2] = A1[2][3];
-    double o2[3];
-    o2[0] = T2[0][3];
-    o2[1] = T2[1][3];
-    o2[2] = T2[2][3];
-    //double o3[3];
-    //o3[0] = T3[0][3];
-    //o3[1] = T3[1][3];
-    //o3[2] = T3[2][3];
-    double z0[3];
-    z0[0] = 0;
-    z0[1] = 0;
-    z0[2] = 1;
-    double z1[3];
-    z1[0] = A1[0][2];
-    z1[1] = A1[1][2];
-    z1[2] = A1[2][2];
-    double z2[3];
-    z2[0] = T2[0][2];
-    z2[1] = T2[1][2];
-    z2[2] = T2[2][2];
-    //double z3[3];
-    //z3[0] = T3[0][2];
-    //z3[1] = T3[1][2];
-    //z3[2] = T3[2][2];
-    double oforearmCG [3];
-    oforearmCG[0] = TforearmCG[0][3];
-    oforearmCG[1] = TforearmCG[1][3];
-    oforearmCG[2] = TforearmCG[2][3];
-    double J2[6][3];
-    J2[0][0] = (z0[1] * (oforearmCG[2] - o0[2])) - (z0[2] * (oforearmCG[1] - o0[1])) ;
-    J2[0][1] = (z1[1] * (oforearmCG[2] - o1[2])) - (z1[2] * (oforearmCG[1] - o1[1])) ;
-    J2[0][2] = (z2[1] * (oforearmCG[2] - o2[2])) - (z2[2] * (oforearmCG[1] - o2[1])) ;
-    J2[1][0] = (z0[2] * (oforearmCG[0] - o0[0])) - (z0[0] * (oforearmCG[2] - o0[2])) ;
-    J2[1][1] = (z1[2] * (oforearmCG[0] - o1[0])) - (z1[0] * (oforearmCG[2] - o1[2])) ;
-    J2[1][2] = (z2[2] * (oforearmCG[0] - o2[0])) - (z2[0] * (oforearmCG[2] - o2[2])) ;
-    J2[2][0] = (z0[0] * (oforearmCG[1] - o0[1])) - (z0[1] * (oforearmCG[0] - o0[0])) ;
-    J2[2][1] = (z1[0] * (oforearmCG[1] - o1[1])) - (z1[1] * (oforearmCG[0] - o1[0])) ;
-    J2[2][2] = (z2[0] * (oforearmCG[1] - o2[1])) - (z2[1] * (oforearmCG[0] - o2[0])) ;
-    J2[3][0] =  z0[0];
-    J2[3][1] =  z1[0];
-    J2[3][2] =  z2[0];
-    J2[4][0] =  z0[1];
-    J2[4][1] =  z1[1];
-    J2[4][2] =  z2[1];
-    J2[5][0] =  z0[2];
-    J2[5][1] =  z1[2];
-    J2[5][2] =  z2[2];
-    double weightforearm = 1;
-    double Fforearm[6] = {0,0,weightforearm,0,0,0};
-    double J2Transpose[6][3];
-    double Torque2[3];
-    matrixMathTranspose((float*)J2,6,3,(float*)J2Transpose);
-    matrixMathMultiply((float*)J2Transpose, (float*)Fforearm, 3, 3, 3, (float*)Torque2);
-
-    double AbicepCG[4][4];
-    double temp = consts->bcgz;
-    AbicepCG[0][0] =1;
-    AbicepCG[0][1] = 0;
-    AbicepCG[0][2] = 0;
-    AbicepCG[0][3] = temp-consts->a2;
-    AbicepCG[1][0] = 0;
-    AbicepCG[1][1] = 1;
-    AbicepCG[1][2] = 0;
-    AbicepCG[1][3] = -consts->bcgy;
-    AbicepCG[2][0] = 0;
-    AbicepCG[2][1] = 0;
-    AbicepCG[2][2] = 1;
-    AbicepCG[2][3] = consts->bcgy;
-    AbicepCG[3][0] = 0;
-    AbicepCG[3][1] = 0;
-    AbicepCG[3][2] = 0;
-    AbicepCG[3][3] = 1;
-    double TbicepCG[4][4];
-    matrixMathMultiply((float*)T2, (float*)AbicepCG, 4, 4, 4, (float*)TbicepCG);
-    //double obicepCG [3];
-    //obicepCG[0] = TbicepCG[0][3];
-    //obicepCG[1] = TbicepCG[1][3];
-    //obicepCG[2] = TbicepCG[2][3];
-    double J1[6][2];
-    J2[0][0] = (z0[1] * (oforearmCG[2] - o0[2])) - (z0[2] * (oforearmCG[1] - o0[1])) ;
-    J2[0][1] = (z1[1] * (oforearmCG[2] - o1[2])) - (z1[2] * (oforearmCG[1] - o1[1])) ;
-    J2[1][0] = (z0[2] * (oforearmCG[0] - o0[0])) - (z0[0] * (oforearmCG[2] - o0[2])) ;
-    J2[1][1] = (z1[2] * (oforearmCG[0] - o1[0])) - (z1[0] * (oforearmCG[2] - o1[2])) ;
-    J2[2][0] = (z0[0] * (oforearmCG[1] - o0[1])) - (z0[1] * (oforearmCG[0] - o0[0])) ;
-    J2[2][1] = (z1[0] * (oforearmCG[1] - o1[1])) - (z1[1] * (oforearmCG[0] - o1[0])) ;
-    J2[3][0] =  z0[0];
-    J2[3][1] =  z1[0];
-    J2[4][0] =  z0[1];
-    J2[4][1] =  z1[1];
-    J2[5][0] =  z0[2];
-    J2[5][1] =  z1[2];
-    double weightbicep = 9.7;
-    double Fbicep[6] = {0,0,weightbicep,0,0,0};
-    double J1Transpose[6][3];
-    double Torque1[2];
-    matrixMathTranspose((float*)J1,6,2,(float*)J1Transpose);
-    matrixMathMultiply((float*)J1Transpose, (float*)Fbicep, 3, 3, 3, (float*)Torque1);
-
-    j1Gravity = Torque1[0] + Torque2[0];
-    j2Gravity = Torque1[1] + Torque2[1];
-    j3Gravity = Torque2[2];
-    j4Gravity = 0;
-    j5Gravity = 0;
-    j6Gravity = 0;
-
-    j1Gravity *= FootPoundToNewtonMeter * 1000;
-    j2Gravity *= FootPoundToNewtonMeter * 1000;
-    j3Gravity *= FootPoundToNewtonMeter * 1000;
-    j4Gravity *= FootPoundToNewtonMeter * 1000;
-    j5Gravity *= FootPoundToNewtonMeter * 1000;
-    j6Gravity *= FootPoundToNewtonMeter * 1000;
+	  //weights of the forearm and bicep at their centers of gravity
+	  const GravityReal weightForearm = 1;
+	  const GravityReal weightBicep = 9.7;
+
+	  GravityReal th1 = angles[0];
+	  GravityReal th2 = angles[1];
+	  GravityReal th3 = angles[2];
+
+	  //base to each of the first three joint frames
+	  Mat4<GravityReal> T1 = Mat4<GravityReal>::fromDH(th1 + consts->th1offset, consts->d1, consts->a1, consts->alpha1);
+	  Mat4<GravityReal> T2 = T1 * Mat4<GravityReal>::fromDH(th2 + consts->th2offset, consts->d2, consts->a2, consts->alpha2);
+	  Mat4<GravityReal> T3 = T2 * Mat4<GravityReal>::fromDH(th3 + consts->th3offset, consts->d3, consts->a3, consts->alpha3);
+
+	  //centers of gravity, offset from the ends of the links they're on. The bicep's second component is its x offset,
+	  //negated as the original update had it; that update read bcgy there by mistake
+	  Vec3<GravityReal> forearmCG = T3.transformPoint(Vec3<GravityReal>(consts->fcgz - consts->a3, consts->fcgx, consts->fcgy));
+	  Vec3<GravityReal> bicepCG = T2.transformPoint(Vec3<GravityReal>(consts->bcgz - consts->a2, -consts->bcgx, consts->bcgy));
+
+	  //joint axises and origins; joint 1 turns about the base's own z axis
+	  Vec3<GravityReal> z0(0, 0, 1), o0;
+	  Vec3<GravityReal> z1 = T1.zAxis(), o1 = T1.origin();
+	  Vec3<GravityReal> z2 = T2.zAxis(), o2 = T2.origin();
+
+	  //torque = J^T * F, one joint at a time. The forearm hangs off of all three joints, the bicep only the first two
+	  Vec3<GravityReal> forearmForce(0, 0, weightForearm);
+	  Vec3<GravityReal> bicepForce(0, 0, weightBicep);
+
+	  torques[0] = jointTorqueFromForce(z0, o0, forearmCG, forearmForce) + jointTorqueFromForce(z0, o0, bicepCG, bicepForce);
+	  torques[1] = jointTorqueFromForce(z1, o1, forearmCG, forearmForce) + jointTorqueFromForce(z1, o1, bicepCG, bicepForce);
+	  torques[2] = jointTorqueFromForce(z2, o2, forearmCG, forearmForce);
+
+	  torques[0] *= FootPoundToNewtonMeter * 1000;
+	  torques[1] *= FootPoundToNewtonMeter * 1000;
+	  torques[2] *= FootPoundToNewtonMeter * 1000;
 	}
+	else if(Model == ChainArm)
+	{
+	  ((ArmChainModel*)ArmModelConstants)->gravityTorques(angles, torques);
+	}
+}
+
+void GravityInertiaSystemStatus::gravityModel(void* status, const float angles[], float torques[])
+{
+  ((GravityInertiaSystemStatus*)status)->modelGravity(angles, torques);
+}
+
+void GravityInertiaSystemStatus::setGravityTable(GravityLookupTable* table)
+{
+  gravityTable = table;
 }
 
 double GravityInertiaSystemStatus::getGravity(uint32_t id)
 {
-    // Return the appropriate value based on the axis.
     // id 1 corresponds to axis 1, id 2 corresponds to axis 2, etc.
-    switch (id)
+    if(id < 1 || id > MaxJoints)
     {
-    case 1:
-        return j1Gravity;
-    case 2:
-        return j2Gravity;
-    case 3:
-        return j3Gravity;
-    case 4:
-        return j4Gravity;
-    case 5:
-        return j5Gravity;
-    case 6:
-        return j6Gravity;
-    default:
-        return 0.0;
+      return 0.0;
     }
+
+    return readPublishedDouble(offsetof(GravityInertiaSample, gravity) + (id - 1) * sizeof(double));
 }
 
 double GravityInertiaSystemStatus::getInertia(uint32_t id)
 {
-    // Return the appropriate value based on the axis.
     // id 1 corresponds to axis 1, id 2 corresponds to axis 2, etc.
-    switch (id)
+    if(id < 1 || id > MaxJoints)
     {
-    case 1:
-        return j1Inertia;
-    case 2:
-        return j2Inertia;
-    case 3:
-        return j3Inertia;
-    case 4:
-        return j4Inertia;
-    case 5:
-        return j5Inertia;
-    case 6:
-        return j6Inertia;
-    default:
-        return 0.0;
+      return 0.0;
     }
+
+    return readPublishedDouble(offsetof(GravityInertiaSample, inertia) + (id - 1) * sizeof(double));
 }
 
-void GravityInertiaSystemStatus::DHTrans(float th, float d, float a, float alpha, double A1[4][4]){  //Calculate the Homogenous transform from the DH convention
-   A1[0][0] = cos(th);
-   A1[0][1] =  -sin(th)*cos(alpha);
-   A1[0][2] = sin(th)*sin(alpha);
-   A1[0][3] = a*cos(th);
-   A1[1][0] =sin(th) ;
-   A1[1][1] = cos(th)*cos(alpha);
-   A1[1][2] = -cos(th)*sin(alpha);
-   A1[1][3] = a*sin(th);
-   A1[2][0] = 0;
-   A1[2][1] = sin(alpha);
-   A1[2][2] = cos(alpha);
-   A1[2][3] = d;
-   A1[3][0] = 0;
-   A1[3][1] = 0;
-   A1[3][2] = 0;
-   A1[3][3] = 1;
+double GravityInertiaSystemStatus::getTorque(uint32_t id)
+{
+    // id 1 corresponds to axis 1, id 2 corresponds to axis 2, etc.
+    if(id < 1 || id > MaxJoints)
+    {
+      return 0.0;
+    }
+
+    return readPublishedDouble(offsetof(GravityInertiaSample, torque) + (id - 1) * sizeof(double));
+}
+
+void GravityInertiaSystemStatus::setJointMotion(uint32_t id, float speed, float acceleration)
+{
+  if(id < 1 || id > MaxJoints)
+  {
+    return;
+  }
+
+  jointSpeeds[id - 1].store(radians(speed), std::memory_order_relaxed);
+  jointAccelerations[id - 1].store(radians(acceleration), std::memory_order_relaxed);
+}
+
+bool GravityInertiaSystemStatus::getSample(GravityInertiaSample& sample)
+{
+  uint32_t words[SampleWords];
+
+  readPublished(0, SampleWords, words);
+  memcpy(&sample, words, sizeof(sample));
+
+  return sample.sequence != 0;
+}
+
+ArmDynamics* GravityInertiaSystemStatus::getDynamics()
+{
+  if(Model != ChainArm)
+  {
+    return 0;
+  }
+
+  return &dynamics;
+}
+
+ArmKinematicsCache* GravityInertiaSystemStatus::getKinematics()
+{
+  if(Model != ChainArm)
+  {
+    return 0;
+  }
+
+  return &kinematics;
 }
 
 float GravityInertiaSystemStatus::positionToRad(uint32_t p_units)
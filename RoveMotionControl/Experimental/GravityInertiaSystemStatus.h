@@ -7,16 +7,24 @@
 #ifndef ROVEJOINTCONTROL_ARMBOARDSOFTWARE_ROVEJOINTCONTROL_SYSTEMSTATUS_H_
 #define ROVEJOINTCONTROL_ARMBOARDSOFTWARE_ROVEJOINTCONTROL_SYSTEMSTATUS_H_
 
+#include <atomic>
 #include "Roveboard.h"
 #include "../AbstractFramework.h"
 #include "../RoveMotionUtilities.h"
+#include "ArmChainModel.h"
+#include "ArmDynamics.h"
+#include "ArmKinematicsCache.h"
+#include "GravityLookupTable.h"
 
 //enum representing the different models of arms that are capable of being computed in this class.
 typedef enum ArmModel
 {
   //the arm for mrdt's 2017 rover called Gryphon
   GryphonArm,
-  AtlasArm
+  AtlasArm,
+
+  //any arm described by an ArmChainModel
+  ChainArm
 } ArmModel;
 
 typedef struct GryphonArmConstants
@@ -99,6 +107,31 @@ typedef struct AtlasArmConstants
 
 } AtlasArmConstants;
 
+//one published set of GravityInertiaSystemStatus results. Index 0 is axis 1
+typedef struct GravityInertiaSample
+{
+  static const uint8_t MaxJoints = ArmChainModel::MaxLinks;
+
+  //the torque each joint needs to hold the arm up against gravity, in milli newton-meters
+  double gravity[MaxJoints];
+
+  //the inertia each joint sees, in kg*m^2. Only worked out for chain arms; 0 for the other models
+  double inertia[MaxJoints];
+
+  //gravity plus the torque it takes to move the arm the way setJointMotion says it's moving, in milli newton-meters.
+  //Only chain arms work the motion out, so it's the same as gravity for the other models
+  double torque[MaxJoints];
+
+  //the joint angles the results were worked out from, in radians. 0 for joints the arm model doesn't read
+  float jointAngles[MaxJoints];
+
+  //micros() when the joint angles were read
+  uint32_t timestamp_us;
+
+  //counts up by one with every update, starting at 1. 0 means nothing's been published yet
+  uint32_t sequence;
+} GravityInertiaSample;
+
 //this class is fairly unique, it's designed to be able to compute how much torque the robotic arm is under at any given moment due to gravity
 //and inertia.
 //It does this by taking in mechanical constants about the arm and tracks the different feedback device's needed to figure out where the arm is
@@ -106,26 +139,57 @@ typedef struct AtlasArmConstants
 //Note that this class needs its own separate call to compute its math separate from the rest of the RJC; it has an update() function that should
 //be called periodically, this will signal to the class that it needs to update its results for how much torque the arm is currently under.
 //The rest of the RJC that tries to compensate for gravity or inertia will call this class everytime they are asked to update their movements.
+//
+//Since update() runs apart from the control loops that read its results, it works into a buffer of its own and only
+//then publishes it whole, so a reader always gets every joint's values from the same update, along with the joint
+//angles they were worked from and when. Publishing copies the results into the older of two published buffers,
+//marking that buffer's sequence odd while it does, then points readers at it. Every access to the published buffers
+//is a C++11 atomic, with acquire and release ordering on the sequences, so nothing races. Readers never wait on the
+//update: one that interrupts update() reads the newer buffer, which update() isn't touching, and one running
+//alongside it on another thread only rereads if two whole updates got published while it was copying.
 //See the readme.md for more info.
 class GravityInertiaSystemStatus
 {
   private:
 
-    // Member variables.
-    double j1Gravity;
-    double j1Inertia;
-    double j2Gravity;
-    double j2Inertia;
-    double j3Gravity;
-    double j3Inertia;
-    double j4Gravity;
-    double j4Inertia;
-    double j5Gravity;
-    double j5Inertia;
-    double j6Gravity;
-    double j6Inertia;
-
-    void DHTrans(float th, float d, float a, float alpha, double A1[4][4]);
+    static const uint8_t MaxJoints = GravityInertiaSample::MaxJoints;
+
+    static const uint8_t SampleWords = sizeof(GravityInertiaSample) / sizeof(uint32_t);
+
+    //a published sample, as the words it's copied in and out in. sequence is odd while it's being written
+    struct PublishedSample
+    {
+      std::atomic<uint32_t> sequence;
+      std::atomic<uint32_t> words[SampleWords];
+    };
+
+    //published[publishCount % 2] is the newest one. next is where update() works, which only it touches
+    PublishedSample published[2];
+    std::atomic<uint32_t> publishCount;
+    GravityInertiaSample next;
+
+    //copies next into the older published buffer and makes it the newest
+    void publish();
+
+    //copies count words, starting that many words into a sample, out of the newest published sample
+    void readPublished(uint8_t firstWord, uint8_t count, uint32_t words[]);
+
+    //reads one of the newest published sample's doubles, given where it is in a sample
+    double readPublishedDouble(size_t offset);
+
+    //when set and ready, gravity comes from the table instead of the arm model's math
+    GravityLookupTable* gravityTable;
+
+    //full dynamics and cached kinematics for chain arms; their chain is 0 for the other models
+    ArmDynamics dynamics;
+    ArmKinematicsCache kinematics;
+
+    //chain arms' inertias, only worked out again when the kinematics change
+    float chainInertias[MaxJoints];
+
+    //how each joint is being moved, as last given to setJointMotion, in radians/s and radians/s^2
+    std::atomic<float> jointSpeeds[MaxJoints];
+    std::atomic<float> jointAccelerations[MaxJoints];
 
 protected:
 
@@ -148,6 +212,9 @@ public:
     // Derived From:    Nothing
     GravityInertiaSystemStatus(ArmModel model, void* armModelConstants);
 
+    // Description:     Constructor for an arm described by an ArmChainModel. Axis ids count up from 1 at the chain's base.
+    GravityInertiaSystemStatus(ArmChainModel* chain);
+
     ~GravityInertiaSystemStatus();
 
     // Description: Calculates the gravity and inertia values of all axises.
@@ -163,8 +230,55 @@ public:
 
     // Description: Returns the calculated inertia of the desired axis.
     // Arguments:   id - the ID of the axis requesting info.
-    // Returns:     the inertia of the given axis.
+    // Returns:     the inertia of the given axis. For chain arms, the inertia the axis sees with the rest of the arm
+    //              held still, in kg*m^2.
     double getInertia(uint32_t id);
+
+    // Description: Returns the torque the desired axis needs to hold the arm up and move it the way setJointMotion
+    //              says it's moving.
+    // Arguments:   id - the ID of the axis requesting info.
+    // Returns:     the torque, in milli newton-meters. The same as getGravity for arms other than chain arms.
+    double getTorque(uint32_t id);
+
+    // Description: Tells update() how an axis is being moved, ex by the trajectory it's following, so the torque it
+    //              publishes covers accelerating the arm and the links swinging each other around as well as gravity.
+    //              Stays in effect until changed; set both to 0 when the axis stops. Safe to call from the control
+    //              loops while update() runs elsewhere, though update() can pick up one axis's new motion a run before
+    //              another's.
+    // Arguments:   id - the ID of the axis
+    //              speed - in degrees/s
+    //              acceleration - in degrees/s^2
+    void setJointMotion(uint32_t id, float speed, float acceleration);
+
+    // Description: Copies out the last published results of every axis, all from the same update.
+    // Arguments:   sample - returned
+    // Returns:     false if update() hasn't published anything yet, in which case sample is all zeroes
+    bool getSample(GravityInertiaSample& sample);
+
+    // Description: Works out the gravity torques from the arm model's math for the given joint angles, without reading
+    //              any sensors. The angles are in radians, index 0 being axis 1, and only the joints the model uses
+    //              need to be filled in. The torques are in milli newton-meters. Doesn't touch anything update() uses,
+    //              so it's safe to run alongside it, ex generating a GravityLookupTable while update() keeps running.
+    void modelGravity(const float angles[], float torques[]);
+
+    // Description: modelGravity in the shape GravityLookupTable::generate wants, with the status passed as the context.
+    //              ex: table.generate(GravityInertiaSystemStatus::gravityModel, &status, 6, 0);
+    static void gravityModel(void* status, const float angles[], float torques[]);
+
+    // Description: Has update() look gravity up in a precomputed table rather than working it out each time, which
+    //              makes it cheap enough to run at the control loops' rate. Pass 0 to go back to the model's math.
+    //              Chain arms still work their inertias out from the model either way.
+    void setGravityTable(GravityLookupTable* table);
+
+    // Description: Returns the dynamics engine for chain arms, for anything that wants the full torques at a given
+    //              speed and acceleration rather than just the gravity and inertia that update() keeps.
+    // Returns:     the dynamics, or 0 if the arm isn't a chain arm
+    ArmDynamics* getDynamics();
+
+    // Description: Returns the kinematics cache update() uses for chain arms, ex to set how far the joints have to
+    //              move before the kinematics get redone. Only use it from the same thread as update().
+    // Returns:     the cache, or 0 if the arm isn't a chain arm
+    ArmKinematicsCache* getKinematics();
 };
 
 #endif /* ROVEJOINTCONTROL_ARMBOARDSOFTWARE_ROVEJOINTCONTROL_SYSTEMSTATUS_H_ */
@@ -0,0 +1,241 @@
+#include "GravityLookupTable.h"
+
+static const float TwoPi = 6.2831853;
+
+GravityLookupTable::GravityLookupTable(float* tableStorage, uint32_t tableStorageLength)
+  : dimensionCount(0), storage(tableStorage), storageLength(tableStorageLength), table(0), outputCount(0), measuredError(0)
+{
+}
+
+bool GravityLookupTable::addDimension(uint8_t jointIndex, float minAngle, float maxAngle, uint16_t points)
+{
+  if(table || dimensionCount >= MaxDimensions || jointIndex >= MaxJoints || points < 2 || !(maxAngle > minAngle) || maxAngle - minAngle > TwoPi + 0.001)
+  {
+    return false;
+  }
+
+  //the new dimension changes fastest, so everything before it now skips over all of its points
+  for(int i = 0; i < dimensionCount; i++)
+  {
+    dimensions[i].stride *= points;
+  }
+
+  Dimension& dimension = dimensions[dimensionCount];
+  dimension.joint = jointIndex;
+  dimension.minAngle = minAngle;
+  dimension.points = points;
+  dimension.step = (maxAngle - minAngle) / (points - 1);
+  dimension.inverseStep = 1 / dimension.step;
+  dimension.stride = 1;
+  dimensionCount++;
+
+  return true;
+}
+
+uint32_t GravityLookupTable::nodeCount()
+{
+  uint32_t count = 1;
+
+  for(int i = 0; i < dimensionCount; i++)
+  {
+    count *= dimensions[i].points;
+  }
+
+  return count;
+}
+
+uint32_t GravityLookupTable::getTableLength(uint8_t outputs)
+{
+  return nodeCount() * outputs;
+}
+
+bool GravityLookupTable::generate(GravityModelFunction model, void* context, uint8_t outputs, const float heldAngles[])
+{
+  float angles[MaxJoints];
+  float torques[MaxJoints];
+  float interpolated[MaxJoints];
+  uint32_t nodes = nodeCount();
+
+  if(dimensionCount == 0 || !storage || outputs == 0 || outputs > MaxJoints || nodes * outputs > storageLength)
+  {
+    return false;
+  }
+
+  for(int j = 0; j < MaxJoints; j++)
+  {
+    angles[j] = heldAngles ? heldAngles[j] : 0;
+  }
+
+  //every grid point; the index of each dimension's point is the node's digit in that dimension's stride
+  for(uint32_t node = 0; node < nodes; node++)
+  {
+    for(int i = 0; i < dimensionCount; i++)
+    {
+      const Dimension& dimension = dimensions[i];
+      uint32_t point = (node / dimension.stride) % dimension.points;
+      angles[dimension.joint] = dimension.minAngle + point * dimension.step;
+    }
+
+    model(context, angles, torques);
+
+    for(int k = 0; k < outputs; k++)
+    {
+      storage[node * outputs + k] = torques[k];
+    }
+  }
+
+  table = storage;
+  outputCount = outputs;
+
+  //interpolation is furthest off in the middle of the cells, so check the middle of every one
+  uint32_t cells = 1;
+  for(int i = 0; i < dimensionCount; i++)
+  {
+    cells *= dimensions[i].points - 1;
+  }
+
+  measuredError = 0;
+  for(uint32_t cell = 0; cell < cells; cell++)
+  {
+    uint32_t remaining = cell;
+    for(int i = dimensionCount - 1; i >= 0; i--)
+    {
+      const Dimension& dimension = dimensions[i];
+      uint32_t point = remaining % (dimension.points - 1);
+      remaining /= dimension.points - 1;
+      angles[dimension.joint] = dimension.minAngle + (point + 0.5) * dimension.step;
+    }
+
+    model(context, angles, torques);
+    lookup(angles, interpolated);
+
+    for(int k = 0; k < outputs; k++)
+    {
+      float error = interpolated[k] - torques[k];
+      if(error < 0)
+      {
+        error = -error;
+      }
+      if(error > measuredError)
+      {
+        measuredError = error;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool GravityLookupTable::useTable(const float* prebuiltTable, uint32_t length, uint8_t outputs)
+{
+  if(dimensionCount == 0 || !prebuiltTable || outputs == 0 || outputs > MaxJoints || length != nodeCount() * outputs)
+  {
+    return false;
+  }
+
+  table = prebuiltTable;
+  outputCount = outputs;
+  measuredError = 0;
+
+  return true;
+}
+
+bool GravityLookupTable::isReady()
+{
+  return table != 0;
+}
+
+void GravityLookupTable::locate(const Dimension& dimension, float angle, uint32_t& index, float& fraction)
+{
+  float range = dimension.step * (dimension.points - 1);
+  float offset = angle - dimension.minAngle;
+
+  while(offset < 0)
+  {
+    offset += TwoPi;
+  }
+  while(offset >= TwoPi)
+  {
+    offset -= TwoPi;
+  }
+
+  //outside of the range, go to whichever end is closer around the circle
+  if(offset > range)
+  {
+    offset = (offset - range < TwoPi - offset) ? range : 0;
+  }
+
+  float position = offset * dimension.inverseStep;
+  index = position;
+  if(index >= (uint32_t)(dimension.points - 1))
+  {
+    index = dimension.points - 2;
+  }
+  fraction = position - index;
+}
+
+void GravityLookupTable::lookup(const float angles[], float torques[])
+{
+  if(!table)
+  {
+    for(int k = 0; k < MaxJoints; k++)
+    {
+      torques[k] = 0;
+    }
+    return;
+  }
+
+  //each corner of the cell the angles are in, and its weight; how close the angles are to it along every dimension.
+  //Built up one dimension at a time, each one doubling the corners
+  const uint8_t MaxCorners = 1 << MaxDimensions;
+  float weights[MaxCorners];
+  uint32_t nodes[MaxCorners];
+  uint8_t corners = 1;
+
+  weights[0] = 1;
+  nodes[0] = 0;
+
+  for(int i = 0; i < dimensionCount; i++)
+  {
+    const Dimension& dimension = dimensions[i];
+    uint32_t index;
+    float fraction;
+
+    locate(dimension, angles[dimension.joint], index, fraction);
+
+    for(int c = 0; c < corners; c++)
+    {
+      nodes[c] += index * dimension.stride;
+      nodes[c + corners] = nodes[c] + dimension.stride;
+      weights[c + corners] = weights[c] * fraction;
+      weights[c] *= 1 - fraction;
+    }
+    corners *= 2;
+  }
+
+  for(int k = 0; k < outputCount; k++)
+  {
+    float sum = 0;
+
+    for(int c = 0; c < corners; c++)
+    {
+      sum += weights[c] * table[nodes[c] * outputCount + k];
+    }
+    torques[k] = sum;
+  }
+
+  for(int k = outputCount; k < MaxJoints; k++)
+  {
+    torques[k] = 0;
+  }
+}
+
+float GravityLookupTable::getMeasuredError()
+{
+  return measuredError;
+}
+
+uint8_t GravityLookupTable::getOutputCount()
+{
+  return outputCount;
+}
@@ -0,0 +1,109 @@
+#ifndef ROVEJOINTCONTROL_GRAVITYLOOKUPTABLE_H_
+#define ROVEJOINTCONTROL_GRAVITYLOOKUPTABLE_H_
+
+#include <stdint.h>
+
+//the arm gravity math GravityLookupTable samples: fills torques, GravityLookupTable::MaxJoints of them, for the given
+//joint angles in radians. context is whatever was given to generate
+typedef void (*GravityModelFunction)(void* context, const float angles[], float torques[]);
+
+//A precomputed table of an arm's gravity torques, over a grid of the few joint angles they actually depend on, so
+//that looking them up while running is a handful of multiply-adds instead of the arm model's trig.
+//
+//Each dimension of the grid is one joint, spanning an angle range with evenly spaced points. The table is generated
+//once at boot by sampling the arm model at every point of the grid, or generated offline (by running generate on a
+//computer and dumping the storage) and handed over with useTable so it can live in flash. Lookups interpolate
+//multilinearly between the corners of the grid cell the angles fall in.
+//
+//Error bound: multilinear interpolation is off by at most (1/8) * sum over dimensions of (step^2 * the largest second
+//derivative of the torque along that joint). Gravity torques are sums of sines of the joint angles, whose second
+//derivative is at most the torque's amplitude, so each dimension adds at most amplitude * step^2 / 8; ex 1.5% of
+//the amplitude for 10 points over a half turn. generate measures the actual error at every cell's center, where it's
+//worst, and getMeasuredError returns it.
+//
+//Memory: the table is points(1) * points(2) * ... * outputs floats. The class doesn't allocate it; it's handed the
+//storage, see getTableLength.
+//see the readme.md for more info
+class GravityLookupTable
+{
+  public:
+    static const uint8_t MaxDimensions = 4;
+    static const uint8_t MaxJoints = 8;
+
+  private:
+    struct Dimension
+    {
+      uint8_t joint;
+      float minAngle;
+      float step;
+      float inverseStep;
+      uint16_t points;
+
+      //how far apart in the table, in nodes, neighbouring points of this dimension are
+      uint32_t stride;
+    };
+
+    Dimension dimensions[MaxDimensions];
+    uint8_t dimensionCount;
+
+    float* storage;
+    uint32_t storageLength;
+
+    //the table lookups read from; either the storage once generated, or a prebuilt one. 0 if not ready
+    const float* table;
+    uint8_t outputCount;
+
+    float measuredError;
+
+    uint32_t nodeCount();
+
+    //finds which cell of a dimension an angle falls in and how far across it, clamping to the ends of the range
+    void locate(const Dimension& dimension, float angle, uint32_t& index, float& fraction);
+
+  public:
+
+    //overview: constructs an empty table.
+    //inputs:   tableStorage: where generate puts the table. Can be 0 if useTable will be used instead
+    //          tableStorageLength: how many floats tableStorage holds
+    GravityLookupTable(float* tableStorage, uint32_t tableStorageLength);
+
+    //overview: adds a dimension to the grid. Dimensions have to be added before the table is generated, and the
+    //          first one added changes slowest in the table's layout.
+    //inputs:   jointIndex: which joint angle the dimension covers, 0 being axis 1
+    //          minAngle, maxAngle: the range covered, in radians. Angles are wrapped into
+    //                              [minAngle, minAngle + 2pi) and then clamped to the range
+    //          points: how many grid points across the range, at least 2
+    //returns:  false if the grid already has MaxDimensions, the table's already made, or the inputs are invalid
+    bool addDimension(uint8_t jointIndex, float minAngle, float maxAngle, uint16_t points);
+
+    //returns how many floats the table takes up with the grid as it is, for the given amount of outputs
+    uint32_t getTableLength(uint8_t outputs);
+
+    //overview: fills the storage by sampling the model at every point of the grid, and measures the error at the
+    //          center of every cell.
+    //inputs:   model, context: the arm math to sample, see GravityModelFunction
+    //          outputs: how many torques to keep per point, starting from the model's first; at most MaxJoints
+    //          heldAngles: the angles for the joints that aren't in the grid, MaxJoints of them, or 0 for all 0
+    //returns:  false if there's no grid, the storage is too small, or outputs is out of range
+    bool generate(GravityModelFunction model, void* context, uint8_t outputs, const float heldAngles[]);
+
+    //overview: uses a table that's already been generated, ex one dumped from generate on a computer and compiled
+    //          into flash. The grid has to be set up the same as when it was generated.
+    //returns:  false if the length doesn't match the grid, or outputs is out of range
+    bool useTable(const float* prebuiltTable, uint32_t length, uint8_t outputs);
+
+    //returns whether the table's been generated or given, and so lookups work
+    bool isReady();
+
+    //overview: interpolates the torques for the given joint angles.
+    //inputs:   angles: joint angles in radians, index 0 being axis 1. Only the grid's joints are read
+    //          torques: returned, one per output. Outputs past the table's are set to 0, up to MaxJoints
+    void lookup(const float angles[], float torques[]);
+
+    //returns the largest error generate measured between the table and the model, or 0 for a prebuilt table
+    float getMeasuredError();
+
+    uint8_t getOutputCount();
+};
+
+#endif
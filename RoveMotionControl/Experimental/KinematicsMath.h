@@ -0,0 +1,153 @@
+#ifndef ROVEJOINTCONTROL_KINEMATICSMATH_H_
+#define ROVEJOINTCONTROL_KINEMATICSMATH_H_
+
+#include <math.h>
+
+//Small fixed size vector and transform types for arm kinematics. Everything is header only and written out by hand
+//rather than looped, so the compiler can inline and schedule it; there's no size checking to do at runtime since
+//the sizes are the types. The number type is a template parameter, so the arm math can pick float, which the
+//boards' fpus do in hardware, or double where the precision's needed and the speed isn't.
+
+//a 3d vector, for positions, joint axises, forces, torques etc
+template<typename T>
+struct Vec3
+{
+  T x, y, z;
+
+  constexpr Vec3() : x(0), y(0), z(0) {}
+  constexpr Vec3(T inX, T inY, T inZ) : x(inX), y(inY), z(inZ) {}
+
+  constexpr Vec3 operator+(const Vec3& other) const { return Vec3(x + other.x, y + other.y, z + other.z); }
+  constexpr Vec3 operator-(const Vec3& other) const { return Vec3(x - other.x, y - other.y, z - other.z); }
+  constexpr Vec3 operator-() const { return Vec3(-x, -y, -z); }
+  constexpr Vec3 operator*(T scale) const { return Vec3(x * scale, y * scale, z * scale); }
+
+  Vec3& operator+=(const Vec3& other) { x += other.x; y += other.y; z += other.z; return *this; }
+  Vec3& operator-=(const Vec3& other) { x -= other.x; y -= other.y; z -= other.z; return *this; }
+};
+
+template<typename T>
+constexpr T dot(const Vec3<T>& a, const Vec3<T>& b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<typename T>
+constexpr Vec3<T> cross(const Vec3<T>& a, const Vec3<T>& b)
+{
+  return Vec3<T>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+//a homogeneous rigid transform; the 4x4 matrix [R p; 0 0 0 1]. The bottom row is always the same, so it isn't
+//stored or multiplied through, which makes composing two of these 36 multiplies instead of a general 4x4's 64.
+template<typename T>
+struct Mat4
+{
+  //rotation, row major, and translation
+  T r[3][3];
+  Vec3<T> p;
+
+  //the identity transform
+  constexpr Mat4() : r{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}, p() {}
+
+  //a pure translation
+  static constexpr Mat4 translation(T x, T y, T z) { return Mat4(1, 0, 0, 0, 1, 0, 0, 0, 1, Vec3<T>(x, y, z)); }
+
+  //the transform of one link of a Denavit-Hartenberg chain; rotate theta about z, move d along z, move a along the
+  //new x, rotate alpha about the new x
+  static Mat4 fromDH(T theta, T d, T a, T alpha)
+  {
+    return fromDH(cos(theta), sin(theta), d, a, cos(alpha), sin(alpha));
+  }
+
+  //fromDH with the sines and cosines already worked out, for when they're cached
+  static Mat4 fromDH(T cosTheta, T sinTheta, T d, T a, T cosAlpha, T sinAlpha)
+  {
+    T ct = cosTheta, st = sinTheta;
+    T ca = cosAlpha, sa = sinAlpha;
+
+    return Mat4(ct, -st * ca,  st * sa,
+                st,  ct * ca, -ct * sa,
+                0,   sa,       ca,
+                Vec3<T>(a * ct, a * st, d));
+  }
+
+  //this transform followed by other, IE this * other
+  Mat4 operator*(const Mat4& o) const
+  {
+    return Mat4(r[0][0] * o.r[0][0] + r[0][1] * o.r[1][0] + r[0][2] * o.r[2][0],
+                r[0][0] * o.r[0][1] + r[0][1] * o.r[1][1] + r[0][2] * o.r[2][1],
+                r[0][0] * o.r[0][2] + r[0][1] * o.r[1][2] + r[0][2] * o.r[2][2],
+                r[1][0] * o.r[0][0] + r[1][1] * o.r[1][0] + r[1][2] * o.r[2][0],
+                r[1][0] * o.r[0][1] + r[1][1] * o.r[1][1] + r[1][2] * o.r[2][1],
+                r[1][0] * o.r[0][2] + r[1][1] * o.r[1][2] + r[1][2] * o.r[2][2],
+                r[2][0] * o.r[0][0] + r[2][1] * o.r[1][0] + r[2][2] * o.r[2][0],
+                r[2][0] * o.r[0][1] + r[2][1] * o.r[1][1] + r[2][2] * o.r[2][1],
+                r[2][0] * o.r[0][2] + r[2][1] * o.r[1][2] + r[2][2] * o.r[2][2],
+                transformPoint(o.p));
+  }
+
+  //a point in this transform's frame, in the base frame
+  Vec3<T> transformPoint(const Vec3<T>& v) const
+  {
+    return rotate(v) + p;
+  }
+
+  //a direction in this transform's frame, in the base frame
+  Vec3<T> rotate(const Vec3<T>& v) const
+  {
+    return Vec3<T>(r[0][0] * v.x + r[0][1] * v.y + r[0][2] * v.z,
+                   r[1][0] * v.x + r[1][1] * v.y + r[1][2] * v.z,
+                   r[2][0] * v.x + r[2][1] * v.y + r[2][2] * v.z);
+  }
+
+  //a direction in the base frame, in this transform's frame
+  Vec3<T> inverseRotate(const Vec3<T>& v) const
+  {
+    return Vec3<T>(r[0][0] * v.x + r[1][0] * v.y + r[2][0] * v.z,
+                   r[0][1] * v.x + r[1][1] * v.y + r[2][1] * v.z,
+                   r[0][2] * v.x + r[1][2] * v.y + r[2][2] * v.z);
+  }
+
+  //the inverse transform. Rigid, so the rotation's inverse is just its transpose
+  Mat4 inverse() const
+  {
+    Mat4 inv(r[0][0], r[1][0], r[2][0],
+             r[0][1], r[1][1], r[2][1],
+             r[0][2], r[1][2], r[2][2],
+             Vec3<T>());
+    inv.p = -inv.rotate(p);
+    return inv;
+  }
+
+  //the frame's axises and origin in the base frame; z is the axis a DH joint turns about
+  constexpr Vec3<T> xAxis() const { return Vec3<T>(r[0][0], r[1][0], r[2][0]); }
+  constexpr Vec3<T> yAxis() const { return Vec3<T>(r[0][1], r[1][1], r[2][1]); }
+  constexpr Vec3<T> zAxis() const { return Vec3<T>(r[0][2], r[1][2], r[2][2]); }
+  constexpr Vec3<T> origin() const { return p; }
+
+  constexpr Mat4(T r00, T r01, T r02, T r10, T r11, T r12, T r20, T r21, T r22, Vec3<T> trans)
+    : r{{r00, r01, r02}, {r10, r11, r12}, {r20, r21, r22}}, p(trans) {}
+};
+
+//overview: one row of J^T * F for a revolute joint; the torque about the joint's axis caused by a force and moment
+//          acting at a point. Looping it over the joints a point depends on gives the whole Jacobian-transpose product
+//          without ever building the Jacobian.
+//inputs:   jointAxis, jointOrigin: the joint's z axis and origin in the base frame
+//          point: where the force acts, in the base frame
+//          force, moment: the wrench acting at the point, in the base frame
+template<typename T>
+inline T jointTorqueFromWrench(const Vec3<T>& jointAxis, const Vec3<T>& jointOrigin, const Vec3<T>& point, const Vec3<T>& force, const Vec3<T>& moment)
+{
+  //linear column of the jacobian is z x (p - o), angular column is z
+  return dot(cross(jointAxis, point - jointOrigin), force) + dot(jointAxis, moment);
+}
+
+//same as above, for a pure force
+template<typename T>
+inline T jointTorqueFromForce(const Vec3<T>& jointAxis, const Vec3<T>& jointOrigin, const Vec3<T>& point, const Vec3<T>& force)
+{
+  return dot(cross(jointAxis, point - jointOrigin), force);
+}
+
+#endif
@@ -9,6 +9,8 @@
 #define ROVEJOINTCONTROL_PIVCONVERTER_H_
 
 #include "../AbstractFramework.h"
+#include "../RoveFixedPoint.h"
+#include "../IOConverters/PositionRoutePlanner.h"
 
 //represents an PIV loop algorithm, IE two cascaded PI loops with the outer loop being a position PI loop that generates a desired velocity
 //for the inner velocity PI loop to use, which converts velocity to power percent. The inner loop will run some x amount of loops faster than
@@ -16,6 +18,8 @@
 //see the readme.MD for more info.
 class PIVConverter : public IOConverter
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
 
     //This flag tracks whether or not the feedback device given to the algorithm is a proper fit for the algorithm
@@ -25,7 +29,7 @@ class PIVConverter : public IOConverter
     FeedbackDevice * feedbackDevVelocity;
     FeedbackDevice * feedbackDevPosition;
 
-    float deg_deadBand;//when the axis is within this many degrees of its destination, it stops
+    MotionReal deg_deadBand;//when the axis is within this many degrees of its destination, it stops
 
     //KPP and KIP are values needed to calculate the output for the position algorithm
     //KPV and KIV are values needed to calculate the output for the velocity algorithm
@@ -39,19 +43,13 @@ class PIVConverter : public IOConverter
 
     //dT represents the time slice constant in seconds for this control loop. It should be externally looped, with dt representing
     //how many seconds pass in between calls to the control loop.
-    //hardStops one and two track physical stops that the axis can't move through like walls. Initialized to -1 as a value representing they're unassigned
-    float DT, errorVelSummation, errorPosSummation, hardStopPos1, hardStopPos2;
-
-    //Function that converts rotation units into something that can be worked with more easily such as degrees.
-    float dist360(int pos_ru);
+    MotionReal DT, errorVelSummation, errorPosSummation;
 
-    //finds the shortest path between two positions in degrees. Note that this function doesn't consider things like hard stops, so
-    //it shouldn't be used to find the BEST path.
-    float calcShortPath(float present, float dest);
+    //finds which way to go around to the destination without running through the hard stops, if any are set
+    PositionRoutePlanner routePlanner;
 
-    //calculates the best route to the destination in distance in degrees from the current position in degrees.
-    //Returns IMPOSSIBLE_MOVEMENT if it can't reach the destination.
-    float calcRouteToDest(float present, float dest);
+    //Function that converts rotation units into something that can be worked with more easily such as degrees.
+    MotionReal dist360(long pos_ru);
 
     // Overview: Full function that takes a postion input (an value for the gear to move to) as well as a boolean to check if the movement
     //           of the gear has been succeeded. Upon being called, the method will run PI logic on the passed input and return
@@ -76,7 +74,7 @@ class PIVConverter : public IOConverter
     //          input: the degrees left to turn for the arm to get to the appropriate destination
     //
     // returns: if arm is at position then the arm stops moving else, the veloicty algorithm is prompted for in runAlgorithm
-    long runPosAlgorithm(const long posDest, float *deg_disToDest);
+    long runPosAlgorithm(const long posDest, MotionReal *deg_disToDest);
 
     // Overview: Full function that determines how much power will be output by the arm to get to its destination
     //
@@ -88,6 +86,8 @@ class PIVConverter : public IOConverter
 
 
   public:
+    static const ValueType StaticInType = InputPosition;
+    static const ValueType StaticOutType = InputPowerPercent;
 
     //Input: inKPP, the integer representing the constant for porportional position
     //       inKIP, the integer representing the constant for integral position
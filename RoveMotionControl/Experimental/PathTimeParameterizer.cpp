@@ -0,0 +1,403 @@
+#include "PathTimeParameterizer.h"
+#include <math.h>
+
+//the per waypoint values besides the three torque coefficients per joint
+static const uint8_t ExtraValuesPerPoint = 4;
+
+//how many times the backwards pass halves the range it's searching for each waypoint's fastest speed
+static const uint8_t SearchSteps = 32;
+
+//the fastest path speed^2 the backwards pass searches up to when nothing else bounds it, ex where the path stands still
+static const float SearchLimit = 1e12;
+
+//the most a float's rounding can be, as a fraction of its size
+static const double FloatRounding = 1.0 / (1 << 24);
+
+//the most rounding in the path's curvature, against the joint speeds squared, that curvatureStride lets through
+static const double CurvatureNoise = 1e-3;
+
+PathTimeParameterizer::PathTimeParameterizer(ArmChainModel* armChain, float* workStorage, uint32_t workStorageLength)
+  : dynamics(armChain), storage(workStorage), storageLength(workStorageLength), path(0), pointCount(0), coefficientA(0),
+    coefficientB(0), coefficientC(0), speedCap(0), reachable(0), squaredSpeed(0), times(0), lastSegment(0)
+{
+  for(int i = 0; i < MaxJoints; i++)
+  {
+    maxTorque[i] = 0;
+    maxSpeed[i] = 0;
+  }
+}
+
+uint32_t PathTimeParameterizer::getStorageLength(uint16_t points)
+{
+  return (uint32_t)points * (3 * dynamics.getChain()->getLinkCount() + ExtraValuesPerPoint);
+}
+
+void PathTimeParameterizer::setTorqueLimit(uint8_t joint, float maxTorque_mNm)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  maxTorque[joint] = maxTorque_mNm;
+}
+
+void PathTimeParameterizer::setMotorLimit(uint8_t joint, float Kt, int motResistance_milliOhms, int supplyMillivolts, float gearRatio)
+{
+  if(motResistance_milliOhms <= 0)
+  {
+    return;
+  }
+
+  //stall current V / R through Kt, in milli newton-meters; millivolts over milliohms is amps
+  setTorqueLimit(joint, Kt * ((float)supplyMillivolts / motResistance_milliOhms) * gearRatio * 1000);
+}
+
+void PathTimeParameterizer::setMaxJointSpeed(uint8_t joint, float speed)
+{
+  if(joint >= MaxJoints)
+  {
+    return;
+  }
+
+  maxSpeed[joint] = speed;
+}
+
+//narrows the range of path accelerations to those keeping -limit <= a * acceleration + b * speed^2 + c <= limit.
+//Returns false if none do
+static bool narrowRange(float a, float b, float c, float limit, float speedSquared, float& minimum, float& maximum)
+{
+  float rest = b * speedSquared + c;
+
+  //the torque doesn't depend on the path acceleration here; only whether the speed's too much for it
+  if(a == 0)
+  {
+    return rest <= limit && rest >= -limit;
+  }
+
+  float low = (-limit - rest) / a;
+  float high = (limit - rest) / a;
+  if(a < 0)
+  {
+    float swap = low;
+    low = high;
+    high = swap;
+  }
+
+  if(low > minimum)
+  {
+    minimum = low;
+  }
+  if(high < maximum)
+  {
+    maximum = high;
+  }
+
+  return minimum <= maximum;
+}
+
+bool PathTimeParameterizer::accelerationRange(uint16_t point, float speedSquared, float& minimum, float& maximum)
+{
+  const uint8_t linkCount = dynamics.getChain()->getLinkCount();
+  const float* a = &coefficientA[point * linkCount];
+  const float* b = &coefficientB[point * linkCount];
+  const float* c = &coefficientC[point * linkCount];
+
+  minimum = -SearchLimit;
+  maximum = SearchLimit;
+
+  if(speedSquared > speedCap[point])
+  {
+    return false;
+  }
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    if(maxTorque[i] == 0)
+    {
+      continue;
+    }
+
+    if(!narrowRange(a[i], b[i], c[i], maxTorque[i], speedSquared, minimum, maximum))
+    {
+      return false;
+    }
+
+    //the acceleration is held until the next waypoint, so it has to work there too, where speed^2 will have gone up
+    //by 2 * acceleration. Otherwise where a joint's a changes sign between waypoints, an acceleration that's fine at
+    //both of them can take far too much torque in between
+    if(point + 1 < pointCount)
+    {
+      const float* nextA = &coefficientA[(point + 1) * linkCount];
+      const float* nextB = &coefficientB[(point + 1) * linkCount];
+      const float* nextC = &coefficientC[(point + 1) * linkCount];
+
+      if(!narrowRange(nextA[i] + 2 * nextB[i], nextB[i], nextC[i], maxTorque[i], speedSquared, minimum, maximum))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//picks how many waypoints apart to take the second differences giving the path's curvature. The waypoints are floats,
+//each only within 2^-24 of its size of the angle it stands for, so a second difference of neighbours carries up to
+//four of those roundings. Packed densely, that's a fair part of the curvature, and moving fast turns it into torque the
+//joints don't really need. Its effect on the joint accelerations, against the joint speeds squared that drive them, goes
+//down with the stride squared; the stride's the smallest that keeps it under CurvatureNoise at every waypoint
+static uint16_t curvatureStride(const float waypoints[], uint16_t points, uint8_t linkCount)
+{
+  double worst = 0;
+
+  for(int k = 1; k < points - 1; k++)
+  {
+    const float* q = &waypoints[k * linkCount];
+    double noise = 0;
+    double slopeSquared = 0;
+
+    for(int i = 0; i < linkCount; i++)
+    {
+      double rounding = (fabs(q[i - linkCount]) + 2 * fabs(q[i]) + fabs(q[i + linkCount])) * FloatRounding;
+      double slope = ((double)q[i + linkCount] - q[i - linkCount]) / 2;
+
+      noise += rounding * rounding;
+      slopeSquared += slope * slope;
+    }
+
+    //where the path stands still there's no speed for the noise to be squared by
+    if(slopeSquared > 0 && sqrt(noise) / slopeSquared > worst)
+    {
+      worst = sqrt(noise) / slopeSquared;
+    }
+  }
+
+  double stride = ceil(sqrt(worst / CurvatureNoise));
+  return stride < 1 ? 1 : stride > 0xFFFF ? 0xFFFF : stride;
+}
+
+bool PathTimeParameterizer::parameterize(const float waypoints[], uint16_t points)
+{
+  const uint8_t linkCount = dynamics.getChain()->getLinkCount();
+  float zeroes[MaxJoints];
+  float slope[MaxJoints];
+  float curvature[MaxJoints];
+  Mat4<float> frames[MaxJoints];
+
+  path = 0;
+  pointCount = points;
+  lastSegment = 0;
+
+  if(points < 3 || linkCount == 0 || !storage || storageLength < getStorageLength(points))
+  {
+    return false;
+  }
+
+  coefficientA = storage;
+  coefficientB = coefficientA + points * linkCount;
+  coefficientC = coefficientB + points * linkCount;
+  speedCap = coefficientC + points * linkCount;
+  reachable = speedCap + points;
+  squaredSpeed = reachable + points;
+  times = squaredSpeed + points;
+
+  for(int i = 0; i < linkCount; i++)
+  {
+    zeroes[i] = 0;
+  }
+
+  uint16_t stride = curvatureStride(waypoints, points, linkCount);
+  if(points < 2 * stride + 1)
+  {
+    return false;
+  }
+
+  //with the path parameter s counting waypoints, joint speed is q' * s' and joint acceleration q' * s'' + q'' * s'^2,
+  //so the torques are M * q' * s'' + (M * q'' + coriolis(q')) * s'^2 + gravity. Each coefficient comes out of a pass
+  //of the dynamics. a and b are worked out without gravity rather than by taking it back off afterwards; with the
+  //waypoints close together they're far smaller than gravity, and would be lost in its rounding
+  for(int k = 0; k < points; k++)
+  {
+    const float* q = &waypoints[k * linkCount];
+
+    //central differences, except at the ends; the curvature there is taken to be the same as next to them. Done in
+    //doubles, and across the stride picked above
+    int before = (k == 0) ? 0 : k - 1;
+    int after = (k == points - 1) ? k : k + 1;
+    int middle = (k < stride) ? stride : (k > points - 1 - stride) ? points - 1 - stride : k;
+    for(int i = 0; i < linkCount; i++)
+    {
+      slope[i] = ((double)waypoints[after * linkCount + i] - waypoints[before * linkCount + i]) / (after - before);
+      curvature[i] = ((double)waypoints[(middle + stride) * linkCount + i] - 2.0 * waypoints[middle * linkCount + i]
+                      + waypoints[(middle - stride) * linkCount + i]) / ((double)stride * stride);
+    }
+
+    float* a = &coefficientA[k * linkCount];
+    float* b = &coefficientB[k * linkCount];
+    float* c = &coefficientC[k * linkCount];
+
+    dynamics.getChain()->forwardKinematics(q, frames);
+    dynamics.gravityTorques(q, c);
+    dynamics.motionTorquesFromFrames(frames, zeroes, slope, a);
+    dynamics.motionTorquesFromFrames(frames, slope, curvature, b);
+
+    speedCap[k] = SearchLimit;
+    for(int i = 0; i < linkCount; i++)
+    {
+      if(maxSpeed[i] != 0 && slope[i] != 0)
+      {
+        float cap = maxSpeed[i] / slope[i];
+        if(cap * cap < speedCap[k])
+        {
+          speedCap[k] = cap * cap;
+        }
+      }
+    }
+  }
+
+  //backwards from stopped at the end: the fastest each waypoint can be passed at and still slow down in time for the
+  //next one. Everything from stopped up to that is possible too, so it's found by halving the range
+  reachable[points - 1] = 0;
+  for(int k = points - 2; k >= 0; k--)
+  {
+    float minimum, maximum;
+    if(!accelerationRange(k, 0, minimum, maximum) || minimum > reachable[k + 1] / 2)
+    {
+      return false;
+    }
+
+    float low = 0;
+    float high = speedCap[k];
+    for(int step = 0; step < SearchSteps; step++)
+    {
+      float middle = (low + high) / 2;
+
+      //with the acceleration held over the step from one waypoint to the next, speed^2 changes by 2 * acceleration
+      if(accelerationRange(k, middle, minimum, maximum) && middle + 2 * minimum <= reachable[k + 1])
+      {
+        low = middle;
+      }
+      else
+      {
+        high = middle;
+      }
+    }
+    reachable[k] = low;
+  }
+
+  //forwards from stopped at the start, accelerating as hard as the torques allow but never past what's reachable
+  squaredSpeed[0] = 0;
+  times[0] = 0;
+  //The backwards pass should leave a way through from every speed it allows, but it only searched for the fastest one,
+  //so each step is checked again: a waypoint with no acceleration the torques allow, or where getting down to what's
+  //reachable at the next one (or to no less than stopped) takes an acceleration outside that range, means the path
+  //can't be timed within the limits after all
+  for(int k = 0; k < points - 1; k++)
+  {
+    float minimum, maximum;
+    if(!accelerationRange(k, squaredSpeed[k], minimum, maximum))
+    {
+      return false;
+    }
+
+    float next = squaredSpeed[k] + 2 * maximum;
+    if(next > reachable[k + 1])
+    {
+      next = reachable[k + 1];
+      if(next < squaredSpeed[k] + 2 * minimum)
+      {
+        return false;
+      }
+    }
+    if(next < 0)
+    {
+      return false;
+    }
+    squaredSpeed[k + 1] = next;
+
+    //the step is one waypoint long, at the average of the speeds at either end
+    float averageSpeed = (sqrt(squaredSpeed[k]) + sqrt(next)) / 2;
+    if(!(averageSpeed > 0))
+    {
+      return false;
+    }
+    times[k + 1] = times[k] + 1 / averageSpeed;
+  }
+
+  path = waypoints;
+  return true;
+}
+
+float PathTimeParameterizer::getDuration()
+{
+  return path ? times[pointCount - 1] : 0;
+}
+
+float PathTimeParameterizer::getWaypointTime(uint16_t point)
+{
+  return (path && point < pointCount) ? times[point] : 0;
+}
+
+float PathTimeParameterizer::getWaypointSpeed(uint16_t point)
+{
+  return (path && point < pointCount) ? sqrt(squaredSpeed[point]) : 0;
+}
+
+void PathTimeParameterizer::evaluate(float time, float angles[], float speeds[])
+{
+  const uint8_t linkCount = dynamics.getChain()->getLinkCount();
+  uint16_t k;
+  float fraction, pathSpeed;
+
+  if(!path)
+  {
+    return;
+  }
+
+  if(time <= 0)
+  {
+    k = 0;
+    fraction = 0;
+    pathSpeed = 0;
+  }
+  else if(time >= times[pointCount - 1])
+  {
+    k = pointCount - 2;
+    fraction = 1;
+    pathSpeed = 0;
+  }
+  else
+  {
+    //usually time only moves forwards, so pick up where the last evaluation left off
+    k = time >= times[lastSegment] ? lastSegment : 0;
+    while(k < pointCount - 2 && time >= times[k + 1])
+    {
+      k++;
+    }
+    lastSegment = k;
+
+    //the path acceleration is held through each step
+    float dt = time - times[k];
+    float startSpeed = sqrt(squaredSpeed[k]);
+    float acceleration = (squaredSpeed[k + 1] - squaredSpeed[k]) / 2;
+
+    fraction = startSpeed * dt + acceleration * dt * dt / 2;
+    pathSpeed = startSpeed + acceleration * dt;
+    if(fraction > 1)
+    {
+      fraction = 1;
+    }
+  }
+
+  const float* from = &path[k * linkCount];
+  const float* to = &path[(k + 1) * linkCount];
+  for(int i = 0; i < linkCount; i++)
+  {
+    angles[i] = from[i] + (to[i] - from[i]) * fraction;
+    if(speeds)
+    {
+      speeds[i] = (to[i] - from[i]) * pathSpeed;
+    }
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef ROVEJOINTCONTROL_PATHTIMEPARAMETERIZER_H_
+#define ROVEJOINTCONTROL_PATHTIMEPARAMETERIZER_H_
+
+#include <stdint.h>
+#include "ArmChainModel.h"
+#include "ArmDynamics.h"
+
+//Times a move along a joint space path as fast as the joints' motors allow: given the path as a list of waypoints,
+//works out how fast to go along it at every waypoint so that no joint ever needs more torque than it has, counting
+//the torque it takes to hold the arm up against gravity and to swing the links around, not just to accelerate them.
+//
+//Along a fixed path, every joint's torque is a * pathAcceleration + b * pathSpeed^2 + c at each waypoint, with a, b
+//and c worked out once per waypoint from the arm's dynamics (ArmDynamics). So every joint's torque limit becomes a
+//band of path accelerations allowed at each path speed, and timing the path is a one dimensional problem. It's solved
+//the way time optimal path parameterization by reachability analysis does it: a pass back from the end finds, for every
+//waypoint, the fastest it can be passing it and still be able to stop at the end; then a pass forwards from the start
+//accelerates as hard as the torques allow without ever going past that. The result is the fastest timing along the
+//path the torque limits allow, to within how finely the waypoints sample it. Each path acceleration is held from one
+//waypoint to the next, and has to be within the limits at both.
+//
+//The limits are only checked at the waypoints. In between, the dynamics drift from what the waypoints sampled, so a
+//joint can need a little more than its limit there. On a six link arm timed from anywhere between fifty and a few
+//thousand waypoints, that stays within 0.5% of the limit (see HostTests/PathTimeParameterizerTest). Leave that much
+//margin in the limits.
+//
+//The path's curvature comes from second differences of the waypoints. Being floats, they carry rounding that grows
+//against the curvature the closer together they're packed, and fast moves turn that into torque. So the differences
+//are taken across as many waypoints as it takes to keep the rounding small, and a path too dense for floats to tell
+//its curvature even across half its length is refused.
+//
+//Torque limits can be given as is, or from a brushed motor's Kt, winding resistance, supply voltage and gear ratio,
+//the same as TtoPPOpenLConverter models it: stall torque, with back EMF left out. Joint speed limits can be added too.
+//
+//Plain floats, no hardware, so it runs the same on a computer for planning long moves as it does on the board for
+//short ones. Memory is handed in; see getStorageLength. Costs three passes of ArmDynamics per waypoint, plus
+//the backwards pass's search, 32 rounds of a couple checks per joint for each waypoint.
+//see the readme.md for more info
+class PathTimeParameterizer
+{
+  private:
+    static const uint8_t MaxJoints = ArmChainModel::MaxLinks;
+
+    ArmDynamics dynamics;
+
+    float* storage;
+    uint32_t storageLength;
+
+    float maxTorque[MaxJoints];
+    float maxSpeed[MaxJoints];
+
+    //the parameterized path; waypoint k of joint i is path[k * links + i]. 0 until parameterize succeeds
+    const float* path;
+    uint16_t pointCount;
+
+    //per waypoint, in storage: the torque coefficients a, b, c for every joint, then the most path speed^2 the speed
+    //limits allow, the most it can be and still stop at the end, the path speed^2 the move goes at, and the time it
+    //gets there
+    float* coefficientA;
+    float* coefficientB;
+    float* coefficientC;
+    float* speedCap;
+    float* reachable;
+    float* squaredSpeed;
+    float* times;
+
+    uint16_t lastSegment;
+
+    //overview: the range of path accelerations the torque limits allow at a waypoint, going at the given path speed^2
+    //returns:  false if there isn't one, IE some joint can't manage at that speed at all
+    bool accelerationRange(uint16_t point, float speedSquared, float& minimum, float& maximum);
+
+  public:
+
+    //overview: constructs for the given arm, with no torque or speed limits.
+    //inputs:   armChain: the arm. Its links shouldn't change while this is in use
+    //          workStorage, workStorageLength: floats for it to work in, see getStorageLength
+    PathTimeParameterizer(ArmChainModel* armChain, float* workStorage, uint32_t workStorageLength);
+
+    //returns how many floats of storage a path of the given amount of waypoints needs
+    uint32_t getStorageLength(uint16_t points);
+
+    //sets a joint's torque limit, in milli newton-meters either way. 0 for no limit, which is the default
+    void setTorqueLimit(uint8_t joint, float maxTorque_mNm);
+
+    //overview: sets a joint's torque limit from its motor, as the torque the motor makes stalled at the supply
+    //          voltage, Kt * V / R, times the gearing.
+    //inputs:   Kt: the motor's torque constant, in newton-meters per amp
+    //          motResistance_milliOhms: resistance at the motor's terminals
+    //          supplyMillivolts: the motor's supply voltage
+    //          gearRatio: motor turns per joint turn
+    void setMotorLimit(uint8_t joint, float Kt, int motResistance_milliOhms, int supplyMillivolts, float gearRatio);
+
+    //sets a joint's speed limit, in radians/s. 0 for no limit, which is the default
+    void setMaxJointSpeed(uint8_t joint, float speed);
+
+    //overview: works out the fastest timing along a path that starts and ends at rest.
+    //inputs:   waypoints: points * links joint angles in radians, one waypoint's after another, spaced evenly along
+    //                     the path. They don't get wrapped, so a joint that crosses 0 has to go negative or past 2pi
+    //                     rather than jump. Has to stay valid for as long as evaluate is used
+    //          points: how many waypoints, at least 3. More follows the dynamics more closely, up to a point; see above
+    //returns:  false if the storage is too small, the waypoints are too close together for their curvature to show in
+    //          floats, there's a waypoint where some joint can't even hold the arm up still within its torque limit, or
+    //          the forwards pass finds a step it can't take within the limits
+    bool parameterize(const float waypoints[], uint16_t points);
+
+    //how long the parameterized move takes, in seconds
+    float getDuration();
+
+    //overview: when the move passes a waypoint, in seconds from the start, and how fast along the path it's going then,
+    //          in waypoints per second
+    float getWaypointTime(uint16_t point);
+    float getWaypointSpeed(uint16_t point);
+
+    //overview: where the move is at the given time since its start. Times before the start give the start, times
+    //          after the end give the end.
+    //inputs:   time: seconds since the start of the move
+    //          angles: returned, joint angles in radians, one per link
+    //          speeds: returned, joint speeds in radians/s. Can be 0 if not needed
+    void evaluate(float time, float angles[], float speeds[]);
+};
+
+#endif
@@ -4,19 +4,20 @@
 #include <stdint.h>
 
 VelocityDeriver::VelocityDeriver(FeedbackDevice* posSensor, float filter_Constant)
-  : FeedbackDevice(InputSpeed), filterConstant(filter_Constant), posDev(posSensor), lastOutput(0)
+  : FeedbackDevice(InputSpeed), filterConstant(filter_Constant), posDev(posSensor), lastOutput(0),
+    status(FeedbackStatus_Success)
 {
   if(posDev->getFeedbackType() != InputPosition)
   {
     debugFault("VelocityDeriver constructor: position feedback device doesn't give position data");
   }
 
-  filterConstant = constrain(filterConstant, 0, 1);
+  filterConstant = constrain(filter_Constant, 0, 1);
   lastPosition = posDev->getFeedback();
   lastTime_ms = millis();
 }
 
-float VelocityDeriver::accountForPositionRollover(float dP)
+MotionReal VelocityDeriver::accountForPositionRollover(MotionReal dP)
 {
   //basically, your destination is always to the left or right of you, one way will be shorter. The direct center of the two paths is at 180 degrees
   //from your starting point. Calculate the degrees to the destination by simply taking the difference between dest and present. If it's more than 180,
@@ -40,26 +41,36 @@ long VelocityDeriver::getFeedback()
   long presentTime_ms;
   int32_t readSpeed;
   int32_t outputSpeed;
-  float dT;
-  float dP;
+  long dT_ms;
+  MotionReal dP;
 
   presentPosition = posDev->getFeedback();
   presentTime_ms = millis();
 
-  dP = presentPosition - lastPosition;
+  //a failed reading says nothing about the speed, so hold the last output
+  status = posDev->getFeedbackStatus();
+  if(status != FeedbackStatus_Success)
+  {
+    return lastOutput;
+  }
+
+  //work in degrees, so that the rollover check compares like units and the distance stays small enough for a fixed
+  //point MotionReal to hold
+  dP = motionRatio((presentPosition - lastPosition) * 360, POS_MAX - POS_MIN);
   dP = accountForPositionRollover(dP);
-  dT = presentTime_ms - lastTime_ms;
-  dT /= 1000.0;
+  dT_ms = presentTime_ms - lastTime_ms;
 
-  if(dT <= 0)
+  if(dT_ms <= 0)
   {
     return lastOutput;
   }
 
-  readSpeed = dP/dT;
+  //degrees per millisecond to the framework's speed units, milli-degrees per second. dT stays a whole number of
+  //milliseconds since a millisecond is no round number in binary fixed point
+  readSpeed = motionToLongScaled(dP, 1000000) / dT_ms;
 
   //output(n) = k * output(n - 1) + (1 - k) * input(n)
-  outputSpeed = filterConstant * lastOutput + (1.0 - filterConstant) * readSpeed;
+  outputSpeed = motionLowPass(filterConstant, lastOutput, readSpeed);
 
   lastOutput = outputSpeed;
   lastTime_ms = presentTime_ms;
@@ -67,3 +78,8 @@ long VelocityDeriver::getFeedback()
 
   return outputSpeed;
 }
+
+FeedbackDevice_Status VelocityDeriver::getFeedbackStatus()
+{
+  return status;
+}
@@ -9,6 +9,7 @@
 #define ROVEJOINTCONTROL_VELOCITYDERIVER_H_
 
 #include "../AbstractFramework.h"
+#include "../RoveFixedPoint.h"
 
 //Feedback device who estimates a axis's velocity, by reading the axis's position from a
 //position feedback device and taking the derivative and then passing the output through a low pass filter
@@ -19,7 +20,7 @@ class VelocityDeriver: public FeedbackDevice
   private:
 
     //the constant k for the low pass filter
-    float filterConstant;
+    MotionReal filterConstant;
 
     //The feedback device providing the position data on this axis, so this velocity deriver
     //can apply a derivative to its information to obtain velocity
@@ -36,15 +37,18 @@ class VelocityDeriver: public FeedbackDevice
     //the last returned output from get feedback, from the last time the function was ran
     long lastOutput;
 
+    //the position sensor's status as of the last reading
+    FeedbackDevice_Status status;
+
     //overview: reads a difference value for position data, and determines if the position readings
     //          rolled over 360 degrees or not. If so, it accounts for it by returning the real
     //          (or in other words, shortest) distance between the position readings, regardless
     //          of rollover.
     //
-    //input:    The relative, non-accounting-for-360-rollover-distance between two points of position data
+    //input:    The relative, non-accounting-for-360-rollover-distance between two points of position data, in degrees
     //
-    //returns:  The true/shortest distance between two points of position data
-    float accountForPositionRollover(float dP);
+    //returns:  The true/shortest distance between two points of position data, in degrees
+    MotionReal accountForPositionRollover(MotionReal dP);
 
   public:
 
@@ -75,6 +79,10 @@ class VelocityDeriver: public FeedbackDevice
     //               function calls, then the class will think we were moving at 0 speed since present position - last
     //               will be 0. So don't call the function at a higher frequency than the sensor's update frequency.
     long getFeedback();
+
+    //checks to see what the status is of the feedback device. Call getFeedback() to update the status, then
+    //call this to see if the operation had any issues.
+    FeedbackDevice_Status getFeedbackStatus();
 };
 
 
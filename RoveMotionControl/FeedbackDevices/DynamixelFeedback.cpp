@@ -0,0 +1,69 @@
+#include "DynamixelFeedback.h"
+#include "../RoveMotionUtilities.h"
+
+DynamixelFeedback::DynamixelFeedback(DynamixelGroup* dynaGroup, uint8_t id, ValueType feedbackType)
+  : FeedbackDevice(feedbackType), group(dynaGroup), reversed(false), lastReturn(0), status(FeedbackStatus_Fail)
+{
+  groupIndex = group->indexOf(id);
+
+  if(groupIndex < 0)
+  {
+    debugFault("Error in DynamixelFeedback constructor: dynamixel isn't in the group");
+  }
+
+  if(feedbackType != InputPosition && feedbackType != InputSpeed)
+  {
+    debugFault("Error in DynamixelFeedback constructor: dynamixels only give position or speed feedback");
+  }
+}
+
+long DynamixelFeedback::getFeedback()
+{
+  long feedback;
+
+  if(groupIndex < 0 || !group->feedbackValid(groupIndex))
+  {
+    status = FeedbackStatus_Fail;
+    return lastReturn;
+  }
+
+  if(fType == InputPosition)
+  {
+    feedback = DynamixelGroup::rawToPosition(group->getType(groupIndex), group->getPresentPosition(groupIndex));
+    if(reversed)
+    {
+      feedback = (POS_MAX - POS_MIN) - feedback;
+    }
+  }
+  else
+  {
+    feedback = DynamixelGroup::rawToSpeed(group->getType(groupIndex), group->getPresentSpeed(groupIndex));
+    if(reversed)
+    {
+      feedback = -feedback;
+    }
+  }
+
+  status = FeedbackStatus_Success;
+  lastReturn = feedback;
+  return feedback;
+}
+
+FeedbackDevice_Status DynamixelFeedback::getFeedbackStatus()
+{
+  return status;
+}
+
+void DynamixelFeedback::reverseDirection(bool reverse)
+{
+  reversed = reverse;
+}
+
+uint8_t DynamixelFeedback::getAlarms()
+{
+  if(groupIndex < 0)
+  {
+    return 0;
+  }
+  return group->getAlarms(groupIndex);
+}
@@ -0,0 +1,45 @@
+#ifndef ROVEJOINTCONTROL_DYNAMIXELFEEDBACK_H_
+#define ROVEJOINTCONTROL_DYNAMIXELFEEDBACK_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../OutputDevices/DynamixelController.h"
+
+//represents a dynamixel's own position or speed sensing. Readings come out of the snapshot its DynamixelGroup takes
+//each tick rather than off the bus, so getFeedback() never blocks.
+//see the readme.md for more info
+class DynamixelFeedback: public FeedbackDevice
+{
+  private:
+    DynamixelGroup* group;
+    int groupIndex;
+    bool reversed;
+    long lastReturn;
+    FeedbackDevice_Status status;
+
+  public:
+
+    //overview: constructor. Public, to be called by main before passing into axis interface
+    //input:    dynaGroup: the group the dynamixel was added to, usually by constructing its DynamixelController
+    //          id: id of the dynamixel
+    //          feedbackType: InputPosition to read the servo's present position, InputSpeed to read its present speed
+    DynamixelFeedback(DynamixelGroup* dynaGroup, uint8_t id, ValueType feedbackType);
+
+    //overview: returns the servo's present position (between POS_MIN and POS_MAX) or present speed (between SPEED_MIN and
+    //          SPEED_MAX) as of the group's last refresh. If that refresh got no good reading, the last good value is
+    //          returned and the status is set to fail. A servo reporting alarms still gives good readings.
+    long getFeedback();
+
+    //checks to see what the status is of the feedback device. Call getFeedback() to update the status, then
+    //call this to see if the operation had any issues.
+    FeedbackDevice_Status getFeedbackStatus();
+
+    //assigns whether or not to reverse which way the device considers positive or negative movement
+    void reverseDirection(bool reverse);
+
+    //returns the alarm bits (overload, overheating, voltage) the servo reported as of the group's last refresh, 0 if
+    //none. An alarm doesn't fail the feedback, since the reading that came with it is still good
+    uint8_t getAlarms();
+};
+
+#endif
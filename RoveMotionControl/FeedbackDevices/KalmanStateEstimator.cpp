@@ -0,0 +1,297 @@
+#include "KalmanStateEstimator.h"
+#include "RoveBoard.h"
+#include <math.h>
+
+//uncertainty given to the velocity and acceleration when the estimate starts, before there's anything to go off of
+static const float INITIAL_RATE_VARIANCE = 10000;
+
+KalmanStateView::KalmanStateView(KalmanStateEstimator* owner, ValueType type)
+  : FeedbackDevice(type), estimator(owner)
+{
+}
+
+long KalmanStateView::getFeedback()
+{
+  switch(fType)
+  {
+    case InputPosition:
+      return estimator->getPositionDegrees() * DEGREES_TO_POS;
+    case InputSpeed:
+      return constrain(estimator->getSpeedDegrees() * 1000, SPEED_MIN, SPEED_MAX);
+    case InputAcceleration:
+      return constrain(estimator->getAccelerationDegrees() * 1000, ACCEL_MIN, ACCEL_MAX);
+    default:
+      return 0;
+  }
+}
+
+FeedbackDevice_Status KalmanStateView::getFeedbackStatus()
+{
+  return estimator->getStatus();
+}
+
+KalmanStateEstimator::KalmanStateEstimator(FeedbackDevice* posSensor, KalmanModel motionModel, float process_noise, float measurement_noise)
+  : posDev(posSensor), model(motionModel), processNoise(process_noise), measurementNoise(measurement_noise), commandGain(0),
+    motorCommand(0), lastUpdate_us(0), initialized(false), status(FeedbackStatus_Success), positionView(this, InputPosition),
+    speedView(this, InputSpeed), accelerationView(this, InputAcceleration)
+{
+  if(posDev->getFeedbackType() != InputPosition)
+  {
+    debugFault("KalmanStateEstimator constructor: position feedback device doesn't give position data");
+  }
+
+  stateCount = (model == KalmanModel_ConstantAcceleration) ? 3 : 2;
+  reset();
+}
+
+void KalmanStateEstimator::reset()
+{
+  for(int i = 0; i < MaxStates; i++)
+  {
+    state[i] = 0;
+    for(int j = 0; j < MaxStates; j++)
+    {
+      covariance[i][j] = 0;
+    }
+  }
+
+  initialized = false;
+}
+
+void KalmanStateEstimator::predict(float dt)
+{
+  float F[MaxStates][MaxStates] = {{1, dt, dt * dt / 2}, {0, 1, dt}, {0, 0, 1}};
+  float FP[MaxStates][MaxStates];
+  float commandAccel = commandGain * motorCommand;
+  int n = stateCount;
+
+  //x = F * x + B * u. The command's acceleration is known, so it goes straight into the prediction instead of into
+  //the acceleration state
+  float newState[MaxStates];
+  for(int i = 0; i < n; i++)
+  {
+    newState[i] = 0;
+    for(int j = 0; j < n; j++)
+    {
+      newState[i] += F[i][j] * state[j];
+    }
+  }
+  newState[0] += commandAccel * dt * dt / 2;
+  newState[1] += commandAccel * dt;
+
+  for(int i = 0; i < n; i++)
+  {
+    state[i] = newState[i];
+  }
+
+  //P = F * P * F' + Q
+  for(int i = 0; i < n; i++)
+  {
+    for(int j = 0; j < n; j++)
+    {
+      FP[i][j] = 0;
+      for(int k = 0; k < n; k++)
+      {
+        FP[i][j] += F[i][k] * covariance[k][j];
+      }
+    }
+  }
+
+  for(int i = 0; i < n; i++)
+  {
+    for(int j = 0; j < n; j++)
+    {
+      covariance[i][j] = 0;
+      for(int k = 0; k < n; k++)
+      {
+        covariance[i][j] += FP[i][k] * F[j][k];
+      }
+    }
+  }
+
+  //Q, for white noise on the highest derivative the model has
+  float dt2 = dt * dt;
+  float dt3 = dt2 * dt;
+  if(model == KalmanModel_ConstantAcceleration)
+  {
+    float dt4 = dt3 * dt;
+    float dt5 = dt4 * dt;
+
+    covariance[0][0] += processNoise * dt5 / 20;
+    covariance[0][1] += processNoise * dt4 / 8;
+    covariance[0][2] += processNoise * dt3 / 6;
+    covariance[1][0] += processNoise * dt4 / 8;
+    covariance[1][1] += processNoise * dt3 / 3;
+    covariance[1][2] += processNoise * dt2 / 2;
+    covariance[2][0] += processNoise * dt3 / 6;
+    covariance[2][1] += processNoise * dt2 / 2;
+    covariance[2][2] += processNoise * dt;
+  }
+  else
+  {
+    covariance[0][0] += processNoise * dt3 / 3;
+    covariance[0][1] += processNoise * dt2 / 2;
+    covariance[1][0] += processNoise * dt2 / 2;
+    covariance[1][1] += processNoise * dt;
+  }
+}
+
+void KalmanStateEstimator::correct(float measured_deg)
+{
+  float gain[MaxStates];
+  float oldTopRow[MaxStates];
+  int n = stateCount;
+
+  //the sensor only reads position, so H = [1 0 0] and the innovation's variance is just P[0][0] + R.
+  //The innovation is taken the short way around, since both positions wrap at 360
+  float innovation = measured_deg - state[0];
+  if(innovation > 180)
+  {
+    innovation -= 360;
+  }
+  else if(innovation <= -180)
+  {
+    innovation += 360;
+  }
+
+  float innovationVariance = covariance[0][0] + measurementNoise;
+  if(innovationVariance <= 0)
+  {
+    return;
+  }
+
+  for(int i = 0; i < n; i++)
+  {
+    gain[i] = covariance[i][0] / innovationVariance;
+    state[i] += gain[i] * innovation;
+    oldTopRow[i] = covariance[0][i];
+  }
+
+  //P = (I - K * H) * P, which with H = [1 0 0] only needs P's top row
+  for(int i = 0; i < n; i++)
+  {
+    for(int j = 0; j < n; j++)
+    {
+      covariance[i][j] -= gain[i] * oldTopRow[j];
+    }
+  }
+
+  //keep the position on the circle; shifting it by a whole turn doesn't change anything else
+  if(state[0] >= 360)
+  {
+    state[0] -= 360;
+  }
+  else if(state[0] < 0)
+  {
+    state[0] += 360;
+  }
+}
+
+void KalmanStateEstimator::update()
+{
+  long reading = posDev->getFeedback();
+  uint32_t now_us = micros();
+
+  status = posDev->getFeedbackStatus();
+
+  if(!initialized)
+  {
+    if(status != FeedbackStatus_Success)
+    {
+      return;
+    }
+
+    state[0] = reading * POS_TO_DEGREES;
+    covariance[0][0] = measurementNoise;
+    covariance[1][1] = INITIAL_RATE_VARIANCE;
+    covariance[2][2] = INITIAL_RATE_VARIANCE;
+    lastUpdate_us = now_us;
+    initialized = true;
+    return;
+  }
+
+  //unsigned subtraction, so micros() rolling over doesn't matter
+  float dt = (uint32_t)(now_us - lastUpdate_us) / 1000000.0;
+  lastUpdate_us = now_us;
+
+  if(dt > 0)
+  {
+    predict(dt);
+  }
+
+  if(status == FeedbackStatus_Success)
+  {
+    correct(reading * POS_TO_DEGREES);
+  }
+  else
+  {
+    //the prediction can wander off the circle with nothing to correct it
+    if(state[0] >= 360 || state[0] < 0)
+    {
+      state[0] -= 360 * floorf(state[0] / 360);
+    }
+  }
+}
+
+void KalmanStateEstimator::updateTask(void* estimator)
+{
+  ((KalmanStateEstimator*)estimator)->update();
+}
+
+void KalmanStateEstimator::setMotorCommand(long powerPercent)
+{
+  motorCommand = constrain(powerPercent, POWERPERCENT_MIN, POWERPERCENT_MAX);
+}
+
+void KalmanStateEstimator::setCommandGain(float degPerS2_perPowerPercent)
+{
+  commandGain = degPerS2_perPowerPercent;
+}
+
+void KalmanStateEstimator::setNoise(float process_noise, float measurement_noise)
+{
+  processNoise = process_noise;
+  measurementNoise = measurement_noise;
+}
+
+FeedbackDevice* KalmanStateEstimator::getPositionFeedback()
+{
+  return &positionView;
+}
+
+FeedbackDevice* KalmanStateEstimator::getSpeedFeedback()
+{
+  return &speedView;
+}
+
+FeedbackDevice* KalmanStateEstimator::getAccelerationFeedback()
+{
+  return &accelerationView;
+}
+
+float KalmanStateEstimator::getPositionDegrees()
+{
+  return state[0];
+}
+
+float KalmanStateEstimator::getSpeedDegrees()
+{
+  return state[1];
+}
+
+float KalmanStateEstimator::getAccelerationDegrees()
+{
+  float accel = commandGain * motorCommand;
+
+  if(model == KalmanModel_ConstantAcceleration)
+  {
+    accel += state[2];
+  }
+
+  return accel;
+}
+
+FeedbackDevice_Status KalmanStateEstimator::getStatus()
+{
+  return status;
+}
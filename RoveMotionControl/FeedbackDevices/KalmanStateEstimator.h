@@ -0,0 +1,141 @@
+#ifndef ROVEJOINTCONTROL_KALMANSTATEESTIMATOR_H_
+#define ROVEJOINTCONTROL_KALMANSTATEESTIMATOR_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+
+class KalmanStateEstimator;
+
+//which motion model a KalmanStateEstimator assumes between readings
+enum KalmanModel
+{
+  //position and velocity, with the acceleration treated as random
+  KalmanModel_ConstantVelocity,
+
+  //position, velocity and acceleration, with the jerk treated as random. Tracks changing speeds with less lag, but is
+  //noisier when the axis is holding still
+  KalmanModel_ConstantAcceleration
+};
+
+//one of the estimates of a KalmanStateEstimator, presented as a feedback device so it can be handed to anything that
+//takes one. Made by the estimator; get them through its getPositionFeedback etc.
+class KalmanStateView: public FeedbackDevice
+{
+  friend class KalmanStateEstimator;
+
+  private:
+    KalmanStateEstimator* estimator;
+
+    KalmanStateView(KalmanStateEstimator* owner, ValueType type);
+
+  public:
+
+    //overview: returns the estimator's latest estimate, as of its last update(). Doesn't run the estimator itself,
+    //          so every view reads the same estimate no matter how many of them are read per tick.
+    long getFeedback();
+
+    //returns the status of the position sensor the estimator last read
+    FeedbackDevice_Status getFeedbackStatus();
+};
+
+//Estimates an axis's position, velocity and acceleration with a kalman filter, from a position sensor such as
+//Ma3Encoder12b and optionally the command being given to the axis's motor. Compared to VelocityDeriver, which
+//differentiates position over whole milliseconds then low passes it, the filter weighs each reading against what the
+//motion model predicted, so the velocity comes out smoother without lagging as much, and it doesn't depend on there
+//being a whole millisecond between readings.
+//
+//The estimate is updated once per tick by calling update(), ex from an AxisGroup task using updateTask. Each of the
+//three estimates is read through its own feedback device view, which all read that same estimate.
+//Works in floats, in degrees, degrees/s and degrees/s^2.
+//see the readme.md for more info
+class KalmanStateEstimator
+{
+  private:
+    static const uint8_t MaxStates = 3;
+
+    FeedbackDevice* posDev;
+    KalmanModel model;
+    uint8_t stateCount;
+
+    //position (kept between 0 and 360), velocity and, for the constant acceleration model, acceleration
+    float state[MaxStates];
+    float covariance[MaxStates][MaxStates];
+
+    //spectral density of the random acceleration or jerk, and variance of the position readings in degrees^2
+    float processNoise;
+    float measurementNoise;
+
+    //acceleration the motor command causes, in degrees/s^2 per power percent unit, and the present command
+    float commandGain;
+    long motorCommand;
+
+    uint32_t lastUpdate_us;
+    bool initialized;
+    FeedbackDevice_Status status;
+
+    KalmanStateView positionView;
+    KalmanStateView speedView;
+    KalmanStateView accelerationView;
+
+    //moves the estimate and its covariance forwards by dt seconds
+    void predict(float dt);
+
+    //corrects the estimate with a position reading, in degrees
+    void correct(float measured_deg);
+
+  public:
+
+    //overview: constructor.
+    //
+    //inputs:   posSensor: the position sensor to read
+    //          motionModel: which model to assume, see KalmanModel
+    //          process_noise: how much the axis's motion is expected to stray from the model; the spectral density of
+    //                         the random acceleration (constant velocity model, in degrees^2/s^3) or jerk (constant
+    //                         acceleration model, in degrees^2/s^5). Higher follows changes faster but smooths less
+    //          measurement_noise: the variance of the sensor's readings, in degrees^2. For an encoder that's only
+    //                             limited by its resolution, that's the resolution squared divided by 12
+    //
+    //warning: Function will block the program in an infinite fault loop if posSensor doesn't give out position data.
+    KalmanStateEstimator(FeedbackDevice* posSensor, KalmanModel motionModel, float process_noise, float measurement_noise);
+
+    //overview: reads the position sensor and updates the estimate. Call once per tick, before anything reads the views.
+    //          If the sensor fails, the estimate just runs on the model until it comes back and the views report
+    //          the failure.
+    void update();
+
+    //calls update() on the estimator passed as the context, for use with AxisGroup::addTask
+    static void updateTask(void* estimator);
+
+    //overview: sets the command presently being given to the motor, so that the acceleration it causes is predicted
+    //          rather than only seen after the fact. Only used if a command gain is set.
+    //input:    powerPercent: the command, between POWERPERCENT_MIN and POWERPERCENT_MAX
+    void setMotorCommand(long powerPercent);
+
+    //sets how much acceleration the motor command causes, in degrees/s^2 per power percent unit. Default is 0, IE the
+    //command isn't used
+    void setCommandGain(float degPerS2_perPowerPercent);
+
+    //changes the noise values given in the constructor
+    void setNoise(float process_noise, float measurement_noise);
+
+    //throws away the estimate, so the next update starts over from the sensor's reading
+    void reset();
+
+    //feedback devices returning the estimate's position (POS_MIN to POS_MAX), speed (SPEED_MIN to SPEED_MAX) and
+    //acceleration (ACCEL_MIN to ACCEL_MAX). Acceleration is always 0 with the constant velocity model unless a command
+    //gain is set
+    FeedbackDevice* getPositionFeedback();
+    FeedbackDevice* getSpeedFeedback();
+    FeedbackDevice* getAccelerationFeedback();
+
+    //the estimate, in degrees, degrees/s and degrees/s^2
+    float getPositionDegrees();
+    float getSpeedDegrees();
+    float getAccelerationDegrees();
+
+    //the status of the position sensor the last time it was read
+    FeedbackDevice_Status getStatus();
+};
+
+#endif
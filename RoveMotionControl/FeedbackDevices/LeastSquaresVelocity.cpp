@@ -0,0 +1,154 @@
+#include "LeastSquaresVelocity.h"
+#include "RoveBoard.h"
+
+static const uint32_t DEFAULT_SAMPLE_TIMEOUT_US = 10000;
+static const long POS_RANGE = POS_MAX - POS_MIN;
+
+//unwrapped positions get pulled back by whole turns once they're this far out, so they never overflow
+static const long REBASE_LIMIT = POS_RANGE * 1000;
+
+LeastSquaresVelocity::LeastSquaresVelocity(FeedbackDevice* posSensor, uint8_t window)
+  : FeedbackDevice(InputSpeed), posDev(posSensor), sampleTimeout_us(DEFAULT_SAMPLE_TIMEOUT_US), lastOutput(0),
+    status(FeedbackStatus_Success)
+{
+  if(posDev->getFeedbackType() != InputPosition)
+  {
+    debugFault("LeastSquaresVelocity constructor: position feedback device doesn't give position data");
+  }
+
+  setWindowSize(window);
+}
+
+void LeastSquaresVelocity::setWindowSize(uint8_t window)
+{
+  windowSize = constrain(window, 2, MaxSamples);
+  reset();
+}
+
+void LeastSquaresVelocity::setSampleTimeout(uint32_t timeout_us)
+{
+  sampleTimeout_us = timeout_us;
+}
+
+void LeastSquaresVelocity::reset()
+{
+  newestSample = 0;
+  sampleCount = 0;
+  lastReading = 0;
+  lastOutput = 0;
+}
+
+void LeastSquaresVelocity::addSample(uint32_t time_us, long reading)
+{
+  long position = reading;
+
+  if(sampleCount > 0)
+  {
+    //unwrap against the last reading, taking the short way around
+    long moved = reading - lastReading;
+    if(moved > POS_RANGE / 2)
+    {
+      moved -= POS_RANGE;
+    }
+    else if(moved < -POS_RANGE / 2)
+    {
+      moved += POS_RANGE;
+    }
+
+    position = samplePositions[newestSample] + moved;
+    newestSample = (newestSample + 1) % MaxSamples;
+  }
+
+  samplePositions[newestSample] = position;
+  sampleTimes_us[newestSample] = time_us;
+  lastReading = reading;
+
+  if(sampleCount < windowSize)
+  {
+    sampleCount++;
+  }
+
+  //the fit only cares about differences, so every sample can be shifted by the same whole turns
+  if(position > REBASE_LIMIT || position < -REBASE_LIMIT)
+  {
+    long shift = position - position % POS_RANGE;
+    for(int i = 0; i < MaxSamples; i++)
+    {
+      samplePositions[i] -= shift;
+    }
+  }
+}
+
+long LeastSquaresVelocity::fitSlope()
+{
+  float times[MaxSamples];
+  float positions[MaxSamples];
+  float meanT = 0, meanP = 0;
+  float spreadTT = 0, spreadTP = 0;
+  uint8_t index = newestSample;
+
+  //times and positions are taken relative to the newest sample, so they stay small enough for a float to hold exactly.
+  //The times count backwards with unsigned subtraction, so micros() rolling over doesn't matter
+  for(int i = 0; i < sampleCount; i++)
+  {
+    times[i] = -(float)(uint32_t)(sampleTimes_us[newestSample] - sampleTimes_us[index]);
+    positions[i] = samplePositions[index] - samplePositions[newestSample];
+    meanT += times[i];
+    meanP += positions[i];
+
+    index = (index + MaxSamples - 1) % MaxSamples;
+  }
+  meanT /= sampleCount;
+  meanP /= sampleCount;
+
+  //slope = sum((t - mean t) * (p - mean p)) / sum((t - mean t)^2). Centering first keeps the float sums from
+  //cancelling each other out
+  for(int i = 0; i < sampleCount; i++)
+  {
+    float t = times[i] - meanT;
+    spreadTT += t * t;
+    spreadTP += t * (positions[i] - meanP);
+  }
+
+  if(spreadTT <= 0)
+  {
+    return lastOutput;
+  }
+
+  //slope in position units (milli-degrees) per microsecond, to milli-degrees per second
+  float slope = spreadTP / spreadTT * 1000000.0;
+
+  return constrain(slope, SPEED_MIN, SPEED_MAX);
+}
+
+long LeastSquaresVelocity::getFeedback()
+{
+  long reading = posDev->getFeedback();
+  uint32_t now_us = micros();
+
+  status = posDev->getFeedbackStatus();
+  if(status != FeedbackStatus_Success)
+  {
+    return lastOutput;
+  }
+
+  //the same reading again most likely means the sensor hasn't updated since, unless it's been that way a while
+  if(sampleCount > 0 && reading == lastReading && (uint32_t)(now_us - sampleTimes_us[newestSample]) < sampleTimeout_us)
+  {
+    return lastOutput;
+  }
+
+  addSample(now_us, reading);
+
+  if(sampleCount >= 2)
+  {
+    lastOutput = fitSlope();
+  }
+
+  return lastOutput;
+}
+
+FeedbackDevice_Status LeastSquaresVelocity::getFeedbackStatus()
+{
+  return status;
+}
@@ -0,0 +1,80 @@
+#ifndef ROVEJOINTCONTROL_LEASTSQUARESVELOCITY_H_
+#define ROVEJOINTCONTROL_LEASTSQUARESVELOCITY_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+
+//Feedback device who estimates an axis's velocity from a position feedback device, by fitting a least squares line
+//through the last several position readings and the micros() times they were taken at. Unlike VelocityDeriver it
+//isn't limited to whole milliseconds, and rather than the noise of a single difference being low pass filtered, the
+//fit averages it out over the window, which lags by only half the window's length.
+//
+//Readings identical to the last one are taken to mean the sensor hasn't updated yet, and are left out so they don't
+//drag the estimate towards 0; so it can be polled faster than the sensor updates. If the reading stays the same for
+//longer than the sample timeout though, the axis is taken to really be holding still.
+//see the readme.md for more info
+class LeastSquaresVelocity: public FeedbackDevice
+{
+  public:
+    static const uint8_t MaxSamples = 16;
+
+  private:
+
+    //The feedback device providing the position data on this axis
+    FeedbackDevice* const posDev;
+
+    //ring buffer of the readings in the window. Positions are unwrapped, IE they keep counting past 360 degrees
+    //instead of rolling over, so the fit never sees a jump
+    uint32_t sampleTimes_us[MaxSamples];
+    long samplePositions[MaxSamples];
+    uint8_t newestSample;
+    uint8_t sampleCount;
+    uint8_t windowSize;
+
+    //the last raw reading, to spot duplicates and to unwrap the next one against
+    long lastReading;
+
+    //how long a reading can stay the same before it's counted again
+    uint32_t sampleTimeout_us;
+
+    long lastOutput;
+    FeedbackDevice_Status status;
+
+    //adds a reading to the window
+    void addSample(uint32_t time_us, long reading);
+
+    //fits the line through the window, returning its slope in milli-degrees/s
+    long fitSlope();
+
+  public:
+
+    //Constructor.
+    //
+    //Inputs: posSensor:  A feedback device who reads positional data.
+    //        window:     how many readings to fit the line through, 2 to MaxSamples. More is smoother, but lags more;
+    //                    the lag is about half the time the window spans
+    //
+    //warning: Function will block the program in an infinite fault loop if posSensor doesn't give out position data.
+    LeastSquaresVelocity(FeedbackDevice* posSensor, uint8_t window);
+
+    //overview: reads the position sensor and returns the present velocity of the axis, between SPEED_MIN and SPEED_MAX.
+    //          Until there are two readings in the window, returns 0.
+    long getFeedback();
+
+    //checks to see what the status is of the feedback device. Call getFeedback() to update the status, then
+    //call this to see if the operation had any issues.
+    FeedbackDevice_Status getFeedbackStatus();
+
+    //sets how many readings to fit the line through, 2 to MaxSamples. Clears the window.
+    void setWindowSize(uint8_t window);
+
+    //sets how long, in microseconds, a reading has to stay the same before it's taken as the axis holding still rather
+    //than the sensor not having updated. Should be a bit longer than the sensor's update period. Default is 10ms.
+    void setSampleTimeout(uint32_t timeout_us);
+
+    //empties the window
+    void reset();
+};
+
+#endif
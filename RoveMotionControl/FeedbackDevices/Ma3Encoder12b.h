@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "../AbstractFramework.h"
+#include "../RoveFixedPoint.h"
 #include "RoveBoard.h"
 
 //represents the MA3 encoder, 12 bit version. This encoder is used to get the current position of an arm shaft. Note that this class expects the
@@ -17,7 +18,7 @@ class Ma3Encoder12b: public FeedbackDevice
     short lastReading;
     uint32_t pwmMax;
     bool reversed;
-    float filterConstant;
+    MotionReal filterConstant;
     uint32_t disconnectCount;
     uint32_t millisLastReading;
     long lastReturn;
@@ -2,12 +2,15 @@
 #define ROVEJOINTCONTROL_PIALGORITHM_H_
 
 #include "../AbstractFramework.h"
+#include "../RoveFixedPoint.h"
+#include "PositionRoutePlanner.h"
 #include "../RoveMotionUtilities.h"
 
 //represents a PI loop algorithm, used to convert position to power percent.
 //see the readme.md for more info.
 class PIAlgorithm : public IOConverter
 {
+  template<class, class, class> friend class StaticAxis;
 
   private:
 
@@ -17,7 +20,7 @@ class PIAlgorithm : public IOConverter
     //pointer to the feedback device used by this algorithm
     FeedbackDevice * feedbackDev;
 
-    float deg_deadBand;//when the axis is within this many degrees of its destination, it stops
+    MotionReal deg_deadBand;//when the axis is within this many degrees of its destination, it stops
     
     //Ki and Kp are PI loop values needed to calculate the output.
     int KI, KP;
@@ -29,28 +32,17 @@ class PIAlgorithm : public IOConverter
     
     //dT represents the time slice constant in seconds for this control loop. It should be externally looped, with dt representing 
     //how many seconds pass in between calls to the control loop. 
-    float DT;
+    MotionReal DT;
 
     //ErrorSummation keeps track of how large our previous errors were when trying to get to the desired destination, used to 
     //calculate power output in the PI loop
-    float errorSummation;
+    MotionReal errorSummation;
 
-    //hardStops one and two track physical stops that the axis can't move through like walls.
-    //Initialized to -1 as a value representing they're unassigned
-    float hardStopPos1, hardStopPos2;
+    //finds which way to go around to the destination without running through the hard stops, if any are set
+    PositionRoutePlanner routePlanner;
 
     //overview: Function that converts rotation units into something that can be worked with more easily such as degrees.
-    float dist360(int pos_ru);
-    
-    //overview: finds the shortest path between two positions in degrees.
-    //          Note that this function doesn't consider things like hard stops, so it shouldn't be used to find the BEST path.
-    //          Built to be called by calcRouteToDest as a part of its calculations.
-    float calcShortPath(float present, float dest);
-    
-    //overview: calculates the best route to the destination in distance in degrees from the current position in degrees.
-    //
-    //Returns:  IMPOSSIBLE_MOVEMENT if it can't reach the destination. Otherwise returns calculated route in degrees.
-    float calcRouteToDest(float present, float dest);
+    MotionReal dist360(long pos_ru);
     
     //checks if the feedback device the class obtained on construction can work with the class or not.
     //Sets the valid construction flag depending on the results.
@@ -75,6 +67,8 @@ class PIAlgorithm : public IOConverter
     long addToOutput(const long inputValue, const long calculatedOutput);
 
   public:
+    static const ValueType StaticInType = InputPosition;
+    static const ValueType StaticOutType = InputPowerPercent;
 
     // Input: inKI, the integer representing the PI constant Ki
     //        inKP, the integer representing the PI constant Kp
@@ -0,0 +1,272 @@
+#include "PIDConverter.h"
+#include "RoveBoard.h"
+#include <math.h>
+#include "../RoveMotionUtilities.h"
+#include "../RoveMotionProfiler.h"
+
+static const int DEFAULT_MINMAG = (POWERPERCENT_MAX * .1); //The default min magnitude of power the motor is allowed to move at. 10% of motor power
+static const float DERIVATIVE_FILTER_RATIO = 10; //default derivative filter time is the derivative time divided by this
+static const long POS_RANGE = POS_MAX - POS_MIN;
+
+PIDConverter::PIDConverter(float inKP, float inKI, float inKD, float inDT, FeedbackDevice* fDev)
+  : PIDConverter(inKP, inKI, inKD, inDT, fDev, DEFAULT_MINMAG)
+{
+}
+
+PIDConverter::PIDConverter(float inKP, float inKI, float inKD, float inDT, FeedbackDevice* fDev, int inpower_minMag)
+  : IOConverter(InputPosition, InputPowerPercent), feedbackDev(fDev), deg_deadBand(1), KP(inKP), KI(inKI), KD(inKD),
+    power_minMag(inpower_minMag), DT(inDT), setpointWeight(1), KVff(0), KAff(0), ffSpeed(0), ffAcceleration(0),
+    integralTerm(0), derivativeTerm(0), lastPosition(0), hasLastPosition(false), lastDestination(0),
+    deg_destination(0), hasDestination(false)
+{
+  if(feedbackDev->getFeedbackType() == inType && inDT > 0)
+  {
+    validConstruction = true;
+  }
+  else
+  {
+    validConstruction = false;
+  }
+
+  if(inKP > 0)
+  {
+    derivativeFilterTime = (inKD / inKP) / DERIVATIVE_FILTER_RATIO;
+  }
+  else
+  {
+    derivativeFilterTime = 0;
+  }
+
+  if(inKI > 0 && inKP > 0)
+  {
+    float integralTime = inKP / inKI;
+    trackingTime = inKD > 0 ? sqrtf(integralTime * inKD / inKP) : integralTime;
+  }
+  else
+  {
+    trackingTime = 0;
+  }
+
+  calculateCoefficients();
+}
+
+void PIDConverter::calculateCoefficients()
+{
+  float dt = motionToFloat(DT);
+
+  //backwards euler of KD * s / (1 + Tf * s), run on the measurement
+  if(dt > 0)
+  {
+    derivativeDecay = derivativeFilterTime / (derivativeFilterTime + dt);
+    derivativeGain = motionToFloat(KD) / (derivativeFilterTime + dt);
+  }
+
+  //tracking times shorter than a tick would overcorrect, so they just take out the whole excess each tick
+  if(trackingTime > dt)
+  {
+    trackingGain = dt / trackingTime;
+  }
+  else
+  {
+    trackingGain = 1;
+  }
+}
+
+long PIDConverter::shortStep(long pos_step)
+{
+  if(pos_step > POS_RANGE / 2)
+  {
+    return pos_step - POS_RANGE;
+  }
+  else if(pos_step < -POS_RANGE / 2)
+  {
+    return pos_step + POS_RANGE;
+  }
+  return pos_step;
+}
+
+MotionReal PIDConverter::dist360(long pos_rotationUnits)
+{
+  return motionRatio(pos_rotationUnits * 360, POS_RANGE);
+}
+
+void PIDConverter::setHardStopPositions(float hardStopPos1_deg, float hardStopPos2_deg)
+{
+  if(!(hardStopPos1_deg == -1 || hardStopPos2_deg == -1))
+  {
+    //round to the nearest position unit, so whole degrees land exactly where destinations in whole degrees do
+    routePlanner.setHardStops(abs(hardStopPos1_deg) * POS_RANGE / 360.0 + 0.5, abs(hardStopPos2_deg) * POS_RANGE / 360.0 + 0.5);
+  }
+  else
+  {
+    routePlanner.clearHardStops();
+  }
+}
+
+long PIDConverter::addToOutput(const long inputValue, const long calculatedOutput)
+{
+  IOConverter_Status dummy;
+  return runAlgorithm(inputValue, calculatedOutput, &dummy);
+}
+
+long PIDConverter::runAlgorithm(const long input, IOConverter_Status * ret_status)
+{
+  return runAlgorithm(input, 0, ret_status);
+}
+
+long PIDConverter::runAlgorithm(const long input, const long oldOutput, IOConverter_Status * ret_status)
+{
+  if (validConstruction == false)
+  {
+    ret_status->flags = IOConverter_AlgorithmFail;
+    return 0;
+  }
+
+  long posNow;
+  ROVEMOTION_PROFILE(feedbackDev, ProfileSite_Feedback, posNow = feedbackDev->getFeedback());
+
+  if(feedbackDev->getFeedbackStatus() != FeedbackStatus_Success)
+  {
+    ret_status->flags = IOConverter_FeedbackFail;
+    ret_status->failedDevice = feedbackDev;
+    return 0;
+  }
+
+  long routeToDest = routePlanner.routeTo(posNow, input);
+  if(routeToDest == PositionRoutePlanner::ImpossibleRoute)
+  {
+    ret_status->flags = IOConverter_AlgorithmFail;
+    return 0;
+  }
+
+  MotionReal deg_disToDest = dist360(routeToDest);
+
+  //derivative on measurement, so only the axis moving drives it, never the destination changing.
+  //Movement between runs is small, so wrap it the short way around
+  if(hasLastPosition)
+  {
+    derivativeTerm = derivativeDecay * derivativeTerm - derivativeGain * dist360(shortStep(posNow - lastPosition));
+  }
+  lastPosition = posNow;
+  hasLastPosition = true;
+
+  //the destination measured from where the axis stood on the first run, IE the distance to it then, plus every change
+  //in it since, each taken the short way around
+  if(!hasDestination)
+  {
+    deg_destination = deg_disToDest;
+    hasDestination = true;
+  }
+  else if(input != lastDestination)
+  {
+    deg_destination += dist360(shortStep(input - lastDestination));
+  }
+  lastDestination = input;
+
+  //within the deadband and the destination isn't going anywhere, so the move's done
+  if(-deg_deadBand < deg_disToDest && deg_disToDest < deg_deadBand && ffSpeed == 0)
+  {
+    ret_status->flags = IOConverter_Complete;
+
+    if(supportIsPersistant)
+    {
+      return supportingAlgorithm->addToOutput(input, oldOutput);
+    }
+    else
+    {
+      return 0;
+    }
+  }
+
+  //setpoint weighting: the proportional term works on (weight * destination - position), with both measured from
+  //where the axis started, which comes out as the error minus the unweighted part of the destination
+  MotionReal proportionalTerm = KP * (deg_disToDest - (MotionReal(1) - setpointWeight) * deg_destination);
+  MotionReal feedforwardTerm = KVff * ffSpeed + KAff * ffAcceleration;
+
+  long unclamped = motionToLong(proportionalTerm + integralTerm + derivativeTerm + feedforwardTerm);
+
+  // if there's a supporting algorithm attached, run its output as well
+  if(supportUsed)
+  {
+    unclamped += supportingAlgorithm->addToOutput(input, unclamped + oldOutput);
+  }
+
+  long pwr_out = constrain(unclamped, POWERPERCENT_MIN, POWERPERCENT_MAX);
+
+  //back-calculation: integrate the error as usual, but while the output's clamped also bleed off the part of the
+  //output that the clamp cut away, so the integral never winds up past what the motor can actually deliver.
+  //The bleed only ever unwinds the integral towards 0, so the result is kept between 0 and the integrated value. Past 0,
+  //when it's the proportional term saturating the output, it would leave the integral wound up backwards once the axis
+  //arrives; and when the clamp is on the other side from the integral, it would wind it up further instead
+  if(KI != 0)
+  {
+    MotionReal integrated = integralTerm + KI * deg_disToDest * DT;
+    MotionReal unwound = integrated + trackingGain * MotionReal(pwr_out - unclamped);
+
+    if(integrated >= 0)
+    {
+      unwound = constrain(unwound, MotionReal(0), integrated);
+    }
+    else
+    {
+      unwound = constrain(unwound, integrated, MotionReal(0));
+    }
+    integralTerm = unwound;
+  }
+
+  //bumping up to the minimum magnitude is a quirk of the motor, not a saturation, so it's left out of the anti-windup
+  if (pwr_out < power_minMag && pwr_out > 0)
+  {
+    pwr_out = power_minMag;
+  }
+  else if (pwr_out > -power_minMag && pwr_out < 0)
+  {
+    pwr_out = -power_minMag;
+  }
+
+  ret_status->flags = IOConverter_RunAgain;
+
+  return pwr_out;
+}
+
+void PIDConverter::setDeadband(float degrees)
+{
+  deg_deadBand = degrees;
+}
+
+void PIDConverter::setSetpointWeight(float weight)
+{
+  setpointWeight = constrain(weight, 0, 1);
+}
+
+void PIDConverter::setDerivativeFilterTime(float seconds)
+{
+  derivativeFilterTime = seconds > 0 ? seconds : 0;
+  calculateCoefficients();
+}
+
+void PIDConverter::setAntiWindupTime(float seconds)
+{
+  trackingTime = seconds > 0 ? seconds : 0;
+  calculateCoefficients();
+}
+
+void PIDConverter::setFeedforwardGains(float speedGain, float accelerationGain)
+{
+  KVff = speedGain;
+  KAff = accelerationGain;
+}
+
+void PIDConverter::setFeedforward(float speed, float acceleration)
+{
+  ffSpeed = speed;
+  ffAcceleration = acceleration;
+}
+
+void PIDConverter::reset()
+{
+  integralTerm = 0;
+  derivativeTerm = 0;
+  hasLastPosition = false;
+  hasDestination = false;
+}
@@ -0,0 +1,148 @@
+#ifndef ROVEJOINTCONTROL_PIDCONVERTER_H_
+#define ROVEJOINTCONTROL_PIDCONVERTER_H_
+
+#include "../AbstractFramework.h"
+#include "../RoveFixedPoint.h"
+#include "PositionRoutePlanner.h"
+#include "../RoveMotionUtilities.h"
+
+//represents a full PID loop algorithm, used to convert position to power percent. Compared to PIAlgorithm it adds:
+//  -a derivative term, taken on the measured position rather than the error so that a new destination doesn't kick it,
+//   and low pass filtered so encoder noise doesn't get amplified straight into the output
+//  -back-calculation anti-windup: while the output is clamped, the integral is bled back towards 0 by however much the
+//   clamp cut off, instead of integration simply stopping
+//  -setpoint weighting on the proportional term, to soften the jump in output when a new destination is given
+//  -velocity and acceleration feedforward inputs, for when something upstream like TrajectoryConverter knows how the
+//   destination is moving
+//see the readme.md for more info.
+class PIDConverter : public IOConverter
+{
+  template<class, class, class> friend class StaticAxis;
+
+  private:
+
+    //This flag tracks whether or not the feedback device given to the algorithm is a proper fit for the algorithm
+    bool validConstruction;
+
+    //pointer to the feedback device used by this algorithm
+    FeedbackDevice * feedbackDev;
+
+    MotionReal deg_deadBand;//when the axis is within this many degrees of its destination, it stops
+
+    //the PID gains, in power percent per degree, per degree*second and per degree/second
+    MotionReal KP, KI, KD;
+
+    //the smallest power (absolute value) the motor is allowed to move at when it's not simply stopping
+    int power_minMag;
+
+    //time in seconds between calls to the control loop
+    MotionReal DT;
+
+    //how much of the destination the proportional term sees, 0 to 1. 1 is a plain PID
+    MotionReal setpointWeight;
+
+    //time constant of the derivative filter, and of the anti-windup tracking, in seconds
+    float derivativeFilterTime, trackingTime;
+
+    //the above turned into the coefficients used every run
+    MotionReal derivativeDecay, derivativeGain, trackingGain;
+
+    //feedforward gains, in power percent per degree/s and per degree/s^2, and the present feedforward inputs
+    MotionReal KVff, KAff;
+    MotionReal ffSpeed, ffAcceleration;
+
+    //the integral term, kept in power percent so that the anti-windup can correct it directly
+    MotionReal integralTerm;
+
+    //the filtered derivative term, in power percent
+    MotionReal derivativeTerm;
+
+    //the position last read, for the derivative
+    long lastPosition;
+    bool hasLastPosition;
+
+    //the destination last given, and the destination in degrees measured from where the axis stood on the first run
+    //since a reset. Setpoint weighting works on the latter, so it follows every change of destination the same way
+    //whether they come as one big step or as a stream of small ones
+    long lastDestination;
+    MotionReal deg_destination;
+    bool hasDestination;
+
+    //finds which way to go around to the destination without running through the hard stops, if any are set
+    PositionRoutePlanner routePlanner;
+
+    //overview: Function that converts rotation units into something that can be worked with more easily such as degrees.
+    MotionReal dist360(long pos_ru);
+
+    //wraps a change in position the short way around, so it's within half a rotation either way
+    long shortStep(long pos_step);
+
+    //works out derivativeDecay, derivativeGain and trackingGain from the gains and time constants
+    void calculateCoefficients();
+
+    //run algorithm implementation, see the abstract class for more info
+    long runAlgorithm(const long input, IOConverter_Status * ret_status);
+
+    //internal instance of runAlgorithm that's designed to be able to service runAlgorithm(long, bool*) or addToOutput.
+    long runAlgorithm(const long input, const long oldOutput, IOConverter_Status * ret_status);
+
+    //function to be called when class is acting as a support algorithm to another IOConverter.
+    long addToOutput(const long inputValue, const long calculatedOutput);
+
+  public:
+    static const ValueType StaticInType = InputPosition;
+    static const ValueType StaticOutType = InputPowerPercent;
+
+    //Overview: constructor.
+    //
+    //Inputs:   inKP: proportional gain, power percent per degree of error
+    //          inKI: integral gain, power percent per degree*second of error
+    //          inKD: derivative gain, power percent per degree/second the axis is moving
+    //          inDT: time in seconds between calls of runAlgorithm. The loop is meant to be put into a timed loop by the
+    //                main program until it's finished.
+    //          fDev: the position feedback device on the axis
+    //
+    //The derivative filter defaults to a tenth of the derivative time (KD/KP), and the anti-windup tracking time to the
+    //geometric mean of the integral and derivative times, or the integral time alone with no derivative.
+    PIDConverter(float inKP, float inKI, float inKD, float inDT, FeedbackDevice* fDev);
+
+    //Same as above, but with the slowest power the motor is allowed to move at when not simply stopping
+    PIDConverter(float inKP, float inKI, float inKD, float inDT, FeedbackDevice* fDev, int inpower_minMag);
+
+    //overview: function for specifying positions of hard stops attached to this axis,
+    //          that is positions in degrees that the axis can't travel through.
+    //          To disable hard stops, set one or both to -1.
+    void setHardStopPositions(float hardStopPos1_deg, float hardStopPos2_deg);
+
+    //sets the deadband, in degrees. When it gets within this many degrees of its destination, and isn't being fed a
+    //feedforward speed, it stops.
+    void setDeadband(float degrees);
+
+    //sets how much of the destination the proportional term sees, from 0 to 1; the proportional term works on
+    //weight * destination - position. At 1 (the default) a new destination makes the proportional term jump by KP
+    //times the distance; lower values take some of that jump out and leave the integral to make up the difference,
+    //trading a bit of speed for less overshoot. The whole difference is left to the integral, so only lower it on loops
+    //with a strong integral term.
+    void setSetpointWeight(float weight);
+
+    //sets the time constant of the derivative filter in seconds. Larger filters more noise, but lags more.
+    void setDerivativeFilterTime(float seconds);
+
+    //sets the anti-windup tracking time constant in seconds; how quickly the integral is pulled back while the output
+    //is clamped. Smaller pulls back harder.
+    void setAntiWindupTime(float seconds);
+
+    //sets the feedforward gains, in power percent per degree/s and per degree/s^2. Both default to 0.
+    void setFeedforwardGains(float speedGain, float accelerationGain);
+
+    //overview: sets the feedforward inputs, IE how fast and how hard the destination itself is moving. Stays in
+    //          effect until changed; set both to 0 when the destination stops.
+    //inputs:   speed: in degrees/s, positive in the direction of increasing position
+    //          acceleration: in degrees/s^2
+    void setFeedforward(float speed, float acceleration);
+
+    //clears the integral and derivative history, so the next run starts fresh
+    void reset();
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "PositionRoutePlanner.h"
+
+static const long POS_RANGE = POS_MAX - POS_MIN;
+
+PositionRoutePlanner::PositionRoutePlanner()
+  : lowStop(0), highStop(0), hasStops(false)
+{
+}
+
+long PositionRoutePlanner::wrap(long position)
+{
+  position = (position - (long)POS_MIN) % POS_RANGE;
+  if(position < 0)
+  {
+    position += POS_RANGE;
+  }
+  return position;
+}
+
+long PositionRoutePlanner::unwrap(long position)
+{
+  return position < lowStop ? position + POS_RANGE : position;
+}
+
+long PositionRoutePlanner::shortestRoute(long present, long destination)
+{
+  //one way around is always at most half a circle; exactly half defaults to positive
+  long route = destination - present;
+  if(route > POS_RANGE / 2)
+  {
+    route -= POS_RANGE;
+  }
+  else if(route <= -POS_RANGE / 2)
+  {
+    route += POS_RANGE;
+  }
+  return route;
+}
+
+void PositionRoutePlanner::setHardStops(long stopPos1, long stopPos2)
+{
+  stopPos1 = wrap(stopPos1);
+  stopPos2 = wrap(stopPos2);
+
+  lowStop = stopPos1 < stopPos2 ? stopPos1 : stopPos2;
+  highStop = stopPos1 < stopPos2 ? stopPos2 : stopPos1;
+  hasStops = true;
+}
+
+void PositionRoutePlanner::clearHardStops()
+{
+  hasStops = false;
+}
+
+long PositionRoutePlanner::routeTo(long present, long destination)
+{
+  present = wrap(present);
+  destination = wrap(destination);
+
+  if(present == destination)
+  {
+    return 0;
+  }
+
+  if(!hasStops)
+  {
+    return shortestRoute(present, destination);
+  }
+
+  if(destination == lowStop || destination == highStop)
+  {
+    return ImpossibleRoute;
+  }
+
+  //the inner arc runs between the stops without crossing the 0 position, the outer arc is everything else
+  bool destInner = lowStop < destination && destination < highStop;
+
+  //sitting right on a stop, there's no telling which side of it the axis is on. So only go the short way, and only
+  //if that doesn't run through the other stop
+  if(present == lowStop || present == highStop)
+  {
+    long route = shortestRoute(present, destination);
+    long arcRoute;
+
+    if(lowStop == highStop)
+    {
+      return route;
+    }
+    else if(destInner)
+    {
+      arcRoute = destination - present;
+    }
+    else
+    {
+      arcRoute = unwrap(destination) - (present == lowStop ? lowStop + POS_RANGE : highStop);
+    }
+
+    return route == arcRoute ? route : ImpossibleRoute;
+  }
+
+  bool presentInner = lowStop < present && present < highStop;
+
+  if(destInner != presentInner)
+  {
+    return ImpossibleRoute;
+  }
+  else if(destInner)
+  {
+    return destination - present;
+  }
+  else
+  {
+    return unwrap(destination) - unwrap(present);
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef ROVEJOINTCONTROL_POSITIONROUTEPLANNER_H_
+#define ROVEJOINTCONTROL_POSITIONROUTEPLANNER_H_
+
+#include <stdint.h>
+#include "../RoveMotionUtilities.h"
+
+//Finds the route an axis should take from one position to another, in the framework's position units, without
+//running through any hard stops. Used by the position loops (PIAlgorithm, PIVConverter) to decide which way to go.
+//
+//Two hard stops split the circle into two arcs, and an axis between them can only ever reach positions in its own arc,
+//by the one path that stays inside it. So the arcs are worked out once when the stops are set, and finding a route
+//is just checking which arc the present and destination positions are in.
+//see the readme.md for more info.
+class PositionRoutePlanner
+{
+  private:
+
+    //the stops, lowest first, in position units between 0 and the range. Meaningless if hasStops is false
+    long lowStop, highStop;
+    bool hasStops;
+
+    //wraps a position into 0 to the range
+    static long wrap(long position);
+
+    //the shorter way around from one wrapped position to another
+    static long shortestRoute(long present, long destination);
+
+    //moves positions below the low stop up by a full circle, so that the arc from the high stop around to the low
+    //stop is one continuous span
+    long unwrap(long position);
+
+  public:
+
+    //returned by routeTo when the destination can't be reached
+    static const long ImpossibleRoute = 2 * (long)(POS_MAX - POS_MIN);
+
+    //constructs a planner with no hard stops
+    PositionRoutePlanner();
+
+    //overview: sets the positions of the hard stops, in position units, which the axis can't travel through.
+    //          Positions outside of POS_MIN to POS_MAX are wrapped onto the circle.
+    void setHardStops(long stopPos1, long stopPos2);
+
+    //removes the hard stops, so every route is just the shortest way around
+    void clearHardStops();
+
+    //overview: calculates the best route from the present position to the destination.
+    //
+    //returns:  the distance to travel in position units, positive or negative for direction. Without hard stops it's
+    //          the shortest way, up to half a circle, with exactly half a circle going positive. With hard stops it's
+    //          the only way that doesn't go through one of them, which might be the long way around.
+    //          ImpossibleRoute if the destination is on a hard stop or on the other side of them.
+    long routeTo(long present, long destination);
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include "TrajectoryConverter.h"
+#include "RoveBoard.h"
+
+static const long POS_RANGE = POS_MAX - POS_MIN;
+
+TrajectoryConverter::TrajectoryConverter(IOConverter* positionConverter, FeedbackDevice* posFeedback, float speedLimit, float accelerationLimit, float jerkLimit)
+  : IOConverter(InputPosition, positionConverter->getOutType()), positionLoop(positionConverter), positionFeedback(posFeedback), feedforwardLoop(0),
+    maxSpeed(speedLimit), maxAcceleration(accelerationLimit), maxJerk(jerkLimit), planned(false), profileDone(true), destination(0), startPosition(0),
+    startTime_us(0), setpoint(0), setpointSpeed(0), setpointAcceleration(0)
+{
+  //the position loop has to take position, and the feedback has to give it
+  if(positionConverter->getInType() == InputPosition && posFeedback->getFeedbackType() == InputPosition)
+  {
+    validConstruction = true;
+  }
+  else
+  {
+    validConstruction = false;
+  }
+}
+
+TrajectoryConverter::TrajectoryConverter(PIDConverter* pidLoop, FeedbackDevice* posFeedback, float speedLimit, float accelerationLimit, float jerkLimit)
+  : TrajectoryConverter((IOConverter*)pidLoop, posFeedback, speedLimit, accelerationLimit, jerkLimit)
+{
+  feedforwardLoop = pidLoop;
+}
+
+long TrajectoryConverter::profilePosition(float distanceMoved)
+{
+  long position = (startPosition + (long)(distanceMoved * POS_RANGE / 360.0)) % POS_RANGE;
+  if(position < 0)
+  {
+    position += POS_RANGE;
+  }
+
+  return position;
+}
+
+bool TrajectoryConverter::planMove(long from, long to, float startSpeed, float startAcceleration)
+{
+  long route = routePlanner.routeTo(from, to);
+
+  if(route == PositionRoutePlanner::ImpossibleRoute)
+  {
+    return false;
+  }
+
+  //the profile works in degrees
+  if(!profile.planFrom(route * 360.0 / POS_RANGE, startSpeed, startAcceleration, maxSpeed, maxAcceleration, maxJerk))
+  {
+    return false;
+  }
+
+  startPosition = from;
+  destination = to;
+  startTime_us = micros();
+  planned = true;
+  profileDone = false;
+  return true;
+}
+
+bool TrajectoryConverter::updateSetpoint(long input, IOConverter_Status * ret_status)
+{
+  float distanceMoved;
+  float elapsed;
+
+  if(!validConstruction)
+  {
+    ret_status->flags = IOConverter_AlgorithmFail;
+    return false;
+  }
+
+  if(!planned || input != destination)
+  {
+    long from;
+    float startSpeed = 0, startAcceleration = 0;
+
+    //mid move, carry on from wherever the old profile has got to by now, at the speed and acceleration it's got to, so
+    //the setpoint and its feedforward don't jump. Otherwise start from rest where the axis actually is
+    if(!profileDone)
+    {
+      float moved;
+      profile.evaluate((micros() - startTime_us) / 1000000.0, &moved, &startSpeed, &startAcceleration);
+      from = profilePosition(moved);
+    }
+    else
+    {
+      from = positionFeedback->getFeedback();
+      if(positionFeedback->getFeedbackStatus() != FeedbackStatus_Success)
+      {
+        ret_status->flags = IOConverter_FeedbackFail;
+        ret_status->failedDevice = positionFeedback;
+        return false;
+      }
+    }
+
+    if(!planMove(from, input, startSpeed, startAcceleration))
+    {
+      ret_status->flags = IOConverter_AlgorithmFail;
+      return false;
+    }
+  }
+
+  elapsed = (micros() - startTime_us) / 1000000.0;
+  profile.evaluate(elapsed, &distanceMoved, &setpointSpeed, &setpointAcceleration);
+
+  if(elapsed >= profile.getDuration())
+  {
+    profileDone = true;
+    setpoint = destination;
+    setpointSpeed = 0;
+    setpointAcceleration = 0;
+  }
+  else
+  {
+    setpoint = profilePosition(distanceMoved);
+  }
+
+  if(feedforwardLoop)
+  {
+    feedforwardLoop->setFeedforward(setpointSpeed, setpointAcceleration);
+  }
+
+  return true;
+}
+
+long TrajectoryConverter::runAlgorithm(const long input, IOConverter_Status * ret_status)
+{
+  IOConverter_Status loopStatus;
+  long output;
+
+  if(!updateSetpoint(input, ret_status))
+  {
+    return 0;
+  }
+
+  output = positionLoop->runAlgorithm(setpoint, &loopStatus);
+
+  // if there's a supporting algorithm attached, run its output as well
+  if(supportUsed)
+  {
+    output += supportingAlgorithm->addToOutput(input, output);
+  }
+
+  //the loop reaching its setpoint only means the move is done once the setpoint's at the destination
+  *ret_status = loopStatus;
+  if(loopStatus.flags == IOConverter_Complete && !isProfileDone())
+  {
+    ret_status->flags = IOConverter_RunAgain;
+  }
+
+  return output;
+}
+
+long TrajectoryConverter::addToOutput(const long inputValue, const long calculatedOutput)
+{
+  IOConverter_Status dummy;
+
+  if(!updateSetpoint(inputValue, &dummy))
+  {
+    return 0;
+  }
+
+  return positionLoop->addToOutput(setpoint, calculatedOutput);
+}
+
+void TrajectoryConverter::setLimits(float speedLimit, float accelerationLimit, float jerkLimit)
+{
+  maxSpeed = speedLimit;
+  maxAcceleration = accelerationLimit;
+  maxJerk = jerkLimit;
+}
+
+void TrajectoryConverter::setHardStopPositions(float hardStopPos1_deg, float hardStopPos2_deg)
+{
+  if(!(hardStopPos1_deg == -1 || hardStopPos2_deg == -1))
+  {
+    routePlanner.setHardStops(abs(hardStopPos1_deg) * POS_RANGE / 360.0 + 0.5, abs(hardStopPos2_deg) * POS_RANGE / 360.0 + 0.5);
+  }
+  else
+  {
+    routePlanner.clearHardStops();
+  }
+}
+
+long TrajectoryConverter::getSetpoint()
+{
+  return setpoint;
+}
+
+float TrajectoryConverter::getSetpointSpeed()
+{
+  return setpointSpeed;
+}
+
+bool TrajectoryConverter::isProfileDone()
+{
+  return profileDone;
+}
@@ -0,0 +1,104 @@
+#ifndef ROVEJOINTCONTROL_TRAJECTORYCONVERTER_H_
+#define ROVEJOINTCONTROL_TRAJECTORYCONVERTER_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+#include "PositionRoutePlanner.h"
+#include "TrajectoryProfile.h"
+#include "PIDConverter.h"
+
+//Sits in front of a position loop such as PIAlgorithm or PIVConverter. Rather than handing the loop the destination
+//straight away, which has it jump at the destination with full power, it plans a TrajectoryProfile from where the axis
+//is to the destination and hands the loop a setpoint that moves along it, so the axis speeds up and slows down within
+//the given speed, acceleration and jerk limits.
+//
+//Takes position, and gives out whatever the position loop gives out. The profile is planned once each time the
+//destination changes; each run after that just evaluates it. A new destination given in the middle of a move is
+//planned from wherever the setpoint has got to, carrying on at its present speed and acceleration, so the setpoint and
+//its feedforward stay smooth through the change.
+//see the readme.md for more info.
+class TrajectoryConverter : public IOConverter
+{
+  private:
+
+    //the position loop the setpoints are handed to, and the sensor it follows
+    IOConverter* positionLoop;
+    FeedbackDevice* positionFeedback;
+
+    //the position loop again if it's a PIDConverter, so the setpoint's speed and acceleration can be fed forward to it.
+    //0 otherwise
+    PIDConverter* feedforwardLoop;
+
+    //limits, in degrees/s, degrees/s^2 and degrees/s^3
+    float maxSpeed, maxAcceleration, maxJerk;
+
+    TrajectoryProfile profile;
+    PositionRoutePlanner routePlanner;
+
+    bool validConstruction;
+
+    //whether there's been a destination to plan for yet, and whether the setpoint has reached it
+    bool planned;
+    bool profileDone;
+
+    //the destination and where the profile started from, in position units, and when it started
+    long destination;
+    long startPosition;
+    uint32_t startTime_us;
+
+    //the last setpoint handed to the position loop, in position units, and its speed and acceleration in degrees/s and
+    //degrees/s^2
+    long setpoint;
+    float setpointSpeed;
+    float setpointAcceleration;
+
+    //plans a profile from the given position, speed and acceleration to the destination
+    bool planMove(long from, long to, float startSpeed, float startAcceleration);
+
+    //where the profile has moved the setpoint to, in position units, from how far along it is in degrees
+    long profilePosition(float distanceMoved);
+
+    //plans a new profile if the destination changed, then moves the setpoint along the profile.
+    //returns false and fills in the status if something went wrong
+    bool updateSetpoint(long input, IOConverter_Status * ret_status);
+
+    //run algorithm implementation, see the abstract class for more info
+    long runAlgorithm(const long input, IOConverter_Status * ret_status);
+
+    //function to be called when class is acting as a support algorithm to another IOConverter.
+    long addToOutput(const long inputValue, const long calculatedOutput);
+
+  public:
+
+    //Overview: constructor.
+    //
+    //Inputs:   positionConverter: the position loop to hand setpoints to. Must take position.
+    //          posFeedback: the position feedback device on the axis, used to find where moves start from.
+    //          speedLimit: max speed, in degrees/s
+    //          accelerationLimit: max acceleration, in degrees/s^2
+    //          jerkLimit: max jerk, in degrees/s^3. 0 for no limit, making the moves trapezoidal
+    TrajectoryConverter(IOConverter* positionConverter, FeedbackDevice* posFeedback, float speedLimit, float accelerationLimit, float jerkLimit);
+
+    //Same as above, but for a PIDConverter position loop, which also gets handed the setpoint's speed and acceleration
+    //as its feedforward inputs each run.
+    TrajectoryConverter(PIDConverter* pidLoop, FeedbackDevice* posFeedback, float speedLimit, float accelerationLimit, float jerkLimit);
+
+    //changes the limits. Takes effect at the next new destination
+    void setLimits(float speedLimit, float accelerationLimit, float jerkLimit);
+
+    //overview: function for specifying positions of hard stops, in degrees, that moves have to go around rather than
+    //          through. Should be the same as what the position loop has, if any. To disable, set one or both to -1.
+    void setHardStopPositions(float hardStopPos1_deg, float hardStopPos2_deg);
+
+    //the setpoint last handed to the position loop, in position units
+    long getSetpoint();
+
+    //the speed of the setpoint, in degrees/s
+    float getSetpointSpeed();
+
+    //whether the setpoint has reached the destination. The axis itself might still be catching up to it
+    bool isProfileDone();
+};
+
+#endif
@@ -0,0 +1,388 @@
+#include "TrajectoryProfile.h"
+#include <math.h>
+
+//works out the timing of the phase that accelerates from rest to the given speed (the deceleration phase is its mirror)
+//Tj: time spent jerking up or down. Ta: total time of the phase. peakAccel: the acceleration held in between
+static void accelerationPhase(float speed, float maxAcceleration, float maxJerk, float* Tj, float* Ta, float* peakAccel)
+{
+  if(maxJerk == 0)
+  {
+    *Tj = 0;
+    *peakAccel = maxAcceleration;
+    *Ta = speed / maxAcceleration;
+  }
+  else if(speed * maxJerk < maxAcceleration * maxAcceleration) //jerks up and straight back down without reaching max acceleration
+  {
+    *Tj = sqrtf(speed / maxJerk);
+    *peakAccel = maxJerk * *Tj;
+    *Ta = 2 * *Tj;
+  }
+  else
+  {
+    *Tj = maxAcceleration / maxJerk;
+    *peakAccel = maxAcceleration;
+    *Ta = *Tj + speed / maxAcceleration;
+  }
+}
+
+//works out the three segments that take the speed from one value to another, starting at the given acceleration and
+//ending at none: jerk to a peak acceleration, hold it, jerk back to 0. The peak is whichever way the speed has to go
+//once the starting acceleration has been jerked away, so the speed can overshoot on the way if it starts off
+//accelerating the wrong way
+static void speedChange(float fromSpeed, float fromAccel, float toSpeed, float maxAcceleration, float maxJerk, float durations[3], float startAccels[3], float jerks[3])
+{
+  float change = toSpeed - fromSpeed;
+  float peakAccel;
+
+  if(maxJerk == 0)
+  {
+    peakAccel = change < 0 ? -maxAcceleration : maxAcceleration;
+    durations[0] = 0;                    startAccels[0] = fromAccel;   jerks[0] = 0;
+    durations[1] = change / peakAccel;   startAccels[1] = peakAccel;   jerks[1] = 0;
+    durations[2] = 0;                    startAccels[2] = peakAccel;   jerks[2] = 0;
+    return;
+  }
+
+  //the speed change from just jerking the starting acceleration back to 0
+  float unwind = fromAccel * fabsf(fromAccel) / (2 * maxJerk);
+
+  //with no hold, change = (2 * peak^2 - fromAccel^2) / 2j going up, the negative of that going down
+  if(change >= unwind)
+  {
+    peakAccel = sqrtf((2 * maxJerk * change + fromAccel * fromAccel) / 2);
+    if(peakAccel > maxAcceleration)
+    {
+      peakAccel = maxAcceleration;
+    }
+  }
+  else
+  {
+    peakAccel = -sqrtf((fromAccel * fromAccel - 2 * maxJerk * change) / 2);
+    if(peakAccel < -maxAcceleration)
+    {
+      peakAccel = -maxAcceleration;
+    }
+  }
+
+  float jerkIn = peakAccel < fromAccel ? -maxJerk : maxJerk;
+  float jerkOut = peakAccel < 0 ? maxJerk : -maxJerk;
+  float timeIn = (peakAccel - fromAccel) / jerkIn;
+  float timeOut = -peakAccel / jerkOut;
+  float holdTime = 0;
+
+  //whatever the jerks don't cover is made up holding the peak
+  if(peakAccel != 0)
+  {
+    holdTime = (change - (fromAccel + peakAccel) / 2 * timeIn - peakAccel / 2 * timeOut) / peakAccel;
+    if(holdTime < 0)
+    {
+      holdTime = 0;
+    }
+  }
+
+  durations[0] = timeIn;     startAccels[0] = fromAccel;   jerks[0] = jerkIn;
+  durations[1] = holdTime;   startAccels[1] = peakAccel;   jerks[1] = 0;
+  durations[2] = timeOut;    startAccels[2] = peakAccel;   jerks[2] = jerkOut;
+}
+
+TrajectoryProfile::TrajectoryProfile()
+{
+  plan(0, 1, 1, 0);
+}
+
+void TrajectoryProfile::clear()
+{
+  direction = 1;
+  distance = 0;
+  totalTime = 0;
+  lastSegment = 0;
+  for(int i = 0; i < SegmentCount; i++)
+  {
+    segments[i].startTime = segments[i].duration = segments[i].position = 0;
+    segments[i].speed = segments[i].acceleration = segments[i].jerk = 0;
+  }
+}
+
+float TrajectoryProfile::integrateSegments(float startSpeed, const float durations[], const float startAccels[], const float jerks[])
+{
+  float time = 0, position = 0, speed = startSpeed;
+
+  //integrate through the segments to get the state at the start of each one
+  for(int i = 0; i < SegmentCount; i++)
+  {
+    float dt = durations[i];
+    float a = startAccels[i];
+    float j = jerks[i];
+
+    segments[i].startTime = time;
+    segments[i].duration = dt;
+    segments[i].position = position;
+    segments[i].speed = speed;
+    segments[i].acceleration = a;
+    segments[i].jerk = j;
+
+    position += speed * dt + a * dt * dt / 2 + j * dt * dt * dt / 6;
+    speed += a * dt + j * dt * dt / 2;
+    time += dt;
+  }
+
+  totalTime = time;
+  return position;
+}
+
+bool TrajectoryProfile::plan(float moveDistance, float maxSpeed, float maxAcceleration, float maxJerk)
+{
+  float D = fabsf(moveDistance);
+  float peakSpeed, cruiseTime, Tj, Ta, peakAccel;
+  float durations[SegmentCount];
+  float startAccels[SegmentCount];
+  float jerks[SegmentCount];
+
+  clear();
+  direction = moveDistance < 0 ? -1 : 1;
+
+  if(maxSpeed <= 0 || maxAcceleration <= 0 || maxJerk < 0)
+  {
+    return false;
+  }
+  else if(D == 0)
+  {
+    return true;
+  }
+
+  //if accelerating to full speed and back down covers the distance or less, there's a cruise in between. The phases are
+  //symmetric, so together they cover speed * Ta
+  accelerationPhase(maxSpeed, maxAcceleration, maxJerk, &Tj, &Ta, &peakAccel);
+  if(maxSpeed * Ta <= D)
+  {
+    peakSpeed = maxSpeed;
+    cruiseTime = (D - maxSpeed * Ta) / maxSpeed;
+  }
+
+  //otherwise find the top speed whose two phases cover exactly the distance
+  else
+  {
+    if(maxJerk == 0)
+    {
+      //D = v^2 / a
+      peakSpeed = sqrtf(D * maxAcceleration);
+    }
+    else
+    {
+      //assuming it still reaches max acceleration, D = v * (a / j + v / a)
+      float aOverJ = maxAcceleration / maxJerk;
+      peakSpeed = maxAcceleration / 2 * (-aOverJ + sqrtf(aOverJ * aOverJ + 4 * D / maxAcceleration));
+
+      //if not, D = 2 * v * sqrt(v / j)
+      if(peakSpeed * maxJerk < maxAcceleration * maxAcceleration)
+      {
+        peakSpeed = cbrtf(D * D * maxJerk / 4);
+      }
+    }
+
+    cruiseTime = 0;
+    accelerationPhase(peakSpeed, maxAcceleration, maxJerk, &Tj, &Ta, &peakAccel);
+  }
+
+  float holdTime = Ta - 2 * Tj;
+  if(holdTime < 0)
+  {
+    holdTime = 0;
+  }
+
+  durations[0] = Tj;         startAccels[0] = 0;           jerks[0] = maxJerk;
+  durations[1] = holdTime;   startAccels[1] = peakAccel;   jerks[1] = 0;
+  durations[2] = Tj;         startAccels[2] = peakAccel;   jerks[2] = -maxJerk;
+  durations[3] = cruiseTime; startAccels[3] = 0;           jerks[3] = 0;
+  durations[4] = Tj;         startAccels[4] = 0;           jerks[4] = -maxJerk;
+  durations[5] = holdTime;   startAccels[5] = -peakAccel;  jerks[5] = 0;
+  durations[6] = Tj;         startAccels[6] = -peakAccel;  jerks[6] = maxJerk;
+
+  integrateSegments(0, durations, startAccels, jerks);
+  distance = D;
+  return true;
+}
+
+float TrajectoryProfile::layOutFrom(float startSpeed, float startAcceleration, float peakSpeed, float cruiseTime, float maxAcceleration, float maxJerk)
+{
+  float durations[SegmentCount];
+  float startAccels[SegmentCount];
+  float jerks[SegmentCount];
+
+  speedChange(startSpeed, startAcceleration, peakSpeed, maxAcceleration, maxJerk, &durations[0], &startAccels[0], &jerks[0]);
+  durations[3] = cruiseTime;   startAccels[3] = 0;   jerks[3] = 0;
+  speedChange(peakSpeed, 0, 0, maxAcceleration, maxJerk, &durations[4], &startAccels[4], &jerks[4]);
+
+  return integrateSegments(startSpeed, durations, startAccels, jerks);
+}
+
+bool TrajectoryProfile::planFrom(float moveDistance, float startSpeed, float startAcceleration, float maxSpeed, float maxAcceleration, float maxJerk)
+{
+  float D = fabsf(moveDistance);
+  float peakSpeed, cruiseTime, covered;
+
+  if(startSpeed == 0 && startAcceleration == 0)
+  {
+    return plan(moveDistance, maxSpeed, maxAcceleration, maxJerk);
+  }
+
+  clear();
+  if(maxSpeed <= 0 || maxAcceleration <= 0 || maxJerk < 0)
+  {
+    return false;
+  }
+
+  //plan as if the move were forwards
+  direction = moveDistance < 0 ? -1 : 1;
+  startSpeed *= direction;
+  startAcceleration *= direction;
+
+  //getting to a cruising speed and back to rest covers more distance the higher that speed is. If it's still short at
+  //full speed, cruise at full speed for the rest. If even full speed backwards overshoots, cruise backwards
+  covered = layOutFrom(startSpeed, startAcceleration, maxSpeed, 0, maxAcceleration, maxJerk);
+  if(covered <= D)
+  {
+    peakSpeed = maxSpeed;
+    cruiseTime = (D - covered) / maxSpeed;
+  }
+  else if((covered = layOutFrom(startSpeed, startAcceleration, -maxSpeed, 0, maxAcceleration, maxJerk)) >= D)
+  {
+    peakSpeed = -maxSpeed;
+    cruiseTime = (covered - D) / maxSpeed;
+  }
+
+  //otherwise find the cruising speed whose phases cover exactly the distance. There's no closed form with the start
+  //speed and acceleration in there, so bisect; planning only happens once per destination
+  else
+  {
+    float low = -maxSpeed, high = maxSpeed;
+    for(int i = 0; i < 32; i++)
+    {
+      float mid = (low + high) / 2;
+      if(layOutFrom(startSpeed, startAcceleration, mid, 0, maxAcceleration, maxJerk) < D)
+      {
+        low = mid;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+
+    peakSpeed = (low + high) / 2;
+    cruiseTime = 0;
+  }
+
+  layOutFrom(startSpeed, startAcceleration, peakSpeed, cruiseTime, maxAcceleration, maxJerk);
+  distance = D;
+  return true;
+}
+
+bool TrajectoryProfile::planFromWithDuration(float moveDistance, float startSpeed, float startAcceleration, float maxSpeed, float maxAcceleration, float maxJerk, float duration)
+{
+  if(startSpeed == 0 && startAcceleration == 0)
+  {
+    return planWithDuration(moveDistance, maxSpeed, maxAcceleration, maxJerk, duration);
+  }
+
+  if(!planFrom(moveDistance, startSpeed, startAcceleration, maxSpeed, maxAcceleration, maxJerk))
+  {
+    return false;
+  }
+
+  //a lower speed limit only ever makes the move longer, so bisect on it. Ending on the faster side means the profile
+  //finishes at most a hair early
+  if(duration > totalTime)
+  {
+    float low = 0, high = maxSpeed;
+    for(int i = 0; i < 24; i++)
+    {
+      float mid = (low + high) / 2;
+      planFrom(moveDistance, startSpeed, startAcceleration, mid, maxAcceleration, maxJerk);
+      if(totalTime > duration)
+      {
+        low = mid;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+
+    return planFrom(moveDistance, startSpeed, startAcceleration, high, maxAcceleration, maxJerk);
+  }
+
+  return true;
+}
+
+bool TrajectoryProfile::planWithDuration(float moveDistance, float maxSpeed, float maxAcceleration, float maxJerk, float duration)
+{
+  if(!plan(moveDistance, maxSpeed, maxAcceleration, maxJerk))
+  {
+    return false;
+  }
+
+  //stretching a profile's time by k is the same as planning it with speed, acceleration and jerk limits divided by
+  //k, k^2 and k^3
+  if(totalTime > 0 && duration > totalTime)
+  {
+    float k = duration / totalTime;
+    return plan(moveDistance, maxSpeed / k, maxAcceleration / (k * k), maxJerk / (k * k * k));
+  }
+
+  return true;
+}
+
+void TrajectoryProfile::evaluate(float time, float* position, float* speed, float* acceleration)
+{
+  float p, v, a;
+
+  if(time <= 0)
+  {
+    p = 0;
+    v = segments[0].speed;
+    a = segments[0].acceleration;
+  }
+  else if(time >= totalTime)
+  {
+    p = distance;
+    v = a = 0;
+  }
+  else
+  {
+    //usually time only moves forwards, so pick up where the last evaluation left off
+    uint8_t i = time >= segments[lastSegment].startTime ? lastSegment : 0;
+    while(i < SegmentCount - 1 && time >= segments[i].startTime + segments[i].duration)
+    {
+      i++;
+    }
+    lastSegment = i;
+
+    const Segment& seg = segments[i];
+    float dt = time - seg.startTime;
+
+    p = seg.position + seg.speed * dt + seg.acceleration * dt * dt / 2 + seg.jerk * dt * dt * dt / 6;
+    v = seg.speed + seg.acceleration * dt + seg.jerk * dt * dt / 2;
+    a = seg.acceleration + seg.jerk * dt;
+  }
+
+  *position = p * direction;
+  if(speed)
+  {
+    *speed = v * direction;
+  }
+  if(acceleration)
+  {
+    *acceleration = a * direction;
+  }
+}
+
+float TrajectoryProfile::getDuration()
+{
+  return totalTime;
+}
+
+float TrajectoryProfile::getDistance()
+{
+  return distance * direction;
+}
@@ -0,0 +1,97 @@
+#ifndef ROVEJOINTCONTROL_TRAJECTORYPROFILE_H_
+#define ROVEJOINTCONTROL_TRAJECTORYPROFILE_H_
+
+#include <stdint.h>
+
+//A point to point motion profile, ending at rest, that keeps within speed, acceleration and jerk limits.
+//With a jerk limit it's an S-curve, seven segments of constant jerk: jerk up to the acceleration, hold it, jerk down
+//to the cruising speed, cruise, then the same in reverse. Without one it's a trapezoid: accelerate, cruise,
+//decelerate. Short moves that can't reach the speed or acceleration limits just skip those segments.
+//
+//plan() starts from rest. planFrom() starts from a given speed and acceleration instead, for changing a move's
+//destination partway through without the speed dropping out; its first three segments take the starting speed to the
+//cruising speed, which can be slower, or even backwards if it's moving too fast to stop short of the destination.
+//
+//All the planning is done by plan(); evaluating where the profile is at a given time is then a polynomial or two.
+//Units are up to the user, so long as they're consistent, IE degrees, degrees/s, degrees/s^2, degrees/s^3.
+//see the readme.md for more info
+class TrajectoryProfile
+{
+  public:
+    static const uint8_t SegmentCount = 7;
+
+  private:
+
+    //the state at the start of each segment, and the jerk through it. Stored for the positive direction
+    struct Segment
+    {
+      float startTime;
+      float duration;
+      float position;
+      float speed;
+      float acceleration;
+      float jerk;
+    };
+
+    Segment segments[SegmentCount];
+    float direction;
+    float distance;
+    float totalTime;
+
+    //where the last evaluation was, so that evaluating at increasing times doesn't have to search
+    uint8_t lastSegment;
+
+    //sets the profile to no motion
+    void clear();
+
+    //fills in the segments from their durations, starting accelerations and jerks, starting at the given speed.
+    //returns the position at the end
+    float integrateSegments(float startSpeed, const float durations[], const float startAccels[], const float jerks[]);
+
+    //lays out a planFrom() profile that goes from the starting speed and acceleration to peakSpeed, cruises for
+    //cruiseTime, and comes to rest. Returns the position at the end
+    float layOutFrom(float startSpeed, float startAcceleration, float peakSpeed, float cruiseTime, float maxAcceleration, float maxJerk);
+
+  public:
+
+    //constructs a profile of no motion
+    TrajectoryProfile();
+
+    //overview: plans a move of the given distance.
+    //inputs:   distance: how far to move. Negative moves backwards
+    //          maxSpeed, maxAcceleration: limits on the magnitudes of each. Must be positive
+    //          maxJerk: limit on the magnitude of jerk, or 0 for no limit, making the profile a trapezoid
+    //returns:  false if the limits aren't positive, in which case the profile is left as no motion
+    bool plan(float distance, float maxSpeed, float maxAcceleration, float maxJerk);
+
+    //overview: plans the same move as plan(), but slowed down so it takes the given time instead, if that's longer. Used
+    //          to make several axises finish their moves together.
+    bool planWithDuration(float distance, float maxSpeed, float maxAcceleration, float maxJerk, float duration);
+
+    //overview: plans a move of the given distance that starts out at the given speed and acceleration, IE wherever the
+    //          last profile was when the destination changed. Takes the same limits as plan().
+    //inputs:   startSpeed, startAcceleration: positive the same way as a positive distance. If they're past the limits, the profile
+    //          brings them back within them as quickly as the jerk limit allows
+    //returns:  false if the limits aren't positive, in which case the profile is left as no motion
+    bool planFrom(float distance, float startSpeed, float startAcceleration, float maxSpeed, float maxAcceleration, float maxJerk);
+
+    //overview: plans the same move as planFrom(), but with the speed limit brought down so it takes the given time
+    //          instead, if that's longer. Starting from rest, this is planWithDuration(). Otherwise the profile can't
+    //          just be stretched, since that would change the starting speed, so it only finishes at the given time
+    //          rather than keeping the same shape.
+    bool planFromWithDuration(float distance, float startSpeed, float startAcceleration, float maxSpeed, float maxAcceleration, float maxJerk, float duration);
+
+    //overview: where the profile is at the given time since its start. Times before the start give the start, times
+    //          after the end give the end.
+    //inputs:   time: time since the start of the profile
+    //          position, speed, acceleration: returned by pointer. Either of the last two can be null if not needed
+    void evaluate(float time, float* position, float* speed, float* acceleration);
+
+    //how long the profile takes from start to finish
+    float getDuration();
+
+    //the total distance of the move, signed
+    float getDistance();
+};
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "TtoPPOpenLConverter.h"
 #include "../RoveMotionUtilities.h"
+#include "../RoveMotionProfiler.h"
 #include "RoveBoard.h"
 
 TtoPPOpenLConverter::TtoPPOpenLConverter(TorqueConverterMotorTypes motor_type, float Kt, int motResistance_milliOhms, int staticMillivolts)
@@ -78,7 +79,7 @@ long TtoPPOpenLConverter::runAlgorithmBrushedDC(const long torque_milliNewtons)
   }
   else if(voltConverterUsed)
   {
-    milliVoltsAvailable = VoltSensor->getFeedback();
+    ROVEMOTION_PROFILE(VoltSensor, ProfileSite_Feedback, milliVoltsAvailable = VoltSensor->getFeedback());
   }
   else
   {
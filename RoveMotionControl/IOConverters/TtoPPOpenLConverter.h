@@ -22,6 +22,8 @@ typedef enum TorqueConverterMotorTypes
 //see the readme.md for more info
 class TtoPPOpenLConverter: public IOConverter
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
 
     //the type of motor to do the torque conversion for
@@ -71,6 +73,8 @@ class TtoPPOpenLConverter: public IOConverter
     long addToOutput(const long inputValue, const long calculatedOutput);
 
   public:
+    static const ValueType StaticInType = InputTorque;
+    static const ValueType StaticOutType = InputPowerPercent;
 
     //overview: Constructor. This version will tell the converter to use a voltage sensor for its calculations, rather
     //          than simply assuming what the motor power line's voltage is.
@@ -0,0 +1,231 @@
+#include "AxisGroup.h"
+#include "RoveBoard.h"
+#include <string.h>
+
+//rate-monotonic utilization bound, n * (2^(1/n) - 1), for 1 to MaxTasks tasks, in tenths of a percent
+static const uint16_t RM_UTILIZATION_BOUND[AxisGroup::MaxTasks] = {1000, 828, 779, 756, 743, 734, 728, 724, 720, 717, 715, 713, 711, 710, 709, 708};
+
+//how far time a is past time b, negative if it's before, accounting for the microsecond clock rolling over
+static int32_t timeSince(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b);
+}
+
+AxisGroup::AxisGroup()
+  : taskCount(0), started(false), ticking(false), overlappedTicks(0)
+{
+}
+
+int AxisGroup::insertTask(Task& task, uint32_t period_us)
+{
+  int i;
+
+  if(taskCount >= MaxTasks || period_us == 0)
+  {
+    return -1;
+  }
+
+  memset(&task.stats, 0, sizeof(task.stats));
+  task.stats.period_us = period_us;
+  task.nextRelease_us = micros();
+  tasks[taskCount] = task;
+
+  //insert into the priority order behind every task with the same or a shorter period
+  for(i = taskCount; i > 0 && tasks[priorityOrder[i - 1]].stats.period_us > period_us; i--)
+  {
+    priorityOrder[i] = priorityOrder[i - 1];
+  }
+  priorityOrder[i] = taskCount;
+
+  return taskCount++;
+}
+
+int AxisGroup::addAxis(MotionAxis* axis, uint32_t period_us)
+{
+  Task task;
+
+  task.kind = AxisTask;
+  task.axis = axis;
+  task.command = 0;
+  task.axisStatus = OutputComplete;
+  task.function = 0;
+  task.context = 0;
+
+  return insertTask(task, period_us);
+}
+
+int AxisGroup::addTask(void (*function)(void* context), void* context, uint32_t period_us)
+{
+  Task task;
+
+  task.kind = FunctionTask;
+  task.axis = 0;
+  task.command = 0;
+  task.axisStatus = OutputComplete;
+  task.function = function;
+  task.context = context;
+
+  return insertTask(task, period_us);
+}
+
+void AxisGroup::setCommand(int index, long command)
+{
+  if(0 <= index && index < taskCount)
+  {
+    tasks[index].command = command;
+  }
+}
+
+AxisControlStatus AxisGroup::getAxisStatus(int index)
+{
+  if(0 <= index && index < taskCount)
+  {
+    return tasks[index].axisStatus;
+  }
+
+  return InvalidInput;
+}
+
+void AxisGroup::start()
+{
+  uint32_t now = micros();
+
+  for(int i = 0; i < taskCount; i++)
+  {
+    tasks[i].nextRelease_us = now;
+  }
+
+  resetStats();
+  started = true;
+}
+
+void AxisGroup::runTask(Task& task)
+{
+  uint32_t release = task.nextRelease_us;
+  uint32_t period = task.stats.period_us;
+  uint32_t startTime = micros();
+  uint32_t endTime;
+
+  if(task.kind == AxisTask)
+  {
+    task.axisStatus = task.axis->runOutputControl(task.command);
+  }
+  else
+  {
+    task.function(task.context);
+  }
+
+  endTime = micros();
+
+  task.stats.runs++;
+  task.stats.lastExecution_us = endTime - startTime;
+  task.stats.lastJitter_us = startTime - release;
+  if(task.stats.lastExecution_us > task.stats.maxExecution_us)
+  {
+    task.stats.maxExecution_us = task.stats.lastExecution_us;
+  }
+  if(task.stats.lastJitter_us > task.stats.maxJitter_us)
+  {
+    task.stats.maxJitter_us = task.stats.lastJitter_us;
+  }
+
+  //each release's deadline is the next release. Finishing past it is a miss, and so is every further release that
+  //came and went without the task getting to run; those are skipped rather than ran back to back
+  task.nextRelease_us = release + period;
+  if(timeSince(endTime, task.nextRelease_us) > 0)
+  {
+    task.stats.deadlineMisses++;
+  }
+  while(timeSince(endTime, task.nextRelease_us + period) >= 0)
+  {
+    task.nextRelease_us += period;
+    task.stats.deadlineMisses++;
+  }
+}
+
+void AxisGroup::tick()
+{
+  if(!started)
+  {
+    return;
+  }
+
+  //if the tick interrupt fired while the main loop was ticking, or the tick took longer than the timer period.
+  //Testing and setting the flag is one atomic operation, so an interrupt landing between the two can't get in too
+  if(__sync_lock_test_and_set(&ticking, true))
+  {
+    overlappedTicks++;
+    return;
+  }
+
+  //shortest period first; times are re-read for each task, so ones that come due while others run still go this tick
+  for(int i = 0; i < taskCount; i++)
+  {
+    Task& task = tasks[priorityOrder[i]];
+
+    if(timeSince(micros(), task.nextRelease_us) >= 0)
+    {
+      runTask(task);
+    }
+  }
+
+  __sync_lock_release(&ticking);
+}
+
+AxisGroupTaskStats AxisGroup::getStats(int index)
+{
+  AxisGroupTaskStats none;
+
+  if(0 <= index && index < taskCount)
+  {
+    return tasks[index].stats;
+  }
+
+  memset(&none, 0, sizeof(none));
+  return none;
+}
+
+void AxisGroup::resetStats()
+{
+  for(int i = 0; i < taskCount; i++)
+  {
+    uint32_t period = tasks[i].stats.period_us;
+
+    memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
+    tasks[i].stats.period_us = period;
+  }
+
+  overlappedTicks = 0;
+}
+
+uint32_t AxisGroup::getOverlappedTicks()
+{
+  return overlappedTicks;
+}
+
+uint32_t AxisGroup::getUtilization()
+{
+  uint32_t utilization = 0;
+
+  for(int i = 0; i < taskCount; i++)
+  {
+    utilization += ((uint64_t)tasks[i].stats.maxExecution_us * 1000) / tasks[i].stats.period_us;
+  }
+
+  return utilization;
+}
+
+bool AxisGroup::isSchedulable()
+{
+  if(taskCount == 0)
+  {
+    return true;
+  }
+
+  return getUtilization() <= RM_UTILIZATION_BOUND[taskCount - 1];
+}
+
+uint8_t AxisGroup::getTaskCount()
+{
+  return taskCount;
+}
@@ -0,0 +1,123 @@
+#ifndef ROVEJOINTCONTROL_AXISGROUP_H_
+#define ROVEJOINTCONTROL_AXISGROUP_H_
+
+#include <stdint.h>
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+
+//timing records kept for each task in an AxisGroup. All times are in microseconds.
+struct AxisGroupTaskStats
+{
+  uint32_t period_us;
+
+  //how many times the task has ran
+  uint32_t runs;
+
+  //how long the task took to run, the last time and at worst
+  uint32_t lastExecution_us;
+  uint32_t maxExecution_us;
+
+  //how late the task started compared to when it was due, the last time and at worst
+  uint32_t lastJitter_us;
+  uint32_t maxJitter_us;
+
+  //how many times the task either finished after its next run was due, or didn't get to run at all before then
+  uint32_t deadlineMisses;
+};
+
+//Runs a set of axises and other periodic jobs, like GravityInertiaSystemStatus::update or DynamixelGroup::update,
+//each at its own rate off of one timer tick. Tasks are run rate-monotonically: whenever several are due at once, the
+//one with the shortest period goes first. Each task's execution time, start jitter and deadline misses are recorded,
+//so it can be checked that every loop is actually running at the rate it's meant to.
+//
+//Call tick() from a timer interrupt or the main loop, at least as often as the shortest period. Tasks aren't
+//preempted by each other; a task that's still running when a higher priority one comes due delays it, which will
+//show up in the delayed task's jitter.
+//see the readme.md for more info
+class AxisGroup
+{
+  public:
+    static const uint8_t MaxTasks = 16;
+
+  private:
+    enum TaskKind { AxisTask, FunctionTask };
+
+    struct Task
+    {
+      TaskKind kind;
+
+      MotionAxis* axis;
+      volatile long command;
+      volatile AxisControlStatus axisStatus;
+
+      void (*function)(void* context);
+      void* context;
+
+      uint32_t nextRelease_us;
+      AxisGroupTaskStats stats;
+    };
+
+    Task tasks[MaxTasks];
+    uint8_t taskCount;
+
+    //task indexes, shortest period first
+    uint8_t priorityOrder[MaxTasks];
+
+    bool started;
+    volatile bool ticking;
+    uint32_t overlappedTicks;
+
+    int insertTask(Task& task, uint32_t period_us);
+    void runTask(Task& task);
+
+  public:
+
+    AxisGroup();
+
+    //overview: adds an axis, to have its runOutputControl called with its command every period.
+    //          The command starts out as 0, so set it with setCommand before starting the group.
+    //returns:  the task's index in the group, or -1 if the group is full or the period is 0
+    int addAxis(MotionAxis* axis, uint32_t period_us);
+
+    //overview: adds a function to be called every period, with the given context pointer passed to it. Use for
+    //          support jobs that aren't axises; ex a static function that casts the context to a
+    //          GravityInertiaSystemStatus and calls its update()
+    //returns:  the task's index in the group, or -1 if the group is full or the period is 0
+    int addTask(void (*function)(void* context), void* context, uint32_t period_us);
+
+    //sets the movement an axis task passes to its runOutputControl from now on
+    void setCommand(int index, long command);
+
+    //returns the status an axis task's runOutputControl returned the last time it ran, or InvalidInput if there's no
+    //task at that index
+    AxisControlStatus getAxisStatus(int index);
+
+    //makes every task due right away and clears the stats. Call once everything's added, right before ticking starts
+    void start();
+
+    //runs every task that's due, in priority order. Call periodically
+    void tick();
+
+    //returns the timing records of a task, all zero if there's no task at that index
+    AxisGroupTaskStats getStats(int index);
+
+    //clears every task's timing records
+    void resetStats();
+
+    //returns how many times tick() got called while a previous call was still running, and so did nothing
+    uint32_t getOverlappedTicks();
+
+    //returns how much of the processor the tasks use at worst, by their max execution times, in tenths of a percent
+    uint32_t getUtilization();
+
+    //overview: checks the tasks against the rate-monotonic schedulability bound, IE whether their worst execution times
+    //          so far are small enough that every task is sure to make its deadlines. Note that execution times are only
+    //          known once the tasks have ran for a while, and that the bound is for a preemptive scheduler; with tasks
+    //          running to completion, make sure the longest task also fits in the shortest period.
+    //returns:  true if the utilization is within the bound
+    bool isSchedulable();
+
+    uint8_t getTaskCount();
+};
+
+#endif
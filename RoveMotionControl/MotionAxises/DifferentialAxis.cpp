@@ -1,5 +1,6 @@
 #include "DifferentialAxis.h"
 #include "../RoveMotionUtilities.h"
+#include "../RoveMotionProfiler.h"
 
 DifferentialAxis::DifferentialAxis(DifferentialType axisType, ValueType inputType, IOConverter *alg, OutputDevice* cont1, OutputDevice* cont2)
   : MotionAxis(inputType, alg, cont1), controller2(cont2), coupled(false), thisAxisType(axisType), motorOneVirtualPower(0), motorTwoVirtualPower(0)
@@ -59,7 +60,7 @@ AxisControlStatus DifferentialAxis::runOutputControl(const long movement)
   	//runs the algorithm on the input if there is one. Else it just passes the output directly to the output device
     if(algorithmUsed)
     {
-      mov = manip->runAlgorithm(movement, &converterStatus);
+      ROVEMOTION_PROFILE(manip, ProfileSite_Converter, mov = manip->runAlgorithm(movement, &converterStatus));
     }
     else
     {
@@ -69,8 +70,8 @@ AxisControlStatus DifferentialAxis::runOutputControl(const long movement)
     
     if(converterStatus.flags != IOConverter_Complete && converterStatus.flags != IOConverter_RunAgain)
     {
-      controller1->stop();
-      controller2->stop();
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputStop, controller1->stop());
+      ROVEMOTION_PROFILE(controller2, ProfileSite_OutputStop, controller2->stop());
 
       if(converterStatus.flags == IOConverter_AlgorithmFail)
       {
@@ -86,8 +87,8 @@ AxisControlStatus DifferentialAxis::runOutputControl(const long movement)
     //if the stopcaps demand that we modify the move value
     else if(!handleStopCap(&mov, controller1->inType))
     {
-      controller1->stop();
-      controller2->stop();
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputStop, controller1->stop());
+      ROVEMOTION_PROFILE(controller2, ProfileSite_OutputStop, controller2->stop());
       returnStatus = StopcapActivated;
     }
     else
@@ -141,8 +142,8 @@ AxisControlStatus DifferentialAxis::runOutputControl(const long movement)
         }
       }
 
-      controller1->move(motorOneTruePower);
-      controller2->move(motorTwoTruePower);
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputMove, controller1->move(motorOneTruePower));
+      ROVEMOTION_PROFILE(controller2, ProfileSite_OutputMove, controller2->move(motorTwoTruePower));
     }
   }
 
@@ -1,5 +1,6 @@
 #include "SingleMotorAxis.h"
 #include "../RoveMotionUtilities.h"
+#include "../RoveMotionProfiler.h"
 
 SingleMotorAxis::SingleMotorAxis(ValueType inputType, IOConverter *alg, OutputDevice* cont) : MotionAxis(inputType, alg, cont)
 {
@@ -57,7 +58,7 @@ AxisControlStatus SingleMotorAxis::runOutputControl(const long movement)
   	//calls algorithm if there's one used. If not, output passed directly to output device
     if(algorithmUsed)
     {
-      mov = manip->runAlgorithm(movement, &converterStatus);
+      ROVEMOTION_PROFILE(manip, ProfileSite_Converter, mov = manip->runAlgorithm(movement, &converterStatus));
     }
     else
     {
@@ -67,7 +68,7 @@ AxisControlStatus SingleMotorAxis::runOutputControl(const long movement)
     
     if(converterStatus.flags != IOConverter_Complete && converterStatus.flags != IOConverter_RunAgain)
     {
-      controller1->stop();
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputStop, controller1->stop());
 
       if(converterStatus.flags == IOConverter_AlgorithmFail)
       {
@@ -83,7 +84,7 @@ AxisControlStatus SingleMotorAxis::runOutputControl(const long movement)
     //if the stopcaps demand that we modify the move value
     else if(!handleStopCap(&mov, controller1->inType))
     {
-      controller1->stop();
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputStop, controller1->stop());
       returnStatus = StopcapActivated;
     }
     else
@@ -98,7 +99,7 @@ AxisControlStatus SingleMotorAxis::runOutputControl(const long movement)
       }
 
       //moves device with output decided on by the algorithm
-      controller1->move(mov);
+      ROVEMOTION_PROFILE(controller1, ProfileSite_OutputMove, controller1->move(mov));
     }
   }
 
@@ -0,0 +1,195 @@
+#ifndef ROVEJOINTCONTROL_STATICAXIS_H_
+#define ROVEJOINTCONTROL_STATICAXIS_H_
+
+#include "RoveBoard.h"
+#include "../AbstractFramework.h"
+#include "../RoveMotionUtilities.h"
+
+//Stopcap for a StaticAxis that doesn't use one. Always reports clear, and folds away entirely once inlined.
+class NoStopcap
+{
+  public:
+    StopcapStatus getStopcapStatus() { return StopcapStatus_None; }
+};
+
+//Converter for a StaticAxis whose commands go straight to the output device, like a SingleMotorAxis constructed
+//without an IOConverter.
+template<ValueType Type>
+class PassThroughConverter
+{
+  public:
+    static const ValueType StaticInType = Type;
+    static const ValueType StaticOutType = Type;
+
+    long runAlgorithm(const long input, IOConverter_Status * ret_status)
+    {
+      ret_status->flags = IOConverter_Complete;
+      return input;
+    }
+};
+
+//Represents an axis with one motor, like SingleMotorAxis, but with its modules fixed at compile time. The types of the
+//converter, output device and stopcap are template arguments, so mismatched value types are compile errors rather than
+//an InvalidConstruction status, and every module call is made directly on the concrete class instead of through the
+//abstract classes' virtual functions, letting the compiler inline the whole control step.
+//
+//Each module must declare its value types as static constants: StaticInType and StaticOutType on converters,
+//StaticInType on output devices. Modules whose types are only known at runtime, such as DynamixelController, need
+//SingleMotorAxis instead. Note that a converter's own feedback device and supporting algorithm are still reached
+//through their abstract classes.
+//
+//ex: StaticAxis<PIAlgorithm, VNH5019, DualLimitSwitch> wrist(piLoop, hBridge, limits);
+//    StaticAxis<PassThroughConverter<InputPowerPercent>, VNH5019> gripper(direct, hBridge);
+//see the readme.md for more info.
+template<class Converter, class Device, class Stopcap = NoStopcap>
+class StaticAxis
+{
+  static_assert(Converter::StaticOutType == Device::StaticInType, "StaticAxis: the converter's output type must be what the output device takes");
+
+  private:
+    Converter& converter;
+    Device& device;
+    Stopcap& stopcap;
+    bool enabled;
+
+    //only compiles for stopcaps that need no construction, which is to say NoStopcap
+    static Stopcap& defaultStopcap()
+    {
+      static Stopcap none;
+      return none;
+    }
+
+    //same checks as MotionAxis::verifyInput, with the switch resolved at compile time
+    static bool verifyInput(long inputToVerify)
+    {
+      switch(InType)
+      {
+        case InputSpeed:
+          return SPEED_MIN <= inputToVerify && inputToVerify <= SPEED_MAX;
+        case InputPosition:
+          return (long)POS_MIN <= inputToVerify && inputToVerify <= (long)POS_MAX;
+        case InputPowerPercent:
+          return POWERPERCENT_MIN <= inputToVerify && inputToVerify <= POWERPERCENT_MAX;
+        case InputTorque:
+          return TORQUE_MIN <= inputToVerify && inputToVerify <= TORQUE_MAX;
+        case InputVoltage:
+          return VOLT_MIN <= inputToVerify && inputToVerify <= VOLT_MAX;
+        case InputAcceleration:
+          return ACCEL_MIN <= inputToVerify && inputToVerify <= ACCEL_MAX;
+        default:
+          return inputToVerify == 0;
+      }
+    }
+
+    //same logic as MotionAxis::handleStopCap
+    bool handleStopCap(long *move)
+    {
+      StopcapStatus status = stopcap.Stopcap::getStopcapStatus();
+
+      if(status == StopcapStatus_FullStop)
+      {
+        return false;
+      }
+      else if(status != StopcapStatus_None)
+      {
+        if(Device::StaticInType == InputPowerPercent || Device::StaticInType == InputTorque || Device::StaticInType == InputSpeed || Device::StaticInType == InputVoltage || Device::StaticInType == InputAcceleration)
+        {
+          if(status == StopcapStatus_OnlyPositive && *move < 0)
+          {
+            *move = 0;
+          }
+          else if(status == StopcapStatus_OnlyNegative && *move > 0)
+          {
+            *move = 0;
+          }
+        }
+        else
+        {
+          debugFault("static axis handle stop cap: logic not implemented");
+        }
+      }
+
+      return true;
+    }
+
+  public:
+
+    //the type of value runOutputControl takes
+    static const ValueType InType = Converter::StaticInType;
+
+    //Overview: creates the axis with a stopcap.
+    StaticAxis(Converter& conv, Device& dev, Stopcap& cap)
+      : converter(conv), device(dev), stopcap(cap), enabled(true) {}
+
+    //Overview: creates the axis without a stopcap. Only available when Stopcap is NoStopcap.
+    StaticAxis(Converter& conv, Device& dev)
+      : converter(conv), device(dev), stopcap(defaultStopcap()), enabled(true) {}
+
+    //Overview: runs control algorithm for the axis so that it moves. Behaves exactly like SingleMotorAxis::runOutputControl,
+    //          minus the InvalidConstruction status which can't happen here.
+    //
+    //Inputs:   movement: the desired movement, of InType.
+    //
+    //returns:  The status of attempting to control this axis.
+    AxisControlStatus runOutputControl(const long movement)
+    {
+      long mov;
+      IOConverter_Status converterStatus;
+
+      if(!enabled)
+      {
+        return DeviceDisabled;
+      }
+
+      if(!verifyInput(movement))
+      {
+        return InvalidInput;
+      }
+
+      mov = converter.Converter::runAlgorithm(movement, &converterStatus);
+
+      if(converterStatus.flags == IOConverter_AlgorithmFail)
+      {
+        device.Device::stop();
+        return AlgorithmError;
+      }
+      else if(converterStatus.flags == IOConverter_FeedbackFail)
+      {
+        device.Device::stop();
+        return FeedbackError;
+      }
+
+      if(!handleStopCap(&mov))
+      {
+        device.Device::stop();
+        return StopcapActivated;
+      }
+
+      device.Device::move(mov);
+
+      return converterStatus.flags == IOConverter_Complete ? OutputComplete : OutputRunning;
+    }
+
+    //tells the axis to halt. Note that this won't keep the axis from moving if called again;
+    //use disable for that
+    void stop()
+    {
+      device.Device::stop();
+    }
+
+    //turns the axis off; it will stop moving until enabled
+    void disableAxis()
+    {
+      device.Device::setPower(false);
+      enabled = false;
+    }
+
+    //turns the axis on after being disabled
+    void enableAxis()
+    {
+      device.Device::setPower(true);
+      enabled = true;
+    }
+};
+
+#endif
@@ -14,6 +14,8 @@
 //class for moving multiple BTM7752G motor controllers with the PCA9685 pwm driver; the latter sends the pwm to the former for us.
 class BTM7752GwithPCA9685: public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   protected:
 
     RoveI2C_Handle i2cHandle;
@@ -44,6 +46,7 @@ class BTM7752GwithPCA9685: public OutputDevice
     long currentMove;
 
   public:
+    static const ValueType StaticInType = InputPowerPercent;
 
     /*constructor for when the i2c not-enable pin on the pca is used.
      * inputs:
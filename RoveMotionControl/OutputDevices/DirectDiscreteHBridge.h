@@ -10,6 +10,8 @@
 //see the README.md for more info
 class DirectDiscreteHBridge : public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
 
     //fpwm_handle the forward PWM pin handler and rpwm_handle is the reverse PWM pin handler
@@ -28,6 +30,8 @@ class DirectDiscreteHBridge : public OutputDevice
     void stop();
 
   public:
+    static const ValueType StaticInType = InputPowerPercent;
+
     //Creates the device. Assigns the pins correctly.
     //
     //Inputs: int FPIN_GEN: The hardware generator for the pwm driving the H bridge's forward transistor
@@ -0,0 +1,335 @@
+#include "DynamixelController.h"
+#include "../RoveMotionUtilities.h"
+
+static const uint16_t AX_POSITION_MAX = 1023;
+static const uint16_t MX_POSITION_MAX = 4095;
+static const long AX_POSITION_RANGE = 300000; //AX servos cover 300 degrees
+static const uint16_t SPEED_MAGNITUDE_MAX = 1023;
+static const uint16_t SPEED_DIRECTION_BIT = 1024;
+static const long AX_SPEED_UNIT = 666; //milliDegrees/s per count, 0.111 rpm
+static const long MX_SPEED_UNIT = 684; //milliDegrees/s per count, 0.114 rpm
+static const uint8_t SNAPSHOT_LENGTH = 4;
+
+DynamixelGroup::DynamixelGroup(uint8_t uartIndex, uint32_t baud, uint8_t txPin, uint8_t rxPin)
+  : baud(baud), servoCount(0), snapshotTime_us(0)
+{
+  uart = roveBoard_UART_open(uartIndex, baud, txPin, rxPin);
+}
+
+int DynamixelGroup::addServo(DynamixelType type, uint8_t id, DynamixelMode mode)
+{
+  if(servoCount >= MaxServos)
+  {
+    return -1;
+  }
+
+  servos[servoCount].id = id;
+  servos[servoCount].type = type;
+  servos[servoCount].uart = uart;
+  servos[servoCount].baud = baud;
+  DynamixelAttachShadow(&servos[servoCount], &shadows[servoCount]);
+
+  modes[servoCount] = mode;
+  goalPending[servoCount] = false;
+  snapshotError[servoCount] = DYNAMIXEL_ERROR_UNKNOWN;
+
+  DynamixelSetMode(servos[servoCount], mode);
+
+  return servoCount++;
+}
+
+int DynamixelGroup::indexOf(uint8_t id)
+{
+  for(int i = 0; i < servoCount; i++)
+  {
+    if(servos[i].id == id)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void DynamixelGroup::setGoal(int index, uint16_t rawGoal)
+{
+  goals[index] = rawGoal;
+  goalPending[index] = true;
+}
+
+void DynamixelGroup::cancelGoal(int index)
+{
+  goalPending[index] = false;
+}
+
+void DynamixelGroup::flush()
+{
+  Dynamixel jointServos[MaxServos], wheelServos[MaxServos];
+  uint8_t jointData[MaxServos * 2], wheelData[MaxServos * 2];
+  uint8_t jointCount = 0, wheelCount = 0;
+
+  //goal position and moving speed are different registers, so the two kinds of servo get a sync-write apiece
+  for(int i = 0; i < servoCount; i++)
+  {
+    if(!goalPending[i])
+    {
+      continue;
+    }
+
+    if(modes[i] == Wheel)
+    {
+      wheelServos[wheelCount] = servos[i];
+      wheelData[wheelCount * 2] = goals[i] & 0x00FF;
+      wheelData[wheelCount * 2 + 1] = goals[i] >> 8;
+      wheelCount++;
+    }
+    else
+    {
+      jointServos[jointCount] = servos[i];
+      jointData[jointCount * 2] = goals[i] & 0x00FF;
+      jointData[jointCount * 2 + 1] = goals[i] >> 8;
+      jointCount++;
+    }
+
+    goalPending[i] = false;
+  }
+
+  if(jointCount > 0)
+  {
+    DynamixelSendSyncWriteCommand(jointServos, jointCount, DYNAMIXEL_GOAL_POSITION_L, 2, jointData);
+  }
+
+  if(wheelCount > 0)
+  {
+    DynamixelSendSyncWriteCommand(wheelServos, wheelCount, DYNAMIXEL_MOVING_SPEED_L, 2, wheelData);
+  }
+}
+
+void DynamixelGroup::refreshFeedback()
+{
+  Dynamixel mxServos[MaxServos];
+  uint8_t mxIndex[MaxServos];
+  uint8_t mxData[MaxServos * SNAPSHOT_LENGTH];
+  uint8_t mxErrors[MaxServos];
+  uint8_t axData[SNAPSHOT_LENGTH];
+  uint8_t mxCount = 0;
+
+  //alarm bits come back with good data, so only a reply that's missing or garbled keeps the old snapshot
+  for(int i = 0; i < servoCount; i++)
+  {
+    if(servos[i].type == MX)
+    {
+      mxServos[mxCount] = servos[i];
+      mxIndex[mxCount] = i;
+      mxCount++;
+    }
+    else
+    {
+      snapshotError[i] = DynamixelReadRegisters(servos[i], DYNAMIXEL_PRESENT_POSITION_L, SNAPSHOT_LENGTH, axData);
+      if(DynamixelDataValid(snapshotError[i]))
+      {
+        memcpy(snapshot[i], axData, SNAPSHOT_LENGTH);
+      }
+    }
+  }
+
+  if(mxCount > 0)
+  {
+    DynamixelBulkRead(mxServos, mxCount, DYNAMIXEL_PRESENT_POSITION_L, SNAPSHOT_LENGTH, mxData, mxErrors);
+
+    for(int i = 0; i < mxCount; i++)
+    {
+      snapshotError[mxIndex[i]] = mxErrors[i];
+      if(DynamixelDataValid(mxErrors[i]))
+      {
+        memcpy(snapshot[mxIndex[i]], &mxData[i * SNAPSHOT_LENGTH], SNAPSHOT_LENGTH);
+      }
+    }
+  }
+
+  snapshotTime_us = micros();
+}
+
+void DynamixelGroup::update()
+{
+  flush();
+  refreshFeedback();
+}
+
+void DynamixelGroup::setTorque(int index, bool torqueOn)
+{
+  uint8_t torque = torqueOn ? 1 : 0;
+
+  DynamixelWriteRegisters(servos[index], DYNAMIXEL_TORQUE_ENABLE, 1, &torque);
+}
+
+uint16_t DynamixelGroup::getPresentPosition(int index)
+{
+  return snapshot[index][0] | (snapshot[index][1] << 8);
+}
+
+uint16_t DynamixelGroup::getPresentSpeed(int index)
+{
+  return snapshot[index][2] | (snapshot[index][3] << 8);
+}
+
+bool DynamixelGroup::feedbackValid(int index)
+{
+  return DynamixelDataValid(snapshotError[index]);
+}
+
+uint8_t DynamixelGroup::getAlarms(int index)
+{
+  return snapshotError[index] & DYNAMIXEL_ALARM_ERRORS;
+}
+
+uint32_t DynamixelGroup::getSnapshotTime()
+{
+  return snapshotTime_us;
+}
+
+DynamixelType DynamixelGroup::getType(int index)
+{
+  return servos[index].type;
+}
+
+DynamixelMode DynamixelGroup::getMode(int index)
+{
+  return modes[index];
+}
+
+uint16_t DynamixelGroup::positionToRaw(DynamixelType type, long position)
+{
+  if(type == AX)
+  {
+    //anything past 300 degrees is in the AX's dead zone, so park it at the end of its travel
+    return constrain((position * AX_POSITION_MAX) / AX_POSITION_RANGE, 0, AX_POSITION_MAX);
+  }
+  else
+  {
+    return constrain((position * (MX_POSITION_MAX + 1)) / (long)(POS_MAX - POS_MIN), 0, MX_POSITION_MAX);
+  }
+}
+
+long DynamixelGroup::rawToPosition(DynamixelType type, uint16_t raw)
+{
+  if(type == AX)
+  {
+    return ((long)raw * AX_POSITION_RANGE) / AX_POSITION_MAX;
+  }
+  else
+  {
+    return ((long)(raw & MX_POSITION_MAX) * (long)(POS_MAX - POS_MIN)) / (MX_POSITION_MAX + 1);
+  }
+}
+
+uint16_t DynamixelGroup::powerPercentToRaw(long powerPercent)
+{
+  uint16_t magnitude = (abs(powerPercent) * SPEED_MAGNITUDE_MAX) / POWERPERCENT_MAX;
+
+  if(powerPercent < 0)
+  {
+    return magnitude | SPEED_DIRECTION_BIT;
+  }
+  return magnitude;
+}
+
+long DynamixelGroup::rawToSpeed(DynamixelType type, uint16_t raw)
+{
+  long magnitude = (raw & SPEED_MAGNITUDE_MAX) * (type == AX ? AX_SPEED_UNIT : MX_SPEED_UNIT);
+
+  if(raw & SPEED_DIRECTION_BIT)
+  {
+    magnitude = -magnitude;
+  }
+  return constrain(magnitude, SPEED_MIN, SPEED_MAX);
+}
+
+DynamixelController::DynamixelController(DynamixelGroup* dynaGroup, DynamixelType type, uint8_t id, DynamixelMode dynaMode, bool upsideDown)
+  : OutputDevice(dynaMode == Wheel ? InputPowerPercent : InputPosition, upsideDown), group(dynaGroup), mode(dynaMode), currentMove(0)
+{
+  groupIndex = group->addServo(type, id, mode);
+
+  if(groupIndex < 0)
+  {
+    debugFault("Error in DynamixelController constructor: dynamixel group is full");
+  }
+}
+
+void DynamixelController::move(const long movement)
+{
+  long mov = movement;
+
+  if(!enabled || groupIndex < 0) //if the manager disabled this device, disable output
+  {
+    return;
+  }
+
+  currentMove = movement;
+
+  if(mode == Wheel)
+  {
+    if(invert)
+    {
+      mov = -mov;
+    }
+
+    group->setGoal(groupIndex, DynamixelGroup::powerPercentToRaw(mov));
+  }
+  else
+  {
+    if(invert)
+    {
+      mov = (POS_MAX - POS_MIN) - mov;
+    }
+
+    group->setGoal(groupIndex, DynamixelGroup::positionToRaw(group->getType(groupIndex), mov));
+  }
+}
+
+//Instructs the dynamixel class to behave as if it is off or on; IE if it's off it'll refuse to send any output
+void DynamixelController::setPower(bool powerOn)
+{
+  if(groupIndex < 0)
+  {
+    return;
+  }
+
+  //writing a goal position turns torque back on, so a joint being powered off just drops whatever it had queued
+  if(powerOn == false)
+  {
+    if(mode == Wheel)
+    {
+      stop();
+    }
+    else
+    {
+      group->cancelGoal(groupIndex);
+    }
+  }
+
+  group->setTorque(groupIndex, powerOn);
+  enabled = powerOn;
+}
+
+long DynamixelController::getCurrentMove()
+{
+  return currentMove;
+}
+
+void DynamixelController::stop()
+{
+  if(groupIndex < 0)
+  {
+    return;
+  }
+
+  if(mode == Wheel)
+  {
+    group->setGoal(groupIndex, 0);
+    currentMove = 0;
+  }
+  else if(group->feedbackValid(groupIndex))
+  {
+    group->setGoal(groupIndex, group->getPresentPosition(groupIndex));
+  }
+}
@@ -0,0 +1,125 @@
+#ifndef ROVEJOINTCONTROL_DYNAMIXELCONTROLLER_H_
+#define ROVEJOINTCONTROL_DYNAMIXELCONTROLLER_H_
+
+#include <stdint.h>
+#include "RoveBoard.h"
+#include "RoveWare/RoveDynamixel.h"
+#include "../AbstractFramework.h"
+
+//Represents every dynamixel sharing one uart. Rather than each device talking to the bus whenever an axis tells it
+//to, DynamixelControllers queue their goals here and DynamixelFeedbacks read out of the snapshot kept here, so a whole
+//tick of bus traffic comes down to one sync-write and one bulk read.
+//
+//Call update() once per control tick, after every axis using the group has run; it sends that tick's queued goals
+//and refreshes the feedback the next tick will read.
+//see the readme.md for more info
+class DynamixelGroup
+{
+  public:
+    static const uint8_t MaxServos = 8;
+
+  private:
+    RoveUart_Handle uart;
+    uint32_t baud;
+    Dynamixel servos[MaxServos];
+    DynamixelShadow shadows[MaxServos];
+    DynamixelMode modes[MaxServos];
+    uint8_t servoCount;
+
+    uint16_t goals[MaxServos];
+    bool goalPending[MaxServos];
+
+    //present position then present speed, raw from the bus
+    uint8_t snapshot[MaxServos][4];
+    uint8_t snapshotError[MaxServos];
+    uint32_t snapshotTime_us;
+
+  public:
+
+    //Inputs: uartIndex -> which hardware uart the dynamixels are on, 0-7
+    //        baud -> baud rate the dynamixels are set to
+    //        txPin, rxPin -> uart pins, as defined by energia's pinmapping
+    DynamixelGroup(uint8_t uartIndex, uint32_t baud, uint8_t txPin, uint8_t rxPin);
+
+    //overview: adds a dynamixel to the group and puts it into the given mode
+    //returns:  the servo's index in the group, or -1 if the group is full
+    int addServo(DynamixelType type, uint8_t id, DynamixelMode mode);
+
+    //returns the index of the servo with the given id, or -1 if it isn't in the group
+    int indexOf(uint8_t id);
+
+    //queues a raw goal for the servo; goal position in joint modes, moving speed in wheel mode. Sent on the next flush()
+    void setGoal(int index, uint16_t rawGoal);
+
+    //drops the servo's queued goal, if it has one
+    void cancelGoal(int index);
+
+    //sends every queued goal; one sync-write for joint mode servos and one for wheel mode servos
+    void flush();
+
+    //reads present position and speed of every servo; one bulk read for the MX servos, a read apiece for the AX servos
+    //since they don't support bulk reads
+    void refreshFeedback();
+
+    //flush() then refreshFeedback(). Call once per control tick
+    void update();
+
+    //turns the servo's torque on or off immediately
+    void setTorque(int index, bool torqueOn);
+
+    //raw values from the last refreshFeedback(). Feedback stays valid while the servo reports alarms such as overload or
+    //overheating, since those don't garble the reading; only a missing or bad reply invalidates it
+    uint16_t getPresentPosition(int index);
+    uint16_t getPresentSpeed(int index);
+    bool feedbackValid(int index);
+    uint32_t getSnapshotTime();
+
+    //the alarm bits (DYNAMIXEL_ALARM_ERRORS) the servo reported in the last refreshFeedback(), 0 if none
+    uint8_t getAlarms(int index);
+
+    DynamixelType getType(int index);
+    DynamixelMode getMode(int index);
+
+    //conversions between the framework's value types and dynamixel register values. AX servos cover 300 degrees
+    //over 0-1023, MX servos 360 degrees over 0-4095; speeds use bit 10 as the direction bit, set meaning negative
+    static uint16_t positionToRaw(DynamixelType type, long position);
+    static long rawToPosition(DynamixelType type, uint16_t raw);
+    static uint16_t powerPercentToRaw(long powerPercent);
+    static long rawToSpeed(DynamixelType type, uint16_t raw);
+};
+
+//represents a single dynamixel, either AX or MX. In wheel mode it takes power percent, in joint and multi turn modes
+//it takes position. Moves are queued in the DynamixelGroup the servo belongs to rather than sent immediately.
+//see the readme.md for more info
+class DynamixelController : public OutputDevice
+{
+  private:
+    DynamixelGroup* group;
+    int groupIndex;
+    DynamixelMode mode;
+    long currentMove;
+
+  protected:
+    //movement command; power percent in wheel mode, position in joint or multi turn mode
+    void move(const long movement);
+
+    //tells the device to power on or off. Powering off also turns the servo's torque off
+    void setPower(bool powerOn);
+
+    //tells device to stop moving. Wheel mode servos spin down, joint mode servos hold their last read position
+    void stop();
+
+  public:
+
+    //Inputs: dynaGroup -> the group representing the uart this dynamixel is on
+    //        type -> Instance of the DynamixelType enum that defines the dynamixel brand such as AX, MX, etc
+    //        id -> id of the dynamixel. Note that if you aren't sure, use RoveDynamixelDiscovery to find it
+    //        mode -> instance of the DynamixelMode enum that defines the dynamixel's mode such as Wheel, Joint, etc
+    //        upsideDown -> Whether or not the dyna is mounted in reverse and thus the inputs need to be reversed as well
+    DynamixelController(DynamixelGroup* dynaGroup, DynamixelType type, uint8_t id, DynamixelMode mode, bool upsideDown);
+
+    //returns the last move command this device got commanded.
+    long getCurrentMove();
+};
+
+#endif
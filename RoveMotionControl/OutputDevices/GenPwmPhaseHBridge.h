@@ -8,6 +8,8 @@
 //see the readme.md for more info
 class GenPwmPhaseHBridge: public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
     
     bool enableLogicHigh; //if there's an enable pin, this tracks if it's logic high or low
@@ -42,6 +44,7 @@ class GenPwmPhaseHBridge: public OutputDevice
     void stop();
     
   public:
+    static const ValueType StaticInType = InputPowerPercent;
 
     //overview: constructor for h bridge devices controlled with a pwm pin and a phase/direction pin
     //
@@ -8,6 +8,8 @@
 //see the readme.md for more info.
 class RCContinuousServo : public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
     const RovePwmWrite_Handle PwmHandle;
     int pwm_stop_us;  //some devices stop at values a little bit different from others, so it's modifiable
@@ -24,6 +26,8 @@ class RCContinuousServo : public OutputDevice
     void stop();
 
   public:
+    static const ValueType StaticInType = InputPowerPercent;
+
     // overview: constructor for a RC Continuous Servo device.
     // inputs:   pwmGen: pwm generator reference
     //           pwmPin: pin assignment for the PWM pin
@@ -8,6 +8,8 @@
 //see the readme.md for more info
 class VNH5019 : public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   private:
     const int INA_PIN, INB_PIN;
     const RovePwmWrite_Handle PwmHandle;
@@ -25,7 +27,8 @@ class VNH5019 : public OutputDevice
     void stop();
     
   public:
-  
+    static const ValueType StaticInType = InputPowerPercent;
+
     //Inputs: pwm generator: reference to output a pwm wave on the pwm pin,
     //        pin assignments for hardware pins,
     //        a bool to determine the orientation of the motor.
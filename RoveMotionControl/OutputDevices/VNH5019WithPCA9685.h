@@ -17,6 +17,8 @@
 //the instances all sharing information on the PCA so that they all know how to talk to it.
 class VNH5019WithPCA9685 : public OutputDevice
 {
+  template<class, class, class> friend class StaticAxis;
+
   protected:
 
      RoveI2C_Handle i2cHandle;
@@ -41,7 +43,7 @@ class VNH5019WithPCA9685 : public OutputDevice
      long currentMove;
 
    public:
-
+     static const ValueType StaticInType = InputPowerPercent;
 
      /*constructor for when the i2c not-enable pin on the pca is not used.
       * inputs:
@@ -0,0 +1,189 @@
+#ifndef ROVEMOTIONCONTROL_ROVEFIXEDPOINT_H_
+#define ROVEMOTIONCONTROL_ROVEFIXEDPOINT_H_
+
+#include <stdint.h>
+
+//Numeric policy for the control loops' per-tick math.
+//
+//By default MotionReal is a float, same as the framework has always used. Define ROVEMOTION_FIXED_POINT in the
+//build to make it a FixedPoint<ROVEMOTION_FIXED_FRAC_BITS> instead (Q16.16 unless told otherwise), so that the
+//math runs on the integer unit; useful on processors without an fpu, or when the fpu's registers are better left
+//alone in interrupts.
+//
+//FixedPoint arithmetic saturates rather than wrapping. With 16 fractional bits values range over +-32767.99998 with
+//a resolution of 1/65536; every operation rounds to that resolution, so a result agrees with the float version to
+//within 1/65536 per operation, and values truncated to longs (see motionToLong) can differ by 1 where the float
+//result lands within that distance of a whole number. Constants like a loop's DT are rounded the same way, so a sum
+//of something times DT over many runs carries DT's relative error, 1/(65536 * DT), along with it. Fewer fractional
+//bits trade resolution for range, IE ROVEMOTION_FIXED_FRAC_BITS=12 gives +-524287 at 1/4096.
+//
+//HostTests/FixedPointTest runs the converters under both policies and checks them against each other.
+
+//represents a signed number with FracBits bits after the binary point, stored in 32 bits.
+template<int FracBits>
+class FixedPoint
+{
+  static_assert(0 < FracBits && FracBits < 31, "FixedPoint: FracBits must be between 1 and 30");
+
+  private:
+    int32_t raw;
+
+    static int32_t saturate(int64_t value)
+    {
+      return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN ? INT32_MIN : (int32_t)value);
+    }
+
+    static int32_t fromDouble(double value)
+    {
+      double scaled = value * One;
+
+      //round to nearest
+      scaled += scaled < 0 ? -0.5 : 0.5;
+      return scaled >= (double)INT32_MAX ? INT32_MAX : (scaled <= (double)INT32_MIN ? INT32_MIN : (int32_t)scaled);
+    }
+
+  public:
+    static const int64_t One = (int64_t)1 << FracBits;
+
+    FixedPoint() : raw(0) {}
+    FixedPoint(int value) : raw(saturate((int64_t)value * One)) {}
+    FixedPoint(unsigned int value) : raw(saturate((int64_t)value * One)) {}
+    FixedPoint(long value) : raw(saturate((int64_t)value * One)) {}
+    FixedPoint(unsigned long value) : raw(saturate((int64_t)value * One)) {}
+    FixedPoint(float value) : raw(fromDouble(value)) {}
+    FixedPoint(double value) : raw(fromDouble(value)) {}
+
+    //builds a value straight out of its raw representation
+    static FixedPoint fromRaw(int32_t rawValue)
+    {
+      FixedPoint ret;
+      ret.raw = rawValue;
+      return ret;
+    }
+
+    //numerator / denominator, computed exactly before rounding. Lets values too big to hold, like positions in
+    //rotation units, be scaled down without passing through the format first
+    static FixedPoint ratio(long numerator, long denominator)
+    {
+      return fromRaw(saturate(((int64_t)numerator * One) / denominator));
+    }
+
+    int32_t getRaw() const { return raw; }
+
+    //truncates towards zero, like casting a float to an integer does
+    long toLong() const
+    {
+      int64_t value = raw;
+      return value < 0 ? -(long)((-value) >> FracBits) : (long)(value >> FracBits);
+    }
+
+    //value * factor truncated towards zero, without the product having to fit in the format
+    long toLongScaled(long factor) const
+    {
+      int64_t value = (int64_t)raw * factor;
+      return value < 0 ? -(long)((-value) >> FracBits) : (long)(value >> FracBits);
+    }
+
+    float toFloat() const { return (float)raw / One; }
+
+    FixedPoint operator-() const { return fromRaw(saturate(-(int64_t)raw)); }
+
+    friend FixedPoint operator+(FixedPoint a, FixedPoint b) { return fromRaw(saturate((int64_t)a.raw + b.raw)); }
+    friend FixedPoint operator-(FixedPoint a, FixedPoint b) { return fromRaw(saturate((int64_t)a.raw - b.raw)); }
+
+    friend FixedPoint operator*(FixedPoint a, FixedPoint b)
+    {
+      return fromRaw(saturate(((int64_t)a.raw * b.raw + (One >> 1)) >> FracBits));
+    }
+
+    //dividing by zero saturates in the direction of the numerator
+    friend FixedPoint operator/(FixedPoint a, FixedPoint b)
+    {
+      if(b.raw == 0)
+      {
+        return fromRaw(a.raw > 0 ? INT32_MAX : (a.raw < 0 ? INT32_MIN : 0));
+      }
+      return fromRaw(saturate(((int64_t)a.raw * One) / b.raw));
+    }
+
+    FixedPoint& operator+=(FixedPoint b) { return *this = *this + b; }
+    FixedPoint& operator-=(FixedPoint b) { return *this = *this - b; }
+    FixedPoint& operator*=(FixedPoint b) { return *this = *this * b; }
+    FixedPoint& operator/=(FixedPoint b) { return *this = *this / b; }
+
+    friend bool operator==(FixedPoint a, FixedPoint b) { return a.raw == b.raw; }
+    friend bool operator!=(FixedPoint a, FixedPoint b) { return a.raw != b.raw; }
+    friend bool operator<(FixedPoint a, FixedPoint b) { return a.raw < b.raw; }
+    friend bool operator>(FixedPoint a, FixedPoint b) { return a.raw > b.raw; }
+    friend bool operator<=(FixedPoint a, FixedPoint b) { return a.raw <= b.raw; }
+    friend bool operator>=(FixedPoint a, FixedPoint b) { return a.raw >= b.raw; }
+};
+
+//energia defines abs as a macro, which works on FixedPoints as is. Anywhere it doesn't, give it an overload.
+#ifndef abs
+template<int FracBits>
+inline FixedPoint<FracBits> abs(FixedPoint<FracBits> value)
+{
+  return value < 0 ? -value : value;
+}
+#endif
+
+#ifdef ROVEMOTION_FIXED_POINT
+  #ifndef ROVEMOTION_FIXED_FRAC_BITS
+    #define ROVEMOTION_FIXED_FRAC_BITS 16
+  #endif
+
+  typedef FixedPoint<ROVEMOTION_FIXED_FRAC_BITS> MotionReal;
+#else
+  typedef float MotionReal;
+#endif
+
+//helpers that do the same thing under either policy
+
+//truncates towards zero
+inline long motionToLong(float value) { return (long)value; }
+
+template<int FracBits>
+inline long motionToLong(FixedPoint<FracBits> value) { return value.toLong(); }
+
+//converts back to a float, for setup math that needs functions like sqrt
+inline float motionToFloat(float value) { return value; }
+
+template<int FracBits>
+inline float motionToFloat(FixedPoint<FracBits> value) { return value.toFloat(); }
+
+//value * factor truncated towards zero. Use when the product could be out of a FixedPoint's range, IE degrees to
+//milli-degrees
+inline long motionToLongScaled(float value, long factor) { return (long)(value * factor); }
+
+template<int FracBits>
+inline long motionToLongScaled(FixedPoint<FracBits> value, long factor) { return value.toLongScaled(factor); }
+
+//numerator / denominator as a MotionReal
+inline MotionReal motionRatio(long numerator, long denominator)
+{
+#ifdef ROVEMOTION_FIXED_POINT
+  return MotionReal::ratio(numerator, denominator);
+#else
+  return (double)numerator / denominator;
+#endif
+}
+
+//one step of a first order low pass filter; output(n) = k * output(n - 1) + (1 - k) * input(n), truncated.
+//Takes and returns longs so that the filtered values themselves needn't fit in a FixedPoint
+inline long motionLowPass(float k, long lastOutput, long input)
+{
+  return k * lastOutput + (1.0 - k) * input;
+}
+
+template<int FracBits>
+inline long motionLowPass(FixedPoint<FracBits> k, long lastOutput, long input)
+{
+  //same as the float equation, rearranged to lastOutput + (1 - k) * (input - lastOutput) so only the difference gets scaled
+  int64_t scaledStep = (int64_t)(input - lastOutput) * (FixedPoint<FracBits>::One - k.getRaw());
+  int64_t step = scaledStep < 0 ? -((-scaledStep) >> FracBits) : (scaledStep >> FracBits);
+
+  return lastOutput + (long)step;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "RoveMotionProfiler.h"
+#include "RoveBoard.h"
+#include <stdio.h>
+#include <string.h>
+
+//only built when profiling, so that none of it takes up memory otherwise
+#ifdef ROVEMOTION_PROFILING
+
+//the cycle counter is in the DWT, which only the ARMv7-M cores (cortex-m3, m4 and m7) have; cortex-m0 and m0+ fall
+//back on micros() like the host does
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define ROVEMOTION_PROFILER_CYCLE_COUNTER
+
+//cortex-m debug registers for the cycle counter
+static volatile uint32_t* const DEMCR = (volatile uint32_t*)0xE000EDFC;
+static volatile uint32_t* const DWT_CTRL = (volatile uint32_t*)0xE0001000;
+static volatile uint32_t* const DWT_CYCCNT = (volatile uint32_t*)0xE0001004;
+static const uint32_t DEMCR_TRCENA = 1UL << 24;
+static const uint32_t DWT_CTRL_CYCCNTENA = 1;
+#endif
+
+static const char* const SITE_NAMES[ProfileSite_Count] = {"converter", "feedback", "move", "stop", "stopcap"};
+
+MotionProfileStats MotionProfiler::entries[MotionProfiler::MaxEntries];
+uint8_t MotionProfiler::entryCount = 0;
+uint32_t MotionProfiler::droppedCount = 0;
+bool MotionProfiler::started = false;
+
+void MotionProfiler::start()
+{
+#ifdef ROVEMOTION_PROFILER_CYCLE_COUNTER
+  *DEMCR |= DEMCR_TRCENA;
+  *DWT_CYCCNT = 0;
+  *DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+
+  started = true;
+}
+
+uint32_t MotionProfiler::now()
+{
+#ifdef ROVEMOTION_PROFILER_CYCLE_COUNTER
+  return *DWT_CYCCNT;
+#else
+  return micros();
+#endif
+}
+
+void MotionProfiler::record(const void* module, MotionProfileSite site, uint32_t ticks)
+{
+  MotionProfileStats* stats = 0;
+  uint8_t bucket;
+
+  if(!started)
+  {
+    start();
+    return; //the counter wasn't running for this one
+  }
+
+  for(int i = 0; i < entryCount; i++)
+  {
+    if(entries[i].module == module && entries[i].site == site)
+    {
+      stats = &entries[i];
+      break;
+    }
+  }
+
+  if(stats == 0)
+  {
+    if(entryCount >= MaxEntries)
+    {
+      droppedCount++;
+      return;
+    }
+
+    stats = &entries[entryCount++];
+    memset(stats, 0, sizeof(MotionProfileStats));
+    stats->module = module;
+    stats->site = site;
+    stats->minTicks = UINT32_MAX;
+  }
+
+  stats->count++;
+  stats->totalTicks += ticks;
+  if(ticks < stats->minTicks)
+  {
+    stats->minTicks = ticks;
+  }
+  if(ticks > stats->maxTicks)
+  {
+    stats->maxTicks = ticks;
+  }
+
+  //floor of log2
+  bucket = ticks == 0 ? 0 : 31 - __builtin_clz(ticks);
+  if(bucket >= MOTION_PROFILE_BUCKETS)
+  {
+    bucket = MOTION_PROFILE_BUCKETS - 1;
+  }
+  stats->histogram[bucket]++;
+}
+
+void MotionProfiler::reset()
+{
+  entryCount = 0;
+  droppedCount = 0;
+}
+
+uint8_t MotionProfiler::getEntryCount()
+{
+  return entryCount;
+}
+
+const MotionProfileStats* MotionProfiler::getEntry(uint8_t index)
+{
+  return index < entryCount ? &entries[index] : 0;
+}
+
+uint32_t MotionProfiler::getMeanTicks(const MotionProfileStats* stats)
+{
+  return stats->count == 0 ? 0 : stats->totalTicks / stats->count;
+}
+
+uint32_t MotionProfiler::getDroppedCount()
+{
+  return droppedCount;
+}
+
+void MotionProfiler::dump(void (*printLine)(const char* line))
+{
+  char line[160];
+  int length;
+
+  for(int i = 0; i < entryCount; i++)
+  {
+    const MotionProfileStats* stats = &entries[i];
+
+    length = snprintf(line, sizeof(line), "%p %s: n %lu min %lu max %lu mean %lu hist", stats->module, SITE_NAMES[stats->site],
+                      (unsigned long)stats->count, (unsigned long)stats->minTicks, (unsigned long)stats->maxTicks,
+                      (unsigned long)getMeanTicks(stats));
+
+    //only the buckets with anything in them, as bucket:count
+    for(int b = 0; b < MOTION_PROFILE_BUCKETS && length < (int)sizeof(line); b++)
+    {
+      if(stats->histogram[b] != 0)
+      {
+        length += snprintf(line + length, sizeof(line) - length, " %d:%lu", b, (unsigned long)stats->histogram[b]);
+      }
+    }
+
+    printLine(line);
+  }
+
+  if(droppedCount > 0)
+  {
+    snprintf(line, sizeof(line), "dropped %lu", (unsigned long)droppedCount);
+    printLine(line);
+  }
+}
+
+#endif
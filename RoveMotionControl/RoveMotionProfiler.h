@@ -0,0 +1,98 @@
+#ifndef ROVEMOTIONCONTROL_ROVEMOTIONPROFILER_H_
+#define ROVEMOTIONCONTROL_ROVEMOTIONPROFILER_H_
+
+#include <stdint.h>
+
+//Timing instrumentation for the framework's calls into its modules.
+//
+//Define ROVEMOTION_PROFILING in the build to turn it on. The axises then time every call they make into their
+//converter, output devices and stopcap, as do the converters into their feedback devices, and keep min/max/mean and a
+//histogram of the times for each module. Without ROVEMOTION_PROFILING the macros below compile down to the bare call
+//and MotionProfiler isn't built at all, so nothing here costs any time or memory; calls to dump() and the like need
+//to be inside #ifdef ROVEMOTION_PROFILING too.
+//
+//Times are in cpu cycles, read off of the debug unit's cycle counter on cores that have one (cortex-m3, m4 and m7);
+//elsewhere they're in microseconds.
+
+//the kinds of calls that get timed
+enum MotionProfileSite
+{
+  ProfileSite_Converter,      //IOConverter::runAlgorithm, called by an axis
+  ProfileSite_Feedback,       //FeedbackDevice::getFeedback, called by a converter
+  ProfileSite_OutputMove,     //OutputDevice::move, called by an axis
+  ProfileSite_OutputStop,     //OutputDevice::stop, called by an axis
+  ProfileSite_Stopcap,        //StopcapMechanism::getStopcapStatus, called by an axis
+  ProfileSite_Count
+};
+
+//bucket i of a histogram counts calls that took from 2^i up to 2^(i+1) - 1 ticks; the last counts everything longer
+const uint8_t MOTION_PROFILE_BUCKETS = 20;
+
+//timing records of one module's calls from one site
+struct MotionProfileStats
+{
+  const void* module;
+  MotionProfileSite site;
+
+  uint32_t count;
+  uint32_t minTicks;
+  uint32_t maxTicks;
+  uint64_t totalTicks;
+  uint32_t histogram[MOTION_PROFILE_BUCKETS];
+};
+
+//The collected records. Everything is static; there's only the one cycle counter to go around.
+class MotionProfiler
+{
+  public:
+    //how many module and site pairs are tracked; calls from any more are counted as dropped
+    static const uint8_t MaxEntries = 32;
+
+    //turns on the cycle counter. Called by the first record, but call it during setup to keep that out of the timings
+    static void start();
+
+    //the present time, in ticks
+    static uint32_t now();
+
+    //adds a call's time to the module's records for that site
+    static void record(const void* module, MotionProfileSite site, uint32_t ticks);
+
+    //clears every record
+    static void reset();
+
+    //how many records there are, and each of them. Used for publishing the stats over telemetry, for instance
+    static uint8_t getEntryCount();
+    static const MotionProfileStats* getEntry(uint8_t index);
+
+    //average time of a record's calls, in ticks
+    static uint32_t getMeanTicks(const MotionProfileStats* stats);
+
+    //how many calls couldn't be recorded because the table was full
+    static uint32_t getDroppedCount();
+
+    //overview: writes out every record as a line of text, ex for printing over serial.
+    //inputs:   printLine: called with each line, without a line ending
+    static void dump(void (*printLine)(const char* line));
+
+  private:
+    static MotionProfileStats entries[MaxEntries];
+    static uint8_t entryCount;
+    static uint32_t droppedCount;
+    static bool started;
+};
+
+#ifdef ROVEMOTION_PROFILING
+  //times the statement, recording it under the given module and site. ex:
+  //ROVEMOTION_PROFILE(manip, ProfileSite_Converter, mov = manip->runAlgorithm(movement, &converterStatus));
+  #define ROVEMOTION_PROFILE(module, site, ...) \
+    do \
+    { \
+      uint32_t profileStart_ = MotionProfiler::now(); \
+      __VA_ARGS__; \
+      MotionProfiler::record((module), (site), MotionProfiler::now() - profileStart_); \
+    } while(0)
+#else
+  #define ROVEMOTION_PROFILE(module, site, ...) do { __VA_ARGS__; } while(0)
+#endif
+
+#endif
@@ -11,7 +11,7 @@ class FeedbackDevice;
 #define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
 
 //All the types of values that can be passed to and be returned from the clases in the control framework
-enum ValueType{InputSpeed, InputPosition, InputPowerPercent, InputTorque, InputVoltage};
+enum ValueType{InputSpeed, InputPosition, InputPowerPercent, InputTorque, InputVoltage, InputAcceleration};
 
 //the types of return statuses that can be returned from the joint interface's 'run output' methods. They are to inform
 //the caller of the status of the joint after attempting to carry out the user's command
@@ -82,6 +82,7 @@ const uint64_t POS_MIN = 0, POS_MAX = 360000; //started with base of 360.000 for
 const int16_t POWERPERCENT_MIN = -1000, POWERPERCENT_MAX = 1000; //measured in percentile, 1 = .1% power
 const int32_t TORQUE_MIN = -100000, TORQUE_MAX = 100000; // 1 value = 1 milliNewton-meter
 const int32_t VOLT_MIN = -1000000, VOLT_MAX = 1000000; //1 value = 1 milliVolt
+const int32_t ACCEL_MIN = -10000000, ACCEL_MAX = 10000000; //1 value = 1 milliDegree/s^2
 
 const char PERCENT_TO_POWERPERCENT = POWERPERCENT_MAX / 100;
 const float POS_TO_DEGREES = 360.0 / (float)(POS_MAX - POS_MIN);